@@ -0,0 +1,179 @@
+// Compares lexLine() with a scanner that classifies characters by chains of comparisons, as tokenize() used to, in MB/s
+// on long lines of literals, of names and of spaced-out terms.  Build from the repository root with
+//     gcc -std=c11 -O2 -Iheaders bench/lexer.c src/lex.c -o lexer_bench
+// adding -mavx2 for the AVX2 scanner, or -DLEX_NO_SIMD for the table alone, and run as "lexer_bench"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "constants.h"
+#include "lex.h"
+
+static double seconds() {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+	return now.tv_sec + 1e-9 * now.tv_nsec;
+}
+
+static char lastHolder[INPUT_HOLDER_SIZE];  // Where the reference scanner leaves what it copied, so that it is kept
+
+static bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+static bool isExponentStart(const char input[]) {
+	if (input[0] == '-') input++;
+	return isDigit(input[0]);
+}
+
+static int naiveLex(const char text[], lexeme lexemes[]) {
+	// Splits a line the way tokenize() used to: one character at a time, testing each against chains of comparisons and
+	// copying numbers and names into a holder, and stepping over spaces one by one
+	char holder[INPUT_HOLDER_SIZE];
+	int count = 0;
+	int length = 0;
+	int i = 0;
+	int start = 0;
+	int exponents = 0;
+	bool afterE = false;
+	unsigned int token = 0;
+	char c = 0;
+
+	while (text[i] != '\n' && text[i] != '\0') {
+		c = text[i];
+		start = i;
+		length = 0;
+		if (isDigit(c)) {
+			exponents = 0;
+			afterE = false;
+			while (isDigit(c) || c == '.' || c == 'E' || c == '-' || (c == 'e' && isExponentStart(&text[i + 1]))) {
+				if (c == '-' && !afterE) break;
+				afterE = false;
+				if (c == 'E' || c == 'e') {
+					exponents++;
+					afterE = true;
+				}
+				if (exponents > 1) break;
+				if (length < INPUT_HOLDER_SIZE) holder[length++] = c;
+				c = text[++i];
+			}
+			token = LEX_NUMBER;
+		}
+		else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+			while ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || isDigit(c) || c == '_') {
+				if (length < INPUT_HOLDER_SIZE) holder[length++] = c;
+				c = text[++i];
+			}
+			token = LEX_NAME;
+		}
+		else if (c == '<' || c == '>') {
+			i++;
+			token = (c == '<') ? OP_LESS_THAN : OP_GREATER_THAN;
+			if (text[i] == '=' || text[i] == c) i++;
+		}
+		else if (c == '-') {
+			i++;
+			token = LEX_MINUS;
+			if (text[i] == '>') i++;
+		}
+		else {
+			i++;
+			switch (c) {
+			case ' ': token = 0; break;
+			case ',': token = ARG_SEPARATOR; break;
+			case '(': token = LEFT_PARENTH; break;
+			case ')': token = RIGHT_PARENTH; break;
+			case '[': token = LEFT_BRACKET; break;
+			case ']': token = RIGHT_BRACKET; break;
+			case '+': token = OP_ADD; break;
+			case '*': token = OP_MUL; break;
+			case '/': token = OP_DIV; break;
+			case '^': token = OP_EXP; break;
+			case '@': token = OP_MATMUL; break;
+			case '=': token = LEX_EQUALS; break;
+			default: token = LEX_UNKNOWN; break;
+			}
+			if (token == 0) continue;
+		}
+		lexemes[count].token = token;
+		lexemes[count].start = start;
+		lexemes[count].length = i - start;
+		if (length > 0) memcpy(lastHolder, holder, length);
+		count++;
+	}
+	return count;
+}
+
+static char* makeLine(const char* pieces[], int nrPieces, long size) {
+	// Repeats pieces, in a fixed pseudo-random order, into a line of about size bytes
+	char* line = malloc(size + 256);
+	unsigned int seed = 1;
+	long length = 0;
+	const char* piece;
+
+	if (line == NULL) return NULL;
+	while (length < size) {
+		seed = seed * 1103515245u + 12345u;
+		piece = pieces[(seed >> 16) % nrPieces];
+		memcpy(&line[length], piece, strlen(piece));
+		length += (long)strlen(piece);
+	}
+	line[length] = '\n';
+	line[length + 1] = '\0';
+	return line;
+}
+
+static double timeBest(int repeats, const char* line, lexeme* lexemes, int capacity, bool naive, int* count) {
+	// Fastest of several runs, in seconds
+	double best = 1e30;
+	double start;
+	double elapsed;
+
+	for (int r = 0; r < repeats; r++) {
+		start = seconds();
+		*count = naive ? naiveLex(line, lexemes) : lexLine(line, lexemes, capacity);
+		elapsed = seconds() - start;
+		if (elapsed < best) best = elapsed;
+	}
+	return best;
+}
+
+int main() {
+
+	const char* literals[] = { "3.14159265358979323846 * ", "2.718281828459045e-3 + ", "123456789012 - ",
+		"6.02214076E23 / ", "1.380649e-23 + ", "0.5772156649015329 * ", "(42 + 17) * " };
+	const char* names[] = { "temperature_kelvin + ", "pressure_pascal * ", "sin(angle_radians) - ",
+		"sqrt(velocity_x^2 + velocity_y^2) / ", "coefficient_17 * " };
+	const char* spaced[] = { "1.5          +     ", "2.25    *         ", "x         -        " };
+	const char** sets[] = { literals, names, spaced };
+	int setSizes[] = { 7, 5, 3 };
+	const char* setNames[] = { "literals", "names", "spaces" };
+	long sizes[] = { 1024, 65536, 4194304 };
+	char* line;
+	lexeme* lexemes;
+	int capacity;
+	int naiveCount, count;
+	double naive, lexer;
+
+	printf("line,bytes,naive_mb_s,lexer_mb_s,speedup,lexemes\n");
+	for (int s = 0; s < 3; s++) {
+		for (int z = 0; z < 3; z++) {
+			line = makeLine(sets[s], setSizes[s], sizes[z]);
+			capacity = (int)sizes[z];
+			lexemes = malloc(capacity * sizeof(lexeme));
+			if (line == NULL || lexemes == NULL) return 1;
+
+			naive = timeBest(sizes[z] < 100000 ? 200 : 5, line, lexemes, capacity, true, &naiveCount);
+			lexer = timeBest(sizes[z] < 100000 ? 200 : 5, line, lexemes, capacity, false, &count);
+			printf("%s,%ld,%.1f,%.1f,%.2f,%d\n", setNames[s], (long)strlen(line), strlen(line) / naive * 1e-6,
+				strlen(line) / lexer * 1e-6, naive / lexer, count);
+			if (count != naiveCount) fprintf(stderr, "%s: the scanners found %d and %d lexemes\n", setNames[s], naiveCount, count);
+
+			free(line);
+			free(lexemes);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,117 @@
+// Compares multiplyMatrices() with a naive triple loop, and times LU factorization, in GFLOP/s.
+// Build from the repository root with
+//     gcc -std=c11 -O2 -Iheaders bench/matrix.c src/matrix.c src/parallel.c -lm -lpthread -o matrix_bench
+// and run as "matrix_bench [threads]"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include "constants.h"
+#include "parallel.h"
+#include "matrix.h"
+
+static double seconds() {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+	return now.tv_sec + 1e-9 * now.tv_nsec;
+}
+
+static void naiveMultiply(long n, const double* a, const double* b, double* c) {
+	for (long i = 0; i < n; i++) {
+		for (long j = 0; j < n; j++) {
+			double sum = 0.0;
+			for (long p = 0; p < n; p++) sum += a[i * n + p] * b[p * n + j];
+			c[i * n + j] = sum;
+		}
+	}
+}
+
+static void fill(double* values, long count, unsigned int seed) {
+	for (long i = 0; i < count; i++) {
+		seed = seed * 1103515245u + 12345u;
+		values[i] = (double)(seed >> 8) / 16777216.0 - 0.5;
+	}
+}
+
+static double timeBest(int repeats, void (*run)(void*), void* context) {
+	// Fastest of several runs, in seconds
+	double best = 1e30;
+	double start;
+	double elapsed;
+
+	for (int r = 0; r < repeats; r++) {
+		start = seconds();
+		run(context);
+		elapsed = seconds() - start;
+		if (elapsed < best) best = elapsed;
+	}
+	return best;
+}
+
+typedef struct {
+	long n;
+	double* a;
+	double* b;
+	double* c;
+	long* pivots;
+} benchCase;
+
+static void runNaive(void* context) {
+	benchCase* bench = context;
+	naiveMultiply(bench->n, bench->a, bench->b, bench->c);
+}
+
+static void runBlocked(void* context) {
+	benchCase* bench = context;
+	for (long i = 0; i < bench->n * bench->n; i++) bench->c[i] = 0.0;
+	multiplyMatrices(bench->n, bench->n, bench->n, bench->a, bench->n, bench->b, bench->n, bench->c, bench->n, false);
+}
+
+static void runLU(void* context) {
+	benchCase* bench = context;
+	int sign;
+	for (long i = 0; i < bench->n * bench->n; i++) bench->c[i] = bench->a[i];
+	factorLU(bench->c, bench->n, bench->pivots, &sign);
+}
+
+int main(int argc, char* argv[]) {
+
+	long sizes[] = { 64, 128, 256, 512, 1024, 2048 };
+	benchCase bench;
+	double naive, blocked, lu, flops;
+
+	if (argc > 1) setNrThreads(atoi(argv[1]));
+	printf("n,naive_gflops,blocked_gflops,speedup,lu_gflops\n");
+
+	for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+		bench.n = sizes[s];
+		bench.a = malloc(bench.n * bench.n * sizeof(double));
+		bench.b = malloc(bench.n * bench.n * sizeof(double));
+		bench.c = malloc(bench.n * bench.n * sizeof(double));
+		bench.pivots = malloc(bench.n * sizeof(long));
+		if (bench.a == NULL || bench.b == NULL || bench.c == NULL || bench.pivots == NULL) return 1;
+		fill(bench.a, bench.n * bench.n, 1);
+		fill(bench.b, bench.n * bench.n, 2);
+		for (long i = 0; i < bench.n; i++) bench.a[i * bench.n + i] += bench.n;
+
+		flops = 2.0 * bench.n * bench.n * bench.n;
+		naive = (bench.n <= 1024) ? timeBest(3, runNaive, &bench) : 0.0;
+		blocked = timeBest(3, runBlocked, &bench);
+		lu = timeBest(3, runLU, &bench);
+		// The naive loop takes too long on the largest matrices, which show - in its columns
+		if (naive > 0.0) {
+			printf("%ld,%.2f,%.2f,%.1f,%.2f\n", bench.n, flops / naive * 1e-9, flops / blocked * 1e-9, naive / blocked,
+				flops / 3.0 / lu * 1e-9);
+		}
+		else {
+			printf("%ld,-,%.2f,-,%.2f\n", bench.n, flops / blocked * 1e-9, flops / 3.0 / lu * 1e-9);
+		}
+
+		free(bench.a);
+		free(bench.b);
+		free(bench.c);
+		free(bench.pivots);
+	}
+	return 0;
+}
@@ -0,0 +1,526 @@
+// Times each stage of evaluating a line, and whole lines, over a corpus of generated expressions.  The corpus is made
+// from a fixed seed, so it is the same on every run and every commit, and holds lines of several shapes: short sums,
+// long chains of operators, nested parentheses, function calls, variables with implicit multiplication, and
+// assignments.  Stages are lexing alone (lexInput), conversion to RPN with lexing (inputToRPN), compiling, running and
+// printing (evaluateRPN), and lookups of names (findVariableSlot).  Whole lines are read from a file, evaluated and
+// printed as the interpreter does, for the whole corpus and for each shape.  Each benchmark is run a few times untimed
+// to warm up caches, and then timed over several runs, from which the mean, the 95% confidence interval of the mean,
+// and lines, or lookups, per second are found.  Results are printed as a table on stderr and written as JSON, and a
+// JSON file of an earlier build can be given to compare with, marking changes whose intervals don't overlap.
+// "make bench" builds and runs it, and it can be run by hand from the repository root, where defaultvars.txt is, as
+//     pipeline_bench [-o results.json] [-c baseline.json] [-r runs] [-w warmups] [-n lines] [-s seed] [--corpus]
+// Printed results go to the null device.  --corpus prints the corpus instead of timing it
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "constants.h"
+#include "tokenize.h"
+#include "auxiliary.h"
+#include "variables.h"
+#include "rpn.h"
+#include "global.h"
+
+#ifdef _WIN32
+#define NULL_DEVICE "NUL"
+#else
+#define NULL_DEVICE "/dev/null"
+#endif
+
+#define MAX_LINE 2048     // Longest line that is generated
+#define MAX_RUNS 1000
+#define NR_NAMES 64       // Names looked up by the lookup benchmark
+#define LOOKUP_REPEATS 2000
+
+typedef enum { SHAPE_SHORT, SHAPE_CHAIN, SHAPE_NESTED, SHAPE_CALLS, SHAPE_VARIABLES, SHAPE_ASSIGN, NR_SHAPES } shapes;
+
+static const char* shapeNames[NR_SHAPES] = { "short", "chain", "nested", "calls", "variables", "assign" };
+static const char* unaryFunctions[] = { "sin", "cos", "tan", "sqrt", "ln", "abs", "floor", "atan", "erf", "sinh" };
+static const char* binaryFunctions[] = { "atan2", "hypot" };
+static const char* binaryOperators[] = { " + ", " - ", " * ", " / ", "+", "-", "*", "/" };
+static const char* powers[] = { "^2", " ^ 3", "^0.5" };  // Small powers, so that results rarely overflow
+static const char* variables[] = { "a", "b", "c", "d", "alpha", "beta", "gamma0", "delta", "pi", "e" };
+
+// Lines are set before the corpus so that its variables are defined
+static const char* setupLines[] = { "a = 1.5", "b = -2.25", "c = 3", "d = 0.125", "alpha = 0.7", "beta = 1e-3",
+	"gamma0 = 42", "delta = 2.5e2" };
+
+typedef struct {
+	char** lines;
+	int* shape;
+	int nrLines;
+} corpus;
+
+typedef struct {
+	const char* name;
+	int items;            // Lines, or names looked up, handled by each run
+	int nrRuns;
+	double runs[MAX_RUNS];
+	double mean;
+	double halfWidth;     // Of the 95% confidence interval of the mean
+	double best;
+} result;
+
+static unsigned long long int seed;
+
+static double seconds() {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+	return now.tv_sec + 1e-9 * now.tv_nsec;
+}
+
+static unsigned int randomBelow(unsigned int limit) {
+	// Next value of a xorshift generator, reduced to below limit
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	return (unsigned int)((seed >> 32) % limit);
+}
+
+static void append(char line[], int* length, const char* text) {
+	// Adds text to a line being generated, dropping what doesn't fit
+	int size = (int)strlen(text);
+
+	if (*length + size >= MAX_LINE) return;
+	memcpy(&line[*length], text, size + 1);
+	*length += size;
+}
+
+static void appendNumber(char line[], int* length) {
+	// Adds an integer, a decimal or a number in scientific notation
+	char number[32];
+
+	switch (randomBelow(3)) {
+	case 0:
+		snprintf(number, sizeof(number), "%u", randomBelow(1000) + 1);
+		break;
+	case 1:
+		snprintf(number, sizeof(number), "%u.%u", randomBelow(100), randomBelow(1000));
+		break;
+	default:
+		snprintf(number, sizeof(number), "%u.%ue%d", randomBelow(9) + 1, randomBelow(100), (int)randomBelow(7) - 3);
+		break;
+	}
+	append(line, length, number);
+}
+
+static void appendTerm(char line[], int* length, int shape, int depth) {
+	// Adds an operand of the given shape: a number, a variable, a call or an expression in parentheses, nesting at
+	// most depth deep
+	unsigned int kind = randomBelow(depth > 0 ? 4 : 2);
+	char number[16];
+
+	if (shape == SHAPE_SHORT || shape == SHAPE_CHAIN) kind = 0;
+	if (shape == SHAPE_NESTED && depth > 0) kind = 3;
+	if (kind == 1 && shape != SHAPE_VARIABLES && shape != SHAPE_ASSIGN) kind = 0;
+	if (kind == 2 && shape != SHAPE_CALLS && shape != SHAPE_ASSIGN) kind = 3;
+	switch (kind) {
+	case 0:
+		appendNumber(line, length);
+		break;
+	case 1:
+		// A variable, sometimes implicitly multiplied by a whole number
+		if (randomBelow(3) == 0) {
+			snprintf(number, sizeof(number), "%u", randomBelow(100) + 2);
+			append(line, length, number);
+		}
+		append(line, length, variables[randomBelow(sizeof(variables) / sizeof(variables[0]))]);
+		break;
+	case 2:
+		if (randomBelow(4) == 0) {
+			append(line, length, binaryFunctions[randomBelow(sizeof(binaryFunctions) / sizeof(binaryFunctions[0]))]);
+			append(line, length, "(");
+			appendTerm(line, length, shape, depth - 1);
+			append(line, length, ", ");
+			appendTerm(line, length, shape, depth - 1);
+		}
+		else {
+			append(line, length, unaryFunctions[randomBelow(sizeof(unaryFunctions) / sizeof(unaryFunctions[0]))]);
+			append(line, length, "(");
+			appendTerm(line, length, shape, depth - 1);
+		}
+		append(line, length, ")");
+		break;
+	default:
+		append(line, length, "(");
+		appendTerm(line, length, shape, depth - 1);
+		for (unsigned int i = randomBelow(3); i > 0; i--) {
+			append(line, length, binaryOperators[randomBelow(4)]);
+			appendTerm(line, length, shape, depth - 1);
+		}
+		append(line, length, ")");
+		break;
+	}
+}
+
+static void makeLine(char line[], int shape) {
+	// Generates one line of the given shape
+	int length = 0;
+	int nrTerms = 0;
+	char name[16];
+
+	line[0] = '\0';
+	switch (shape) {
+	case SHAPE_SHORT:
+		nrTerms = 2 + randomBelow(2);
+		break;
+	case SHAPE_CHAIN:
+		nrTerms = 20 + randomBelow(60);
+		break;
+	case SHAPE_NESTED:
+		nrTerms = 1 + randomBelow(3);
+		break;
+	case SHAPE_ASSIGN:
+		snprintf(name, sizeof(name), "v%u = ", randomBelow(16));
+		append(line, &length, name);
+		// Fall through
+	default:
+		nrTerms = 2 + randomBelow(5);
+		break;
+	}
+	for (int i = 0; i < nrTerms; i++) {
+		if (i > 0) append(line, &length, binaryOperators[randomBelow(sizeof(binaryOperators) / sizeof(binaryOperators[0]))]);
+		appendTerm(line, &length, shape, shape == SHAPE_NESTED ? 4 : 3);
+		if (randomBelow(8) == 0) append(line, &length, powers[randomBelow(sizeof(powers) / sizeof(powers[0]))]);
+	}
+}
+
+static bool makeCorpus(corpus* lines, int nrLines) {
+	// Generates nrLines lines, with the shapes taking turns.  Returns false if there is no memory
+	char line[MAX_LINE];
+
+	lines->lines = malloc(nrLines * sizeof(char*));
+	lines->shape = malloc(nrLines * sizeof(int));
+	lines->nrLines = 0;
+	if (lines->lines == NULL || lines->shape == NULL) return false;
+	for (int i = 0; i < nrLines; i++) {
+		lines->shape[i] = i % NR_SHAPES;
+		makeLine(line, lines->shape[i]);
+		lines->lines[i] = malloc(strlen(line) + 1);
+		if (lines->lines[i] == NULL) return false;
+		strcpy(lines->lines[i], line);
+		lines->nrLines++;
+	}
+	return true;
+}
+
+static void setInput(const char* line) {
+	// Puts a line into terminalInput as readLine() would leave it
+	int length = (int)strlen(line);
+
+	reserveInput(length + 2);
+	memcpy(terminalInput, line, length);
+	terminalInput[length] = '\n';
+	terminalInput[length + 1] = '\0';
+}
+
+static void endLine() {
+	// Clears what a line left behind, as the interpreter does between lines
+	double printVal = 0.0;
+
+	resetValues(&printVal);
+	compactVariables();
+}
+
+static double runLex(const corpus* lines, int shape) {
+	// Lexes every line.  Returns the time taken
+	double start = seconds();
+
+	for (int i = 0; i < lines->nrLines; i++) {
+		setInput(lines->lines[i]);
+		lexInput(0);
+	}
+	(void)shape;
+	return seconds() - start;
+}
+
+static double runParse(const corpus* lines, int shape) {
+	// Converts every line to RPN, lexing it first.  Returns the time taken
+	double start = seconds();
+
+	for (int i = 0; i < lines->nrLines; i++) {
+		setInput(lines->lines[i]);
+		inputToRPN();
+		endLine();
+	}
+	(void)shape;
+	return seconds() - start;
+}
+
+static double runEvaluate(const corpus* lines, int shape) {
+	// Compiles, runs and prints every line once it is in RPN.  Returns the time taken by that alone
+	double total = 0.0;
+	double start = 0.0;
+
+	for (int i = 0; i < lines->nrLines; i++) {
+		setInput(lines->lines[i]);
+		inputToRPN();
+		if (error == NO_ERROR) {
+			start = seconds();
+			evaluateRPN();
+			total += seconds() - start;
+		}
+		endLine();
+	}
+	(void)shape;
+	return total;
+}
+
+static char lookupNames[NR_NAMES][INPUT_HOLDER_SIZE];
+
+static double runLookup(const corpus* lines, int shape) {
+	// Looks up names of variables, constants and names that aren't defined.  Returns the time taken
+	double start = seconds();
+	volatile int found = 0;
+
+	for (int r = 0; r < LOOKUP_REPEATS; r++) {
+		for (int i = 0; i < NR_NAMES; i++) found += findVariableSlot(lookupNames[i]);
+	}
+	(void)lines;
+	(void)shape;
+	return seconds() - start;
+}
+
+static FILE* corpusFile;  // The corpus, one line after another, as the interpreter reads it
+
+static double runLines(const corpus* lines, int shape) {
+	// Reads, evaluates and prints the lines of a shape, or every line if shape is NR_SHAPES, as the interpreter does.
+	// Returns the time taken
+	double start = seconds();
+	int i = 0;
+
+	rewind(corpusFile);
+	while (readLine(corpusFile)) {
+		if (shape == NR_SHAPES || lines->shape[i] == shape) {
+			inputToRPN();
+			if (error == NO_ERROR) evaluateRPN();
+			if (error != NO_ERROR) printError();
+		}
+		endLine();
+		i++;
+	}
+	return seconds() - start;
+}
+
+static double tQuantile(int degrees) {
+	// Two sided 95% quantile of Student's t distribution
+	static const double table[] = { 0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201,
+		2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052,
+		2.048, 2.045, 2.042 };
+
+	if (degrees < 1) return 0.0;
+	if (degrees <= 30) return table[degrees];
+	return 1.96 + 2.4 / degrees;
+}
+
+static void timeBenchmark(result* bench, double (*run)(const corpus*, int), const corpus* lines, int shape,
+	int warmups, int nrRuns) {
+	// Runs a benchmark warmups times untimed and nrRuns times timed, and finds the statistics of the timed runs
+	double sum = 0.0;
+	double squares = 0.0;
+
+	for (int i = 0; i < warmups; i++) run(lines, shape);
+	bench->nrRuns = nrRuns;
+	bench->best = 1e30;
+	for (int i = 0; i < nrRuns; i++) {
+		bench->runs[i] = run(lines, shape);
+		sum += bench->runs[i];
+		if (bench->runs[i] < bench->best) bench->best = bench->runs[i];
+	}
+	bench->mean = sum / nrRuns;
+	for (int i = 0; i < nrRuns; i++) squares += (bench->runs[i] - bench->mean) * (bench->runs[i] - bench->mean);
+	bench->halfWidth = nrRuns > 1 ? tQuantile(nrRuns - 1) * sqrt(squares / (nrRuns - 1) / nrRuns) : 0.0;
+}
+
+static bool readBaseline(const char* fileName, const char* name, double* mean, double* halfWidth) {
+	// Finds the mean time per item, and its confidence interval, of a benchmark in a JSON file written by writeResults()
+	static char* text = NULL;
+	static const char* textName = NULL;
+	char key[64];
+	const char* found = NULL;
+	FILE* file = NULL;
+	long size = 0;
+	int items = 0;
+
+	if (textName != fileName) {
+		free(text);
+		text = NULL;
+		textName = fileName;
+		file = fopen(fileName, "rb");
+		if (file == NULL) return false;
+		fseek(file, 0, SEEK_END);
+		size = ftell(file);
+		rewind(file);
+		text = malloc(size + 1);
+		if (text != NULL) text[fread(text, 1, size, file)] = '\0';
+		fclose(file);
+	}
+	if (text == NULL) return false;
+	snprintf(key, sizeof(key), "\"%s\": {", name);
+	found = strstr(text, key);
+	if (found == NULL || sscanf(found + strlen(key), " \"items\": %d, \"mean\": %lf, \"ci95\": %lf", &items, mean,
+		halfWidth) != 3 || items <= 0) return false;
+	*mean /= items;
+	*halfWidth /= items;
+	return true;
+}
+
+static void printResults(const result results[], int nrResults, const char* baselineName) {
+	// Prints a table of the results, with the change in time per item from the baseline if one is given.  A change is
+	// marked with * when the confidence intervals don't overlap
+	double mean = 0.0;
+	double halfWidth = 0.0;
+	double itemMean = 0.0;
+	double itemHalfWidth = 0.0;
+
+	fprintf(stderr, "%-18s %8s %12s %10s %14s", "benchmark", "items", "mean (s)", "ci95 (s)", "items/s");
+	fprintf(stderr, baselineName != NULL ? "%10s\n" : "\n", "change");
+	for (int i = 0; i < nrResults; i++) {
+		fprintf(stderr, "%-18s %8d %12.6f %10.6f %14.0f", results[i].name, results[i].items, results[i].mean,
+			results[i].halfWidth, results[i].items / results[i].mean);
+		if (baselineName != NULL && readBaseline(baselineName, results[i].name, &mean, &halfWidth)) {
+			itemMean = results[i].mean / results[i].items;
+			itemHalfWidth = results[i].halfWidth / results[i].items;
+			fprintf(stderr, "%+9.1f%%%s", 100.0 * (itemMean - mean) / mean,
+				fabs(itemMean - mean) > itemHalfWidth + halfWidth ? "*" : "");
+		}
+		fprintf(stderr, "\n");
+	}
+}
+
+static bool writeResults(const char* fileName, const result results[], int nrResults, const corpus* lines,
+	unsigned long long int corpusSeed, int warmups) {
+	// Writes the results as JSON.  Returns false if the file can't be written
+	FILE* file = fopen(fileName, "w");
+	long bytes = 0;
+
+	if (file == NULL) return false;
+	for (int i = 0; i < lines->nrLines; i++) bytes += (long)strlen(lines->lines[i]) + 1;
+	fprintf(file, "{\n  \"corpus\": {\"seed\": %llu, \"lines\": %d, \"bytes\": %ld},\n", corpusSeed, lines->nrLines,
+		bytes);
+	fprintf(file, "  \"warmups\": %d,\n  \"results\": {\n", warmups);
+	for (int i = 0; i < nrResults; i++) {
+		fprintf(file, "    \"%s\": { \"items\": %d, \"mean\": %.9f, \"ci95\": %.9f, \"best\": %.9f, "
+			"\"per_second\": %.1f, \"runs\": [", results[i].name, results[i].items, results[i].mean,
+			results[i].halfWidth, results[i].best, results[i].items / results[i].mean);
+		for (int r = 0; r < results[i].nrRuns; r++) fprintf(file, r == 0 ? "%.9f" : ", %.9f", results[i].runs[r]);
+		fprintf(file, i + 1 < nrResults ? "] },\n" : "] }\n");
+	}
+	fprintf(file, "  }\n}\n");
+	return fclose(file) == 0;
+}
+
+int main(int argc, char** argv) {
+
+	const char* outputName = NULL;
+	const char* baselineName = NULL;
+	unsigned long long int corpusSeed = 20240601;
+	int nrRuns = 10;
+	int warmups = 2;
+	int nrLines = 6000;
+	bool printCorpus = false;
+	corpus lines;
+	result* results = NULL;
+	int nrResults = 0;
+	int perShape[NR_SHAPES] = { 0 };
+	char* names[NR_SHAPES];
+	char constantsName[64] = "defaultvars.txt";
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			outputName = argv[++i];
+		}
+		else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+			baselineName = argv[++i];
+		}
+		else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+			nrRuns = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+			warmups = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+			nrLines = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+			corpusSeed = strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--corpus") == 0) {
+			printCorpus = true;
+		}
+		else {
+			fprintf(stderr, "Unrecognized option \"%s\"\n", argv[i]);
+			return 1;
+		}
+	}
+	if (nrRuns < 1 || nrRuns > MAX_RUNS || warmups < 0 || nrLines < NR_SHAPES) {
+		fprintf(stderr, "Expected 1 to %d runs, no fewer than 0 warmups and at least %d lines\n", MAX_RUNS, NR_SHAPES);
+		return 1;
+	}
+
+	seed = corpusSeed != 0 ? corpusSeed : 1;
+	if (!makeCorpus(&lines, nrLines)) return 1;
+	if (printCorpus) {
+		for (int i = 0; i < lines.nrLines; i++) printf("%s\n", lines.lines[i]);
+		return 0;
+	}
+	corpusFile = tmpfile();
+	if (corpusFile == NULL) return 1;
+	for (int i = 0; i < lines.nrLines; i++) fprintf(corpusFile, "%s\n", lines.lines[i]);
+	for (int i = 0; i < lines.nrLines; i++) perShape[lines.shape[i]]++;
+
+	if (freopen(NULL_DEVICE, "w", stdout) == NULL) return 1;
+	initVariables();
+	loadVariables(CONST_START, USER_VAR_START, constantsName);
+	for (int i = 0; i < (int)(sizeof(setupLines) / sizeof(setupLines[0])); i++) {
+		setInput(setupLines[i]);
+		inputToRPN();
+		evaluateRPN();
+		endLine();
+	}
+	for (int i = 0; i < NR_NAMES; i++) {
+		// Every other name is defined, and the others are names from the corpus that aren't, or are misspelled
+		if (i % 2 == 0) {
+			strcpy(lookupNames[i], variables[(i / 2) % (sizeof(variables) / sizeof(variables[0]))]);
+		}
+		else {
+			snprintf(lookupNames[i], INPUT_HOLDER_SIZE, "%s%d", i % 4 == 1 ? "v" : "missing", i);
+		}
+	}
+
+	results = calloc(5 + NR_SHAPES, sizeof(result));
+	if (results == NULL) return 1;
+	results[nrResults].name = "lex";
+	results[nrResults].items = lines.nrLines;
+	timeBenchmark(&results[nrResults++], runLex, &lines, NR_SHAPES, warmups, nrRuns);
+	results[nrResults].name = "parse";
+	results[nrResults].items = lines.nrLines;
+	timeBenchmark(&results[nrResults++], runParse, &lines, NR_SHAPES, warmups, nrRuns);
+	results[nrResults].name = "evaluate";
+	results[nrResults].items = lines.nrLines;
+	timeBenchmark(&results[nrResults++], runEvaluate, &lines, NR_SHAPES, warmups, nrRuns);
+	results[nrResults].name = "lookup";
+	results[nrResults].items = NR_NAMES * LOOKUP_REPEATS;
+	timeBenchmark(&results[nrResults++], runLookup, &lines, NR_SHAPES, warmups, nrRuns);
+	results[nrResults].name = "lines";
+	results[nrResults].items = lines.nrLines;
+	timeBenchmark(&results[nrResults++], runLines, &lines, NR_SHAPES, warmups, nrRuns);
+	for (int shape = 0; shape < NR_SHAPES; shape++) {
+		names[shape] = malloc(strlen(shapeNames[shape]) + 7);
+		if (names[shape] == NULL) return 1;
+		sprintf(names[shape], "lines.%s", shapeNames[shape]);
+		results[nrResults].name = names[shape];
+		results[nrResults].items = perShape[shape];
+		timeBenchmark(&results[nrResults++], runLines, &lines, shape, warmups, nrRuns);
+	}
+
+	printResults(results, nrResults, baselineName);
+	if (outputName != NULL && !writeResults(outputName, results, nrResults, &lines, corpusSeed, warmups)) {
+		fprintf(stderr, "Could not write %s\n", outputName);
+		return 1;
+	}
+	return 0;
+}
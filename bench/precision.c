@@ -0,0 +1,92 @@
+// Times the functions of the multi-precision mode set by "prec" at 50, 1000 and 100000 significant digits: pi the first
+// time it is found, and then sqrt, exp, ln, sin, atan, erf and gamma of a number that isn't a constant.  gamma is left
+// out at 100000 digits, where Stirling's series takes far too long.  Build from the repository root with
+//     gcc -std=c11 -O2 -Iheaders bench/precision.c src/bigfloat.c src/bigint.c src/auxiliary.c src/profile.c src/global.c -lm -o precision_bench
+// and run as "precision_bench"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include "constants.h"
+#include "bigfloat.h"
+
+static double seconds() {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+	return now.tv_sec + 1e-9 * now.tv_nsec;
+}
+
+typedef struct {
+	const char* name;
+	unsigned int operand;
+	const char* argument;
+} benchCase;
+
+static double timeBest(int repeats, const benchCase* bench, long long int bits) {
+	// Fastest of several runs, in seconds, or -1 if there is no memory.  exp is timed as e^x, as the interpreter does it
+	bigFloat value, argument;
+	double best = 1e30;
+	double start;
+	bool ok = true;
+
+	initFloat(&value);
+	initFloat(&argument);
+	for (int r = 0; r < repeats && ok; r++) {
+		ok = setFloatText(&argument, bench->argument, bits) && copyFloat(&value, &argument)
+			&& (bench->operand != OP_EXP || setFloatConstant(&value, "e", bits));
+		start = seconds();
+		if (bench->operand == OP_EXP) {
+			ok = ok && applyFloatBinary(OP_EXP, &value, &argument, bits);
+		}
+		else {
+			ok = ok && applyFloatUnary(bench->operand, &value, bits);
+		}
+		if (seconds() - start < best) best = seconds() - start;
+	}
+	freeFloat(&value);
+	freeFloat(&argument);
+	return ok ? best : -1.0;
+}
+
+int main() {
+
+	int digits[] = { 50, 1000, 100000 };
+	int repeats[] = { 200, 10, 1 };
+	benchCase cases[] = {
+		{ "sqrt", OP_SQRT, "2" },
+		{ "exp", OP_EXP, "0.7" },
+		{ "ln", OP_LN, "0.7" },
+		{ "sin", OP_SIN, "0.7" },
+		{ "atan", OP_ATAN, "0.7" },
+		{ "erf", OP_ERF, "0.5" },
+		{ "gamma", OP_GAMMA, "0.7" },
+	};
+	bigFloat constant;
+	long long int bits = 0;
+	double start;
+
+	printf("%-8s", "digits");
+	printf("%12s", "pi");
+	for (int c = 0; c < (int)(sizeof(cases) / sizeof(cases[0])); c++) printf("%12s", cases[c].name);
+	printf("\n");
+	initFloat(&constant);
+	for (int d = 0; d < 3; d++) {
+		bits = precisionBits(digits[d]);
+		printf("%-8d", digits[d]);
+		start = seconds();
+		if (!setFloatConstant(&constant, "pi", bits)) return 1;
+		printf("%12.6f", seconds() - start);
+		for (int c = 0; c < (int)(sizeof(cases) / sizeof(cases[0])); c++) {
+			if (cases[c].operand == OP_GAMMA && digits[d] > 10000) {
+				printf("%12s", "-");
+				continue;
+			}
+			printf("%12.6f", timeBest(repeats[d], &cases[c], bits));
+			fflush(stdout);
+		}
+		printf("\n");
+	}
+	freeFloat(&constant);
+	return 0;
+}
@@ -0,0 +1,35 @@
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#define KLL_MAX_LEVELS 48
+#define AGGREGATE_STRIPES 16  // Parts of an array aggregated in parallel
+
+// Summary statistics of a stream of values.  Partial aggregates of separate parts of a stream can be merged
+typedef struct {
+	long long int count;
+	long long int undefined;   // NaN values, which are left out of everything else
+	double sum;
+	double compensation;       // Rounding error of the sum
+	double mean;
+	double m2;                 // Sum of squared differences from the mean
+	double min;
+	double max;
+	int nrLevels;              // Levels of the quantile sketch.  Items at level h stand for 2^h values
+	double* items[KLL_MAX_LEVELS];
+	int size[KLL_MAX_LEVELS];
+	int capacity[KLL_MAX_LEVELS];
+	int bottomCapacity;        // Capacity of level 0, which changes with the number of levels
+	unsigned int compactions;
+} aggregate;
+
+void initAggregate(aggregate* stats);
+void freeAggregate(aggregate* stats);
+void addValue(aggregate* stats, double value);
+void addValues(aggregate* stats, const double values[], long long int count, long long int stride);
+void addValuesParallel(aggregate stripes[], const double values[], long long int count);
+void mergeAggregate(aggregate* stats, aggregate* other);
+double findQuantile(const aggregate* stats, double fraction);
+void printStatsHeader();
+void printStats(const char name[], const aggregate* stats);
+
+#endif
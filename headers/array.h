@@ -0,0 +1,9 @@
+#ifndef ARRAY_H
+#define ARRAY_H
+
+#include "compile.h"
+
+int executeArrayInstruction(const program* prog, int pc, double stack[], int* stackLength);
+void clearArrays();
+
+#endif
@@ -1,16 +1,35 @@
-#ifndef AUXILIARY_H
-#define AUXILIARY_H
-
-int findNumDecimals(double input);
-unsigned int pop(unsigned int arr[], int* length);
-void push(unsigned int arr[], unsigned int val, int* length, int maxLength);
-bool stackIsEmpty(unsigned int stack[]);
-bool isFunction(unsigned int token);
-bool isOperator(unsigned int token);
-bool isBinaryOperator(unsigned int token);
-long long int doubleToInt(double input);
-double gcd(double a, double b);
-unsigned int findFunction(char input[]);
-void resetValues(double* printVal);
-
+#ifndef AUXILIARY_H
+#define AUXILIARY_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "bigint.h"
+#include "bigfloat.h"
+
+int findNumDecimals(double input);
+unsigned int pop(unsigned int arr[], int* length);
+void push(unsigned int arr[], unsigned int val, int* length, int maxLength);
+bool stackIsEmpty(unsigned int stack[]);
+bool growBuffer(void* buffer, int* capacity, int needed, int size);
+bool isOperand(unsigned int token);
+bool isFunction(unsigned int token);
+bool isOperator(unsigned int token);
+bool isBinaryOperator(unsigned int token);
+int nrArguments(unsigned int token);
+int minArguments(unsigned int token);
+long long int doubleToInt(double input);
+bool fitsInteger(double input);
+double gcd(double a, double b);
+unsigned int findFunction(char input[]);
+bool parseRange(char spec[], char name[], double values[], int maxValues, int* nrValues);
+void printResult(double value);
+void printInteger(long long int value);
+void printBigInteger(const bigInteger* value);
+void printBigFloat(const bigFloat* value, int digits);
+void printArray(const void* values, long length, long columns, char type);
+void printError();
+bool reserveInput(int length);
+bool readLine(FILE* file);
+void resetValues(double* printVal);
+
 #endif
\ No newline at end of file
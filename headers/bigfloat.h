@@ -0,0 +1,29 @@
+#ifndef BIGFLOAT_H
+#define BIGFLOAT_H
+
+#include <stdbool.h>
+#include "bigint.h"
+
+// A binary floating point number of any precision, of value mantissa * 2^exponent, or undefined, as NaN is.  Every
+// operation rounds its result to a number of bits it is given.  The mantissa of a value that isn't zero is odd
+typedef struct {
+	bigInteger mantissa;
+	long long int exponent;
+	bool undefined;
+} bigFloat;
+
+void initFloat(bigFloat* value);
+void freeFloat(bigFloat* value);
+bool copyFloat(bigFloat* to, const bigFloat* from);
+long long int precisionBits(int digits);
+bool setFloat(bigFloat* value, double number, long long int bits);
+bool setFloatInteger(bigFloat* value, const bigInteger* integer, long long int bits);
+bool setFloatText(bigFloat* value, const char text[], long long int bits);
+bool setFloatConstant(bigFloat* value, const char name[], long long int bits);
+double floatToDouble(const bigFloat* value);
+char* floatToString(const bigFloat* value, int digits, bool scientific);
+bool isFloatOperator(unsigned int operand);
+bool applyFloatBinary(unsigned int operand, bigFloat* left, const bigFloat* right, long long int bits);
+bool applyFloatUnary(unsigned int operand, bigFloat* value, long long int bits);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// An integer of any size: its sign, and its magnitude in 32-bit limbs, the lowest first, with no zero limbs at the top
+typedef struct {
+	uint32_t* limbs;
+	int length;     // Limbs in use.  Zero has none
+	int capacity;
+	bool negative;
+} bigInteger;
+
+void initBig(bigInteger* value);
+void freeBig(bigInteger* value);
+bool setBig(bigInteger* value, long long int integer);
+bool setBigLimbs(bigInteger* value, const uint32_t limbs[], int length, bool negative);
+bool setBigText(bigInteger* value, const char text[], int length);
+bool copyBig(bigInteger* to, const bigInteger* from);
+int compareBig(const bigInteger* a, const bigInteger* b);
+bool addBig(bigInteger* left, const bigInteger* right, bool subtract);
+bool addBigSmall(bigInteger* value, long long int amount);
+bool multiplyBig(bigInteger* result, const bigInteger* a, const bigInteger* b);
+bool multiplyBigSmall(bigInteger* value, uint32_t factor);
+bool multiplyAddBigSmall(bigInteger* value, uint32_t factor, const bigInteger* other, uint32_t otherFactor);
+bool divideBig(bigInteger* quotient, bigInteger* remainder, const bigInteger* a, const bigInteger* b);
+long long int bigBitLength(const bigInteger* value);
+bool shiftBigLeft(bigInteger* value, long long int bits);
+void shiftBigRight(bigInteger* value, long long int bits);
+bool bigToInteger(const bigInteger* value, long long int* integer);
+double bigToDouble(const bigInteger* value);
+char* bigToString(const bigInteger* value);
+bool applyBigBinary(unsigned int operand, bigInteger* left, const bigInteger* right);
+bool applyBigUnary(unsigned int operand, bigInteger* value);
+
+#endif
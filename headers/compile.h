@@ -0,0 +1,31 @@
+#ifndef COMPILE_H
+#define COMPILE_H
+
+#include <stdbool.h>
+
+typedef struct {
+	unsigned int* code;   // Instruction stream.  Loads, stores and prints are followed by their argument
+	int length;
+	int capacity;
+	double* constants;    // Literal values, indexed by the argument of INST_LOAD_CONST
+	int nrConstants;
+	int constCapacity;
+	int* literals;        // Position in literalText of the text of each constant written in the program, or -1
+	char* literalText;    // Text of the numbers written in the program, each ended by \0, read again by "prec"
+	int textLength;
+	int textCapacity;
+	int stackDepth;       // Largest value stack any statement or function body needs, found at compile time
+	char* types;          // Type the statements compiled so far leave in each variable slot, TYPE_FREE where they don't
+	int typesCapacity;
+} program;
+
+void initProgram(program* prog);
+void clearProgram(program* prog);
+void freeProgram(program* prog);
+void emitCode(program* prog, unsigned int word);
+int addConstant(program* prog, double value);
+int addLiteral(program* prog, double value, const char text[]);
+void compileLine(program* prog, int lineNumber, int printMode);
+void compileExpression(program* prog, char text[], char* names[], int nrNames);
+
+#endif
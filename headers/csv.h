@@ -0,0 +1,6 @@
+#ifndef CSV_H
+#define CSV_H
+
+int runCsv(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef DUAL_H
+#define DUAL_H
+
+#include "compile.h"
+
+void gradient(const program* prog, int pc, const double point[], const double locals[], double partials[]);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef EXECUTE_H
+#define EXECUTE_H
+
+#include "compile.h"
+
+int bodyOffset(unsigned int instruction);
+int nrHigherOrderValues(const program* prog, int pc);
+double callHigherOrder(const program* prog, int pc, const double values[], double locals[]);
+double executeCode(const program* prog, int start, int end, double locals[]);
+double runProgram(const program* prog);
+void executeBatch(const program* prog, int start, int end, const double locals[], const double* lanes[],
+	int count, double results[], double* workspace);
+
+#endif
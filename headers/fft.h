@@ -0,0 +1,9 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdbool.h>
+
+bool fourierTransform(const double* input, bool complexInput, double* output, long n, bool inverse);
+bool convolve(const double* a, long na, const double* b, long nb, double* c, bool correlate);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef FORMULA_H
+#define FORMULA_H
+
+#include "compile.h"
+
+double defineFormula(const program* prog, int pc);
+void assignedVariable(int slot);
+void deletedVariable(int slot);
+
+#endif
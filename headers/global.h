@@ -1,14 +1,32 @@
-#ifndef GLOBAL_H
-#define GLOBAL_H
-
-#include "constants.h"
-
-extern double variableMap[VAR_MAP_SIZE];  // Memory for all variables, regardless of type or size
-extern char variableNames[VAR_NAME_SIZE][10];
-extern char variableTypes[VAR_MAP_SIZE];  // Stores type of each variable, or if space is currently unallocated
-extern char terminalInput[INPUT_SIZE];   // Raw user input from terminal, \n\0 terminated
-extern unsigned int expressionRPN[RPN_SIZE]; // Stores operations and variables in RPN format
-extern char unrecognizedToken[INPUT_HOLDER_SIZE]; // Printed to alert user of invalid input
-extern char error;
-
+#ifndef GLOBAL_H
+#define GLOBAL_H
+
+#include <stdbool.h>
+#include "constants.h"
+
+typedef struct {
+	double value;   // Value of a number
+	long long int integer;  // Exact value of a number that is integral
+	bool integral;  // Set for numbers written as digits alone that fit in 64 bits, or of any size with bigIntegers set
+	bool big;       // Set for integral numbers that don't fit in 64 bits, which are read again from their text
+	int source;     // Variable slot a name was found in: 0 for numbers, -1 for names that aren't defined
+	int name;       // Position of the text of the name or number in operandNames
+} operand;
+
+extern double* variableMap;  // Memory for all variables, regardless of type or size.  Grows as variables are added
+extern char* variableTypes;  // Stores type of each word of variableMap, or if space is currently unallocated
+extern char (*variableNames)[INPUT_HOLDER_SIZE];  // Name of the variable in each slot
+extern int* variableOffsets;  // Position in variableMap of the value of the variable in each slot
+extern char* terminalInput;   // Raw user input from terminal, \n\0 terminated.  Grows to hold the longest line read
+extern unsigned int* expressionRPN; // Stores operations and variables in RPN format, ended by 0.  Grows as needed
+extern int* expressionArgs;  // Argument count of each function in expressionRPN called with parentheses, 0 otherwise
+extern char unrecognizedToken[INPUT_HOLDER_SIZE]; // Printed to alert user of invalid input
+extern operand* operands;    // Numbers and names of the current line.  Token OPERAND_START + i in expressionRPN is operand i
+extern char* operandNames;   // Text of the operands, each ended by \0
+extern char error;
+extern int errorLine;  // Script line on which a runtime error occurred
+extern char outputFormat;  // OUTPUT_DECIMAL or OUTPUT_SCIENTIFIC
+extern bool bigIntegers;   // Integers that don't fit in 64 bits are kept exactly rather than converted to doubles
+extern int precisionDigits;  // Significant digits set by "prec", to which programs are run on floats, or 0 for doubles
+
 #endif
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef INTEGER_H
+#define INTEGER_H
+
+#include <stdbool.h>
+
+bool isIntegerOperator(unsigned int token);
+bool applyIntegerBinary(unsigned int operand, long long int left, long long int right, long long int* result);
+bool applyIntegerUnary(unsigned int operand, long long int value, long long int* result);
+bool parseInteger(const char text[], int length, long long int* value);
+
+#endif
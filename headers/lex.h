@@ -0,0 +1,15 @@
+#ifndef LEX_H
+#define LEX_H
+
+// Lexemes that are not single operators.  Their values are below OPERATOR_START, so that they can't be mistaken for one
+typedef enum LEXEME_KINDS { LEX_NUMBER = 1, LEX_NAME, LEX_MINUS, LEX_EQUALS, LEX_DEFINE, LEX_BAD_NUMBER, LEX_UNKNOWN } LEXS;
+
+typedef struct {
+	unsigned int token;  // Token of an operator or bracket, or one of LEXEME_KINDS
+	int start;           // Position of the text of the lexeme in the line
+	int length;
+} lexeme;
+
+int lexLine(const char text[], lexeme lexemes[], int capacity);
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <stdbool.h>
+
+typedef struct {
+	void* address;          // Start of the mapping
+	long long int size;     // Bytes mapped
+	long long int offset;   // Position of the first value in the file
+	const void* values;
+	long length;
+	long columns;           // Row length of a matrix, or 0 for a plain array
+	char type;              // TYPE_DOUBLE_ARR or TYPE_FLOAT_ARR
+} mappedArray;
+
+bool mapFile(const char fileName[], mappedArray* array);
+bool mapArrayFile(const char fileName[], bool single, mappedArray* array);
+void unmapArrayFile(mappedArray* array);
+
+#endif
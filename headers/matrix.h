@@ -0,0 +1,12 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <stdbool.h>
+
+bool multiplyMatrices(long m, long n, long k, const double* a, long lda, const double* b, long ldb, double* c, long ldc,
+	bool subtract);
+void transposeMatrix(const double* a, double* t, long rows, long columns);
+bool factorLU(double* a, long n, long pivots[], int* sign);
+void solveLU(const double* lu, const long pivots[], long n, double* x, long columns);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+#include <stdbool.h>
+#include "compile.h"
+
+double sampleMean(const program* prog, int bodyStart, int bodyEnd, double count, const double locals[], bool report);
+int runMonteCarlo(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef ODE_H
+#define ODE_H
+
+int runOdeSolve(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+typedef void (*parallelTask)(void* context, int index);
+
+void setNrThreads(int count);
+int getNrThreads();
+void parallelFor(int nrTasks, parallelTask task, void* context);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "constants.h"
+
+typedef enum PROFILE_STAGES {
+	STAGE_OTHER, STAGE_READ, STAGE_LEX, STAGE_PARSE, STAGE_COMPILE, STAGE_EXECUTE, STAGE_PRINT, NR_STAGES
+} STAGES;
+
+typedef enum PROFILE_LOOKUPS { LOOKUP_FUNCTION, LOOKUP_VARIABLE, NR_LOOKUPS } LOOKUPS;
+
+#define NR_OPCODES (INST_DEFINE + 1 - OPERATOR_START)
+#define SEGMENT_LENGTH 64  // Most instructions timed in a segment
+
+// Counters of one thread.  Runs of the interpreter loops are sampled: each run takes one off profileCountdown, and one
+// that brings it to 0, or any run while profileDetail is set, calls countRun().  Such a run adds the weight countRun()
+// gives it to counts for each instruction, by its opcode less OPERATOR_START, and if it is a sample, calls
+// timeInstruction() before each instruction and endRun() when it returns.  The times of a segment of the run are kept
+// apart until it ends, and only added to those of their opcodes if the thread ran all through it
+typedef struct {
+	uint64_t counts[NR_OPCODES];
+	uint64_t samples[NR_OPCODES];
+	uint64_t sampledTicks[NR_OPCODES];
+	uint64_t segmentTicks[SEGMENT_LENGTH];
+	unsigned short segmentOps[SEGMENT_LENGTH];
+	int segmentLength;
+	uint64_t lookups[NR_LOOKUPS];
+	unsigned int sampled;     // Opcode of the instruction being timed, plus one, or 0
+	uint64_t sampleStart;
+	bool inSegment;           // Whether a segment is being timed
+	double lastWall;          // Time and CPU time of the thread a segment is measured from
+	double lastCpu;
+	int gap;                  // Runs from the last sample to the next one, which the next one stands for
+	unsigned int seed;        // State of the generator of gaps between samples
+} profileCounters;
+
+extern bool profiling;      // Set while instrumentation is on
+extern bool profileDetail;  // Set while every run is counted, rather than estimated from samples
+extern _Thread_local int profileCountdown;  // Runs of interpreter loops by the thread until the next sample
+
+void startProfile(bool detail);
+void stopProfile();
+void resetProfile();
+void enterStage(int stage);
+void leaveStage();
+void countLookup(int kind);
+profileCounters* threadProfile();
+profileCounters* countRun(int* weight, bool* timed);
+void timeInstruction(profileCounters* counters, unsigned int instruction);
+void endRun(profileCounters* counters);
+void printProfile();
+bool writeProfile(FILE* file);
+
+#endif
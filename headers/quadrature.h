@@ -0,0 +1,9 @@
+#ifndef QUADRATURE_H
+#define QUADRATURE_H
+
+#include "compile.h"
+
+double integrateRange(const program* prog, int bodyStart, int bodyEnd, int local,
+	double low, double high, double tolerance, double locals[]);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdbool.h>
+
+// Where the draws of the calling thread come from.  Outside of montecarlo() stream is 0, and draws are numbered by a
+// counter of the session.  Inside it, a draw is numbered by its stream, its sample, and how many draws the sample
+// made before it, so that it doesn't depend on which thread evaluates the sample
+typedef struct {
+	unsigned int stream;
+	unsigned long long int sample;  // Sample of lane 0
+	int lane;
+	unsigned int draw;
+	bool lanes;                     // Whether the lanes of a batch are samples, rather than points of one sample
+	unsigned int lastDraw;          // Most draws any lane of a batch made, while its lanes are run one by one
+} randomState;
+
+void seedRandom(unsigned long long int seed);
+unsigned long long int getSeed();
+unsigned int newStream();
+randomState enterSamples(unsigned int stream, unsigned long long int first, bool lanes);
+void leaveSamples(randomState previous);
+randomState enterLanes();
+void selectLane(randomState* batch, int lane);
+void leaveLanes(randomState* batch);
+double drawValue(unsigned int operand, double left, double right);
+void drawLanes(unsigned int operand, double below[], const double top[], int count);
+
+#endif
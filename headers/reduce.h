@@ -0,0 +1,10 @@
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include "compile.h"
+
+void neumaierAdd(double* sum, double* compensation, double value);
+double reduceRange(const program* prog, unsigned int operand, int bodyStart, int bodyEnd, int local,
+	double low, double high, double locals[]);
+
+#endif
@@ -1,8 +1,9 @@
-#ifndef RPN_H
-#define RPN_H
-
-void pushOperator(unsigned int token, unsigned int stack[], int* stackLength, int* outputLength);
-void inputToRPN();
-double evaluateRPN();
-
-#endif
+#ifndef RPN_H
+#define RPN_H
+
+void inputToRPN();
+double evaluateRPN();
+double applyBinaryOperator(unsigned int operand, double left, double right);
+double applyUnaryOperator(unsigned int operand, double value);
+
+#endif
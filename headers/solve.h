@@ -0,0 +1,11 @@
+#ifndef SOLVE_H
+#define SOLVE_H
+
+#include <stdbool.h>
+#include "compile.h"
+
+double solveRange(const program* prog, unsigned int operand, int bodyStart, int bodyEnd, int local,
+	double low, double high, double locals[]);
+int runSolveBatch(bool minimize, char expression[], char bracket[], char parameter[]);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+int runSweep(int argc, char* argv[]);
+
+#endif
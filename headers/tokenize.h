@@ -1,6 +1,8 @@
-#ifndef TOKENIZE_H
-#define TOKENIZE_H
-
-unsigned int tokenize(int* indexPtr, int* evalVarHead, bool unaryNegation, int* keywordState);
-
-#endif
+#ifndef TOKENIZE_H
+#define TOKENIZE_H
+
+void clearOperands();
+int lexInput(int start);
+unsigned int tokenize(int* indexPtr, bool unaryNegation, int* keywordState);
+
+#endif
\ No newline at end of file
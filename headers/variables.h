@@ -1,10 +1,32 @@
-#ifndef VARIABLES_H
-#define VARIABLES_H
-
-void loadVariables(int VAR_START_POSITION, int VAR_END_POSITION, char filename[64]);
-void saveVariable(int VAR_START_POSITION, int VAR_END_POSITION, char filename[]);
-int addVariable();
-void delVariable();
-double findVariable(char input[]);
-
-#endif
+#ifndef VARIABLES_H
+#define VARIABLES_H
+
+#include <stdbool.h>
+#include "bigint.h"
+#include "bigfloat.h"
+
+void initVariables();
+void loadVariables(int VAR_START_POSITION, int VAR_END_POSITION, char filename[64]);
+void saveVariable(int VAR_START_POSITION, int VAR_END_POSITION, char filename[]);
+bool saveSession(const char fileName[]);
+bool loadSession(const char fileName[]);
+int addVariable(char name[]);
+void unbindVariable(char name[]);
+void delVariable(int slot);
+void compactVariables();
+int findVariableSlot(char input[]);
+double getVariable(int slot);
+void setVariable(int slot, double value);
+long long int getInteger(int slot);
+void setInteger(int slot, long long int value);
+bool getBigInteger(int slot, bigInteger* value);
+bool setBigInteger(int slot, const bigInteger* value);
+bool getBigFloat(int slot, bigFloat* value);
+bool setBigFloat(int slot, const bigFloat* value);
+char getVariableType(int slot);
+double* getArray(int slot, long* length, long* columns);
+bool setArray(int slot, const double values[], long length, long columns, char type);
+bool mapVariable(char name[], const char fileName[], bool single);
+double findVariable(char input[]);
+
+#endif
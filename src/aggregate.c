@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "constants.h"
+#include "reduce.h"
+#include "parallel.h"
+#include "aggregate.h"
+
+// Quantiles are kept in a KLL sketch.  Each level holds values of equal weight, and a full level is compacted by
+// sorting it and moving every other value to the level above, where each stands for twice as many.  Lower levels get
+// geometrically smaller capacities, so the sketch holds about 3 * KLL_K values, and quantiles are within about
+// 1.7 / KLL_K of their rank
+#define KLL_K 1024
+#define KLL_MIN_CAPACITY 8
+
+static const double quantileFractions[7] = { 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99 };
+
+typedef struct {
+	double value;
+	double weight;
+} weightedValue;
+
+typedef struct {
+	aggregate* stripes;
+	const double* values;
+	long long int count;
+} stripeTask;
+
+void initAggregate(aggregate* stats) {
+	stats->count = 0;
+	stats->undefined = 0;
+	stats->sum = 0.0;
+	stats->compensation = 0.0;
+	stats->mean = 0.0;
+	stats->m2 = 0.0;
+	stats->min = INFINITY;
+	stats->max = -INFINITY;
+	stats->nrLevels = 0;
+	stats->bottomCapacity = KLL_MIN_CAPACITY;
+	stats->compactions = 0;
+	for (int i = 0; i < KLL_MAX_LEVELS; i++) {
+		stats->items[i] = NULL;
+		stats->size[i] = 0;
+		stats->capacity[i] = 0;
+	}
+}
+
+void freeAggregate(aggregate* stats) {
+	for (int i = 0; i < KLL_MAX_LEVELS; i++) free(stats->items[i]);
+	initAggregate(stats);
+}
+
+static int compareDoubles(const void* a, const void* b) {
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+static int compareWeighted(const void* a, const void* b) {
+	return compareDoubles(&((const weightedValue*)a)->value, &((const weightedValue*)b)->value);
+}
+
+static int compactionOffset(const double items[], int size, unsigned int count) {
+	// Chooses which half of a sorted level a compaction keeps.  Always keeping the same half would bias quantiles,
+	// so the choice is a hash of the level's middle value and a counter, which is deterministic but unbiased
+	unsigned long long int bits = 0;
+
+	memcpy(&bits, &items[size / 2], sizeof(bits));
+	bits ^= count * 0x9E3779B97F4A7C15ULL;
+	bits ^= bits >> 31;
+	bits *= 0xBF58476D1CE4E5B9ULL;
+	bits ^= bits >> 29;
+	return (int)(bits & 1);
+}
+
+static int levelCapacity(const aggregate* stats, int level) {
+	// Capacity of a level, shrinking by 2/3 per level below the top one
+	double capacity = KLL_K * pow(2.0 / 3.0, stats->nrLevels - 1 - level);
+	return (capacity > KLL_MIN_CAPACITY) ? (int)ceil(capacity) : KLL_MIN_CAPACITY;
+}
+
+static bool appendItem(aggregate* stats, int level, double value) {
+	// Adds a value to a level, growing its buffer as needed
+	int capacity = 0;
+	double* items;
+
+	if (stats->size[level] >= stats->capacity[level]) {
+		capacity = (stats->capacity[level] > 0) ? 2 * stats->capacity[level] : 2 * KLL_MIN_CAPACITY;
+		items = realloc(stats->items[level], capacity * sizeof(double));
+		if (items == NULL) return false;
+		stats->items[level] = items;
+		stats->capacity[level] = capacity;
+	}
+	stats->items[level][stats->size[level]] = value;
+	stats->size[level]++;
+	return true;
+}
+
+static void compress(aggregate* stats) {
+	// Compacts the lowest level that is over its capacity, repeating until every level fits
+	bool compacted = true;
+	int kept = 0;
+	int offset = 0;
+	int level = 0;
+
+	while (compacted) {
+		compacted = false;
+		for (level = 0; level < stats->nrLevels; level++) {
+			if (stats->size[level] > levelCapacity(stats, level)) break;
+		}
+		if (level == stats->nrLevels) break;
+		if (level + 1 == stats->nrLevels) {
+			if (stats->nrLevels >= KLL_MAX_LEVELS) break;
+			stats->nrLevels++;
+		}
+
+		// Sort, keep an odd value out if there is one, and promote every other of the rest
+		qsort(stats->items[level], stats->size[level], sizeof(double), compareDoubles);
+		kept = stats->size[level] % 2;
+		offset = compactionOffset(stats->items[level], stats->size[level], stats->compactions);
+		stats->compactions++;
+		for (int i = kept + offset; i < stats->size[level]; i += 2) {
+			if (!appendItem(stats, level + 1, stats->items[level][i])) return;
+		}
+		stats->size[level] = kept;
+		compacted = true;
+	}
+	stats->bottomCapacity = levelCapacity(stats, 0);
+}
+
+void addValue(aggregate* stats, double value) {
+	// Adds a value to the count, sum, mean and variance (by Welford's method), extremes, and quantile sketch
+	double delta = 0.0;
+
+	if (isnan(value)) {
+		stats->undefined++;
+		return;
+	}
+	stats->count++;
+	neumaierAdd(&stats->sum, &stats->compensation, value);
+	delta = value - stats->mean;
+	stats->mean += delta / stats->count;
+	stats->m2 += delta * (value - stats->mean);
+	if (value < stats->min) stats->min = value;
+	if (value > stats->max) stats->max = value;
+
+	if (stats->nrLevels == 0) {
+		stats->nrLevels = 1;
+		stats->bottomCapacity = levelCapacity(stats, 0);
+	}
+	if (!appendItem(stats, 0, value)) return;
+	if (stats->size[0] > stats->bottomCapacity) compress(stats);
+}
+
+void addValues(aggregate* stats, const double values[], long long int count, long long int stride) {
+	// Adds every stride-th value of an array
+	for (long long int i = 0; i < count; i++) {
+		addValue(stats, values[i * stride]);
+	}
+}
+
+static void addStripe(void* context, int index) {
+	// Adds one contiguous part of an array to the aggregate of that part
+	stripeTask* task = context;
+	long long int first = task->count * index / AGGREGATE_STRIPES;
+	long long int last = task->count * (index + 1) / AGGREGATE_STRIPES;
+
+	addValues(&task->stripes[index], &task->values[first], last - first, 1);
+}
+
+void addValuesParallel(aggregate stripes[], const double values[], long long int count) {
+	// Adds an array split into AGGREGATE_STRIPES parts, each to its own aggregate, on the thread pool.  The split only
+	// depends on the count, so merging the stripes in order gives the same result whatever the thread count
+	stripeTask task;
+
+	task.stripes = stripes;
+	task.values = values;
+	task.count = count;
+	parallelFor(AGGREGATE_STRIPES, addStripe, &task);
+}
+
+void mergeAggregate(aggregate* stats, aggregate* other) {
+	// Adds the values summarized by another aggregate, which is emptied.  The mean and variance are combined with the
+	// parallel form of Welford's method, and the sketches level by level
+	long long int count = stats->count + other->count;
+	double delta = other->mean - stats->mean;
+
+	stats->undefined += other->undefined;
+	if (other->count > 0) {
+		neumaierAdd(&stats->sum, &stats->compensation, other->sum);
+		neumaierAdd(&stats->sum, &stats->compensation, other->compensation);
+		stats->m2 += other->m2 + delta * delta * ((double)stats->count * other->count / count);
+		stats->mean += delta * ((double)other->count / count);
+		stats->count = count;
+		if (other->min < stats->min) stats->min = other->min;
+		if (other->max > stats->max) stats->max = other->max;
+
+		if (other->nrLevels > stats->nrLevels) stats->nrLevels = other->nrLevels;
+		for (int level = 0; level < other->nrLevels; level++) {
+			for (int i = 0; i < other->size[level]; i++) {
+				appendItem(stats, level, other->items[level][i]);
+			}
+		}
+		compress(stats);
+	}
+	freeAggregate(other);
+}
+
+double findQuantile(const aggregate* stats, double fraction) {
+	// Returns the value at a fraction of the way through the sorted values, estimated from the sketch
+	weightedValue* values;
+	int nrValues = 0;
+	double total = 0.0;
+	double target = 0.0;
+	double result = NAN;
+
+	for (int level = 0; level < stats->nrLevels; level++) nrValues += stats->size[level];
+	if (nrValues == 0) return NAN;
+	values = malloc(nrValues * sizeof(weightedValue));
+	if (values == NULL) return NAN;
+
+	nrValues = 0;
+	for (int level = 0; level < stats->nrLevels; level++) {
+		for (int i = 0; i < stats->size[level]; i++) {
+			values[nrValues].value = stats->items[level][i];
+			values[nrValues].weight = ldexp(1.0, level);
+			total += values[nrValues].weight;
+			nrValues++;
+		}
+	}
+	qsort(values, nrValues, sizeof(weightedValue), compareWeighted);
+
+	target = fraction * total;
+	total = 0.0;
+	for (int i = 0; i < nrValues; i++) {
+		total += values[i].weight;
+		result = values[i].value;
+		if (total >= target) break;
+	}
+	free(values);
+	return result;
+}
+
+void printStatsHeader() {
+	printf("name,count,undefined,sum,mean,stddev,min,p1,p5,p25,median,p75,p95,p99,max\n");
+}
+
+void printStats(const char name[], const aggregate* stats) {
+	// Prints a line with the summary statistics of a column.  The mean is taken from the compensated sum, which is more
+	// accurate than the running mean.  The standard deviation is that of a sample
+	double sum = stats->sum + stats->compensation;
+
+	printf("%s,%lld,%lld,%.17g,%.17g,%.17g,%.17g", name, stats->count, stats->undefined,
+		sum, (stats->count > 0) ? sum / stats->count : NAN,
+		(stats->count > 1) ? sqrt(stats->m2 / (stats->count - 1)) : NAN, (stats->count > 0) ? stats->min : NAN);
+	for (int i = 0; i < 7; i++) {
+		printf(",%.17g", (stats->count > 0) ? findQuantile(stats, quantileFractions[i]) : NAN);
+	}
+	printf(",%.17g\n", (stats->count > 0) ? stats->max : NAN);
+}
\ No newline at end of file
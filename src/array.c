@@ -0,0 +1,845 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "compile.h"
+#include "execute.h"
+#include "parallel.h"
+#include "reduce.h"
+#include "matrix.h"
+#include "fft.h"
+#include "variables.h"
+#include "array.h"
+#include "formula.h"
+#include "profile.h"
+#include "global.h"
+
+// Arrays are values on a stack of their own, next to the value stack of executeCode().  An array is either the values
+// of a variable, which are used where they are, or a temporary that is freed once it has been used.  Operations that
+// fail leave an undefined array, which is reported when it is stored or printed, as undefined scalars are.  A matrix is
+// an array of its values row by row, along with the number of columns.  Element-wise operations treat it like any other
+// array, but only combine it with arrays of the same shape.  Complex arrays, made by fft and ifft, hold a real and an
+// imaginary part for each value, one after the other.  The compiler only lets them reach the operations that take them.
+// Arrays of floats, mapped from a file, are read a batch at a time by element-wise operations and reductions, and are
+// converted to doubles as a whole by the other operations
+
+typedef struct {
+	double* values;   // NULL if the array is undefined
+	long length;
+	long columns;     // Row length of a matrix, or 0 for a plain array
+	bool complex;     // Whether the values are pairs of a real and an imaginary part
+	bool single;      // Whether the values are floats rather than doubles
+	bool owned;       // Whether values is a temporary, to be freed once used
+	char status;      // Error to report for an undefined array
+} arrayValue;
+
+typedef struct {
+	const program* prog;
+	int bodyStart;
+	int bodyEnd;
+	int nrInputs;
+	const double* inputs[MAX_LOCALS];  // Values of each array input, NULL for scalars
+	bool single[MAX_LOCALS];           // Whether the values of an input are floats
+	double locals[MAX_LOCALS];         // Value of each scalar input
+	long length;
+	double* results;          // Where the values go, or NULL if they are reduced
+	unsigned int reduction;   // OP_SUM, OP_PROD, OP_MAX, OP_MIN, OP_DOT, or 0
+	double* partial;          // Reduction of each chunk
+	double* compensation;     // Accumulated rounding error of each chunk
+} arrayTask;
+
+static arrayValue* arrayStack;  // Grows as needed, so that an expression can hold any number of arrays at once
+static int nrArrays;
+static int arrayCapacity;
+
+static void pushArray(double* values, long length, long columns, bool owned, char status) {
+	arrayStack[nrArrays].values = values;
+	arrayStack[nrArrays].length = length;
+	arrayStack[nrArrays].columns = columns;
+	arrayStack[nrArrays].complex = false;
+	arrayStack[nrArrays].single = false;
+	arrayStack[nrArrays].owned = owned;
+	arrayStack[nrArrays].status = (values == NULL && status == NO_ERROR) ? ERR_UNDEFINED : status;
+	nrArrays++;
+}
+
+static void pushComplex(double* values, long length, long columns) {
+	pushArray(values, length, columns, true, NO_ERROR);
+	arrayStack[nrArrays - 1].complex = true;
+}
+
+static void releaseArray(arrayValue* array) {
+	// Frees an array once it has been used, if it is a temporary
+	if (array->owned) free(array->values);
+	array->values = NULL;
+	array->owned = false;
+}
+
+// Frees the arrays left by a statement that stopped early
+void clearArrays() {
+
+	while (nrArrays > 0) {
+		nrArrays--;
+		releaseArray(&arrayStack[nrArrays]);
+	}
+}
+
+static double reductionStart(unsigned int reduction) {
+	switch (reduction) {
+	case OP_PROD:
+		return 1.0;
+	case OP_MAX:
+		return -INFINITY;
+	case OP_MIN:
+		return INFINITY;
+	default:
+		return 0.0;
+	}
+}
+
+static void reduceValues(unsigned int reduction, const double a[], const double b[], long count, double* result,
+	double* compensation) {
+	// Folds values into a reduction.  Sums are added up in blocks of BATCH_SIZE with one accumulator per lane, which the
+	// compiler vectorizes, and each block sum is added with compensation.  dot multiplies a and b first
+	double lanes[BATCH_SIZE];
+	double previous = 0.0;
+	long block = 0;
+
+	switch (reduction) {
+	case OP_SUM:
+	case OP_DOT:
+		for (long start = 0; start < count; start += BATCH_SIZE) {
+			block = (count - start < BATCH_SIZE) ? count - start : BATCH_SIZE;
+			for (int i = 0; i < BATCH_SIZE; i++) lanes[i] = 0.0;
+			if (reduction == OP_DOT) {
+				for (long i = 0; i < block; i++) lanes[i] = a[start + i] * b[start + i];
+			}
+			else {
+				for (long i = 0; i < block; i++) lanes[i] = a[start + i];
+			}
+			for (int width = BATCH_SIZE / 2; width > 0; width /= 2) {
+				for (int i = 0; i < width; i++) lanes[i] += lanes[i + width];
+			}
+			neumaierAdd(result, compensation, lanes[0]);
+		}
+		break;
+	case OP_PROD:
+		for (long i = 0; i < count; i++) {
+			previous = *result;
+			*result *= a[i];
+			*compensation = *compensation * a[i] + fma(previous, a[i], -*result);
+		}
+		break;
+	case OP_MAX:
+		for (long i = 0; i < count; i++) {
+			if (a[i] > *result || isnan(a[i])) *result = a[i];
+			if (isnan(*result)) break;
+		}
+		break;
+	case OP_MIN:
+		for (long i = 0; i < count; i++) {
+			if (a[i] < *result || isnan(a[i])) *result = a[i];
+			if (isnan(*result)) break;
+		}
+		break;
+	}
+}
+
+static const double* readBatch(const arrayTask* task, int input, long offset, int count, double converted[]) {
+	// Returns the values of an input from offset on, converted to doubles if they are floats
+	const float* values = (const float*)task->inputs[input] + offset;
+
+	if (!task->single[input]) return task->inputs[input] + offset;
+	for (int i = 0; i < count; i++) converted[i] = values[i];
+	return converted;
+}
+
+static void runChunk(void* context, int index) {
+	// Evaluates the body of INST_MAP, or applies a reduction, for one chunk of the elements.  Chunks are always split
+	// the same way, so that reductions give the same result whatever the thread count.  Floats are converted a batch at
+	// a time, and reduced in batches as doubles are, so they give the same results
+	arrayTask* task = context;
+	long start = (long)index * ARRAY_CHUNK_SIZE;
+	long end = (start + ARRAY_CHUNK_SIZE < task->length) ? start + ARRAY_CHUNK_SIZE : task->length;
+	const double* lanes[MAX_LOCALS] = { NULL };
+	double values[BATCH_SIZE];
+	double other[BATCH_SIZE];
+	double* results = values;
+	double* workspace = NULL;
+	int count = 0;
+
+	task->partial[index] = reductionStart(task->reduction);
+	task->compensation[index] = 0.0;
+
+	if (task->prog == NULL && !task->single[0] && !task->single[1]) {
+		// A reduction of the arrays themselves
+		reduceValues(task->reduction, task->inputs[0] + start, (task->reduction == OP_DOT) ? task->inputs[1] + start : NULL,
+			end - start, &task->partial[index], &task->compensation[index]);
+		return;
+	}
+	if (task->prog == NULL) {
+		for (long offset = start; offset < end; offset += BATCH_SIZE) {
+			count = (end - offset < BATCH_SIZE) ? (int)(end - offset) : BATCH_SIZE;
+			reduceValues(task->reduction, readBatch(task, 0, offset, count, values),
+				(task->reduction == OP_DOT) ? readBatch(task, 1, offset, count, other) : NULL, count, &task->partial[index],
+				&task->compensation[index]);
+		}
+		return;
+	}
+
+	// The stack of executeBatch(), followed by room for the converted values of each input
+	workspace = malloc((task->prog->stackDepth + task->nrInputs) * BATCH_SIZE * sizeof(double));
+	if (workspace == NULL) {
+		task->partial[index] = NAN;
+		if (task->results != NULL) {
+			for (long i = start; i < end; i++) task->results[i] = NAN;
+		}
+		return;
+	}
+	for (long offset = start; offset < end; offset += BATCH_SIZE) {
+		count = (end - offset < BATCH_SIZE) ? (int)(end - offset) : BATCH_SIZE;
+		for (int i = 0; i < task->nrInputs; i++) {
+			lanes[i] = (task->inputs[i] != NULL)
+				? readBatch(task, i, offset, count, &workspace[(task->prog->stackDepth + i) * BATCH_SIZE]) : NULL;
+		}
+		if (task->results != NULL) results = task->results + offset;
+		executeBatch(task->prog, task->bodyStart, task->bodyEnd, task->locals, lanes, count, results, workspace);
+		if (task->reduction != 0) {
+			reduceValues(task->reduction, results, NULL, count, &task->partial[index], &task->compensation[index]);
+		}
+	}
+	free(workspace);
+}
+
+static double runChunks(arrayTask* task) {
+	// Runs a task over all chunks of its elements, returning the combined reduction if there is one
+	int nrChunks = (int)((task->length + ARRAY_CHUNK_SIZE - 1) / ARRAY_CHUNK_SIZE);
+	double result = reductionStart(task->reduction);
+	double compensation = 0.0;
+	double previous = 0.0;
+	double partial[1];
+	double partialCompensation[1];
+
+	if (nrChunks == 1) {
+		// Small arrays aren't worth the allocations
+		task->partial = partial;
+		task->compensation = partialCompensation;
+		runChunk(task, 0);
+		return partial[0] + partialCompensation[0];
+	}
+	task->partial = malloc(nrChunks * sizeof(double));
+	task->compensation = malloc(nrChunks * sizeof(double));
+	if (task->partial == NULL || task->compensation == NULL) {
+		free(task->partial);
+		free(task->compensation);
+		if (task->results != NULL) {
+			for (long i = 0; i < task->length; i++) task->results[i] = NAN;
+		}
+		return NAN;
+	}
+
+	parallelFor(nrChunks, runChunk, task);
+
+	// Combine chunks in order
+	for (int i = 0; i < nrChunks; i++) {
+		switch (task->reduction) {
+		case OP_SUM:
+		case OP_DOT:
+			neumaierAdd(&result, &compensation, task->partial[i]);
+			compensation += task->compensation[i];
+			break;
+		case OP_PROD:
+			previous = result;
+			result *= task->partial[i];
+			compensation = compensation * task->partial[i] + fma(previous, task->partial[i], -result)
+				+ previous * task->compensation[i];
+			break;
+		case OP_MAX:
+			if (task->partial[i] > result || isnan(task->partial[i])) result = task->partial[i];
+			break;
+		case OP_MIN:
+			if (task->partial[i] < result || isnan(task->partial[i])) result = task->partial[i];
+			break;
+		}
+	}
+	free(task->partial);
+	free(task->compensation);
+	return result + compensation;
+}
+
+static double* newArray(long length) {
+	if (length < 1 || length > 0x7FFFFFFFFFFFL / (long)sizeof(double)) return NULL;
+	return malloc(length * sizeof(double));
+}
+
+static void makeArray(const double stack[], int nrValues) {
+	// [a, b, ...] from the top values of the value stack
+	double* values = newArray(nrValues);
+
+	if (values == NULL) {
+		pushArray(NULL, 0, 0, false, ERR_OVERFLOW);
+		return;
+	}
+	for (int i = 0; i < nrValues; i++) values[i] = stack[i];
+	pushArray(values, nrValues, 0, true, NO_ERROR);
+}
+
+static void materialize(arrayValue* array) {
+	// Converts an array of floats to doubles, for the operations that work on whole arrays
+	double* values = NULL;
+
+	if (!array->single || array->values == NULL) return;
+	values = newArray(array->length);
+	if (values != NULL) {
+		for (long i = 0; i < array->length; i++) values[i] = ((const float*)array->values)[i];
+	}
+	releaseArray(array);
+	array->values = values;
+	array->owned = values != NULL;
+	array->single = false;
+	array->status = (values == NULL) ? ERR_OVERFLOW : NO_ERROR;
+}
+
+static void makeMatrix(int nrRows) {
+	// [[a, b, ...], [c, d, ...], ...] from the rows on top of the array stack, which must all have the same length
+	arrayValue* rows = &arrayStack[nrArrays - nrRows];
+	long columns = rows[0].length;
+	double* values = NULL;
+	char status = NO_ERROR;
+
+	for (int i = 0; i < nrRows; i++) {
+		materialize(&rows[i]);
+		if (rows[i].values == NULL && status == NO_ERROR) status = rows[i].status;
+		if ((rows[i].length != columns || rows[i].columns != 0) && status == NO_ERROR) status = ERR_UNDEFINED;
+	}
+	if (status == NO_ERROR) {
+		values = newArray(nrRows * columns);
+		if (values == NULL) status = ERR_OVERFLOW;
+	}
+	for (int i = 0; i < nrRows; i++) {
+		if (values != NULL) memcpy(&values[i * columns], rows[i].values, columns * sizeof(double));
+		releaseArray(&rows[i]);
+	}
+	nrArrays -= nrRows;
+	pushArray(values, nrRows * columns, columns, values != NULL, status);
+}
+
+static void makeLinspace(double low, double high, double count) {
+	// linspace(low, high, count) holds count evenly spaced values from low to high, which are both included.  A single
+	// value is low, and there must be at least one
+	long length = 0;
+	double* values = NULL;
+
+	if (isnan(count) || count < 1.0 || count > 9e15 || count != floor(count) || isnan(low) || isnan(high) || isinf(low) || isinf(high)) {
+		pushArray(NULL, 0, 0, false, ERR_UNDEFINED);
+		return;
+	}
+	length = (long)count;
+	values = newArray(length);
+	if (values == NULL) {
+		pushArray(NULL, 0, 0, false, ERR_OVERFLOW);
+		return;
+	}
+	values[0] = low;
+	for (long i = 1; i < length; i++) {
+		values[i] = low + (high - low) * ((double)i / (double)(length - 1));
+	}
+	if (length > 1) values[length - 1] = high;
+	pushArray(values, length, 0, true, NO_ERROR);
+}
+
+static int runMap(const program* prog, int pc, double stack[], int* stackLength) {
+	// Runs the loop of INST_MAP over the inputs on the stacks, returning the position of the end of its body.  The result
+	// is written over a temporary input when there is one, since each element only depends on the same elements of the
+	// inputs, and executeBatch() reads a batch of them before writing any
+	unsigned int reduction = prog->code[pc + 1];
+	int nrInputs = prog->code[pc + 2];
+	unsigned int arrayMask = prog->code[pc + 3];
+	arrayTask task;
+	arrayValue inputs[MAX_LOCALS];
+	arrayValue* output = NULL;
+	char status = NO_ERROR;
+	double result = 0.0;
+	long columns = 0;
+
+	task.prog = prog;
+	task.bodyStart = pc + 5;
+	task.bodyEnd = task.bodyStart + prog->code[pc + 4];
+	task.nrInputs = nrInputs;
+	task.reduction = reduction;
+	task.length = -1;
+
+	for (int i = nrInputs - 1; i >= 0; i--) {
+		if ((arrayMask >> i) & 1) {
+			nrArrays--;
+			inputs[i] = arrayStack[nrArrays];
+			task.inputs[i] = inputs[i].values;
+			task.single[i] = inputs[i].single;
+			if (inputs[i].values == NULL && status == NO_ERROR) status = inputs[i].status;
+			if (task.length >= 0 && (inputs[i].length != task.length || inputs[i].columns != columns) && status == NO_ERROR) {
+				status = ERR_UNDEFINED;
+			}
+			task.length = inputs[i].length;
+			columns = inputs[i].columns;
+			if (inputs[i].owned && output == NULL) output = &inputs[i];
+		}
+		else {
+			(*stackLength)--;
+			task.locals[i] = stack[*stackLength];
+			task.inputs[i] = NULL;
+			task.single[i] = false;
+			inputs[i].values = NULL;
+			inputs[i].owned = false;
+		}
+	}
+
+	if (status != NO_ERROR) {
+		// Arrays of different shapes, or an undefined input
+		if (reduction != 0) {
+			stack[*stackLength] = NAN;
+			(*stackLength)++;
+		}
+		else {
+			pushArray(NULL, 0, 0, false, status);
+		}
+	}
+	else if (reduction != 0) {
+		task.results = NULL;
+		result = runChunks(&task);
+		stack[*stackLength] = result;
+		(*stackLength)++;
+	}
+	else {
+		task.results = (output != NULL) ? output->values : newArray(task.length);
+		if (task.results == NULL) {
+			pushArray(NULL, 0, 0, false, ERR_OVERFLOW);
+		}
+		else {
+			runChunks(&task);
+			pushArray(task.results, task.length, columns, true, NO_ERROR);
+			if (output != NULL) output->owned = false;
+		}
+	}
+
+	for (int i = 0; i < nrInputs; i++) {
+		releaseArray(&inputs[i]);
+	}
+	return task.bodyEnd - 1;
+}
+
+static double reduceArray(unsigned int reduction, arrayValue* a, arrayValue* b) {
+	// sum, prod, max or min of the values of an array, or the dot product of two arrays
+	arrayTask task;
+
+	if (a->values == NULL || (b != NULL && (b->values == NULL || b->length != a->length))) return NAN;
+	task.prog = NULL;
+	task.reduction = reduction;
+	task.inputs[0] = a->values;
+	task.inputs[1] = (b != NULL) ? b->values : NULL;
+	task.single[0] = a->single;
+	task.single[1] = b != NULL && b->single;
+	task.length = a->length;
+	task.results = NULL;
+	return runChunks(&task);
+}
+
+static long rowsOf(const arrayValue* array) {
+	return (array->columns > 0) ? array->length / array->columns : 1;
+}
+
+static void multiply(arrayValue* a, arrayValue* b) {
+	// a @ b, the matrix product.  A plain array is a row on the left and a column on the right, and the product has as
+	// many dimensions as its operands have together, less two: a matrix times an array is an array
+	long m = rowsOf(a);
+	long k = (a->columns > 0) ? a->columns : a->length;
+	long n = (b->columns > 0) ? b->columns : 1;
+	double* values = NULL;
+
+	if (a->values == NULL || b->values == NULL) {
+		pushArray(NULL, 0, 0, false, (a->values == NULL) ? a->status : b->status);
+		return;
+	}
+	if (((b->columns > 0) ? rowsOf(b) : b->length) != k || m > 0x7FFFFFFFFFFFL / n) {
+		pushArray(NULL, 0, 0, false, ERR_UNDEFINED);
+		return;
+	}
+	values = (m * n >= 1) ? calloc(m * n, sizeof(double)) : NULL;
+	if (values == NULL || !multiplyMatrices(m, n, k, a->values, k, b->values, n, values, n, false)) {
+		free(values);
+		pushArray(NULL, 0, 0, false, ERR_OVERFLOW);
+		return;
+	}
+	pushArray(values, m * n, (a->columns > 0 && b->columns > 0) ? n : 0, true, NO_ERROR);
+}
+
+static void transpose(arrayValue* a) {
+	// The transpose of a matrix.  A plain array is its own transpose
+	double* values = NULL;
+
+	if (a->values == NULL || a->columns == 0) {
+		pushArray(a->values, a->length, 0, a->owned, a->status);
+		a->owned = false;
+		return;
+	}
+	values = newArray(a->length);
+	if (values == NULL) {
+		pushArray(NULL, 0, 0, false, ERR_OVERFLOW);
+		return;
+	}
+	transposeMatrix(a->values, values, rowsOf(a), a->columns);
+	pushArray(values, a->length, rowsOf(a), true, NO_ERROR);
+}
+
+static double* factor(const arrayValue* a, long** pivots, int* sign, bool* singular) {
+	// Returns the LU factors of a square matrix and sets their pivots, or returns NULL if a is not square or there is no
+	// memory
+	long n = a->columns;
+	double* lu = NULL;
+
+	if (a->values == NULL || n == 0 || a->length != n * n) return NULL;
+	lu = newArray(a->length);
+	*pivots = malloc(n * sizeof(long));
+	if (lu == NULL || *pivots == NULL) {
+		free(lu);
+		free(*pivots);
+		return NULL;
+	}
+	memcpy(lu, a->values, a->length * sizeof(double));
+	*singular = !factorLU(lu, n, *pivots, sign);
+	return lu;
+}
+
+static double determinant(const arrayValue* a) {
+	// The determinant of a square matrix, the product of the diagonal of its LU factors.  A singular matrix has a zero
+	// on the diagonal
+	long* pivots = NULL;
+	int sign = 1;
+	bool singular = false;
+	double* lu = factor(a, &pivots, &sign, &singular);
+	double result = sign;
+
+	if (lu == NULL) return NAN;
+	for (long i = 0; i < a->columns; i++) result *= lu[i * a->columns + i];
+	if (singular && !isnan(result)) result = 0.0;
+	free(lu);
+	free(pivots);
+	return result;
+}
+
+static void solveLinear(arrayValue* a, arrayValue* b) {
+	// solve(A, b) gives x such that A x = b, for a square matrix A and an array or matrix b with as many rows.  inv(A)
+	// is solve(A, I), and passes NULL for b.  Singular matrices give an undefined array
+	long n = a->columns;
+	long columns = (b == NULL) ? n : b->columns;
+	long length = (b == NULL) ? n * n : b->length;
+	long* pivots = NULL;
+	int sign = 1;
+	bool singular = false;
+	double* lu = NULL;
+	double* values = NULL;
+
+	if (a->values == NULL || (b != NULL && b->values == NULL)) {
+		pushArray(NULL, 0, 0, false, (a->values == NULL) ? a->status : b->status);
+		return;
+	}
+	if (n == 0 || a->length != n * n || (b != NULL && ((columns > 0) ? rowsOf(b) : b->length) != n)) {
+		pushArray(NULL, 0, 0, false, ERR_UNDEFINED);
+		return;
+	}
+	lu = factor(a, &pivots, &sign, &singular);
+	values = newArray(length);
+	if (lu == NULL || values == NULL || singular) {
+		pushArray(NULL, 0, 0, false, (lu == NULL || values == NULL) ? ERR_OVERFLOW : ERR_UNDEFINED);
+		free(lu);
+		free(pivots);
+		free(values);
+		return;
+	}
+	if (b == NULL) {
+		for (long i = 0; i < length; i++) values[i] = (i % (n + 1) == 0) ? 1.0 : 0.0;
+	}
+	else {
+		memcpy(values, b->values, length * sizeof(double));
+	}
+	solveLU(lu, pivots, n, values, (columns > 0) ? columns : 1);
+	free(lu);
+	free(pivots);
+	pushArray(values, length, columns, true, NO_ERROR);
+}
+
+static void makeIdentity(double size) {
+	// eye(n) is the n x n identity matrix
+	long n = 0;
+	double* values = NULL;
+
+	if (!(size >= 1.0 && size <= 9e7) || size != floor(size)) {
+		pushArray(NULL, 0, 0, false, ERR_UNDEFINED);
+		return;
+	}
+	n = (long)size;
+	values = (n * n <= 0x7FFFFFFFFFFFL / (long)sizeof(double)) ? calloc(n * n, sizeof(double)) : NULL;
+	if (values == NULL) {
+		pushArray(NULL, 0, 0, false, ERR_OVERFLOW);
+		return;
+	}
+	for (long i = 0; i < n; i++) values[i * n + i] = 1.0;
+	pushArray(values, n * n, n, true, NO_ERROR);
+}
+
+static void reshape(arrayValue* a, double rows, double columns) {
+	// reshape(a, rows, columns) is a matrix with the values of a, which must have rows x columns of them
+	if (a->values == NULL) {
+		pushArray(NULL, 0, 0, false, a->status);
+		return;
+	}
+	if (!(rows >= 1.0 && columns >= 1.0) || rows != floor(rows) || columns != floor(columns) || rows * columns != a->length) {
+		pushArray(NULL, 0, 0, false, ERR_UNDEFINED);
+		return;
+	}
+	pushArray(a->values, a->length, (long)columns, a->owned, NO_ERROR);
+	arrayStack[nrArrays - 1].single = a->single;
+	a->owned = false;
+}
+
+static void transform(arrayValue* a, bool inverse) {
+	// fft and ifft of an array of real or complex values, or of each row of a matrix
+	long rowLength = (a->columns > 0) ? a->columns : a->length;
+	double* values = NULL;
+	bool ok = true;
+
+	if (a->values == NULL) {
+		pushArray(NULL, 0, 0, false, a->status);
+		return;
+	}
+	values = newArray(2 * a->length);
+	if (values == NULL) {
+		pushArray(NULL, 0, 0, false, ERR_OVERFLOW);
+		return;
+	}
+	for (long row = 0; row < a->length && ok; row += rowLength) {
+		ok = fourierTransform(&a->values[(a->complex ? 2 : 1) * row], a->complex, &values[2 * row], rowLength, inverse);
+	}
+	if (!ok) {
+		free(values);
+		pushArray(NULL, 0, 0, false, ERR_OVERFLOW);
+		return;
+	}
+	pushComplex(values, a->length, a->columns);
+}
+
+static void convolveArrays(arrayValue* a, arrayValue* b, bool correlate) {
+	// conv and xcorr of two arrays, which give a value for every overlap of the two
+	double* values = NULL;
+
+	if (a->values == NULL || b->values == NULL) {
+		pushArray(NULL, 0, 0, false, (a->values == NULL) ? a->status : b->status);
+		return;
+	}
+	if (a->columns > 0 || b->columns > 0) {
+		pushArray(NULL, 0, 0, false, ERR_UNDEFINED);
+		return;
+	}
+	values = newArray(a->length + b->length - 1);
+	if (values == NULL || !convolve(a->values, a->length, b->values, b->length, values, correlate)) {
+		free(values);
+		pushArray(NULL, 0, 0, false, ERR_OVERFLOW);
+		return;
+	}
+	pushArray(values, a->length + b->length - 1, 0, true, NO_ERROR);
+}
+
+static void complexPart(arrayValue* a, unsigned int part) {
+	// real, imag and abs of each value of a complex array.  A real array is its own real part
+	double* values = NULL;
+
+	if (a->values == NULL || (!a->complex && part == OP_REAL)) {
+		pushArray(a->values, a->length, a->columns, a->owned, a->status);
+		a->owned = false;
+		return;
+	}
+	values = newArray(a->length);
+	if (values == NULL) {
+		pushArray(NULL, 0, 0, false, ERR_OVERFLOW);
+		return;
+	}
+	for (long i = 0; i < a->length; i++) {
+		if (!a->complex) {
+			values[i] = (part == OP_IMAG) ? 0.0 : fabs(a->values[i]);
+		}
+		else if (part == OP_MAGNITUDE) {
+			values[i] = hypot(a->values[2 * i], a->values[2 * i + 1]);
+		}
+		else {
+			values[i] = a->values[2 * i + ((part == OP_IMAG) ? 1 : 0)];
+		}
+	}
+	pushArray(values, a->length, a->columns, true, NO_ERROR);
+}
+
+static bool isDefined(arrayValue* array) {
+	// Arrays can only be stored or printed if all their values are defined, as with scalars
+	if (array->values == NULL) return false;
+	for (long i = 0; i < (array->complex ? 2 : 1) * array->length; i++) {
+		if (isnan(array->values[i]) || isinf(array->values[i])) {
+			array->status = ERR_UNDEFINED;
+			return false;
+		}
+	}
+	return true;
+}
+
+// Runs the instruction at pc that creates, uses or stores an array, and returns the position of its last argument.
+// Instructions that take scalars take them from the value stack, and those giving a scalar leave it there
+int executeArrayInstruction(const program* prog, int pc, double stack[], int* stackLength) {
+
+	unsigned int instruction = prog->code[pc];
+	arrayValue* top = NULL;
+	arrayValue first;
+	arrayValue second;
+	double* values = NULL;
+	long length = 0;
+	long columns = 0;
+	int count = 0;
+	char type = TYPE_DOUBLE_ARR;
+
+	// No instruction leaves more than one array more than it found
+	if (!growBuffer(&arrayStack, &arrayCapacity, nrArrays + 1, sizeof(arrayValue))) {
+		error = ERR_OVERFLOW;
+		return pc;
+	}
+	top = (nrArrays > 0) ? &arrayStack[nrArrays - 1] : NULL;
+
+	switch (instruction) {
+	case INST_LOAD_ARRAY:
+		values = getArray(prog->code[pc + 1], &length, &columns);
+		pushArray(values, length, columns, false, NO_ERROR);
+		arrayStack[nrArrays - 1].complex = getVariableType(prog->code[pc + 1]) == TYPE_CPLX_RECT_ARR;
+		arrayStack[nrArrays - 1].single = getVariableType(prog->code[pc + 1]) == TYPE_FLOAT_ARR;
+		return pc + 1;
+	case OP_ARRAY:
+		// Followed by the number of elements, and by 1 if they are the rows of a matrix
+		count = prog->code[pc + 1];
+		if (prog->code[pc + 2] == 1) {
+			makeMatrix(count);
+		}
+		else {
+			*stackLength -= count;
+			makeArray(&stack[*stackLength], count);
+		}
+		return pc + 2;
+	case OP_LINSPACE:
+		*stackLength -= 3;
+		makeLinspace(stack[*stackLength], stack[*stackLength + 1], stack[*stackLength + 2]);
+		return pc;
+	case INST_MAP:
+		return runMap(prog, pc, stack, stackLength);
+	case INST_REDUCE:
+		stack[*stackLength] = reduceArray(prog->code[pc + 1], top, NULL);
+		(*stackLength)++;
+		releaseArray(top);
+		nrArrays--;
+		return pc + 1;
+	case OP_DOT:
+		stack[*stackLength] = reduceArray(OP_DOT, top - 1, top);
+		(*stackLength)++;
+		releaseArray(top - 1);
+		releaseArray(top);
+		nrArrays -= 2;
+		return pc;
+	case OP_MATMUL:
+	case OP_LINSOLVE:
+	case OP_CONV:
+	case OP_XCORR:
+		// Both operands are consumed before the result is pushed in their place
+		first = top[-1];
+		second = top[0];
+		nrArrays -= 2;
+		materialize(&first);
+		materialize(&second);
+		if (instruction == OP_MATMUL) {
+			multiply(&first, &second);
+		}
+		else if (instruction == OP_LINSOLVE) {
+			solveLinear(&first, &second);
+		}
+		else {
+			convolveArrays(&first, &second, instruction == OP_XCORR);
+		}
+		releaseArray(&first);
+		releaseArray(&second);
+		return pc;
+	case OP_TRANSPOSE:
+	case OP_INV:
+	case OP_RESHAPE:
+	case OP_FFT:
+	case OP_IFFT:
+	case OP_REAL:
+	case OP_IMAG:
+	case OP_MAGNITUDE:
+		first = top[0];
+		nrArrays--;
+		if (instruction != OP_RESHAPE) materialize(&first);
+		if (instruction == OP_TRANSPOSE) {
+			transpose(&first);
+		}
+		else if (instruction == OP_INV) {
+			solveLinear(&first, NULL);
+		}
+		else if (instruction == OP_FFT || instruction == OP_IFFT) {
+			transform(&first, instruction == OP_IFFT);
+		}
+		else if (instruction == OP_RESHAPE) {
+			*stackLength -= 2;
+			reshape(&first, stack[*stackLength], stack[*stackLength + 1]);
+		}
+		else {
+			complexPart(&first, instruction);
+		}
+		releaseArray(&first);
+		return pc;
+	case OP_DET:
+		materialize(top);
+		stack[*stackLength] = determinant(top);
+		(*stackLength)++;
+		releaseArray(top);
+		nrArrays--;
+		return pc;
+	case OP_EYE:
+		(*stackLength)--;
+		makeIdentity(stack[*stackLength]);
+		return pc;
+	case INST_ASSIGN_ARRAY:
+	case INST_PRINT_ARRAY:
+		// Followed by the slot assigned to and the line number, or by the line number.  Printed arrays become "ans".  The
+		// values of variables were checked when they were stored, and those of files are taken as they are
+		if (top->owned ? !isDefined(top) : top->values == NULL) {
+			error = top->status;
+			errorLine = prog->code[(instruction == INST_ASSIGN_ARRAY) ? pc + 2 : pc + 1];
+		}
+		else {
+			type = top->complex ? TYPE_CPLX_RECT_ARR : (top->single ? TYPE_FLOAT_ARR : TYPE_DOUBLE_ARR);
+			if (instruction == INST_PRINT_ARRAY) {
+				enterStage(STAGE_PRINT);
+				printArray(top->values, top->length, top->columns, type);
+				leaveStage();
+			}
+			if (!setArray((instruction == INST_ASSIGN_ARRAY) ? prog->code[pc + 1] : ANS_ADDR, top->values, top->length,
+				top->columns, type)) {
+				error = ERR_OVERFLOW;
+				errorLine = prog->code[(instruction == INST_ASSIGN_ARRAY) ? pc + 2 : pc + 1];
+			}
+			else if (instruction == INST_ASSIGN_ARRAY) {
+				assignedVariable(prog->code[pc + 1]);
+			}
+		}
+		releaseArray(top);
+		nrArrays--;
+		return (instruction == INST_ASSIGN_ARRAY) ? pc + 2 : pc + 1;
+	default:
+		error = ERR_SYNTAX;
+		return pc;
+	}
+}
\ No newline at end of file
@@ -1,137 +1,429 @@
-#include<stdio.h>
-#include<math.h>
-#include<stdlib.h>
-#include<stdbool.h>
-#include"constants.h"
-#include "auxiliary.h"
-#include "global.h"
-
-int findNumDecimals(double input) {
-	// Finds appropriate amount of decimals to display such that final output is accurate, and takes up similar amount of space each time
-	int decimals = 15;
-	while (input >= 10 && decimals > 0) {
-		input /= 10.0;
-		decimals--;
-	}
-	return decimals;
-}
-
-unsigned int pop(unsigned int arr[], int* length) {
-	// Removes LAST element from array, returns that element, and decrements array length
-	if (*length > 0) {
-		unsigned int val = arr[*length - 1];
-		arr[*length - 1] = 0;
-		(*length)--;
-		return val;
-	}
-	return OP_NULL;
-}
-
-void push(unsigned int arr[], unsigned int val, int* length, int maxLength) {
-	// Appends input to the end of array, increments array length
-	if (*length >= maxLength) {
-		error = ERR_OVERFLOW;
-		return;
-	}
-	arr[*length] = val;
-	(*length)++;
-}
-
-bool stackIsEmpty(unsigned int stack[]) {
-	// Returns true if given stack array is empty
-	return (stack[0] == 0);
-}
-
-bool isFunction(unsigned int token) {
-	// Returns true if given operator uses function notation, func(arg1, arg2)
-	return ((token > END_OPS && token < END_FUNCS) || token > USER_FUNC_START);
-}
-
-bool isOperator(unsigned int token) {
-	// Returns true if given token is an operator
-	return (token >= OP_NULL && token < LEFT_PARENTH);
-}
-
-bool isBinaryOperator(unsigned int token) {
-	// Returns true if function or operator has two inputs, false if one
-	return (token < UNARY_OPERATORS && token != OP_NOT && token != OP_NEG && token > OP_NULL);
-}
-
-long long int doubleToInt(double input) {
-	// Converts double to long long int
-	return (long long int)((input >= 0) ? input + 0.5 : input - 0.5);
-}
-
-double gcd(double a, double b) {
-	// Uses the Euclidean algorithm to find the greatest commoon denominator of two numbers
-	long long int A = doubleToInt(a);
-	long long int B = doubleToInt(b);
-	long long int swap;
-
-	while (B != 0) {
-		swap = B;
-		B = A % B;
-		A = swap;
-	}
-
-	return (double)A;
-}
-
-unsigned int findFunction(char input[]) {
-	// Returns the op-code for a given string representing a function. Unused (terminal) characters must be null
-
-	// TODO: User defined functions
-
-	char functions[NR_FUNCTIONS][10] = { "div", "mod", "log", "root",
-		"sin", "cos", "tan", "sec", "csc", "cot",
-		"asin", "acos", "atan", "asec", "acsc", "acot",
-		"sinh", "cosh", "tanh", "sech", "csch", "coth",
-		"asinh", "acosh", "atanh", "asech", "acsch", "acoth",
-		"sqrt", "ln", "log10", "ceil", "floor", "round", "sgn", "gcd", "lcm", "atan2", "abs", "log2",
-		"cbrt", "trunc", "erf", "erfc", "gamma", "hypot", "lgamma", "sinc", "nsinc", "reqll", "perr", "deg", "rad",
-		"is", "and", "or", "not", "mod", "xor", "iff", "AND", "OR", "XOR", "NOT",
-		"if", "elif", "else", "switch", "case", "while", "for", "goto", "break", "continue", "def", "class", "return", "del"
-	};
-	int functionOP[NR_FUNCTIONS] = { OP_DIV_INT, OP_MOD, OP_LOG, OP_ROOT,
-		OP_SIN, OP_COS, OP_TAN, OP_SEC, OP_CSC, OP_COT,
-		OP_ASIN, OP_ACOS, OP_ATAN, OP_ASEC, OP_ACSC, OP_ACOT,
-		OP_SINH, OP_COSH, OP_TANH, OP_SECH, OP_CSCH, OP_COTH,
-		OP_ASINH, OP_ACOSH, OP_ATANH, OP_ASECH, OP_ACSCH, OP_ACOTH,
-		OP_SQRT, OP_LN, OP_LOG10, OP_CEIL, OP_FLOOR, OP_ROUND, OP_SIGN, OP_GCD, OP_LCM, OP_ATAN2, OP_ABS, OP_LOG2,
-		OP_CBRT, OP_TRUNC, OP_ERF, OP_ERFC, OP_GAMMA, OP_HYPOT, OP_LGAMMA, OP_SINC, OP_NSINC, OP_REQLL, OP_PERR, OP_DEG, OP_RAD,
-		OP_IS, OP_AND, OP_OR, OP_NOT, OP_MOD, OP_XOR, OP_IFF, OP_BITWISE_AND, OP_BITWISE_OR, OP_BITWISE_XOR, OP_BITWISE_NOT,
-		KW_IF, KW_ELIF, KW_ELSE, KW_SWITCH, KW_CASE, KW_WHILE, KW_FOR, KW_GOTO, KW_BREAK, KW_CONTINUE, KW_DEF, KW_CLASS, KW_RETURN, KW_DEL
-	};
-
-	for (int i = 0; i < NR_FUNCTIONS; i++) { // function loop
-		for (int j = 0; j < 10; j++) { // character loop
-			if (input[j] != functions[i][j]) {
-				// If at any point the input and current function don't match, try next function
-				break;
-			}
-			else if (j == 9 && input[10] == '\0') {
-				// Return if end of the input has been reached and all have matched
-				return functionOP[i];
-			}
-		}
-	}
-	return OP_NULL;
-}
-
-void resetValues(double* printVal) {
-	// Resets values and arrays between main loops
-	for (int i = EVAL_VARS_START; i < VAR_MAP_SIZE; i++) {
-		variableMap[i] = 0.0;
-	}
-	for (int i = 0; i < RPN_SIZE; i++) {
-		expressionRPN[i] = 0;
-	}
-	for (int i = 0; i < INPUT_SIZE; i++) {
-		terminalInput[i] = 0;
-	}
-	for (int i = 0; i < INPUT_HOLDER_SIZE; i++) {
-		unrecognizedToken[i] = 0;
-	}
-	*printVal = 0.0;
-	error = NO_ERROR;
+#include<stdio.h>
+#include<math.h>
+#include<stdlib.h>
+#include<stdbool.h>
+#include<string.h>
+#include"constants.h"
+#include "auxiliary.h"
+#include "profile.h"
+#include "global.h"
+
+#define ARRAY_PRINT_EDGE 3  // Values printed at each end of a long array
+#define INPUT_START_SIZE 1024  // Bytes first allocated for terminalInput
+
+static int inputCapacity;
+
+int findNumDecimals(double input) {
+	// Finds appropriate amount of decimals to display such that final output is accurate, and takes up similar amount of space each time
+	int decimals = 15;
+	while (input >= 10 && decimals > 0) {
+		input /= 10.0;
+		decimals--;
+	}
+	return decimals;
+}
+
+unsigned int pop(unsigned int arr[], int* length) {
+	// Removes LAST element from array, returns that element, and decrements array length
+	if (*length > 0) {
+		unsigned int val = arr[*length - 1];
+		arr[*length - 1] = 0;
+		(*length)--;
+		return val;
+	}
+	return OP_NULL;
+}
+
+void push(unsigned int arr[], unsigned int val, int* length, int maxLength) {
+	// Appends input to the end of array, increments array length
+	if (*length >= maxLength) {
+		error = ERR_OVERFLOW;
+		return;
+	}
+	arr[*length] = val;
+	(*length)++;
+}
+
+bool stackIsEmpty(unsigned int stack[]) {
+	// Returns true if given stack array is empty
+	return (stack[0] == 0);
+}
+
+// Makes a buffer, passed as the address of its pointer, hold at least needed elements of the given size.  The capacity
+// is doubled when it grows, so that filling a buffer one element at a time takes linear time.  Returns false if there
+// is no memory, leaving the buffer as it was
+bool growBuffer(void* buffer, int* capacity, int needed, int size) {
+
+	void** pointer = buffer;
+	void* grown = NULL;
+	long long int newCapacity = (*capacity > 0) ? *capacity : 16;
+
+	if (needed <= *capacity) return true;
+	while (newCapacity < needed) newCapacity *= 2;
+	if (newCapacity > 0x7FFFFFFF) newCapacity = 0x7FFFFFFF;
+	if (newCapacity < needed) return false;
+	grown = realloc(*pointer, (size_t)newCapacity * size);
+	if (grown == NULL) return false;
+	*pointer = grown;
+	*capacity = (int)newCapacity;
+	return true;
+}
+
+bool isOperand(unsigned int token) {
+	// Returns true if a token of expressionRPN is a number or a name rather than an operator
+	return token >= OPERAND_START;
+}
+
+bool isFunction(unsigned int token) {
+	// Returns true if given operator uses function notation, func(arg1, arg2)
+	return ((token > END_OPS && token < END_FUNCS) || (token > USER_FUNC_START && token < OPERAND_START));
+}
+
+bool isOperator(unsigned int token) {
+	// Returns true if given token is an operator
+	return (token >= OP_NULL && token < LEFT_PARENTH);
+}
+
+bool isBinaryOperator(unsigned int token) {
+	// Returns true if function or operator has two inputs, false if one
+	return (token < UNARY_OPERATORS && token != OP_NOT && token != OP_NEG && token != OP_BITWISE_NOT && token > OP_NULL);
+}
+
+int nrArguments(unsigned int token) {
+	// Returns the amount of values an operator or function acts on, or 0 if it cannot be evaluated
+	if (token == OP_NEG || token == OP_NOT || token == OP_BITWISE_NOT || token == KW_DEL) return 1;
+	if (isBinaryOperator(token) || token == INST_ASSIGN_VAL || token == INST_DEFINE) return 2;
+	if (token >= UNARY_OPERATORS && token < ARRAY_OPERATORS) return 1;
+	if (token == OP_MAX || token == OP_MIN) return 1;
+	if (token == OP_TRANSPOSE || token == OP_DET || token == OP_INV || token == OP_EYE) return 1;
+	if (token == OP_FFT || token == OP_IFFT || token == OP_REAL || token == OP_IMAG || token == OP_MAGNITUDE) return 1;
+	if (token == OP_DOT || token == OP_LINSOLVE || token == OP_CONV || token == OP_XCORR || token == OP_MONTECARLO) return 2;
+	if (token == OP_LINSPACE || token == OP_RESHAPE) return 3;
+	if (token == OP_ARRAY) return 0x7FFFFFFF;
+	if (token == OP_SUM || token == OP_PROD || token == OP_SOLVE || token == OP_MINIMIZE) return 4;
+	if (token == OP_INTEGRATE) return 5;
+	if (token == OP_GRAD) return MAX_ARGS;
+	return 0;
+}
+
+int minArguments(unsigned int token) {
+	// Returns the amount of arguments a function needs when its optional arguments are left out
+	if (token == OP_INTEGRATE) return 4;
+	if (token == OP_GRAD) return 2;
+	if (token == OP_SUM || token == OP_PROD || token == OP_ARRAY) return 1;  // sum and prod of the values of an array
+	if (token == OP_SOLVE) return 2;  // solve(A, b) solves a linear system
+	return nrArguments(token);
+}
+
+long long int doubleToInt(double input) {
+	// Converts double to long long int
+	return (long long int)((input >= 0) ? input + 0.5 : input - 0.5);
+}
+
+bool fitsInteger(double input) {
+	// Returns true if input rounds to a long long int, the values for which doubleToInt is defined.  Doubles that large
+	// are whole, so only the bounds themselves need care: -2^63 fits and 2^63 doesn't
+	return input >= -9223372036854775808.0 && input < 9223372036854775808.0;
+}
+
+double gcd(double a, double b) {
+	// Uses the Euclidean algorithm to find the greatest commoon denominator of two numbers.  Numbers that don't round to
+	// a long long int give NaN
+	long long int A = 0;
+	long long int B = 0;
+	long long int swap;
+
+	if (!fitsInteger(a) || !fitsInteger(b)) return NAN;
+	A = doubleToInt(a);
+	B = doubleToInt(b);
+	while (B != 0) {
+		swap = B;
+		B = (B == -1) ? 0 : A % B;  // LLONG_MIN % -1 overflows
+		A = swap;
+	}
+
+	return (double)A;
+}
+
+unsigned int findFunction(char input[]) {
+	// Returns the op-code for a given string representing a function, or OP_NULL
+	countLookup(LOOKUP_FUNCTION);
+
+	// TODO: User defined functions
+
+	char functions[NR_FUNCTIONS][12] = { "div", "mod", "log", "root",
+		"sin", "cos", "tan", "sec", "csc", "cot",
+		"asin", "acos", "atan", "asec", "acsc", "acot",
+		"sinh", "cosh", "tanh", "sech", "csch", "coth",
+		"asinh", "acosh", "atanh", "asech", "acsch", "acoth",
+		"sqrt", "ln", "log10", "ceil", "floor", "round", "sgn", "gcd", "lcm", "atan2", "abs", "log2",
+		"cbrt", "trunc", "erf", "erfc", "gamma", "hypot", "lgamma", "sinc", "nsinc", "reqll", "perr", "deg", "rad",
+		"uniform", "normal", "lognormal", "fact", "nCr", "nPr",
+		"is", "and", "or", "not", "mod", "xor", "iff", "AND", "OR", "XOR", "NOT",
+		"sum", "prod", "integrate", "solve", "minimize", "grad", "montecarlo", "linspace", "dot", "max", "min",
+		"transpose", "det", "inv", "eye", "reshape", "fft", "ifft", "conv", "xcorr", "real", "imag",
+		"if", "elif", "else", "switch", "case", "while", "for", "goto", "break", "continue", "def", "class", "return", "del"
+	};
+	int functionOP[NR_FUNCTIONS] = { OP_DIV_INT, OP_MOD, OP_LOG, OP_ROOT,
+		OP_SIN, OP_COS, OP_TAN, OP_SEC, OP_CSC, OP_COT,
+		OP_ASIN, OP_ACOS, OP_ATAN, OP_ASEC, OP_ACSC, OP_ACOT,
+		OP_SINH, OP_COSH, OP_TANH, OP_SECH, OP_CSCH, OP_COTH,
+		OP_ASINH, OP_ACOSH, OP_ATANH, OP_ASECH, OP_ACSCH, OP_ACOTH,
+		OP_SQRT, OP_LN, OP_LOG10, OP_CEIL, OP_FLOOR, OP_ROUND, OP_SIGN, OP_GCD, OP_LCM, OP_ATAN2, OP_ABS, OP_LOG2,
+		OP_CBRT, OP_TRUNC, OP_ERF, OP_ERFC, OP_GAMMA, OP_HYPOT, OP_LGAMMA, OP_SINC, OP_NSINC, OP_REQLL, OP_PERR, OP_DEG, OP_RAD,
+		OP_UNIFORM, OP_NORMAL, OP_LOGNORMAL, OP_FACTORIAL, OP_NCR, OP_NPR,
+		OP_IS, OP_AND, OP_OR, OP_NOT, OP_MOD, OP_XOR, OP_IFF, OP_BITWISE_AND, OP_BITWISE_OR, OP_BITWISE_XOR, OP_BITWISE_NOT,
+		OP_SUM, OP_PROD, OP_INTEGRATE, OP_SOLVE, OP_MINIMIZE, OP_GRAD, OP_MONTECARLO, OP_LINSPACE, OP_DOT, OP_MAX, OP_MIN,
+		OP_TRANSPOSE, OP_DET, OP_INV, OP_EYE, OP_RESHAPE, OP_FFT, OP_IFFT, OP_CONV, OP_XCORR, OP_REAL, OP_IMAG,
+		KW_IF, KW_ELIF, KW_ELSE, KW_SWITCH, KW_CASE, KW_WHILE, KW_FOR, KW_GOTO, KW_BREAK, KW_CONTINUE, KW_DEF, KW_CLASS, KW_RETURN, KW_DEL
+	};
+
+	for (int i = 0; i < NR_FUNCTIONS; i++) { // function loop
+		for (int j = 0; j < 12; j++) { // character loop
+			if (input[j] != functions[i][j]) {
+				// If at any point the input and current function don't match, try next function
+				break;
+			}
+			else if (input[j] == '\0') {
+				// Return if end of the input has been reached and all have matched
+				return functionOP[i];
+			}
+		}
+	}
+	return OP_NULL;
+}
+
+bool parseRange(char spec[], char name[], double values[], int maxValues, int* nrValues) {
+	// Reads "name=v1:v2:..." into a name of at most INPUT_HOLDER_SIZE - 1 characters and up to maxValues numbers
+	int length = 0;
+	char* position;
+	char* end;
+
+	while (spec[length] != '=' && spec[length] != '\0') length++;
+	if (spec[length] != '=' || length == 0 || length > INPUT_HOLDER_SIZE - 1) return false;
+	for (int i = 0; i < length; i++) name[i] = spec[i];
+	name[length] = '\0';
+
+	*nrValues = 0;
+	position = &spec[length + 1];
+	while (*nrValues < maxValues) {
+		values[*nrValues] = strtod(position, &end);
+		if (end == position) return false;
+		(*nrValues)++;
+		if (*end == '\0') return true;
+		if (*end != ':') return false;
+		position = end + 1;
+	}
+	return false;
+}
+
+void printResult(double value) {
+	// Prints a result in the current output format
+	if (outputFormat == OUTPUT_SCIENTIFIC) {
+		printf("  %.15E\n", value);
+	}
+	else {
+		printf("  %.*lf\n", findNumDecimals(value), value);
+	}
+}
+
+void printInteger(long long int value) {
+	// Prints an integer result exactly, or in scientific notation like any other value
+	if (outputFormat == OUTPUT_SCIENTIFIC) {
+		printf("  %.15E\n", (double)value);
+	}
+	else {
+		printf("  %lld\n", value);
+	}
+}
+
+// Prints an integer of any size exactly, or in scientific notation rounded to 16 significant digits
+void printBigInteger(const bigInteger* value) {
+
+	char* text = bigToString(value);
+	char* digits = text;
+	char mantissa[17] = "0000000000000000";
+	int length = 0;
+	int exponent = 0;
+	int i = 0;
+
+	if (text == NULL) {
+		printf("  Out of memory\n");
+		return;
+	}
+	if (outputFormat != OUTPUT_SCIENTIFIC) {
+		printf("  %s\n", text);
+		free(text);
+		return;
+	}
+	if (*digits == '-') digits++;
+	length = (int)strlen(digits);
+	exponent = length - 1;
+	memcpy(mantissa, digits, (length < 16) ? length : 16);
+	if (length > 16 && digits[16] >= '5') {
+		// Round up, carrying into the digits before
+		for (i = 15; i >= 0 && mantissa[i] == '9'; i--) mantissa[i] = '0';
+		if (i >= 0) {
+			mantissa[i]++;
+		}
+		else {
+			mantissa[0] = '1';
+			exponent++;
+		}
+	}
+	printf("  %s%c.%sE+%02d\n", (digits > text) ? "-" : "", mantissa[0], &mantissa[1], exponent);
+	free(text);
+}
+
+// Prints a number of any precision to a number of significant digits, every one of them in scientific notation, and
+// otherwise leaving out zeros at the end
+void printBigFloat(const bigFloat* value, int digits) {
+
+	char* text = floatToString(value, digits, outputFormat == OUTPUT_SCIENTIFIC);
+
+	if (text == NULL) {
+		printf("  Out of memory\n");
+		return;
+	}
+	printf("  %s\n", text);
+	free(text);
+}
+
+static double valueAt(const void* values, long index, char type) {
+	return (type == TYPE_FLOAT_ARR) ? ((const float*)values)[index] : ((const double*)values)[index];
+}
+
+static void printRow(const void* values, long length, char type) {
+	// Prints the values of an array between brackets.  Long arrays are shortened to their first and last few values.
+	// Complex values are pairs of a real and an imaginary part, printed as 1+2i
+	long shown = (length > 2 * ARRAY_PRINT_EDGE + 1) ? ARRAY_PRINT_EDGE : length;
+
+	printf("[");
+	for (long i = 0; i < length; i++) {
+		if (i == shown && i < length - ARRAY_PRINT_EDGE) {
+			printf(", ...");
+			i = length - ARRAY_PRINT_EDGE;
+		}
+		if (type == TYPE_CPLX_RECT_ARR) {
+			printf((outputFormat == OUTPUT_SCIENTIFIC) ? "%s%.15E%+.15Ei" : "%s%.15g%+.15gi", (i > 0) ? ", " : "",
+				valueAt(values, 2 * i, type), valueAt(values, 2 * i + 1, type) + 0.0);
+		}
+		else {
+			printf((outputFormat == OUTPUT_SCIENTIFIC) ? "%s%.15E" : "%s%.15g", (i > 0) ? ", " : "", valueAt(values, i, type));
+		}
+	}
+	printf("]");
+}
+
+void printArray(const void* values, long length, long columns, char type) {
+	// Prints the values of an array on one line in the current output format, followed by its length if it was shortened.
+	// A matrix, which has a number of columns, is printed a row per line, and long matrices are shortened in the same way.
+	// type is TYPE_DOUBLE_ARR, TYPE_CPLX_RECT_ARR, or TYPE_FLOAT_ARR for the floats of a file
+	long valueSize = (type == TYPE_FLOAT_ARR) ? sizeof(float) : ((type == TYPE_CPLX_RECT_ARR) ? 2 : 1) * sizeof(double);
+	long rows = (columns > 0) ? length / columns : 1;
+	long shown = (rows > 2 * ARRAY_PRINT_EDGE + 1) ? ARRAY_PRINT_EDGE : rows;
+
+	if (columns == 0) {
+		printf("  ");
+		printRow(values, length, type);
+		if (length > 2 * ARRAY_PRINT_EDGE + 1) printf("  (%ld values)", length);
+		printf("\n");
+		return;
+	}
+
+	printf("  [");
+	for (long r = 0; r < rows; r++) {
+		if (r == shown && r < rows - ARRAY_PRINT_EDGE) {
+			printf("\n   ...,");
+			r = rows - ARRAY_PRINT_EDGE;
+		}
+		printf((r > 0) ? "\n   " : "");
+		printRow((const char*)values + r * columns * valueSize, columns, type);
+		printf((r < rows - 1) ? "," : "]");
+	}
+	if (rows > 2 * ARRAY_PRINT_EDGE + 1 || columns > 2 * ARRAY_PRINT_EDGE + 1) printf("  (%ld x %ld)", rows, columns);
+	printf("\n");
+}
+
+void printError() {
+	// Prints a description of the current error
+	switch (error) {
+	case ERR_SYNTAX:
+		printf("  Syntax error\n");
+		break;
+	case ERR_UNKNOWN_TOKEN:
+		printf("  Unrecognized token \"");
+		for (int i = 0; i < INPUT_HOLDER_SIZE-1; i++) {
+			if (unrecognizedToken[i] == '\0') break;
+			if (unrecognizedToken[i] == '\t') {
+				printf("[tab]");
+			}
+			else {
+				printf("%c", unrecognizedToken[i]);
+			}
+		}
+		if (unrecognizedToken[INPUT_HOLDER_SIZE - 1] != 0) printf("...");
+		printf("\"\n");
+		break;
+	case ERR_OVERFLOW:
+		printf("  Overflow error\n");
+		break;
+	case ERR_UNDEFINED:
+		printf("  Undefined or out of bounds\n");
+		break;
+	case ERR_CIRCULAR:
+		printf("  Circular definition\n");
+		break;
+	}
+}
+
+// Makes terminalInput hold at least length characters.  Returns false if there is no memory
+bool reserveInput(int length) {
+	if (length < INPUT_START_SIZE) length = INPUT_START_SIZE;
+	return growBuffer(&terminalInput, &inputCapacity, length, sizeof(char));
+}
+
+static bool readText(FILE* file) {
+	// Reads a line into terminalInput for readLine()
+	int length = 0;
+
+	if (!reserveInput(INPUT_START_SIZE)) return false;
+	terminalInput[0] = '\0';
+	while (fgets(&terminalInput[length], inputCapacity - length, file) != NULL) {
+		length += (int)strlen(&terminalInput[length]);
+		if (length > 0 && terminalInput[length - 1] == '\n') return true;
+		if (length < inputCapacity - 1) break;  // End of the file
+		if (!reserveInput(2 * inputCapacity)) return false;
+	}
+	if (length == 0) return false;
+	if (!reserveInput(length + 2)) return false;
+	terminalInput[length] = '\n';
+	terminalInput[length + 1] = '\0';
+	return true;
+}
+
+// Reads a line of any length into terminalInput, which grows to hold it, and ends it with "\n\0" even if it is the
+// last line of the file and has no line break.  Returns false at the end of the file, or if there is no memory
+bool readLine(FILE* file) {
+
+	bool read = false;
+
+	enterStage(STAGE_READ);
+	read = readText(file);
+	leaveStage();
+	return read;
+}
+
+void resetValues(double* printVal) {
+	// Resets values and arrays between main loops
+	if (terminalInput != NULL) terminalInput[0] = '\0';
+	if (expressionRPN != NULL) {
+		expressionRPN[0] = 0;
+		expressionArgs[0] = 0;
+	}
+	for (int i = 0; i < INPUT_HOLDER_SIZE; i++) {
+		unrecognizedToken[i] = 0;
+	}
+	*printVal = 0.0;
+	error = NO_ERROR;
 }
\ No newline at end of file
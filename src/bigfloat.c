@@ -0,0 +1,2276 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "constants.h"
+#include "bigint.h"
+#include "bigfloat.h"
+
+// Floats of any precision, for "prec N".  Sums, products, quotients and square roots are found exactly, or with a bit
+// that records whether anything was left over, and are then rounded to nearest, ties to even, so they are correctly
+// rounded.  Other functions are found with more bits than asked for, and kept once the approximation less and plus a
+// bound on its error round to the same value, and found again with twice as many more bits otherwise.  The bound is
+// proven for the functions the others are made of, exp, log, sin, cos, atan, erf, erfc and gamma, and for the others it
+// is the difference from the approximation with fewer bits.  Series are summed by binary splitting, which finds a sum of
+// n terms of rational ratio as one fraction from the sums of both halves, so that most work is in a few long products.
+// pi comes from the Chudnovsky series and ln 2 from atanh(1/26), atanh(1/4801) and atanh(1/8749), and both are kept for
+// the largest precision they were found to.  exp takes out a multiple of ln 2 and sin and cos a multiple of pi / 2, and
+// what is left is split into pieces of 8, 16, 32 and so on bits, each a short fraction whose series is summed by binary
+// splitting.  log and atan invert exp and sin with Newton's iteration, and gamma is Stirling's series after shifting its
+// argument up, with Bernoulli numbers from the tangent numbers
+#define MAX_EXPONENT (1LL << 21)  // Values stay below 2^MAX_EXPONENT in magnitude, and smaller ones than 2^-MAX_EXPONENT are 0
+#define EXACT_BITS (1LL << 40)    // Precision of sums and products that aren't rounded
+#define GUARD_BITS 32             // Bits functions carry beyond the precision asked for
+#define ERROR_BITS 8              // Error bound of a function, as a power of 2 of the last bit of its precision
+#define FIRST_EXTRA 32            // Bits beyond the precision asked for of the first approximation of a function
+#define FIRST_PIECE 8             // Bits of the first piece of an argument split for exp, sin and cos
+#define SHORT_ARGUMENT 256        // Longest mantissa for which the series of erf is summed by binary splitting
+#define RECIPROCAL_LIMBS 128      // Quotients and divisors from which division goes through a reciprocal
+#define NEWTON_START 48           // Good bits of the doubles Newton's iterations start from
+#define MAX_STEPS 64
+#define MAX_REDUCTION (1LL << 20) // Largest power of 2 of an argument of sin or cos
+#define EXACT_FACTORIAL 65536     // Bits of the largest n! found exactly as the gamma of an integer
+#define MAX_GAMMA_DIGITS 10000    // Most digits gamma and lgamma are found to, other than exactly, since they take seconds there
+#define DIGITS_TO_BITS 3.32192809488736234787
+#define LN_2 0.69314718055994530942
+#define LOG2_E 1.44269504088896340736
+#define SQRT_HALF 0.70710678118654752440
+
+typedef enum { SERIES_PI, SERIES_ATANH, SERIES_EXP, SERIES_SIN, SERIES_ERF } seriesKind;
+
+// A series each of whose terms is the one before times p(k) / q(k), summed from k = 0 with weights a(k)
+typedef struct {
+	seriesKind kind;
+	bigInteger u;        // Argument u / 2^r of exp, sin and erf
+	bigInteger square;   // u^2
+	long long int r;
+	long long int m;     // Argument 1 / m of atanh
+} series;
+
+// The sum of terms a to b of a series is t / (q 2^shift), and the product of their ratios p / (q 2^shift)
+typedef struct {
+	bigInteger p;
+	bigInteger q;
+	bigInteger t;
+	long long int shift;
+} splitSum;
+
+static bigFloat cachedPi;
+static long long int piBits;      // Precision of cachedPi, 0 before it is found
+static bigFloat cachedLn2;
+static long long int ln2Bits;
+static bigInteger* tangents;      // Tangent numbers T(1), T(2) ... for Stirling's series
+static int nrTangents;
+
+void initFloat(bigFloat* value) {
+	initBig(&value->mantissa);
+	value->exponent = 0;
+	value->undefined = false;
+}
+
+void freeFloat(bigFloat* value) {
+	freeBig(&value->mantissa);
+	initFloat(value);
+}
+
+// Copies a float.  Returns false if there is no memory
+bool copyFloat(bigFloat* to, const bigFloat* from) {
+
+	if (to == from) return true;
+	to->exponent = from->exponent;
+	to->undefined = from->undefined;
+	return copyBig(&to->mantissa, &from->mantissa);
+}
+
+static void moveFloat(bigFloat* to, bigFloat* from) {
+	// Gives the value of from to to, leaving from empty
+	freeFloat(to);
+	*to = *from;
+	initFloat(from);
+}
+
+static void setUndefined(bigFloat* value) {
+	value->mantissa.length = 0;
+	value->mantissa.negative = false;
+	value->exponent = 0;
+	value->undefined = true;
+}
+
+static void setZero(bigFloat* value) {
+	value->mantissa.length = 0;
+	value->mantissa.negative = false;
+	value->exponent = 0;
+	value->undefined = false;
+}
+
+static bool isZero(const bigFloat* value) {
+	return !value->undefined && value->mantissa.length == 0;
+}
+
+static bool isNegative(const bigFloat* value) {
+	return value->mantissa.negative;
+}
+
+static long long int topBit(const bigFloat* value) {
+	// |value| is in [2^(topBit - 1), 2^topBit).  Not for zero
+	return value->exponent + bigBitLength(&value->mantissa);
+}
+
+static int bitsOf(long long int n) {
+	// Number of bits of |n|
+	int bits = 0;
+	unsigned long long int magnitude = (n < 0) ? 0 - (unsigned long long int)n : (unsigned long long int)n;
+
+	while (magnitude > 0) {
+		magnitude >>= 1;
+		bits++;
+	}
+	return bits;
+}
+
+static bool bitAt(const bigInteger* value, long long int position) {
+	if (position < 0 || position >= 32LL * value->length) return false;
+	return (value->limbs[position / 32] >> (position % 32)) & 1;
+}
+
+static bool bitsBelow(const bigInteger* value, long long int position) {
+	// Whether any bit below position is set
+	long long int limb = position / 32;
+
+	for (long long int i = 0; i < limb && i < value->length; i++) {
+		if (value->limbs[i] != 0) return true;
+	}
+	if (limb >= value->length || position % 32 == 0) return false;
+	return (value->limbs[limb] & ((1u << (position % 32)) - 1)) != 0;
+}
+
+static long long int lowestBit(const bigInteger* value) {
+	// Position of the lowest set bit of a number that isn't zero
+	long long int limb = 0;
+	int bit = 0;
+
+	while (value->limbs[limb] == 0) limb++;
+	while (!((value->limbs[limb] >> bit) & 1)) bit++;
+	return 32 * limb + bit;
+}
+
+static bool roundFloat(bigFloat* value, long long int bits, bool inexact) {
+	// Rounds to bits bits, to nearest and ties to even.  inexact is set if the exact value is a little larger in
+	// magnitude than value, by less than its last bit, which only happens for values of more than bits + 1 bits.  The
+	// mantissa is then made odd
+	long long int length = bigBitLength(&value->mantissa);
+	long long int shift = length - bits;
+	bool half = false;
+	bool rest = false;
+	bool ok = true;
+
+	if (value->undefined) return true;
+	if (length == 0) {
+		value->exponent = 0;
+		return true;
+	}
+	if (shift > 0) {
+		half = bitAt(&value->mantissa, shift - 1);
+		rest = inexact || bitsBelow(&value->mantissa, shift - 1);
+		shiftBigRight(&value->mantissa, shift);
+		value->exponent += shift;
+		if (half && (rest || bitAt(&value->mantissa, 0))) {
+			ok = addBigSmall(&value->mantissa, value->mantissa.negative ? -1 : 1);
+		}
+	}
+	if (ok && value->mantissa.length > 0) {
+		shift = lowestBit(&value->mantissa);
+		shiftBigRight(&value->mantissa, shift);
+		value->exponent += shift;
+	}
+	return ok;
+}
+
+static void limitRange(bigFloat* value) {
+	// Values too large to keep are undefined, and values too small are 0
+	if (value->undefined || value->mantissa.length == 0) return;
+	if (topBit(value) > MAX_EXPONENT) {
+		setUndefined(value);
+	}
+	else if (topBit(value) < -MAX_EXPONENT) {
+		setZero(value);
+	}
+}
+
+static bool setSmall(bigFloat* value, long long int integer) {
+	// value = integer, exactly
+	value->undefined = false;
+	value->exponent = 0;
+	return setBig(&value->mantissa, integer) && roundFloat(value, EXACT_BITS, false);
+}
+
+// Number of bits that holds a number of decimal digits, with a few more so that the last digit is right
+long long int precisionBits(int digits) {
+
+	return (long long int)ceil(digits * DIGITS_TO_BITS) + 8;
+}
+
+// Sets a float to a double, rounded to bits bits.  NaN and infinities are undefined
+bool setFloat(bigFloat* value, double number, long long int bits) {
+
+	int exponent = 0;
+	double fraction = 0.0;
+
+	if (isnan(number) || isinf(number)) {
+		setUndefined(value);
+		return true;
+	}
+	fraction = frexp(number, &exponent);
+	value->undefined = false;
+	value->exponent = exponent - 53;
+	return setBig(&value->mantissa, (long long int)ldexp(fraction, 53)) && roundFloat(value, bits, false);
+}
+
+// Sets a float to an integer, rounded to bits bits
+bool setFloatInteger(bigFloat* value, const bigInteger* integer, long long int bits) {
+
+	value->undefined = false;
+	value->exponent = 0;
+	return copyBig(&value->mantissa, integer) && roundFloat(value, bits, false);
+}
+
+static double leadingBits(const bigFloat* value, long long int* scale) {
+	// Returns d and sets scale so that value is about d 2^scale, with |d| in [0.5, 1)
+	const bigInteger* mantissa = &value->mantissa;
+	int skipped = (mantissa->length > 3) ? mantissa->length - 3 : 0;
+	double leading = 0.0;
+	int power = 0;
+
+	for (int i = mantissa->length - 1; i >= skipped; i--) {
+		leading = leading * 4294967296.0 + mantissa->limbs[i];
+	}
+	leading = frexp(leading, &power);
+	*scale = value->exponent + 32LL * skipped + power;
+	return mantissa->negative ? -leading : leading;
+}
+
+// Returns the nearest double to a float, or an infinity if it is too large for one
+double floatToDouble(const bigFloat* value) {
+
+	bigFloat rounded;
+	double result = 0.0;
+
+	if (value->undefined) return NAN;
+	if (value->mantissa.length == 0) return 0.0;
+	if (topBit(value) > 1100) return isNegative(value) ? -INFINITY : INFINITY;
+	if (topBit(value) < -1100) return 0.0;
+	initFloat(&rounded);
+	if (copyFloat(&rounded, value) && roundFloat(&rounded, 53, false)) {
+		result = ldexp(bigToDouble(&rounded.mantissa), (int)rounded.exponent);
+	}
+	freeFloat(&rounded);
+	return result;
+}
+
+static bool toInteger(bigInteger* integer, const bigFloat* value, unsigned int mode) {
+	// Sets integer to value rounded to a whole number by OP_FLOOR, OP_CEIL, OP_TRUNC or OP_ROUND, which rounds halves
+	// away from zero
+	long long int shift = -value->exponent;
+	bool fraction = false;
+	bool half = false;
+	bool up = false;
+
+	if (!copyBig(integer, &value->mantissa)) return false;
+	if (value->exponent >= 0) return shiftBigLeft(integer, value->exponent);
+	fraction = integer->length > 0;
+	half = bitAt(integer, shift - 1);
+	integer->negative = false;
+	shiftBigRight(integer, shift);
+	switch (mode) {
+	case OP_FLOOR:
+		up = fraction && value->mantissa.negative;
+		break;
+	case OP_CEIL:
+		up = fraction && !value->mantissa.negative;
+		break;
+	case OP_ROUND:
+		up = half;
+		break;
+	default:
+		break;
+	}
+	if (up && !addBigSmall(integer, 1)) return false;
+	integer->negative = value->mantissa.negative && integer->length > 0;
+	return true;
+}
+
+static bool isInteger(const bigFloat* value) {
+	// The mantissa is odd, so a value is whole if it has no bits after the point
+	return !value->undefined && (value->mantissa.length == 0 || value->exponent >= 0);
+}
+
+static int compareFloat(const bigFloat* a, const bigFloat* b) {
+	// Returns -1, 0 or 1 as a is less than, equal to or greater than b
+	int sign = isNegative(a) ? -1 : 1;
+	long long int shift = 0;
+	bigInteger aligned;
+	int order = 0;
+
+	if (isZero(a) || isZero(b) || isNegative(a) != isNegative(b)) {
+		if (isZero(a) && isZero(b)) return 0;
+		if (isZero(a)) return isNegative(b) ? 1 : -1;
+		return sign;
+	}
+	if (topBit(a) != topBit(b)) return (topBit(a) > topBit(b)) ? sign : -sign;
+	// Same sign and magnitude within a factor of 2, so aligning the mantissas takes at most as many bits as either has
+	initBig(&aligned);
+	shift = a->exponent - b->exponent;
+	if (shift >= 0) {
+		if (!copyBig(&aligned, &a->mantissa) || !shiftBigLeft(&aligned, shift)) order = 0;
+		else order = compareBig(&aligned, &b->mantissa);
+	}
+	else {
+		if (!copyBig(&aligned, &b->mantissa) || !shiftBigLeft(&aligned, -shift)) order = 0;
+		else order = compareBig(&a->mantissa, &aligned);
+	}
+	freeBig(&aligned);
+	return order;
+}
+
+static bool sameFloat(const bigFloat* a, const bigFloat* b) {
+	return a->undefined == b->undefined && a->exponent == b->exponent && compareBig(&a->mantissa, &b->mantissa) == 0;
+}
+
+static bool addFloat(bigFloat* result, const bigFloat* a, const bigFloat* b, long long int bits, bool subtract) {
+	// result = a + b, or a - b, rounded to bits bits.  An operand entirely below the bit the sum is rounded at only
+	// decides which way the sum rounds, so it is replaced by a single bit below it, which rounds it the same way
+	const bigFloat* large = a;
+	const bigFloat* small = b;
+	bool largeNegated = false;
+	bool smallNegated = subtract;
+	long long int low = 0;
+	long long int exponent = 0;
+	bigFloat sum, far;
+	bigInteger aligned;
+	bool ok = true;
+
+	if (a->undefined || b->undefined) {
+		setUndefined(result);
+		return true;
+	}
+	if (isZero(a) || isZero(b)) {
+		ok = copyFloat(result, isZero(b) ? a : b);
+		if (isZero(a) && subtract) result->mantissa.negative = !result->mantissa.negative && result->mantissa.length > 0;
+		return ok && roundFloat(result, bits, false);
+	}
+	if (topBit(b) > topBit(a)) {
+		large = b;
+		small = a;
+		largeNegated = subtract;
+		smallNegated = false;
+	}
+	initFloat(&sum);
+	initFloat(&far);
+	initBig(&aligned);
+	low = ((large->exponent < topBit(large) - bits) ? large->exponent : topBit(large) - bits) - 2;
+	if (topBit(small) <= low) {
+		ok = setBig(&far.mantissa, isNegative(small) ? -1 : 1);
+		far.exponent = low - 1;
+		small = &far;
+	}
+	exponent = (large->exponent < small->exponent) ? large->exponent : small->exponent;
+	ok = ok && copyBig(&sum.mantissa, &large->mantissa) && shiftBigLeft(&sum.mantissa, large->exponent - exponent)
+		&& copyBig(&aligned, &small->mantissa) && shiftBigLeft(&aligned, small->exponent - exponent);
+	if (ok) {
+		if (largeNegated) sum.mantissa.negative = !sum.mantissa.negative;
+		if (smallNegated) aligned.negative = !aligned.negative;
+		sum.exponent = exponent;
+		ok = addBig(&sum.mantissa, &aligned, false) && roundFloat(&sum, bits, false);
+	}
+	if (ok) moveFloat(result, &sum);
+	freeFloat(&sum);
+	freeFloat(&far);
+	freeBig(&aligned);
+	return ok;
+}
+
+static bool multiplyFloat(bigFloat* result, const bigFloat* a, const bigFloat* b, long long int bits) {
+	// result = a * b, rounded to bits bits
+	if (a->undefined || b->undefined) {
+		setUndefined(result);
+		return true;
+	}
+	result->exponent = a->exponent + b->exponent;
+	result->undefined = false;
+	return multiplyBig(&result->mantissa, &a->mantissa, &b->mantissa) && roundFloat(result, bits, false);
+}
+
+static bool reciprocal(bigFloat* result, const bigFloat* value, long long int bits);
+
+static bool divideFloor(bigInteger* quotient, bigInteger* remainder, const bigInteger* a, const bigInteger* b) {
+	// quotient = a / b rounded down and remainder = a - quotient b, for a and b above 0.  Long quotients by long divisors
+	// come from a reciprocal of b by Newton's iteration, which are then corrected by at most a few units
+	long long int quotientBits = bigBitLength(a) - bigBitLength(b) + 1;
+	bigFloat inverse, dividend, estimate;
+	bigInteger product;
+	bool ok = true;
+
+	if (quotientBits < 32LL * RECIPROCAL_LIMBS || b->length < RECIPROCAL_LIMBS) {
+		return divideBig(quotient, remainder, a, b);
+	}
+	initFloat(&inverse);
+	initFloat(&dividend);
+	initFloat(&estimate);
+	initBig(&product);
+	ok = setFloatInteger(&dividend, b, EXACT_BITS) && reciprocal(&inverse, &dividend, quotientBits + 32)
+		&& setFloatInteger(&dividend, a, quotientBits + 32) && multiplyFloat(&estimate, &dividend, &inverse, quotientBits + 32)
+		&& toInteger(quotient, &estimate, OP_FLOOR) && multiplyBig(&product, quotient, b) && copyBig(remainder, a)
+		&& addBig(remainder, &product, true);
+	while (ok && remainder->negative) {
+		ok = addBigSmall(quotient, -1) && addBig(remainder, b, false);
+	}
+	while (ok && compareBig(remainder, b) >= 0) {
+		ok = addBigSmall(quotient, 1) && addBig(remainder, b, true);
+	}
+	freeFloat(&inverse);
+	freeFloat(&dividend);
+	freeFloat(&estimate);
+	freeBig(&product);
+	return ok;
+}
+
+static bool divideFloat(bigFloat* result, const bigFloat* a, const bigFloat* b, long long int bits) {
+	// result = a / b, rounded to bits bits, from a quotient of at least bits + 2 bits and whether it left a remainder
+	long long int shift = bits + 3 + bigBitLength(&b->mantissa) - bigBitLength(&a->mantissa);
+	long long int exponent = 0;
+	bool negative = isNegative(a) != isNegative(b);
+	bigInteger dividend, divisor, remainder;
+	bool ok = true;
+
+	if (a->undefined || b->undefined || isZero(b)) {
+		setUndefined(result);
+		return true;
+	}
+	if (isZero(a)) {
+		setZero(result);
+		return true;
+	}
+	if (shift < 0) shift = 0;
+	exponent = a->exponent - b->exponent - shift;
+	initBig(&dividend);
+	initBig(&divisor);
+	initBig(&remainder);
+	ok = copyBig(&dividend, &a->mantissa) && shiftBigLeft(&dividend, shift) && copyBig(&divisor, &b->mantissa);
+	dividend.negative = false;
+	divisor.negative = false;
+	ok = ok && divideFloor(&result->mantissa, &remainder, &dividend, &divisor);
+	if (ok) {
+		result->mantissa.negative = negative;
+		result->exponent = exponent;
+		result->undefined = false;
+		ok = roundFloat(result, bits, remainder.length > 0);
+	}
+	freeBig(&dividend);
+	freeBig(&divisor);
+	freeBig(&remainder);
+	return ok;
+}
+
+static int newtonSteps(long long int bits, int growth, long long int steps[]) {
+	// Precisions of the steps of a Newton's iteration that ends at bits bits, from the last, each step multiplying the
+	// good bits by growth
+	int count = 0;
+
+	for (long long int precision = bits + 4; count < MAX_STEPS; precision = precision / growth + 4) {
+		steps[count++] = precision;
+		if (precision <= NEWTON_START) break;
+	}
+	return count;
+}
+
+static bool reciprocal(bigFloat* result, const bigFloat* value, long long int bits) {
+	// result = 1 / value to about bits bits, by y + y (1 - value y), which doubles the good bits of y
+	long long int steps[MAX_STEPS];
+	int nrSteps = newtonSteps(bits, 2, steps);
+	long long int scale = 0;
+	double leading = leadingBits(value, &scale);
+	bigFloat y, rounded, error;
+	bool ok = true;
+
+	initFloat(&y);
+	initFloat(&rounded);
+	initFloat(&error);
+	ok = setFloat(&y, 1.0 / leading, 53);
+	y.exponent -= scale;
+	for (int i = nrSteps - 1; i >= 0 && ok; i--) {
+		ok = copyFloat(&rounded, value) && roundFloat(&rounded, steps[i], false)
+			&& multiplyFloat(&error, &rounded, &y, EXACT_BITS) && setSmall(&rounded, 1)
+			&& addFloat(&error, &rounded, &error, steps[i] / 2 + 8, true)
+			&& multiplyFloat(&error, &error, &y, steps[i] / 2 + 8) && addFloat(&y, &y, &error, steps[i], false);
+	}
+	if (ok) moveFloat(result, &y);
+	freeFloat(&y);
+	freeFloat(&rounded);
+	freeFloat(&error);
+	return ok;
+}
+
+static bool inverseRoot(bigFloat* result, const bigFloat* value, long long int bits) {
+	// result = 1 / sqrt(value) to about bits bits, by y + y (1 - value y^2) / 2
+	long long int steps[MAX_STEPS];
+	int nrSteps = newtonSteps(bits, 2, steps);
+	long long int scale = 0;
+	double leading = leadingBits(value, &scale);
+	bigFloat y, rounded, error;
+	bool ok = true;
+
+	if (scale & 1) {
+		leading *= 2;
+		scale--;
+	}
+	initFloat(&y);
+	initFloat(&rounded);
+	initFloat(&error);
+	ok = setFloat(&y, 1.0 / sqrt(leading), 53);
+	y.exponent -= scale / 2;
+	for (int i = nrSteps - 1; i >= 0 && ok; i--) {
+		ok = copyFloat(&rounded, value) && roundFloat(&rounded, steps[i], false)
+			&& multiplyFloat(&error, &y, &y, steps[i]) && multiplyFloat(&error, &error, &rounded, steps[i])
+			&& setSmall(&rounded, 1) && addFloat(&error, &rounded, &error, steps[i] / 2 + 8, true)
+			&& multiplyFloat(&error, &error, &y, steps[i] / 2 + 8);
+		error.exponent--;
+		ok = ok && addFloat(&y, &y, &error, steps[i], false);
+	}
+	if (ok) moveFloat(result, &y);
+	freeFloat(&y);
+	freeFloat(&rounded);
+	freeFloat(&error);
+	return ok;
+}
+
+static bool squareRoot(bigFloat* result, const bigFloat* value, long long int bits) {
+	// result = sqrt(value), rounded to bits bits.  s = floor(sqrt(n)) of an integer n of about 2 bits + 4 bits comes from
+	// n / sqrt(n), and is corrected until n - s^2 is in [0, 2s]
+	long long int shift = 2 * bits + 4 - bigBitLength(&value->mantissa);
+	bigFloat number, estimate;
+	bigInteger root, remainder, step;
+	bool ok = true;
+
+	if (value->undefined || isNegative(value)) {
+		setUndefined(result);
+		return true;
+	}
+	if (isZero(value)) {
+		setZero(result);
+		return true;
+	}
+	if (shift < 0) shift = 0;
+	if ((value->exponent - shift) % 2 != 0) shift++;
+	initFloat(&number);
+	initFloat(&estimate);
+	initBig(&root);
+	initBig(&remainder);
+	initBig(&step);
+	ok = copyBig(&number.mantissa, &value->mantissa) && shiftBigLeft(&number.mantissa, shift)
+		&& inverseRoot(&estimate, &number, bigBitLength(&number.mantissa) / 2 + 32)
+		&& multiplyFloat(&estimate, &estimate, &number, bigBitLength(&number.mantissa) / 2 + 32)
+		&& toInteger(&root, &estimate, OP_FLOOR) && multiplyBig(&step, &root, &root)
+		&& copyBig(&remainder, &number.mantissa) && addBig(&remainder, &step, true);
+	// remainder = n - s^2, which grows by 2s + 1 when s goes down by 1
+	while (ok && remainder.negative) {
+		ok = addBigSmall(&root, -1) && copyBig(&step, &root) && shiftBigLeft(&step, 1) && addBigSmall(&step, 1)
+			&& addBig(&remainder, &step, false);
+	}
+	while (ok && copyBig(&step, &root) && shiftBigLeft(&step, 1) && compareBig(&remainder, &step) > 0) {
+		ok = addBigSmall(&step, 1) && addBig(&remainder, &step, true) && addBigSmall(&root, 1);
+	}
+	if (ok) {
+		result->undefined = false;
+		result->exponent = (value->exponent - shift) / 2;
+		ok = copyBig(&result->mantissa, &root) && roundFloat(result, bits, remainder.length > 0);
+	}
+	freeFloat(&number);
+	freeFloat(&estimate);
+	freeBig(&root);
+	freeBig(&remainder);
+	freeBig(&step);
+	return ok;
+}
+
+static bool seriesTerm(const series* s, long long int k, splitSum* term) {
+	// Sets p(k), q(k) and a(k) p(k) of a term of a series
+	bool ok = true;
+
+	term->shift = 0;
+	switch (s->kind) {
+	case SERIES_PI:
+		// Terms (-1)^k (6k)! / ((3k)! k!^3 640320^3k) (13591409 + 545140134 k)
+		if (k == 0) {
+			ok = setBig(&term->p, 1) && setBig(&term->q, 1);
+		}
+		else {
+			ok = setBig(&term->p, -(6 * k - 5) * (2 * k - 1) * (6 * k - 1)) && setBig(&term->q, k * k * k)
+				&& setBig(&term->t, 10939058860032000LL) && multiplyBig(&term->q, &term->q, &term->t);
+		}
+		return ok && setBig(&term->t, 13591409 + 545140134 * k) && multiplyBig(&term->t, &term->t, &term->p);
+	case SERIES_ATANH:
+		// Terms 1 / ((2k + 1) m^(2k + 1))
+		ok = (k == 0) ? setBig(&term->p, 1) && setBig(&term->q, s->m)
+			: setBig(&term->p, 2 * k - 1) && setBig(&term->q, (2 * k + 1) * s->m * s->m);
+		break;
+	case SERIES_EXP:
+		// Terms x^k / k!
+		ok = (k == 0) ? setBig(&term->p, 1) && setBig(&term->q, 1) : copyBig(&term->p, &s->u) && setBig(&term->q, k);
+		term->shift = (k == 0) ? 0 : s->r;
+		break;
+	case SERIES_SIN:
+		// Terms (-1)^k x^(2k + 1) / (2k + 1)!
+		ok = (k == 0) ? copyBig(&term->p, &s->u) && setBig(&term->q, 1)
+			: copyBig(&term->p, &s->square) && setBig(&term->q, 2 * k * (2 * k + 1));
+		if (k > 0) term->p.negative = true;
+		term->shift = (k == 0) ? s->r : 2 * s->r;
+		break;
+	case SERIES_ERF:
+		// Terms 2^k x^(2k + 1) / (2k + 1)!!
+		ok = (k == 0) ? copyBig(&term->p, &s->u) && setBig(&term->q, 1)
+			: copyBig(&term->p, &s->square) && shiftBigLeft(&term->p, 1) && setBig(&term->q, 2 * k + 1);
+		term->shift = (k == 0) ? s->r : 2 * s->r;
+		break;
+	}
+	return ok && copyBig(&term->t, &term->p);
+}
+
+static bool splitSeries(const series* s, long long int a, long long int b, splitSum* sum, bool needProduct) {
+	// Sums terms a to b - 1 from the sums of both halves: p = p1 p2, q = q1 q2 and t = t1 q2 2^shift2 + p1 t2
+	splitSum right;
+	long long int middle = a + (b - a) / 2;
+	bool ok = true;
+
+	if (b - a == 1) return seriesTerm(s, a, sum);
+	initBig(&right.p);
+	initBig(&right.q);
+	initBig(&right.t);
+	ok = splitSeries(s, a, middle, sum, true) && splitSeries(s, middle, b, &right, needProduct)
+		&& multiplyBig(&sum->t, &sum->t, &right.q) && shiftBigLeft(&sum->t, right.shift)
+		&& multiplyBig(&right.t, &sum->p, &right.t) && addBig(&sum->t, &right.t, false)
+		&& multiplyBig(&sum->q, &sum->q, &right.q) && (!needProduct || multiplyBig(&sum->p, &sum->p, &right.p));
+	sum->shift += right.shift;
+	freeBig(&right.p);
+	freeBig(&right.q);
+	freeBig(&right.t);
+	return ok;
+}
+
+static bool sumSeries(bigFloat* result, const series* s, long long int nrTerms, long long int bits) {
+	// result = the sum of the first nrTerms terms of a series, rounded to bits bits
+	splitSum sum;
+	bigFloat numerator, denominator;
+	bool ok = true;
+
+	initBig(&sum.p);
+	initBig(&sum.q);
+	initBig(&sum.t);
+	initFloat(&numerator);
+	initFloat(&denominator);
+	ok = splitSeries(s, 0, nrTerms, &sum, false) && setFloatInteger(&numerator, &sum.t, EXACT_BITS)
+		&& setFloatInteger(&denominator, &sum.q, EXACT_BITS) && divideFloat(result, &numerator, &denominator, bits);
+	result->exponent -= sum.shift;
+	freeBig(&sum.p);
+	freeBig(&sum.q);
+	freeBig(&sum.t);
+	freeFloat(&numerator);
+	freeFloat(&denominator);
+	return ok;
+}
+
+static void initSeries(series* s, seriesKind kind) {
+	s->kind = kind;
+	initBig(&s->u);
+	initBig(&s->square);
+	s->r = 0;
+	s->m = 0;
+}
+
+static void freeSeries(series* s) {
+	freeBig(&s->u);
+	freeBig(&s->square);
+}
+
+static bool atanhInverse(bigFloat* result, long long int m, long long int bits) {
+	// result = atanh(1 / m), whose terms get smaller by m^2 each
+	series s;
+	bool ok = true;
+
+	initSeries(&s, SERIES_ATANH);
+	s.m = m;
+	ok = sumSeries(result, &s, (long long int)(bits / (2 * log2((double)m))) + 2, bits);
+	freeSeries(&s);
+	return ok;
+}
+
+static bool findPi(bigFloat* result, long long int bits) {
+	// pi = 426880 sqrt(10005) / the sum of the Chudnovsky series, each term of which gives 47 bits
+	series s;
+	bigFloat root, factor;
+	bool ok = true;
+
+	initSeries(&s, SERIES_PI);
+	initFloat(&root);
+	initFloat(&factor);
+	ok = sumSeries(result, &s, bits / 47 + 2, bits + 8) && setSmall(&root, 10005)
+		&& squareRoot(&root, &root, bits + 8) && setSmall(&factor, 426880)
+		&& multiplyFloat(&root, &root, &factor, bits + 8) && divideFloat(result, &root, result, bits);
+	freeSeries(&s);
+	freeFloat(&root);
+	freeFloat(&factor);
+	return ok;
+}
+
+static bool getPi(bigFloat* result, long long int bits) {
+	// result = pi to bits bits, from the value kept for the largest precision asked for so far
+	if (piBits < bits) {
+		if (!findPi(&cachedPi, bits + GUARD_BITS)) {
+			piBits = 0;
+			return false;
+		}
+		piBits = bits + GUARD_BITS - 4;
+	}
+	return copyFloat(result, &cachedPi) && roundFloat(result, bits, false);
+}
+
+static bool getLn2(bigFloat* result, long long int bits) {
+	// ln 2 = 18 atanh(1/26) - 2 atanh(1/4801) + 8 atanh(1/8749)
+	bigFloat term, factor;
+	bool ok = true;
+
+	if (ln2Bits < bits) {
+		initFloat(&term);
+		initFloat(&factor);
+		ok = atanhInverse(&cachedLn2, 26, bits + GUARD_BITS) && setSmall(&factor, 18)
+			&& multiplyFloat(&cachedLn2, &cachedLn2, &factor, bits + GUARD_BITS)
+			&& atanhInverse(&term, 4801, bits + GUARD_BITS) && setSmall(&factor, 2)
+			&& multiplyFloat(&term, &term, &factor, bits + GUARD_BITS)
+			&& addFloat(&cachedLn2, &cachedLn2, &term, bits + GUARD_BITS, true)
+			&& atanhInverse(&term, 8749, bits + GUARD_BITS) && setSmall(&factor, 8)
+			&& multiplyFloat(&term, &term, &factor, bits + GUARD_BITS)
+			&& addFloat(&cachedLn2, &cachedLn2, &term, bits + GUARD_BITS, false);
+		ln2Bits = ok ? bits + GUARD_BITS - 4 : 0;
+		freeFloat(&term);
+		freeFloat(&factor);
+		if (!ok) return false;
+	}
+	return copyFloat(result, &cachedLn2) && roundFloat(result, bits, false);
+}
+
+static bool toFixed(bigInteger* fixed, const bigFloat* value, long long int fractionBits) {
+	// fixed = |value| 2^fractionBits, rounded down
+	long long int shift = value->exponent + fractionBits;
+
+	if (!copyBig(fixed, &value->mantissa)) return false;
+	fixed->negative = false;
+	if (shift >= 0) return shiftBigLeft(fixed, shift);
+	shiftBigRight(fixed, -shift);
+	return true;
+}
+
+static bool takePiece(bigInteger* piece, const bigInteger* fixed, long long int fractionBits, long long int low,
+	long long int high) {
+	// piece = bits low + 1 to high after the point of a number with fractionBits bits after the point
+	if (!copyBig(piece, fixed)) return false;
+	shiftBigRight(piece, fractionBits - high);
+	if (piece->length > (high - low + 31) / 32) piece->length = (int)((high - low + 31) / 32);
+	if ((high - low) % 32 != 0 && piece->length == (high - low + 31) / 32) {
+		piece->limbs[piece->length - 1] &= (1u << ((high - low) % 32)) - 1;
+	}
+	while (piece->length > 0 && piece->limbs[piece->length - 1] == 0) piece->length--;
+	return true;
+}
+
+static long long int termsNeeded(double logTerm, double logRatio, double growth, long long int bits) {
+	// Terms of a series until they are below 2^-bits, where term k is term k - 1 times ratio / (k (k + growth)), or
+	// ratio / k when growth is 0, in powers of 2
+	for (long long int k = 1; ; k++) {
+		logTerm += logRatio - log2((double)k) - ((growth > 0) ? log2(k + growth) : 0.0);
+		if (logTerm < -(double)bits - 2) return k + 1;
+	}
+}
+
+static bool expSmall(bigFloat* result, const bigFloat* value, long long int bits) {
+	// result = exp(value) for |value| < 1/2, as the product of exp of its pieces
+	bigInteger fixed;
+	series s;
+	bigFloat piece;
+	bool ok = true;
+
+	initBig(&fixed);
+	initSeries(&s, SERIES_EXP);
+	initFloat(&piece);
+	ok = toFixed(&fixed, value, bits) && setSmall(result, 1);
+	for (long long int low = 0, high = FIRST_PIECE; low < bits && ok; low = high, high *= 2) {
+		if (high > bits) high = bits;
+		ok = takePiece(&s.u, &fixed, bits, low, high);
+		if (!ok || s.u.length == 0) continue;
+		s.u.negative = isNegative(value);
+		s.r = high;
+		ok = sumSeries(&piece, &s, termsNeeded(0.0, (low == 0) ? -1.0 : (double)-low, 0.0, bits), bits)
+			&& multiplyFloat(result, result, &piece, bits);
+	}
+	freeBig(&fixed);
+	freeSeries(&s);
+	freeFloat(&piece);
+	return ok;
+}
+
+static bool expFloat(bigFloat* result, const bigFloat* value, long long int bits) {
+	// result = exp(value) = 2^n exp(value - n ln 2), to about bits bits
+	double estimate = floatToDouble(value);
+	long long int work = bits + GUARD_BITS + bitsOf(bits);
+	long long int n = 0;
+	bigFloat reduced, multiple;
+	bool ok = true;
+
+	if (value->undefined || estimate > (MAX_EXPONENT + 2) * LN_2) {
+		setUndefined(result);
+		return true;
+	}
+	if (isZero(value)) return setSmall(result, 1);
+	if (estimate < -(MAX_EXPONENT + 2) * LN_2) {
+		setZero(result);
+		return true;
+	}
+	n = llround(estimate / LN_2);
+	initFloat(&reduced);
+	initFloat(&multiple);
+	ok = getLn2(&multiple, work + bitsOf(n) + 4) && setSmall(&reduced, n)
+		&& multiplyFloat(&multiple, &multiple, &reduced, EXACT_BITS)
+		&& addFloat(&reduced, value, &multiple, EXACT_BITS, true) && expSmall(result, &reduced, work);
+	result->exponent += n;
+	ok = ok && roundFloat(result, bits, false);
+	freeFloat(&reduced);
+	freeFloat(&multiple);
+	return ok;
+}
+
+static bool logFloat(bigFloat* result, const bigFloat* value, long long int bits) {
+	// result = log(value) = log(y) + k ln 2, with y in [1/sqrt(2), sqrt(2)).  log(y) is z, with z + 2 (y - exp(z)) /
+	// (y + exp(z)), which triples the good bits of z.  y near 1 has a small logarithm, which takes as many more bits
+	// as there are zeros at the start of y - 1
+	long long int steps[MAX_STEPS];
+	int nrSteps = 0;
+	long long int k = 0;
+	long long int scale = 0;
+	long long int work = bits + GUARD_BITS;
+	double leading = 0.0;
+	bigFloat y, z, power, difference, sum;
+	bool ok = true;
+
+	if (value->undefined || isNegative(value) || isZero(value)) {
+		setUndefined(result);
+		return true;
+	}
+	if (value->exponent == 0 && value->mantissa.length == 1 && value->mantissa.limbs[0] == 1) {
+		setZero(result);
+		return true;
+	}
+	initFloat(&y);
+	initFloat(&z);
+	initFloat(&power);
+	initFloat(&difference);
+	initFloat(&sum);
+	leading = leadingBits(value, &scale);
+	k = scale;
+	if (leading < SQRT_HALF) {
+		leading *= 2;
+		k--;
+	}
+	ok = copyFloat(&y, value) && setSmall(&power, 1) && addFloat(&difference, &y, &power, EXACT_BITS, true);
+	y.exponent -= k;
+	if (ok && k == 0 && !isZero(&difference) && topBit(&difference) < 0) work -= topBit(&difference);
+	nrSteps = newtonSteps(work, 3, steps);
+	ok = ok && setFloat(&z, log(leading), 53);
+	for (int i = nrSteps - 1; i >= 0 && ok; i--) {
+		ok = expFloat(&power, &z, steps[i]) && addFloat(&difference, &y, &power, steps[i], true)
+			&& addFloat(&sum, &y, &power, steps[i], false) && divideFloat(&difference, &difference, &sum, steps[i]);
+		difference.exponent++;
+		ok = ok && addFloat(&z, &z, &difference, steps[i], false);
+	}
+	if (ok && k != 0) {
+		ok = getLn2(&power, work + bitsOf(k)) && setSmall(&sum, k) && multiplyFloat(&power, &power, &sum, EXACT_BITS)
+			&& addFloat(&z, &z, &power, work, false);
+	}
+	ok = ok && roundFloat(&z, bits, false);
+	if (ok) moveFloat(result, &z);
+	freeFloat(&y);
+	freeFloat(&z);
+	freeFloat(&power);
+	freeFloat(&difference);
+	freeFloat(&sum);
+	return ok;
+}
+
+static bool sinCosSmall(bigFloat* sine, bigFloat* cosine, const bigFloat* value, long long int bits) {
+	// sin and cos of 0 <= value < 1, from sin of each of its pieces, the cos of which is sqrt(1 - sin^2), and
+	// sin(a + b) = sin a cos b + cos a sin b and cos(a + b) = cos a cos b - sin a sin b.  sin of a small value is about as
+	// small, so value is cut into pieces to as many more bits as it has zeros after the point
+	long long int fractionBits = bits + ((topBit(value) < 0) ? -topBit(value) : 0);
+	bigInteger fixed;
+	series s;
+	bigFloat pieceSin, pieceCos, product, one;
+	bool first = true;
+	bool ok = true;
+
+	initBig(&fixed);
+	initSeries(&s, SERIES_SIN);
+	initFloat(&pieceSin);
+	initFloat(&pieceCos);
+	initFloat(&product);
+	initFloat(&one);
+	ok = toFixed(&fixed, value, fractionBits) && setSmall(sine, 0) && setSmall(cosine, 1) && setSmall(&one, 1);
+	for (long long int low = 0, high = FIRST_PIECE; low < fractionBits && ok; low = high, high *= 2) {
+		if (high > fractionBits) high = fractionBits;
+		ok = takePiece(&s.u, &fixed, fractionBits, low, high) && multiplyBig(&s.square, &s.u, &s.u);
+		if (!ok || s.u.length == 0) continue;
+		s.r = high;
+		ok = sumSeries(&pieceSin, &s, termsNeeded(0.0, (low == 0) ? 0.0 : (double)-2 * low, 1.0, fractionBits), bits)
+			&& multiplyFloat(&pieceCos, &pieceSin, &pieceSin, bits) && addFloat(&pieceCos, &one, &pieceCos, EXACT_BITS, true)
+			&& squareRoot(&pieceCos, &pieceCos, bits);
+		if (ok && first) {
+			ok = copyFloat(sine, &pieceSin) && copyFloat(cosine, &pieceCos);
+			first = false;
+		}
+		else if (ok) {
+			// The new sine uses the old cosine, so it is found in product first
+			ok = multiplyFloat(&product, sine, &pieceCos, bits) && multiplyFloat(&one, cosine, &pieceSin, bits)
+				&& addFloat(&product, &product, &one, bits, false) && multiplyFloat(cosine, cosine, &pieceCos, bits)
+				&& multiplyFloat(&one, sine, &pieceSin, bits) && addFloat(cosine, cosine, &one, bits, true)
+				&& copyFloat(sine, &product) && setSmall(&one, 1);
+		}
+	}
+	freeBig(&fixed);
+	freeSeries(&s);
+	freeFloat(&pieceSin);
+	freeFloat(&pieceCos);
+	freeFloat(&product);
+	freeFloat(&one);
+	return ok;
+}
+
+static bool sinCos(bigFloat* sine, bigFloat* cosine, const bigFloat* value, long long int bits) {
+	// sin and cos of value, either of which may be NULL.  value less the nearest multiple n of pi / 2 is found with
+	// enough bits of pi that what is left keeps bits good bits, and sin and cos of it are swapped and negated by n mod 4
+	long long int top = 0;
+	long long int extra = 0;
+	long long int work = 0;
+	int quadrant = 0;
+	bigFloat halfPi, quotient, reduced, s, c;
+	bigInteger n;
+	bool ok = true;
+
+	if (value->undefined || (!isZero(value) && topBit(value) > MAX_REDUCTION)) {
+		if (sine != NULL) setUndefined(sine);
+		if (cosine != NULL) setUndefined(cosine);
+		return true;
+	}
+	if (isZero(value)) {
+		return (sine == NULL || setSmall(sine, 0)) && (cosine == NULL || setSmall(cosine, 1));
+	}
+	top = (topBit(value) > 0) ? topBit(value) : 0;
+	initFloat(&halfPi);
+	initFloat(&quotient);
+	initFloat(&reduced);
+	initFloat(&s);
+	initFloat(&c);
+	initBig(&n);
+	while (ok) {
+		work = bits + GUARD_BITS + extra;
+		ok = getPi(&halfPi, work + top + 8);
+		halfPi.exponent--;
+		ok = ok && divideFloat(&quotient, value, &halfPi, top + 8) && toInteger(&n, &quotient, OP_ROUND)
+			&& setFloatInteger(&quotient, &n, EXACT_BITS) && multiplyFloat(&quotient, &quotient, &halfPi, EXACT_BITS)
+			&& addFloat(&reduced, value, &quotient, EXACT_BITS, true);
+		if (!ok || n.length == 0 || topBit(&reduced) >= -(extra + 4)) break;
+		extra = 8 - topBit(&reduced);
+	}
+	if (ok) {
+		quadrant = (n.length > 0) ? (int)(n.limbs[0] & 3) : 0;
+		if (n.negative) quadrant = (4 - quadrant) & 3;
+		ok = copyFloat(&quotient, &reduced);
+		quotient.mantissa.negative = false;
+		ok = ok && sinCosSmall(&s, &c, &quotient, work);
+		if (isNegative(&reduced)) s.mantissa.negative = !s.mantissa.negative && s.mantissa.length > 0;
+	}
+	if (ok && sine != NULL) {
+		ok = copyFloat(sine, (quadrant & 1) ? &c : &s) && roundFloat(sine, bits, false);
+		if (quadrant >= 2) sine->mantissa.negative = !sine->mantissa.negative && sine->mantissa.length > 0;
+	}
+	if (ok && cosine != NULL) {
+		ok = copyFloat(cosine, (quadrant & 1) ? &s : &c) && roundFloat(cosine, bits, false);
+		if (quadrant == 1 || quadrant == 2) {
+			cosine->mantissa.negative = !cosine->mantissa.negative && cosine->mantissa.length > 0;
+		}
+	}
+	freeFloat(&halfPi);
+	freeFloat(&quotient);
+	freeFloat(&reduced);
+	freeFloat(&s);
+	freeFloat(&c);
+	freeBig(&n);
+	return ok;
+}
+
+static bool atanSmall(bigFloat* result, const bigFloat* value, long long int bits) {
+	// result = atan(value) for 0 < value <= 1, as y + cos(y) (value cos(y) - sin(y)), which doubles the good bits of y
+	long long int steps[MAX_STEPS];
+	int nrSteps = newtonSteps(bits, 2, steps);
+	bigFloat y, s, c, error;
+	bool ok = true;
+
+	initFloat(&y);
+	initFloat(&s);
+	initFloat(&c);
+	initFloat(&error);
+	ok = setFloat(&y, atan(floatToDouble(value)), 53);
+	for (int i = nrSteps - 1; i >= 0 && ok; i--) {
+		ok = sinCos(&s, &c, &y, steps[i]) && multiplyFloat(&error, value, &c, steps[i])
+			&& addFloat(&error, &error, &s, steps[i], true) && multiplyFloat(&error, &error, &c, steps[i])
+			&& addFloat(&y, &y, &error, steps[i], false);
+	}
+	if (ok) moveFloat(result, &y);
+	freeFloat(&y);
+	freeFloat(&s);
+	freeFloat(&c);
+	freeFloat(&error);
+	return ok;
+}
+
+static bool atanFloat(bigFloat* result, const bigFloat* value, long long int bits) {
+	// atan(x) = pi / 2 - atan(1 / x) for x > 1
+	long long int work = bits + GUARD_BITS;
+	bool negative = isNegative(value);
+	bigFloat magnitude, halfPi;
+	int order = 0;
+	bool ok = true;
+
+	if (value->undefined || isZero(value)) return copyFloat(result, value);
+	initFloat(&magnitude);
+	initFloat(&halfPi);
+	ok = copyFloat(&magnitude, value) && setSmall(&halfPi, 1);
+	magnitude.mantissa.negative = false;
+	order = compareFloat(&magnitude, &halfPi);
+	if (ok && order == 0) {
+		ok = getPi(result, work);
+		result->exponent -= 2;
+	}
+	else if (ok && order > 0) {
+		ok = divideFloat(&magnitude, &halfPi, &magnitude, work) && atanSmall(&magnitude, &magnitude, work)
+			&& getPi(&halfPi, work + 2);
+		halfPi.exponent--;
+		ok = ok && addFloat(result, &halfPi, &magnitude, work, true);
+	}
+	else if (ok) {
+		ok = atanSmall(result, &magnitude, work);
+	}
+	if (ok && negative) result->mantissa.negative = !result->mantissa.negative && result->mantissa.length > 0;
+	ok = ok && roundFloat(result, bits, false);
+	freeFloat(&magnitude);
+	freeFloat(&halfPi);
+	return ok;
+}
+
+static bool erfSum(bigFloat* result, const bigFloat* value, const bigFloat* square, long long int bits) {
+	// result = the sum of 2^k x^(2k + 1) / (2k + 1)!! for x > 0, all of whose terms are positive.  They grow while k is
+	// below x^2, and are summed by binary splitting when x has a short mantissa
+	double x2 = floatToDouble(square);
+	long long int scale = 0;
+	double logValue = log2(fabs(leadingBits(value, &scale))) + scale;
+	long long int nrTerms = 0;
+	double logTerm = logValue;
+	series s;
+	bigFloat term, factor;
+	bool ok = true;
+
+	if (bigBitLength(&value->mantissa) <= SHORT_ARGUMENT) {
+		for (nrTerms = 1; nrTerms <= 2 * x2 + 1 || logTerm >= logValue - bits - 4; nrTerms++) {
+			logTerm += log2(2 * x2) - log2(2.0 * nrTerms + 1);
+		}
+		initSeries(&s, SERIES_ERF);
+		ok = copyBig(&s.u, &value->mantissa);
+		if (value->exponent >= 0) {
+			ok = ok && shiftBigLeft(&s.u, value->exponent);
+		}
+		else {
+			s.r = -value->exponent;
+		}
+		ok = ok && multiplyBig(&s.square, &s.u, &s.u) && sumSeries(result, &s, nrTerms + 1, bits);
+		freeSeries(&s);
+		return ok;
+	}
+	initFloat(&term);
+	initFloat(&factor);
+	ok = copyFloat(&term, value) && copyFloat(result, value);
+	for (long long int k = 1; ok; k++) {
+		ok = multiplyFloat(&term, &term, square, bits) && setSmall(&factor, 2 * k + 1);
+		term.exponent++;
+		ok = ok && divideFloat(&term, &term, &factor, bits) && addFloat(result, result, &term, bits, false);
+		if (k > x2 && topBit(&term) < topBit(result) - bits - 4) break;
+	}
+	freeFloat(&term);
+	freeFloat(&factor);
+	return ok;
+}
+
+static bool erfFloat(bigFloat* result, const bigFloat* value, long long int bits) {
+	// erf(x) = 2 / sqrt(pi) exp(-x^2) times the sum of erfSum(), which is within 2^-bits of 1 when x^2 > bits ln 2
+	long long int work = bits + GUARD_BITS;
+	bool negative = isNegative(value);
+	bigFloat magnitude, square, factor;
+	bool ok = true;
+
+	if (value->undefined || isZero(value)) return copyFloat(result, value);
+	initFloat(&magnitude);
+	initFloat(&square);
+	initFloat(&factor);
+	ok = copyFloat(&magnitude, value) && multiplyFloat(&square, value, value, EXACT_BITS);
+	magnitude.mantissa.negative = false;
+	if (ok && floatToDouble(&square) > (work + 8) * LN_2) {
+		// 1 - 2^-(work + 8), which rounds as erf(x) does
+		ok = setSmall(result, 1) && shiftBigLeft(&result->mantissa, work + 8) && addBigSmall(&result->mantissa, -1);
+		result->exponent = -(work + 8);
+	}
+	else if (ok) {
+		ok = erfSum(result, &magnitude, &square, work + 16) && getPi(&factor, work + 16)
+			&& squareRoot(&factor, &factor, work + 16) && divideFloat(result, result, &factor, work + 16);
+		square.mantissa.negative = true;
+		ok = ok && expFloat(&factor, &square, work + 16) && multiplyFloat(result, result, &factor, work);
+		result->exponent++;
+	}
+	if (ok && negative) result->mantissa.negative = true;
+	ok = ok && roundFloat(result, bits, false);
+	freeFloat(&magnitude);
+	freeFloat(&square);
+	freeFloat(&factor);
+	return ok;
+}
+
+static bool erfcFloat(bigFloat* result, const bigFloat* value, long long int bits) {
+	// erfc(x) = 1 - erf(x), which loses about x^2 log2(e) bits for x > 0.  Once erfc(x) is below 2^-bits, the
+	// asymptotic series exp(-x^2) / (x sqrt(pi)) times the sum of (-1)^k (2k - 1)!! / (2x^2)^k is used instead, whose
+	// terms get smaller until k is about x^2
+	long long int work = bits + GUARD_BITS;
+	double x2 = 0.0;
+	bigFloat square, term, sum, factor;
+	bool ok = true;
+
+	if (value->undefined) {
+		setUndefined(result);
+		return true;
+	}
+	if (isZero(value)) return setSmall(result, 1);
+	initFloat(&square);
+	initFloat(&term);
+	initFloat(&sum);
+	initFloat(&factor);
+	ok = multiplyFloat(&square, value, value, EXACT_BITS) && setSmall(&sum, 1);
+	x2 = floatToDouble(&square);
+	if (ok && (isNegative(value) || x2 <= (work + 8) * LN_2)) {
+		ok = erfFloat(&term, value, work + (isNegative(value) ? 0 : (long long int)(x2 * LOG2_E) + 8))
+			&& addFloat(result, &sum, &term, bits, true);
+	}
+	else if (ok) {
+		ok = copyFloat(&term, &sum) && copyFloat(&factor, &square);
+		factor.exponent++;
+		for (long long int k = 1; ok; k++) {
+			ok = divideFloat(&term, &term, &factor, work) && setSmall(result, 2 * k - 1)
+				&& multiplyFloat(&term, &term, result, work);
+			term.mantissa.negative = !term.mantissa.negative;
+			ok = ok && addFloat(&sum, &sum, &term, work, false);
+			if (topBit(&term) < topBit(&sum) - work - 4) break;
+		}
+		square.mantissa.negative = true;
+		ok = ok && expFloat(&term, &square, work) && multiplyFloat(&sum, &sum, &term, work) && getPi(&factor, work)
+			&& squareRoot(&factor, &factor, work) && multiplyFloat(&factor, &factor, value, work)
+			&& divideFloat(result, &sum, &factor, bits);
+	}
+	freeFloat(&square);
+	freeFloat(&term);
+	freeFloat(&sum);
+	freeFloat(&factor);
+	return ok;
+}
+
+static bool findTangents(int count) {
+	// Tangent numbers T(1) to T(count), where tan x is the sum of T(k) x^(2k - 1) / (2k - 1)!:  T(k) starts as
+	// (k - 1)!, and then T(j) = (j - k) T(j - 1) + (j - k + 2) T(j) for every k from 2 and j from k
+	bigInteger* values = NULL;
+	bool ok = true;
+
+	if (count <= nrTangents) return true;
+	values = calloc(count + 1, sizeof(bigInteger));
+	if (values == NULL) return false;
+	ok = setBig(&values[1], 1);
+	for (int k = 2; k <= count && ok; k++) {
+		ok = copyBig(&values[k], &values[k - 1]) && multiplyBigSmall(&values[k], k - 1);
+	}
+	for (int k = 2; k <= count && ok; k++) {
+		for (int j = k; j <= count && ok; j++) {
+			ok = multiplyAddBigSmall(&values[j], j - k + 2, &values[j - 1], j - k);
+		}
+	}
+	for (int i = 0; i <= nrTangents && tangents != NULL; i++) freeBig(&tangents[i]);
+	free(tangents);
+	tangents = values;
+	nrTangents = ok ? count : 0;
+	return ok;
+}
+
+static bool shiftProduct(bigFloat* product, const bigFloat* value, long long int n, long long int bits) {
+	// product = x (x + 1) ... (x + n - 1) for x > 0.  Factors are taken in groups, as a polynomial in x whose
+	// coefficients are whole numbers found exactly, so that a group costs one product at full precision and a product of
+	// each power of x, found once, by a short coefficient.  About sqrt(bits / 64) factors a group balance the two
+	int group = 1 + (int)sqrt(bits / 64.0);
+	int factors = 0;
+	long long int next = 0;
+	bigInteger* coefficients = calloc(group + 1, sizeof(bigInteger));
+	bigFloat* powers = calloc(group + 1, sizeof(bigFloat));
+	bigFloat term, factor;
+	bool ok = coefficients != NULL && powers != NULL;
+
+	initFloat(&term);
+	initFloat(&factor);
+	for (int i = 0; ok && i <= group; i++) {
+		initBig(&coefficients[i]);
+		initFloat(&powers[i]);
+	}
+	ok = ok && setSmall(product, 1) && setSmall(&powers[0], 1);
+	for (int i = 1; i <= group && ok; i++) ok = multiplyFloat(&powers[i], &powers[i - 1], value, bits);
+	for (long long int k = 0; k < n && ok; k += group) {
+		factors = (n - k < group) ? (int)(n - k) : group;
+		ok = setBig(&coefficients[0], 1);
+		for (int i = 0; i < factors && ok; i++) {
+			// Multiplies the polynomial by x + k + i
+			next = k + i;
+			ok = copyBig(&coefficients[i + 1], &coefficients[i]);
+			for (int j = i; j > 0 && ok; j--) {
+				ok = multiplyBigSmall(&coefficients[j], (uint32_t)next) && addBig(&coefficients[j], &coefficients[j - 1], false);
+			}
+			ok = ok && multiplyBigSmall(&coefficients[0], (uint32_t)next);
+		}
+		ok = ok && copyFloat(&term, &powers[factors]);
+		for (int j = 0; j < factors && ok; j++) {
+			ok = setFloatInteger(&factor, &coefficients[j], EXACT_BITS) && multiplyFloat(&factor, &factor, &powers[j], bits)
+				&& addFloat(&term, &term, &factor, bits, false);
+		}
+		ok = ok && multiplyFloat(product, product, &term, bits);
+	}
+	freeFloat(&term);
+	freeFloat(&factor);
+	for (int i = 0; coefficients != NULL && powers != NULL && i <= group; i++) {
+		freeBig(&coefficients[i]);
+		freeFloat(&powers[i]);
+	}
+	free(coefficients);
+	free(powers);
+	return ok;
+}
+
+static bool stirling(bigFloat* logGamma, bigFloat* shift, const bigFloat* value, long long int bits) {
+	// For x >= 1/2, sets logGamma to log gamma(z) for z = x + n no smaller than bits, and shift to x (x + 1) ...
+	// (x + n - 1), so that gamma(x) = exp(logGamma) / shift.  log gamma(z) is (z - 1/2) log z - z + log(2 pi) / 2 plus
+	// the sum of B(2k) / (2k (2k - 1) z^(2k - 1)), where B(2k) = (-1)^(k - 1) 2k T(k) / (4^k (4^k - 1))
+	double estimate = floatToDouble(value);
+	long long int n = (estimate < bits) ? (long long int)ceil(bits - estimate) : 0;
+	long long int nrTerms = 0;
+	double logZ = log2(estimate + n);
+	double logTerm = 0.0;
+	long long int work = bits + 2 * bitsOf((long long int)(estimate + n)) + 8;
+	bigFloat z, term, power, inverse, coefficient, denominator;
+	bool ok = true;
+
+	initFloat(&z);
+	initFloat(&term);
+	initFloat(&power);
+	initFloat(&inverse);
+	initFloat(&coefficient);
+	initFloat(&denominator);
+	ok = shiftProduct(shift, value, n, bits + 2 * bitsOf(n) + 8);
+	for (nrTerms = 1; ; nrTerms++) {
+		logTerm = 1 + lgamma(2.0 * nrTerms + 1) * LOG2_E - 2 * nrTerms * log2(2 * pi)
+			- log2(2.0 * nrTerms * (2 * nrTerms - 1)) - (2 * nrTerms - 1) * logZ;
+		if (logTerm < -(double)work - 4) break;
+	}
+	ok = ok && findTangents((int)nrTerms) && setSmall(&z, n) && addFloat(&z, value, &z, EXACT_BITS, false)
+		&& logFloat(&term, &z, work) && setSmall(&power, 1);
+	power.exponent = -1;
+	ok = ok && addFloat(&power, &z, &power, EXACT_BITS, true) && multiplyFloat(logGamma, &term, &power, work)
+		&& addFloat(logGamma, logGamma, &z, work, true) && getPi(&term, work + 4);
+	term.exponent++;
+	ok = ok && logFloat(&term, &term, work);
+	term.exponent--;
+	ok = ok && addFloat(logGamma, logGamma, &term, work, false) && setSmall(&power, 1)
+		&& divideFloat(&inverse, &power, &z, work) && copyFloat(&power, &inverse)
+		&& multiplyFloat(&inverse, &inverse, &inverse, work);
+	for (long long int k = 1; k <= nrTerms && ok; k++) {
+		// T(k) / ((2k - 1) (4^k - 1) 4^k)
+		ok = setFloatInteger(&coefficient, &tangents[k], EXACT_BITS) && setSmall(&denominator, 1)
+			&& shiftBigLeft(&denominator.mantissa, 2 * k) && addBigSmall(&denominator.mantissa, -1)
+			&& multiplyBigSmall(&denominator.mantissa, (uint32_t)(2 * k - 1))
+			&& divideFloat(&coefficient, &coefficient, &denominator, work);
+		coefficient.exponent -= 2 * k;
+		if (k % 2 == 0) coefficient.mantissa.negative = true;
+		ok = ok && multiplyFloat(&term, &coefficient, &power, work) && addFloat(logGamma, logGamma, &term, work, false)
+			&& multiplyFloat(&power, &power, &inverse, work);
+	}
+	freeFloat(&z);
+	freeFloat(&term);
+	freeFloat(&power);
+	freeFloat(&inverse);
+	freeFloat(&coefficient);
+	freeFloat(&denominator);
+	return ok;
+}
+
+static bool exactGamma(const bigFloat* value, long long int bits) {
+	// Whether value is whole and >= 1, and (value - 1)! isn't too long to find exactly
+	if (!isInteger(value) || isNegative(value) || isZero(value) || topBit(value) > 40) return false;
+	return lgamma(floatToDouble(value)) * LOG2_E < EXACT_FACTORIAL + 4.0 * bits;
+}
+
+static bool factorialFloat(bigFloat* result, const bigFloat* value, long long int bits, bool* exact) {
+	// result = (value - 1)! for a whole value >= 1 whose factorial isn't too long to find exactly
+	long long int n = 0;
+	bigInteger integer;
+	bool ok = true;
+
+	*exact = false;
+	if (!exactGamma(value, bits)) return true;
+	initBig(&integer);
+	ok = toInteger(&integer, value, OP_TRUNC) && bigToInteger(&integer, &n);
+	if (ok) {
+		ok = setBig(&integer, n - 1) && applyBigUnary(OP_FACTORIAL, &integer)
+			&& setFloatInteger(result, &integer, bits);
+		*exact = ok;
+	}
+	freeBig(&integer);
+	return ok;
+}
+
+static bool gammaFloat(bigFloat* result, const bigFloat* value, long long int bits, bool logarithm) {
+	// result = gamma(value), or log |gamma(value)|.  Below 1/2, gamma(x) = pi / (sin(pi x) gamma(1 - x)), where sin(pi x)
+	// is found from x less its nearest whole number, so that no bits are lost when x is near one
+	long long int work = bits + GUARD_BITS;
+	double estimate = floatToDouble(value);
+	bool exact = false;
+	bigFloat logGamma, shift, piValue, fraction;
+	bigInteger n;
+	bool odd = false;
+	bool ok = true;
+
+	if (value->undefined || (isInteger(value) && (isNegative(value) || isZero(value)))) {
+		setUndefined(result);
+		return true;
+	}
+	ok = factorialFloat(result, value, work, &exact);
+	if (ok && exact) return !logarithm || logFloat(result, result, bits);
+	if (ok && !logarithm && estimate > 0 && (estimate - 0.5) * log2(estimate) > MAX_EXPONENT + 64) {
+		setUndefined(result);
+		return true;
+	}
+	if (ok && !logarithm && estimate < 0 && lgamma(1 - estimate) * LOG2_E > MAX_EXPONENT + 64) {
+		setZero(result);
+		return true;
+	}
+	if (ok && logarithm && fabs(estimate) > 1E15) {
+		setUndefined(result);
+		return true;
+	}
+	initFloat(&logGamma);
+	initFloat(&shift);
+	initFloat(&piValue);
+	initFloat(&fraction);
+	initBig(&n);
+	if (ok && estimate >= 0.5) {
+		ok = stirling(&logGamma, &shift, value, work);
+		if (logarithm) {
+			ok = ok && logFloat(&shift, &shift, work) && addFloat(result, &logGamma, &shift, bits, true);
+		}
+		else {
+			ok = ok && expFloat(&logGamma, &logGamma, work) && divideFloat(result, &logGamma, &shift, bits);
+		}
+	}
+	else if (ok) {
+		ok = toInteger(&n, value, OP_ROUND) && setFloatInteger(&fraction, &n, EXACT_BITS)
+			&& addFloat(&fraction, value, &fraction, EXACT_BITS, true) && getPi(&piValue, work + 4)
+			&& multiplyFloat(&fraction, &fraction, &piValue, work + 4) && sinCos(&fraction, NULL, &fraction, work + 4)
+			&& setSmall(&shift, 1) && addFloat(&shift, &shift, value, EXACT_BITS, true)
+			&& gammaFloat(&logGamma, &shift, work + 4, logarithm);
+		odd = n.length > 0 && (n.limbs[0] & 1);
+		if (odd) fraction.mantissa.negative = !fraction.mantissa.negative;
+		if (ok && logarithm) {
+			fraction.mantissa.negative = false;
+			ok = logFloat(&piValue, &piValue, work) && logFloat(&fraction, &fraction, work)
+				&& addFloat(&piValue, &piValue, &fraction, work, true) && addFloat(result, &piValue, &logGamma, bits, true);
+		}
+		else if (ok) {
+			ok = multiplyFloat(&fraction, &fraction, &logGamma, work + 4) && divideFloat(result, &piValue, &fraction, bits);
+		}
+	}
+	freeFloat(&logGamma);
+	freeFloat(&shift);
+	freeFloat(&piValue);
+	freeFloat(&fraction);
+	freeBig(&n);
+	return ok;
+}
+
+static bool powerFloat(bigFloat* result, const bigFloat* base, const bigFloat* power, long long int bits) {
+	// result = base^power.  Whole powers are found by squaring, exactly if the result isn't much longer than bits, and
+	// others as exp(power log(base)), with as many more bits as that has before the point
+	long long int scale = 0;
+	double logBase = 0.0;
+	double logResult = 0.0;
+	long long int n = 0;
+	long long int work = 0;
+	bigFloat square, product;
+	bigInteger exponent;
+	bool ok = true;
+
+	if (base->undefined || power->undefined || (isZero(base) && isNegative(power))) {
+		setUndefined(result);
+		return true;
+	}
+	if (isZero(power)) return setSmall(result, 1);
+	if (isZero(base)) return copyFloat(result, base);
+	logBase = log2(fabs(leadingBits(base, &scale))) + scale;
+	logResult = logBase * floatToDouble(power);
+	if (logResult > MAX_EXPONENT + 64 || (!isInteger(power) && isNegative(base))) {
+		setUndefined(result);
+		return true;
+	}
+	if (logResult < -MAX_EXPONENT - 64) {
+		setZero(result);
+		return true;
+	}
+	initFloat(&square);
+	initFloat(&product);
+	initBig(&exponent);
+	if (isInteger(power) && topBit(power) < 62) {
+		ok = toInteger(&exponent, power, OP_TRUNC) && bigToInteger(&exponent, &n);
+		n = (n < 0) ? -n : n;
+		if (ok && n * bigBitLength(&base->mantissa) <= 4 * bits + 64) {
+			exponent.negative = false;
+			product.exponent = base->exponent * n;
+			ok = copyBig(&product.mantissa, &base->mantissa) && applyBigBinary(OP_EXP, &product.mantissa, &exponent);
+		}
+		else if (ok) {
+			work = bits + 2 * bitsOf(n) + 8;
+			ok = copyFloat(&square, base) && setSmall(&product, 1);
+			for (long long int rest = n; rest > 0 && ok; rest >>= 1) {
+				if (rest & 1) ok = multiplyFloat(&product, &product, &square, work);
+				if (rest > 1) ok = ok && multiplyFloat(&square, &square, &square, work);
+			}
+		}
+		if (ok && isNegative(power)) {
+			ok = setSmall(&square, 1) && divideFloat(result, &square, &product, bits);
+		}
+		else if (ok) {
+			ok = roundFloat(&product, bits, false);
+			moveFloat(result, &product);
+		}
+	}
+	else {
+		work = bits + ((fabs(logResult) > 1) ? bitsOf((long long int)fabs(logResult)) : 0) + 8;
+		ok = logFloat(&square, base, work) && multiplyFloat(&square, &square, power, work)
+			&& expFloat(result, &square, bits);
+	}
+	freeFloat(&square);
+	freeFloat(&product);
+	freeBig(&exponent);
+	return ok;
+}
+
+static bool addSmall(bigFloat* result, long long int integer, const bigFloat* value, bool subtract) {
+	// result = integer + value, or integer - value, exactly
+	bigFloat number;
+	bool ok = true;
+
+	initFloat(&number);
+	ok = setSmall(&number, integer) && addFloat(result, &number, value, EXACT_BITS, subtract);
+	freeFloat(&number);
+	return ok;
+}
+
+static long long int guardBits(const bigFloat* value) {
+	// Bits lost to cancellation by functions such as sinh and atanh near zero, which start like their argument
+	return (isZero(value) || topBit(value) >= 0) ? 4 : 4 - topBit(value);
+}
+
+static bool evaluateHyperbolic(unsigned int operand, bigFloat* result, const bigFloat* value, long long int bits) {
+	// sinh, cosh and tanh from exp, and their inverses from log
+	long long int work = bits + guardBits(value);
+	bool negative = isNegative(value);
+	bigFloat power, inverse, magnitude;
+	bool ok = true;
+
+	initFloat(&power);
+	initFloat(&inverse);
+	initFloat(&magnitude);
+	ok = copyFloat(&magnitude, value);
+	magnitude.mantissa.negative = false;
+	switch (operand) {
+	case OP_SINH:
+	case OP_COSH:
+		ok = ok && expFloat(&power, value, work) && setSmall(&inverse, 1) && divideFloat(&inverse, &inverse, &power, work)
+			&& addFloat(result, &power, &inverse, bits, operand == OP_SINH);
+		result->exponent--;
+		break;
+	case OP_TANH:
+		// 1 - 2 / (exp(2x) + 1), which is 1 to any precision once exp(2x) is too large to keep
+		if (floatToDouble(&magnitude) > (work + 8) * LN_2 / 2) {
+			ok = ok && setSmall(result, 1) && shiftBigLeft(&result->mantissa, work + 8) && addBigSmall(&result->mantissa, -1);
+			result->exponent = -(work + 8);
+		}
+		else {
+			magnitude.exponent++;
+			ok = ok && expFloat(&power, &magnitude, work) && addSmall(&inverse, 1, &power, false)
+				&& addSmall(&power, -1, &power, false) && divideFloat(result, &power, &inverse, bits);
+		}
+		if (negative) result->mantissa.negative = true;
+		break;
+	case OP_ASINH:
+		// log(|x| + sqrt(x^2 + 1))
+		ok = ok && multiplyFloat(&power, value, value, EXACT_BITS) && addSmall(&power, 1, &power, false)
+			&& squareRoot(&power, &power, work) && addFloat(&power, &power, &magnitude, work, false)
+			&& logFloat(result, &power, bits);
+		if (negative) result->mantissa.negative = true;
+		break;
+	case OP_ACOSH:
+		// log(x + sqrt(x^2 - 1)), which loses bits as x gets near 1
+		ok = ok && addSmall(&power, 1, value, true);
+		if (ok && !isZero(&power) && !isNegative(&power)) {
+			setUndefined(result);
+			break;
+		}
+		work = bits + guardBits(&power);
+		ok = ok && multiplyFloat(&power, value, value, EXACT_BITS) && addSmall(&power, -1, &power, false)
+			&& squareRoot(&power, &power, work) && addFloat(&power, &power, value, work, false)
+			&& logFloat(result, &power, bits);
+		break;
+	case OP_ATANH:
+		// log((1 + x) / (1 - x)) / 2
+		ok = ok && addSmall(&power, 1, value, false) && addSmall(&inverse, 1, value, true)
+			&& divideFloat(&power, &power, &inverse, work) && logFloat(result, &power, bits);
+		result->exponent--;
+		break;
+	}
+	freeFloat(&power);
+	freeFloat(&inverse);
+	freeFloat(&magnitude);
+	return ok;
+}
+
+static bool evaluate(unsigned int operand, bigFloat* result, const bigFloat* left, const bigFloat* right,
+	long long int bits);
+
+static bool evaluateInverse(unsigned int operand, bigFloat* result, const bigFloat* value, long long int bits) {
+	// An inverse function of 1 / value, as asec(x) is acos(1 / x)
+	bigFloat inverse;
+	bool ok = true;
+
+	initFloat(&inverse);
+	ok = setSmall(&inverse, 1) && divideFloat(&inverse, &inverse, value, bits + 8)
+		&& evaluate(operand, result, &inverse, NULL, bits);
+	freeFloat(&inverse);
+	return ok;
+}
+
+static bool evaluate(unsigned int operand, bigFloat* result, const bigFloat* left, const bigFloat* right,
+	long long int bits) {
+	// result = an operator applied to left and right, or to left alone, to about bits bits.  OP_NULL is exp, which has no
+	// operator of its own
+	bigFloat a, b;
+	bool ok = true;
+
+	if (left->undefined || (right != NULL && right->undefined)) {
+		setUndefined(result);
+		return true;
+	}
+	initFloat(&a);
+	initFloat(&b);
+	switch (operand) {
+	case OP_NULL:
+		ok = expFloat(result, left, bits);
+		break;
+	case OP_LN:
+		ok = logFloat(result, left, bits);
+		break;
+	case OP_SIN:
+		ok = sinCos(result, NULL, left, bits);
+		break;
+	case OP_COS:
+		ok = sinCos(NULL, result, left, bits);
+		break;
+	case OP_ATAN:
+		ok = atanFloat(result, left, bits);
+		break;
+	case OP_ERF:
+		ok = erfFloat(result, left, bits);
+		break;
+	case OP_ERFC:
+		ok = erfcFloat(result, left, bits);
+		break;
+	case OP_GAMMA:
+	case OP_LGAMMA:
+		ok = gammaFloat(result, left, bits, operand == OP_LGAMMA);
+		break;
+	case OP_EXP:
+		ok = powerFloat(result, left, right, bits);
+		break;
+	case OP_LOG:
+		ok = logFloat(&a, right, bits + 8) && logFloat(&b, left, bits + 8) && divideFloat(result, &a, &b, bits);
+		break;
+	case OP_ROOT:
+		ok = setSmall(&a, 1) && divideFloat(&a, &a, left, bits + 8) && powerFloat(result, right, &a, bits);
+		break;
+	case OP_ATAN2:
+		// atan(y / x), moved by pi to the half plane of x
+		if (isZero(right)) {
+			ok = getPi(result, bits);
+			result->exponent--;
+			result->mantissa.negative = isNegative(left);
+			if (isZero(left)) setZero(result);
+			break;
+		}
+		ok = divideFloat(&a, left, right, bits + 8) && atanFloat(result, &a, bits + 8);
+		if (ok && isNegative(right)) {
+			ok = getPi(&b, bits + 8);
+			b.mantissa.negative = isNegative(left);
+			ok = ok && addFloat(result, result, &b, bits, false);
+		}
+		break;
+	case OP_LOG2:
+	case OP_LOG10:
+		ok = logFloat(&a, left, bits + 8) && ((operand == OP_LOG2) ? getLn2(&b, bits + 8) : setSmall(&b, 10)
+			&& logFloat(&b, &b, bits + 8)) && divideFloat(result, &a, &b, bits);
+		break;
+	case OP_CBRT:
+		ok = copyFloat(&a, left);
+		a.mantissa.negative = false;
+		ok = ok && (isZero(left) || (logFloat(&a, &a, bits + 8) && setSmall(&b, 3) && divideFloat(&a, &a, &b, bits + 8)
+			&& expFloat(&a, &a, bits))) && copyFloat(result, &a);
+		result->mantissa.negative = isNegative(left);
+		break;
+	case OP_TAN:
+	case OP_SEC:
+	case OP_CSC:
+	case OP_COT:
+		ok = sinCos(&a, &b, left, bits + 4) && setSmall(result, 1);
+		if (operand == OP_TAN) ok = ok && divideFloat(result, &a, &b, bits);
+		if (operand == OP_SEC) ok = ok && divideFloat(result, result, &b, bits);
+		if (operand == OP_CSC) ok = ok && divideFloat(result, result, &a, bits);
+		if (operand == OP_COT) ok = ok && divideFloat(result, &b, &a, bits);
+		break;
+	case OP_ASIN:
+	case OP_ACOS:
+		// atan(x / sqrt((1 - x)(1 + x))) and 2 atan(sqrt((1 - x) / (1 + x))), both of which are exact at the ends
+		ok = addSmall(&a, 1, left, true) && addSmall(&b, 1, left, false);
+		if (ok && (isNegative(&a) || isNegative(&b))) {
+			setUndefined(result);
+		}
+		else if (ok && operand == OP_ASIN && (isZero(&a) || isZero(&b))) {
+			ok = getPi(result, bits);
+			result->exponent--;
+			result->mantissa.negative = isZero(&b);
+		}
+		else if (ok && operand == OP_ASIN) {
+			ok = multiplyFloat(&a, &a, &b, EXACT_BITS) && squareRoot(&a, &a, bits + 8)
+				&& divideFloat(&a, left, &a, bits + 8) && atanFloat(result, &a, bits);
+		}
+		else if (ok && isZero(&b)) {
+			ok = getPi(result, bits);
+		}
+		else if (ok) {
+			ok = divideFloat(&a, &a, &b, bits + 8) && squareRoot(&a, &a, bits + 8) && atanFloat(result, &a, bits);
+			result->exponent++;
+		}
+		break;
+	case OP_ASEC:
+	case OP_ACSC:
+		ok = evaluateInverse((operand == OP_ASEC) ? OP_ACOS : OP_ASIN, result, left, bits);
+		break;
+	case OP_ACOT:
+		// atan(1 / x), plus pi for x < 0
+		if (isZero(left)) {
+			ok = getPi(result, bits);
+			result->exponent--;
+			break;
+		}
+		ok = evaluateInverse(OP_ATAN, result, left, bits + 4);
+		if (ok && isNegative(left)) ok = getPi(&a, bits + 4) && addFloat(result, result, &a, bits, false);
+		break;
+	case OP_SINH:
+	case OP_COSH:
+	case OP_TANH:
+	case OP_ASINH:
+	case OP_ACOSH:
+	case OP_ATANH:
+		ok = evaluateHyperbolic(operand, result, left, bits);
+		break;
+	case OP_SECH:
+	case OP_CSCH:
+	case OP_COTH:
+		if (operand == OP_SECH) ok = evaluateHyperbolic(OP_COSH, &a, left, bits + 4);
+		if (operand == OP_CSCH) ok = ok && evaluateHyperbolic(OP_SINH, &a, left, bits + 4);
+		if (operand == OP_COTH) ok = ok && evaluateHyperbolic(OP_TANH, &a, left, bits + 4);
+		ok = ok && setSmall(&b, 1) && divideFloat(result, &b, &a, bits);
+		break;
+	case OP_ASECH:
+	case OP_ACSCH:
+	case OP_ACOTH:
+		ok = evaluateInverse((operand == OP_ASECH) ? OP_ACOSH : (operand == OP_ACSCH) ? OP_ASINH : OP_ATANH, result, left,
+			bits);
+		break;
+	case OP_SINC:
+		ok = isZero(left) ? setSmall(result, 1)
+			: sinCos(&a, NULL, left, bits + 4) && divideFloat(result, &a, left, bits);
+		break;
+	case OP_NSINC:
+		// sin(pi x) / (pi x), with sin(pi x) from x less its nearest whole number n, as (-1)^n sin(pi (x - n))
+		if (isZero(left)) {
+			ok = setSmall(result, 1);
+			break;
+		}
+		{
+			bigInteger n;
+			initBig(&n);
+			ok = toInteger(&n, left, OP_ROUND) && setFloatInteger(&a, &n, EXACT_BITS)
+				&& addFloat(&a, left, &a, EXACT_BITS, true) && getPi(&b, bits + 8)
+				&& multiplyFloat(&a, &a, &b, bits + 8) && sinCos(&a, NULL, &a, bits + 8)
+				&& multiplyFloat(&b, &b, left, bits + 8) && divideFloat(result, &a, &b, bits);
+			if (n.length > 0 && (n.limbs[0] & 1)) result->mantissa.negative = !result->mantissa.negative && !isZero(result);
+			freeBig(&n);
+		}
+		break;
+	case OP_DEG:
+	case OP_RAD:
+		ok = getPi(&a, bits + 4) && setSmall(&b, 180);
+		if (operand == OP_DEG) {
+			ok = ok && multiplyFloat(&b, &b, left, EXACT_BITS) && divideFloat(result, &b, &a, bits);
+		}
+		else {
+			ok = ok && multiplyFloat(&a, &a, left, bits + 4) && divideFloat(result, &a, &b, bits);
+		}
+		break;
+	default:
+		setUndefined(result);
+		break;
+	}
+	freeFloat(&a);
+	freeFloat(&b);
+	return ok;
+}
+
+static bool isProven(unsigned int operand) {
+	// Functions with a proven bound on their error, which is 2^ERROR_BITS units of their last bit
+	switch (operand) {
+	case OP_NULL:
+	case OP_LN:
+	case OP_SIN:
+	case OP_COS:
+	case OP_ATAN:
+	case OP_ERF:
+	case OP_ERFC:
+	case OP_GAMMA:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool roundsTo(bigFloat* rounded, const bigFloat* approximation, long long int error, long long int bits,
+	bool* settled) {
+	// Sets rounded to approximation rounded to bits bits, and settled to whether everything within 2^error of it rounds
+	// the same way
+	bigFloat bound, low, high;
+	bool ok = true;
+
+	initFloat(&bound);
+	initFloat(&low);
+	initFloat(&high);
+	ok = setSmall(&bound, 1);
+	bound.exponent = error;
+	ok = ok && addFloat(&low, approximation, &bound, bits, true) && addFloat(&high, approximation, &bound, bits, false)
+		&& copyFloat(rounded, approximation) && roundFloat(rounded, bits, false);
+	*settled = ok && sameFloat(&low, &high);
+	freeFloat(&bound);
+	freeFloat(&low);
+	freeFloat(&high);
+	return ok;
+}
+
+static bool roundFunction(unsigned int operand, bigFloat* result, const bigFloat* left, const bigFloat* right,
+	long long int bits) {
+	// result = an operator applied to its operands, correctly rounded to bits bits unless it is closer than 2^-(4 bits)
+	// to halfway between two values of that many bits.  The error of an operator without a proven bound is taken to be
+	// the difference from the approximation before, which had half as many more bits
+	long long int limit = 4 * bits + 256;
+	long long int error = 0;
+	bool proven = isProven(operand);
+	bool first = true;
+	bool settled = false;
+	bigFloat approximation, previous, difference;
+	bool ok = true;
+
+	if ((operand == OP_GAMMA || operand == OP_LGAMMA) && bits > precisionBits(MAX_GAMMA_DIGITS) && !exactGamma(left, bits)) {
+		setUndefined(result);
+		return true;
+	}
+	initFloat(&approximation);
+	initFloat(&previous);
+	initFloat(&difference);
+	for (long long int extra = FIRST_EXTRA; ok && !settled; extra *= 2) {
+		ok = evaluate(operand, &approximation, left, right, bits + extra);
+		if (!ok) break;
+		if (approximation.undefined || isZero(&approximation)) {
+			ok = copyFloat(result, &approximation);
+			break;
+		}
+		error = topBit(&approximation) - (bits + extra) + ERROR_BITS;
+		if (!proven && !first) {
+			ok = addFloat(&difference, &approximation, &previous, EXACT_BITS, true);
+			if (ok && !isZero(&difference) && topBit(&difference) + 1 > error) error = topBit(&difference) + 1;
+		}
+		if (proven || !first) ok = ok && roundsTo(result, &approximation, error, bits, &settled);
+		settled = settled || (!first && extra >= limit);
+		if (settled && ok && extra >= limit) ok = copyFloat(result, &approximation) && roundFloat(result, bits, false);
+		first = false;
+		ok = ok && copyFloat(&previous, &approximation);
+	}
+	freeFloat(&approximation);
+	freeFloat(&previous);
+	freeFloat(&difference);
+	return ok;
+}
+
+static bool setConstant(bigFloat* value, int constant, long long int bits) {
+	// pi, e or the golden ratio, to about bits bits
+	bigFloat one;
+	bool ok = true;
+
+	initFloat(&one);
+	ok = setSmall(&one, 1);
+	if (constant == 0) ok = ok && getPi(value, bits);
+	if (constant == 1) ok = ok && expFloat(value, &one, bits);
+	if (constant == 2) {
+		ok = ok && setSmall(value, 5) && squareRoot(value, value, bits) && addFloat(value, value, &one, bits, false);
+		value->exponent--;
+	}
+	freeFloat(&one);
+	return ok;
+}
+
+// Sets a float to a constant of defaultvars.txt that is found to any precision: pi, e, pythag (the square root of 2) and
+// gold, correctly rounded to bits bits.  Returns false for other names, which keep the value of the file
+bool setFloatConstant(bigFloat* value, const char name[], long long int bits) {
+
+	static const char* names[] = { "pi", "e", "gold" };
+	static bigFloat cached[3];
+	static long long int cachedBits[3];
+	bool settled = false;
+	bigFloat approximation;
+	bool ok = true;
+
+	if (strcmp(name, "pythag") == 0) return setSmall(value, 2) && squareRoot(value, value, bits);
+	for (int i = 0; i < 3; i++) {
+		if (strcmp(name, names[i]) != 0) continue;
+		if (cachedBits[i] == bits) return copyFloat(value, &cached[i]);
+		initFloat(&approximation);
+		for (long long int extra = FIRST_EXTRA; ok && !settled; extra *= 2) {
+			ok = setConstant(&approximation, i, bits + extra)
+				&& roundsTo(value, &approximation, topBit(&approximation) - (bits + extra) + ERROR_BITS, bits, &settled);
+		}
+		freeFloat(&approximation);
+		cachedBits[i] = (ok && copyFloat(&cached[i], value)) ? bits : 0;
+		return ok;
+	}
+	return false;
+}
+
+// Sets a float to a number written in decimal, with an optional point and exponent, as in 12.5E-3, correctly rounded
+// to bits bits.  Returns false if there is no memory
+bool setFloatText(bigFloat* value, const char text[], long long int bits) {
+
+	bigInteger digits, power;
+	bigFloat numerator, denominator;
+	long long int exponent = 0;
+	long long int written = 0;
+	uint32_t chunk = 0;
+	uint32_t chunkScale = 1;
+	bool afterPoint = false;
+	bool ok = true;
+	const char* c = text;
+
+	initBig(&digits);
+	initBig(&power);
+	initFloat(&numerator);
+	initFloat(&denominator);
+	// Digits are taken 9 at a time, so that the number is multiplied by 10^9 at once
+	for (; ok && ((*c >= '0' && *c <= '9') || *c == '.'); c++) {
+		if (*c == '.') {
+			afterPoint = true;
+			continue;
+		}
+		chunk = chunk * 10 + (*c - '0');
+		chunkScale *= 10;
+		if (afterPoint) exponent--;
+		if (chunkScale == 1000000000) {
+			ok = multiplyBigSmall(&digits, chunkScale) && addBigSmall(&digits, chunk);
+			chunk = 0;
+			chunkScale = 1;
+		}
+	}
+	ok = ok && multiplyBigSmall(&digits, chunkScale) && addBigSmall(&digits, chunk);
+	if (*c == 'e' || *c == 'E') {
+		// Exponents far out of range are cut, so that adding them can't overflow
+		written = strtoll(c + 1, NULL, 10);
+		exponent += (written > EXACT_BITS) ? EXACT_BITS : (written < -EXACT_BITS) ? -EXACT_BITS : written;
+	}
+	value->undefined = false;
+	value->exponent = 0;
+	if (ok && digits.length == 0) {
+		setZero(value);
+	}
+	else if (ok && exponent + bigBitLength(&digits) * 0.30103 > MAX_EXPONENT * 0.30103 + 1) {
+		setUndefined(value);
+	}
+	else if (ok && exponent + bigBitLength(&digits) * 0.30103 < -MAX_EXPONENT * 0.30103 - 1) {
+		setZero(value);
+	}
+	else if (ok) {
+		ok = setBig(&power, 10) && setFloatInteger(&numerator, &digits, EXACT_BITS)
+			&& setBig(&digits, (exponent < 0) ? -exponent : exponent) && applyBigBinary(OP_EXP, &power, &digits)
+			&& setFloatInteger(&denominator, &power, EXACT_BITS);
+		if (ok && exponent >= 0) {
+			ok = multiplyFloat(value, &numerator, &denominator, bits);
+		}
+		else if (ok) {
+			ok = divideFloat(value, &numerator, &denominator, bits);
+		}
+		limitRange(value);
+	}
+	freeBig(&digits);
+	freeBig(&power);
+	freeFloat(&numerator);
+	freeFloat(&denominator);
+	return ok;
+}
+
+static bool scaledDigits(bigInteger* digits, const bigFloat* value, long long int power) {
+	// digits = |value| 10^power rounded to a whole number, to nearest and ties to even
+	bigInteger numerator, denominator, remainder, ten;
+	bool ok = true;
+
+	initBig(&numerator);
+	initBig(&denominator);
+	initBig(&remainder);
+	initBig(&ten);
+	ok = copyBig(&numerator, &value->mantissa) && setBig(&denominator, 1) && setBig(&ten, 10)
+		&& setBig(&remainder, (power < 0) ? -power : power) && applyBigBinary(OP_EXP, &ten, &remainder);
+	numerator.negative = false;
+	if (ok && power >= 0) ok = multiplyBig(&numerator, &numerator, &ten);
+	if (ok && power < 0) ok = multiplyBig(&denominator, &denominator, &ten);
+	if (ok && value->exponent >= 0) ok = shiftBigLeft(&numerator, value->exponent);
+	if (ok && value->exponent < 0) ok = shiftBigLeft(&denominator, -value->exponent);
+	ok = ok && divideFloor(digits, &remainder, &numerator, &denominator) && shiftBigLeft(&remainder, 1);
+	if (ok) {
+		int order = compareBig(&remainder, &denominator);
+		if (order > 0 || (order == 0 && digits->length > 0 && (digits->limbs[0] & 1))) ok = addBigSmall(digits, 1);
+	}
+	freeBig(&numerator);
+	freeBig(&denominator);
+	freeBig(&remainder);
+	freeBig(&ten);
+	return ok;
+}
+
+// Returns text of a float rounded to a number of significant digits, which is allocated and must be freed, or NULL if
+// there is no memory.  Values are written in scientific notation with every digit if scientific is set, as d.dddE+NN,
+// and otherwise with a point as %g writes them, leaving out zeros at the end
+char* floatToString(const bigFloat* value, int digits, bool scientific) {
+
+	long long int scale = 0;
+	double leading = 0.0;
+	long long int exponent = 0;
+	long long int length = 0;
+	long long int point = 0;
+	bigInteger rounded;
+	char* text = NULL;
+	char* result = NULL;
+	char* out = NULL;
+	bool ok = true;
+
+	if (value->undefined || isZero(value)) {
+		result = malloc(4);
+		if (result != NULL) strcpy(result, value->undefined ? "nan" : "0");
+		return result;
+	}
+	leading = leadingBits(value, &scale);
+	exponent = (long long int)floor(log10(fabs(leading)) + scale * 0.30102999566398119521);
+	initBig(&rounded);
+	// The estimate of the exponent may be one off either way.  A value just below a power of 10 may round up to it with
+	// either the exponent below it or the one above, and the one below is right unless it gives another digit
+	for (int attempt = 0; attempt < 4 && ok; attempt++) {
+		ok = scaledDigits(&rounded, value, digits - 1 - exponent);
+		free(text);
+		text = ok ? bigToString(&rounded) : NULL;
+		ok = text != NULL;
+		if (!ok) break;
+		length = (long long int)strlen(text);
+		if (length == digits && (attempt > 0 || text[0] != '1' || strspn(&text[1], "0") != (size_t)length - 1)) break;
+		exponent += (length > digits) ? 1 : -1;
+	}
+	freeBig(&rounded);
+	if (!ok) return NULL;
+	if (length > digits) {
+		text[digits] = '\0';
+		length = digits;
+	}
+	if (!scientific) {
+		while (length > 1 && text[length - 1] == '0') text[--length] = '\0';
+	}
+	result = malloc(length + digits + 32);
+	if (result == NULL) {
+		free(text);
+		return NULL;
+	}
+	out = result;
+	if (isNegative(value)) *out++ = '-';
+	if (!scientific && exponent >= -5 && exponent < digits) {
+		if (exponent < 0) {
+			out += sprintf(out, "0.");
+			for (long long int i = 1; i < -exponent; i++) *out++ = '0';
+			strcpy(out, text);
+		}
+		else {
+			point = exponent + 1;
+			for (long long int i = 0; i < point; i++) *out++ = (i < length) ? text[i] : '0';
+			if (length > point) out += sprintf(out, ".%s", &text[point]);
+			*out = '\0';
+		}
+	}
+	else {
+		*out++ = text[0];
+		if (length > 1) out += sprintf(out, ".%s", &text[1]);
+		sprintf(out, "E%c%02lld", (exponent < 0) ? '-' : '+', (exponent < 0) ? -exponent : exponent);
+	}
+	free(text);
+	return result;
+}
+
+// Whether an operator acts on floats of any precision.  Operators on arrays and matrices, and random draws, don't
+bool isFloatOperator(unsigned int operand) {
+
+	return operand >= OP_ADD && operand <= OP_LGAMMA && operand != OP_MATMUL
+		&& (operand < OP_UNIFORM || operand > OP_LOGNORMAL);
+}
+
+static bool isTrue(const bigFloat* value) {
+	return value->undefined || !isZero(value);
+}
+
+static bool setTruth(bigFloat* value, bool truth) {
+	return setSmall(value, truth ? 1 : 0);
+}
+
+static bool isE(const bigFloat* value, long long int bits) {
+	// Whether a value is e rounded to bits bits, as e^x is then exp(x)
+	bigFloat e;
+	bool same = false;
+
+	if (value->undefined || isNegative(value) || isZero(value) || topBit(value) != 2) return false;
+	initFloat(&e);
+	same = setFloatConstant(&e, "e", bits) && sameFloat(&e, value);
+	freeFloat(&e);
+	return same;
+}
+
+static bool applyDiscrete(unsigned int operand, bigFloat* left, const bigFloat* right, long long int bits) {
+	// Operators on whole numbers, which act on the operands rounded half away from zero as doubles do for div, mod, gcd and
+	// lcm, and are undefined for operands that aren't whole for the others, and for results that are too large
+	bigInteger a, b;
+	bool rounds = operand == OP_DIV_INT || operand == OP_MOD || operand == OP_GCD || operand == OP_LCM;
+	bool ok = true;
+
+	if (!rounds && (!isInteger(left) || (right != NULL && !isInteger(right)))) {
+		setUndefined(left);
+		return true;
+	}
+	initBig(&a);
+	initBig(&b);
+	ok = toInteger(&a, left, OP_ROUND) && (right == NULL || toInteger(&b, right, OP_ROUND));
+	if (ok && (right != NULL ? applyBigBinary(operand, &a, &b) : applyBigUnary(operand, &a))) {
+		ok = setFloatInteger(left, &a, bits);
+	}
+	else if (ok) {
+		setUndefined(left);
+	}
+	freeBig(&a);
+	freeBig(&b);
+	return ok;
+}
+
+// left = an operator applied to left and right, rounded to bits bits.  Results that are undefined, or too large to keep,
+// are undefined, as doubles are NaN.  Returns false if there is no memory
+bool applyFloatBinary(unsigned int operand, bigFloat* left, const bigFloat* right, long long int bits) {
+
+	bigFloat a, b;
+	int order = 0;
+	bool ok = true;
+
+	if (operand >= OP_IS && operand <= OP_LESS_THAN_EQUAL_TO) {
+		if (left->undefined || right->undefined) return setTruth(left, false);
+		order = compareFloat(left, right);
+		switch (operand) {
+		case OP_IS:
+			return setTruth(left, order == 0);
+		case OP_GREATER_THAN:
+			return setTruth(left, order > 0);
+		case OP_LESS_THAN:
+			return setTruth(left, order < 0);
+		case OP_GREATER_THAN_EQUAL_TO:
+			return setTruth(left, order >= 0);
+		default:
+			return setTruth(left, order <= 0);
+		}
+	}
+	switch (operand) {
+	case OP_AND:
+		return setTruth(left, isTrue(left) && isTrue(right));
+	case OP_OR:
+		return setTruth(left, isTrue(left) || isTrue(right));
+	case OP_XOR:
+		return setTruth(left, isTrue(left) != isTrue(right));
+	case OP_IMPLIES:
+		return setTruth(left, !isTrue(left) || isTrue(right));
+	case OP_IFF:
+		return setTruth(left, isTrue(left) == isTrue(right));
+	case OP_IMPLIED_BY:
+		return setTruth(left, isTrue(left) && !isTrue(right));
+	default:
+		break;
+	}
+	if (left->undefined || right->undefined) {
+		setUndefined(left);
+		return true;
+	}
+	initFloat(&a);
+	initFloat(&b);
+	switch (operand) {
+	case OP_ADD:
+	case OP_SUB:
+		ok = addFloat(left, left, right, bits, operand == OP_SUB);
+		break;
+	case OP_MUL:
+		ok = multiplyFloat(left, left, right, bits);
+		break;
+	case OP_DIV:
+		ok = divideFloat(left, left, right, bits);
+		break;
+	case OP_HYPOT:
+		ok = multiplyFloat(&a, left, left, EXACT_BITS) && multiplyFloat(&b, right, right, EXACT_BITS)
+			&& addFloat(&a, &a, &b, EXACT_BITS, false) && squareRoot(left, &a, bits);
+		break;
+	case OP_REQLL:
+		// lr / (l + r), with both exact before the one rounding
+		ok = multiplyFloat(&a, left, right, EXACT_BITS) && addFloat(&b, left, right, EXACT_BITS, false)
+			&& divideFloat(left, &a, &b, bits);
+		break;
+	case OP_PERR:
+		// 100 |l - r| / r
+		ok = addFloat(&a, left, right, EXACT_BITS, true) && setSmall(&b, 100) && multiplyFloat(&a, &a, &b, EXACT_BITS);
+		a.mantissa.negative = false;
+		ok = ok && divideFloat(left, &a, right, bits);
+		break;
+	case OP_DIV_INT:
+	case OP_MOD:
+	case OP_GCD:
+	case OP_LCM:
+	case OP_NCR:
+	case OP_NPR:
+	case OP_LEFT_SHIFT:
+	case OP_RIGHT_SHIFT:
+	case OP_BITWISE_AND:
+	case OP_BITWISE_OR:
+	case OP_BITWISE_XOR:
+		ok = applyDiscrete(operand, left, right, bits);
+		break;
+	case OP_EXP:
+		if (isE(left, bits)) {
+			ok = copyFloat(&a, right) && roundFunction(OP_NULL, left, &a, NULL, bits);
+		}
+		else {
+			ok = copyFloat(&a, left) && roundFunction(OP_EXP, left, &a, right, bits);
+		}
+		break;
+	default:
+		ok = copyFloat(&a, left) && roundFunction(operand, left, &a, right, bits);
+		break;
+	}
+	limitRange(left);
+	freeFloat(&a);
+	freeFloat(&b);
+	return ok;
+}
+
+// value = an operator applied to value, rounded to bits bits.  Returns false if there is no memory
+bool applyFloatUnary(unsigned int operand, bigFloat* value, long long int bits) {
+
+	bigFloat a;
+	bigInteger integer;
+	bool ok = true;
+
+	if (operand == OP_NOT) return setTruth(value, !isTrue(value));
+	if (value->undefined) return true;
+	initFloat(&a);
+	initBig(&integer);
+	switch (operand) {
+	case OP_NEG:
+		value->mantissa.negative = !value->mantissa.negative && !isZero(value);
+		ok = roundFloat(value, bits, false);
+		break;
+	case OP_ABS:
+		value->mantissa.negative = false;
+		ok = roundFloat(value, bits, false);
+		break;
+	case OP_SIGN:
+		ok = setSmall(value, isNegative(value) ? -1 : 1);
+		break;
+	case OP_CEIL:
+	case OP_FLOOR:
+	case OP_ROUND:
+	case OP_TRUNC:
+		ok = toInteger(&integer, value, operand) && setFloatInteger(value, &integer, bits);
+		break;
+	case OP_SQRT:
+		ok = squareRoot(value, value, bits);
+		break;
+	case OP_BITWISE_NOT:
+		ok = applyDiscrete(operand, value, NULL, bits);
+		break;
+	case OP_FACTORIAL:
+		// Exact for whole numbers, as long as the result can be kept, and gamma(x + 1) otherwise
+		if (isInteger(value) && isNegative(value)) {
+			setUndefined(value);
+		}
+		else if (isInteger(value) && toInteger(&integer, value, OP_TRUNC) && applyBigUnary(OP_FACTORIAL, &integer)) {
+			ok = setFloatInteger(value, &integer, bits);
+		}
+		else {
+			ok = addSmall(&a, 1, value, false) && roundFunction(OP_GAMMA, value, &a, NULL, bits);
+		}
+		break;
+	default:
+		ok = copyFloat(&a, value) && roundFunction(operand, value, &a, NULL, bits);
+		break;
+	}
+	limitRange(value);
+	freeFloat(&a);
+	freeBig(&integer);
+	return ok;
+}
\ No newline at end of file
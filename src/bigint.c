@@ -0,0 +1,1182 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "bigint.h"
+
+// Integers of any size, for statements on integers whose values don't fit in 64 bits.  Magnitudes are arrays of 32-bit
+// limbs, so that the product of two limbs fits in 64 bits.  Long products use Karatsuba's method, which splits each
+// factor in two halves and needs three products of halves rather than four, and the longest ones number theoretic
+// transforms, which find the product of the 16-bit pieces of both factors as a convolution modulo two primes.  n! is
+// found from the swinging factorial, as n! = (n/2)!^2 * swing(n), where swing(n) is a product of prime powers no larger
+// than n, and nCr and nPr from the exponent of every prime in them.  Both are then products of many small factors,
+// which are multiplied in a balanced tree, so that the long products are of numbers of about the same size, where the
+// faster methods pay off
+#define KARATSUBA_THRESHOLD 32  // Limbs below which products are done limb by limb
+#define TRANSFORM_THRESHOLD 8192  // Limbs from which products of about equal lengths use number theoretic transforms
+#define TRANSFORM_MAX_LENGTH (1 << 23)  // Longest transform, bounded by the powers of 2 dividing p - 1 for the primes
+#define TRANSFORM_GENERATOR 3   // Primitive root of both primes
+#define MAX_LIMBS (1 << 17)     // Largest integer kept, of about 1.2 million digits.  Larger results are left to doubles
+#define SIEVE_LIMIT (1 << 26)   // Largest n of nCr and nPr found from the exponents of primes, which needs a table of n bytes
+#define PRODUCT_LEAVES 16       // Factors multiplied one at a time at the leaves of a product tree
+#define CHUNK_BASE 1000000000u  // Nine decimal digits, the largest power of 10 in a limb
+
+// A prime for number theoretic transforms, with the constants of its Montgomery form, in which x is kept as x 2^32 mod p
+typedef struct {
+	uint32_t modulus;
+	uint32_t negativeInverse;   // -1 / p mod 2^32
+	uint32_t montgomeryOne;     // 2^32 mod p
+	uint32_t montgomerySquare;  // 2^64 mod p
+} transformPrime;
+
+static const transformPrime transformPrimes[2] = {
+	{ 998244353u, 998244351u, 301989884u, 932051910u },
+	{ 469762049u, 469762047u, 67108855u, 460175152u }
+};
+
+typedef struct {
+	uint64_t* values;
+	int count;
+	int capacity;
+	uint64_t pending;  // Product of the factors added since the last entry, kept below 2^32
+} factorList;
+
+void initBig(bigInteger* value) {
+	value->limbs = NULL;
+	value->length = 0;
+	value->capacity = 0;
+	value->negative = false;
+}
+
+void freeBig(bigInteger* value) {
+	free(value->limbs);
+	initBig(value);
+}
+
+static bool reserveLimbs(bigInteger* value, int length) {
+	// Makes room for a magnitude of length limbs, keeping the limbs in use
+	if (length > MAX_LIMBS + 2) return false;
+	return growBuffer(&value->limbs, &value->capacity, length, sizeof(uint32_t));
+}
+
+static void trim(bigInteger* value) {
+	// Drops zero limbs from the top.  Zero is never negative
+	while (value->length > 0 && value->limbs[value->length - 1] == 0) value->length--;
+	if (value->length == 0) value->negative = false;
+}
+
+static void replaceLimbs(bigInteger* value, uint32_t limbs[], int length, bool negative) {
+	// Makes an allocated array of limbs the magnitude of value
+	free(value->limbs);
+	value->limbs = limbs;
+	value->length = length;
+	value->capacity = length;
+	value->negative = negative;
+	trim(value);
+}
+
+static bool setMagnitude(bigInteger* value, uint64_t magnitude, bool negative) {
+	if (!reserveLimbs(value, 2)) return false;
+	value->limbs[0] = (uint32_t)magnitude;
+	value->limbs[1] = (uint32_t)(magnitude >> 32);
+	value->length = 2;
+	value->negative = negative;
+	trim(value);
+	return true;
+}
+
+bool setBig(bigInteger* value, long long int integer) {
+	return setMagnitude(value, (integer < 0) ? 0 - (uint64_t)integer : (uint64_t)integer, integer < 0);
+}
+
+// Sets an integer from its limbs, the lowest first, and its sign.  Returns false if there is no memory
+bool setBigLimbs(bigInteger* value, const uint32_t limbs[], int length, bool negative) {
+
+	if (!reserveLimbs(value, length)) return false;
+	if (length > 0) memmove(value->limbs, limbs, length * sizeof(uint32_t));
+	value->length = length;
+	value->negative = negative;
+	trim(value);
+	return true;
+}
+
+// Sets an integer from length decimal digits, such as the text of a literal.  Each nine of them multiply the limbs by
+// 10^9 and add their value, the first ones fewer so that the rest come in nines.  Returns false if there is no memory
+bool setBigText(bigInteger* value, const char text[], int length) {
+
+	int digits = (length % 9 == 0) ? 9 : length % 9;
+	uint32_t factor = 0;
+	uint64_t carry = 0;
+
+	// Each nine digits need less than 30 bits, so there are never more limbs than there are nines of digits, plus one
+	if (!reserveLimbs(value, length / 9 + 1)) return false;
+	value->length = 0;
+	value->negative = false;
+	for (int start = 0; start < length; start += digits, digits = 9) {
+		factor = 1;
+		carry = 0;
+		for (int i = start; i < start + digits; i++) {
+			factor *= 10;
+			carry = 10 * carry + (uint64_t)(text[i] - '0');
+		}
+		for (int i = 0; i < value->length; i++) {
+			carry += (uint64_t)value->limbs[i] * factor;
+			value->limbs[i] = (uint32_t)carry;
+			carry >>= 32;
+		}
+		if (carry != 0) {
+			value->limbs[value->length] = (uint32_t)carry;
+			value->length++;
+		}
+	}
+	trim(value);
+	return true;
+}
+
+// Copies an integer.  Returns false if there is no memory
+bool copyBig(bigInteger* to, const bigInteger* from) {
+
+	return setBigLimbs(to, from->limbs, from->length, from->negative);
+}
+
+// Gives the value of an integer that fits in 64 bits.  Returns false if it doesn't
+bool bigToInteger(const bigInteger* value, long long int* integer) {
+
+	uint64_t magnitude = 0;
+
+	if (value->length > 2) return false;
+	for (int i = value->length - 1; i >= 0; i--) {
+		magnitude = (magnitude << 32) | value->limbs[i];
+	}
+	if (magnitude > (value->negative ? 0x8000000000000000ULL : 0x7FFFFFFFFFFFFFFFULL)) return false;
+	*integer = value->negative ? -(long long int)(magnitude - 1) - 1 : (long long int)magnitude;
+	return true;
+}
+
+// Returns the nearest double to an integer, or an infinity if it is too large for one
+double bigToDouble(const bigInteger* value) {
+
+	double result = 0.0;
+	int skipped = (value->length > 3) ? value->length - 3 : 0;  // Three limbs hold more than the 53 bits of a double
+
+	for (int i = value->length - 1; i >= skipped; i--) {
+		result = result * 4294967296.0 + value->limbs[i];
+	}
+	result = ldexp(result, 32 * skipped);
+	return value->negative ? -result : result;
+}
+
+static uint32_t divideSmall(uint32_t quotient[], const uint32_t a[], int length, uint32_t divisor) {
+	// quotient = a / divisor over length limbs, returning the remainder.  quotient may be a
+	uint64_t remainder = 0;
+	uint64_t current = 0;
+
+	for (int i = length - 1; i >= 0; i--) {
+		current = (remainder << 32) | a[i];
+		quotient[i] = (uint32_t)(current / divisor);
+		remainder = current % divisor;
+	}
+	return (uint32_t)remainder;
+}
+
+// Returns the decimal digits of an integer, after a '-' if it is negative, in memory the caller frees, or NULL if there
+// is no memory.  The magnitude is divided by 10^9 again and again, giving nine digits at a time from the lowest
+char* bigToString(const bigInteger* value) {
+
+	uint32_t* magnitude = malloc((value->length + 1) * sizeof(uint32_t));
+	uint32_t* chunks = malloc((value->length * 11 / 10 + 2) * sizeof(uint32_t));
+	char* text = NULL;
+	int length = value->length;
+	int nrChunks = 0;
+	int position = 0;
+
+	if (magnitude != NULL && chunks != NULL) {
+		if (length > 0) memcpy(magnitude, value->limbs, length * sizeof(uint32_t));
+		do {
+			chunks[nrChunks++] = divideSmall(magnitude, magnitude, length, CHUNK_BASE);
+			while (length > 0 && magnitude[length - 1] == 0) length--;
+		} while (length > 0);
+		text = malloc(9 * nrChunks + 2);
+	}
+	if (text != NULL) {
+		position = sprintf(text, "%s%u", value->negative ? "-" : "", chunks[nrChunks - 1]);
+		for (int i = nrChunks - 2; i >= 0; i--) {
+			position += sprintf(&text[position], "%09u", chunks[i]);
+		}
+	}
+	free(magnitude);
+	free(chunks);
+	return text;
+}
+
+static int compareLimbs(const uint32_t a[], int aLength, const uint32_t b[], int bLength) {
+	// Compares two magnitudes with no zero limbs at the top, returning -1, 0 or 1
+	if (aLength != bLength) return (aLength > bLength) ? 1 : -1;
+	for (int i = aLength - 1; i >= 0; i--) {
+		if (a[i] != b[i]) return (a[i] > b[i]) ? 1 : -1;
+	}
+	return 0;
+}
+
+// Compares two integers, returning -1, 0 or 1
+int compareBig(const bigInteger* a, const bigInteger* b) {
+
+	int order = compareLimbs(a->limbs, a->length, b->limbs, b->length);
+
+	if (a->negative != b->negative) return a->negative ? -1 : 1;
+	return a->negative ? -order : order;
+}
+
+static uint32_t addLimbs(uint32_t result[], const uint32_t a[], int aLength, const uint32_t b[], int bLength) {
+	// result = a + b over aLength limbs, where b has at most as many.  Returns the carry out of the top.  result may be a
+	uint64_t carry = 0;
+	int i = 0;
+
+	for (; i < bLength; i++) {
+		carry += (uint64_t)a[i] + b[i];
+		result[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	for (; i < aLength; i++) {
+		carry += a[i];
+		result[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	return (uint32_t)carry;
+}
+
+static void subtractLimbs(uint32_t result[], const uint32_t a[], int aLength, const uint32_t b[], int bLength) {
+	// result = a - b over aLength limbs, where b is no larger than a.  result may be a or b
+	uint64_t difference = 0;
+	uint64_t borrow = 0;
+	int i = 0;
+
+	for (; i < bLength; i++) {
+		difference = (uint64_t)a[i] - b[i] - borrow;
+		result[i] = (uint32_t)difference;
+		borrow = (difference >> 32) & 1;
+	}
+	for (; i < aLength; i++) {
+		difference = (uint64_t)a[i] - borrow;
+		result[i] = (uint32_t)difference;
+		borrow = (difference >> 32) & 1;
+	}
+}
+
+static void multiplySchool(uint32_t result[], const uint32_t a[], int aLength, const uint32_t b[], int bLength) {
+	// result = a * b over aLength + bLength limbs, one limb of a at a time
+	uint64_t carry = 0;
+
+	memset(result, 0, (aLength + bLength) * sizeof(uint32_t));
+	for (int i = 0; i < aLength; i++) {
+		carry = 0;
+		for (int j = 0; j < bLength; j++) {
+			carry += (uint64_t)a[i] * b[j] + result[i + j];
+			result[i + j] = (uint32_t)carry;
+			carry >>= 32;
+		}
+		result[i + bLength] = (uint32_t)carry;
+	}
+}
+
+static uint32_t reduceWord(uint64_t value, const transformPrime* prime) {
+	// Montgomery reduction: value 2^-32 mod p, for value below p 2^32
+	uint32_t m = (uint32_t)value * prime->negativeInverse;
+	uint64_t reduced = (value + (uint64_t)m * prime->modulus) >> 32;
+
+	return (reduced >= prime->modulus) ? (uint32_t)(reduced - prime->modulus) : (uint32_t)reduced;
+}
+
+static uint32_t powerMod(uint32_t base, uint32_t exponent, uint32_t modulus) {
+	uint64_t result = 1;
+	uint64_t square = base;
+
+	for (; exponent > 0; exponent >>= 1) {
+		if (exponent & 1) result = result * square % modulus;
+		square = square * square % modulus;
+	}
+	return (uint32_t)result;
+}
+
+static void transform(uint32_t values[], int length, const uint32_t roots[], bool inverse, const transformPrime* prime) {
+	// Number theoretic transform in place over length values, a power of 2, with roots[i] the ith power of a root of
+	// unity of order length in Montgomery form.  The forward transform takes values in order and leaves them in
+	// bit-reversed order, and the inverse one takes them bit-reversed and gives them in order, so that neither reorders
+	uint32_t p = prime->modulus;
+	uint32_t u = 0;
+	uint32_t v = 0;
+
+	for (int half = inverse ? 1 : length / 2; half >= 1 && half < length; half = inverse ? 2 * half : half / 2) {
+		int step = length / (2 * half);
+		for (int start = 0; start < length; start += 2 * half) {
+			for (int j = 0; j < half; j++) {
+				u = values[start + j];
+				v = values[start + j + half];
+				if (inverse) {
+					v = reduceWord((uint64_t)v * roots[j * step], prime);
+					values[start + j] = (u + v >= p) ? u + v - p : u + v;
+					values[start + j + half] = (u >= v) ? u - v : u + p - v;
+				}
+				else {
+					values[start + j] = (u + v >= p) ? u + v - p : u + v;
+					values[start + j + half] = reduceWord((uint64_t)((u >= v) ? u - v : u + p - v) * roots[j * step], prime);
+				}
+			}
+		}
+	}
+}
+
+static bool convolve(uint32_t result[], const uint32_t a[], int aLength, const uint32_t b[], int bLength, int length,
+	const transformPrime* prime) {
+	// result = the cyclic convolution of the 16-bit pieces of a and b mod p, over length values
+	uint32_t* values = calloc(2 * (size_t)length, sizeof(uint32_t));
+	uint32_t* other = values + length;
+	uint32_t* roots = malloc(length / 2 * sizeof(uint32_t));
+	uint32_t* inverseRoots = malloc(length / 2 * sizeof(uint32_t));
+	uint32_t p = prime->modulus;
+	uint32_t root = powerMod(TRANSFORM_GENERATOR, (p - 1) / length, p);
+	uint32_t power = prime->montgomeryOne;
+	uint32_t inversePower = prime->montgomeryOne;
+	uint32_t montgomeryRoot = reduceWord((uint64_t)root * prime->montgomerySquare, prime);
+	uint32_t montgomeryInverse = reduceWord((uint64_t)powerMod(root, p - 2, p) * prime->montgomerySquare, prime);
+	uint32_t scale = 0;
+	bool square = a == b && aLength == bLength;
+
+	if (values == NULL || roots == NULL || inverseRoots == NULL) {
+		free(values);
+		free(roots);
+		free(inverseRoots);
+		return false;
+	}
+	for (int i = 0; i < length / 2; i++) {
+		roots[i] = power;
+		inverseRoots[i] = inversePower;
+		power = reduceWord((uint64_t)power * montgomeryRoot, prime);
+		inversePower = reduceWord((uint64_t)inversePower * montgomeryInverse, prime);
+	}
+	for (int i = 0; i < aLength; i++) {
+		values[2 * i] = a[i] & 0xFFFF;
+		values[2 * i + 1] = a[i] >> 16;
+	}
+	transform(values, length, roots, false, prime);
+	if (square) {
+		other = values;
+	}
+	else {
+		for (int i = 0; i < bLength; i++) {
+			other[2 * i] = b[i] & 0xFFFF;
+			other[2 * i + 1] = b[i] >> 16;
+		}
+		transform(other, length, roots, false, prime);
+	}
+	// Each pointwise product leaves a factor 2^-32, which the scaling by 2^32 / length takes out again together with the
+	// length the inverse transform multiplies by
+	for (int i = 0; i < length; i++) values[i] = reduceWord((uint64_t)values[i] * other[i], prime);
+	transform(values, length, inverseRoots, true, prime);
+	scale = reduceWord((uint64_t)powerMod(length, p - 2, p) * prime->montgomerySquare, prime);
+	scale = reduceWord((uint64_t)scale * prime->montgomerySquare, prime);
+	for (int i = 0; i < length; i++) result[i] = reduceWord((uint64_t)values[i] * scale, prime);
+	free(values);
+	free(roots);
+	free(inverseRoots);
+	return true;
+}
+
+static bool multiplyTransform(uint32_t result[], const uint32_t a[], int aLength, const uint32_t b[], int bLength) {
+	// result = a * b over aLength + bLength limbs, from the convolution of their 16-bit pieces.  Each term of the
+	// convolution is below length 2^32, so that it is found exactly from its values mod two primes whose product is
+	// larger, by the Chinese remainder theorem
+	const transformPrime* first = &transformPrimes[0];
+	const transformPrime* second = &transformPrimes[1];
+	int length = 1;
+	uint32_t* terms = NULL;
+	uint64_t carry = 0;
+	uint64_t term = 0;
+	uint64_t correction = 0;
+	uint64_t inverse = powerMod(first->modulus % second->modulus, second->modulus - 2, second->modulus);
+
+	while (length < 2 * (aLength + bLength)) length *= 2;
+	if (length > TRANSFORM_MAX_LENGTH) return false;
+	terms = malloc(2 * (size_t)length * sizeof(uint32_t));
+	if (terms == NULL) return false;
+	if (!convolve(terms, a, aLength, b, bLength, length, first)
+		|| !convolve(&terms[length], a, aLength, b, bLength, length, second)) {
+		free(terms);
+		return false;
+	}
+	for (int i = 0; i < 2 * (aLength + bLength); i++) {
+		correction = (terms[length + i] + second->modulus - terms[i] % second->modulus) % second->modulus;
+		term = terms[i] + first->modulus * (correction * inverse % second->modulus);
+		carry += term;
+		if (i & 1) {
+			result[i / 2] |= (uint32_t)(carry & 0xFFFF) << 16;
+		}
+		else {
+			result[i / 2] = (uint32_t)(carry & 0xFFFF);
+		}
+		carry >>= 16;
+	}
+	free(terms);
+	return true;
+}
+
+static bool multiplyLimbs(uint32_t result[], const uint32_t a[], int aLength, const uint32_t b[], int bLength) {
+	// result = a * b over aLength + bLength limbs, which must not overlap a or b.  Returns false if there is no memory
+	const uint32_t* swap = NULL;
+	uint32_t* work = NULL;
+	uint32_t* sumA = NULL;
+	uint32_t* sumB = NULL;
+	uint32_t* middle = NULL;
+	int half = 0;
+	int piece = 0;
+	int sumALength = 0;
+	int sumBLength = 0;
+	int middleLength = 0;
+	bool ok = true;
+
+	if (aLength < bLength) {
+		swap = a;
+		a = b;
+		b = swap;
+		half = aLength;
+		aLength = bLength;
+		bLength = half;
+	}
+	if (bLength < KARATSUBA_THRESHOLD) {
+		multiplySchool(result, a, aLength, b, bLength);
+		return true;
+	}
+	if (bLength >= TRANSFORM_THRESHOLD && aLength < 2 * bLength && multiplyTransform(result, a, aLength, b, bLength)) {
+		return true;
+	}
+
+	if (aLength >= 2 * bLength) {
+		// a is much longer, so it is multiplied by b a piece of the length of b at a time
+		work = malloc(2 * bLength * sizeof(uint32_t));
+		if (work == NULL) return false;
+		memset(result, 0, (aLength + bLength) * sizeof(uint32_t));
+		for (int start = 0; start < aLength && ok; start += bLength) {
+			piece = (aLength - start < bLength) ? aLength - start : bLength;
+			ok = multiplyLimbs(work, &a[start], piece, b, bLength);
+			addLimbs(&result[start], &result[start], piece + bLength, work, piece + bLength);
+		}
+		free(work);
+		return ok;
+	}
+
+	// a = a1 B^half + a0 and b = b1 B^half + b0, where B is 2^32.  Then a b = a1 b1 B^(2 half) + a0 b0
+	// + ((a0 + a1)(b0 + b1) - a0 b0 - a1 b1) B^half.  Since b is more than half as long as a, b1 is never empty
+	half = aLength / 2;
+	sumALength = aLength - half + 1;
+	sumBLength = ((bLength - half > half) ? bLength - half : half) + 1;
+	middleLength = sumALength + sumBLength;
+	work = malloc(2 * middleLength * sizeof(uint32_t));
+	if (work == NULL) return false;
+	sumA = work;
+	sumB = sumA + sumALength;
+	middle = sumB + sumBLength;
+
+	sumA[sumALength - 1] = addLimbs(sumA, &a[half], aLength - half, a, half);
+	if (bLength - half >= half) {
+		sumB[sumBLength - 1] = addLimbs(sumB, &b[half], bLength - half, b, half);
+	}
+	else {
+		sumB[sumBLength - 1] = addLimbs(sumB, b, half, &b[half], bLength - half);
+	}
+	ok = multiplyLimbs(result, a, half, b, half)
+		&& multiplyLimbs(&result[2 * half], &a[half], aLength - half, &b[half], bLength - half)
+		&& multiplyLimbs(middle, sumA, sumALength, sumB, sumBLength);
+	if (ok) {
+		subtractLimbs(middle, middle, middleLength, result, 2 * half);
+		subtractLimbs(middle, middle, middleLength, &result[2 * half], aLength + bLength - 2 * half);
+		while (middleLength > 0 && middle[middleLength - 1] == 0) middleLength--;
+		addLimbs(&result[half], &result[half], aLength + bLength - half, middle, middleLength);
+	}
+	free(work);
+	return ok;
+}
+
+// result = a * b.  result may be a or b
+bool multiplyBig(bigInteger* result, const bigInteger* a, const bigInteger* b) {
+
+	int length = a->length + b->length;
+	uint32_t* limbs = NULL;
+
+	if (a->length == 0 || b->length == 0) return setBig(result, 0);
+	if (length > MAX_LIMBS) return false;
+	limbs = malloc(length * sizeof(uint32_t));
+	if (limbs == NULL) return false;
+	if (!multiplyLimbs(limbs, a->limbs, a->length, b->limbs, b->length)) {
+		free(limbs);
+		return false;
+	}
+	replaceLimbs(result, limbs, length, a->negative != b->negative);
+	return true;
+}
+
+// value = value * factor
+bool multiplyBigSmall(bigInteger* value, uint32_t factor) {
+
+	uint64_t carry = 0;
+
+	if (!reserveLimbs(value, value->length + 1)) return false;
+	for (int i = 0; i < value->length; i++) {
+		carry += (uint64_t)value->limbs[i] * factor;
+		value->limbs[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	value->limbs[value->length] = (uint32_t)carry;
+	value->length++;
+	trim(value);
+	return true;
+}
+
+// value = value * factor + other * otherFactor, of magnitudes, in one pass.  The factors must be below 2^30, so that
+// both products of a limb and the carry fit in 64 bits, and other must not be value
+bool multiplyAddBigSmall(bigInteger* value, uint32_t factor, const bigInteger* other, uint32_t otherFactor) {
+
+	int length = (value->length > other->length) ? value->length : other->length;
+	uint64_t carry = 0;
+
+	if (!reserveLimbs(value, length + 1)) return false;
+	for (int i = value->length; i < length; i++) value->limbs[i] = 0;
+	for (int i = 0; i < length; i++) {
+		carry += (uint64_t)value->limbs[i] * factor;
+		if (i < other->length) carry += (uint64_t)other->limbs[i] * otherFactor;
+		value->limbs[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	value->limbs[length] = (uint32_t)carry;
+	value->length = length + 1;
+	trim(value);
+	return true;
+}
+
+// left = left + right, or left - right.  Magnitudes of the same sign are added, and otherwise the smaller is taken
+// from the larger.  right must not be left
+bool addBig(bigInteger* left, const bigInteger* right, bool subtract) {
+
+	bool rightNegative = (right->negative != subtract) && right->length > 0;
+	int length = (left->length > right->length) ? left->length : right->length;
+
+	if (left->length == 0 || left->negative == rightNegative) {
+		if (!reserveLimbs(left, length + 1)) return false;
+		for (int i = left->length; i < length; i++) left->limbs[i] = 0;
+		left->limbs[length] = addLimbs(left->limbs, left->limbs, length, right->limbs, right->length);
+		left->length = length + 1;
+		left->negative = rightNegative;
+	}
+	else if (compareLimbs(left->limbs, left->length, right->limbs, right->length) >= 0) {
+		subtractLimbs(left->limbs, left->limbs, left->length, right->limbs, right->length);
+	}
+	else {
+		if (!reserveLimbs(left, right->length)) return false;
+		subtractLimbs(left->limbs, right->limbs, right->length, left->limbs, left->length);
+		left->length = right->length;
+		left->negative = rightNegative;
+	}
+	trim(left);
+	return left->length <= MAX_LIMBS;
+}
+
+// value = value + amount
+bool addBigSmall(bigInteger* value, long long int amount) {
+
+	bigInteger small;
+	bool ok = false;
+
+	initBig(&small);
+	ok = setBig(&small, amount) && addBig(value, &small, false);
+	freeBig(&small);
+	return ok;
+}
+
+static bool divideLimbs(uint32_t quotient[], uint32_t remainder[], const uint32_t a[], int aLength, const uint32_t b[],
+	int bLength) {
+	// quotient = a / b over aLength - bLength + 1 limbs, and remainder = a mod b over bLength limbs, for a no shorter
+	// than b.  Knuth's algorithm D: both are first shifted so that the top bit of b is set, which makes the quotient limb
+	// guessed from the top limbs of the remainder at most two too large
+	uint32_t* un = NULL;
+	uint32_t* vn = NULL;
+	int shift = 0;
+	uint64_t top = 0;
+	uint64_t guess = 0;
+	uint64_t rest = 0;
+	uint64_t product = 0;
+	long long int t = 0;
+	long long int k = 0;
+
+	if (bLength == 1) {
+		remainder[0] = divideSmall(quotient, a, aLength, b[0]);
+		return true;
+	}
+	un = malloc((aLength + 1) * sizeof(uint32_t));
+	vn = malloc(bLength * sizeof(uint32_t));
+	if (un == NULL || vn == NULL) {
+		free(un);
+		free(vn);
+		return false;
+	}
+	while (!(b[bLength - 1] & (0x80000000u >> shift))) shift++;
+	for (int i = bLength - 1; i > 0; i--) {
+		vn[i] = (b[i] << shift) | ((shift > 0) ? b[i - 1] >> (32 - shift) : 0);
+	}
+	vn[0] = b[0] << shift;
+	un[aLength] = (shift > 0) ? a[aLength - 1] >> (32 - shift) : 0;
+	for (int i = aLength - 1; i > 0; i--) {
+		un[i] = (a[i] << shift) | ((shift > 0) ? a[i - 1] >> (32 - shift) : 0);
+	}
+	un[0] = a[0] << shift;
+
+	for (int j = aLength - bLength; j >= 0; j--) {
+		top = ((uint64_t)un[j + bLength] << 32) | un[j + bLength - 1];
+		guess = top / vn[bLength - 1];
+		rest = top % vn[bLength - 1];
+		while (guess > 0xFFFFFFFFu || guess * vn[bLength - 2] > ((rest << 32) | un[j + bLength - 2])) {
+			guess--;
+			rest += vn[bLength - 1];
+			if (rest > 0xFFFFFFFFu) break;
+		}
+
+		// Take guess times b from the remainder, and add b back if that was one time too many
+		k = 0;
+		for (int i = 0; i < bLength; i++) {
+			product = guess * vn[i];
+			t = (long long int)un[i + j] - k - (long long int)(product & 0xFFFFFFFFu);
+			un[i + j] = (uint32_t)t;
+			k = (long long int)(product >> 32) - (t >> 32);
+		}
+		t = (long long int)un[j + bLength] - k;
+		un[j + bLength] = (uint32_t)t;
+		quotient[j] = (uint32_t)guess;
+		if (t < 0) {
+			quotient[j]--;
+			k = 0;
+			for (int i = 0; i < bLength; i++) {
+				t = (long long int)un[i + j] + vn[i] + k;
+				un[i + j] = (uint32_t)t;
+				k = t >> 32;
+			}
+			un[j + bLength] += (uint32_t)k;
+		}
+	}
+
+	for (int i = 0; i < bLength - 1; i++) {
+		remainder[i] = (un[i] >> shift) | ((shift > 0) ? un[i + 1] << (32 - shift) : 0);
+	}
+	remainder[bLength - 1] = un[bLength - 1] >> shift;
+	free(un);
+	free(vn);
+	return true;
+}
+
+// Divides, rounding towards zero as C does: quotient = a / b and remainder = a - quotient * b, which has the sign of
+// a.  Either result may be NULL, or a.  b must not be zero
+bool divideBig(bigInteger* quotient, bigInteger* remainder, const bigInteger* a, const bigInteger* b) {
+
+	uint32_t* quotientLimbs = NULL;
+	uint32_t* remainderLimbs = NULL;
+	int length = a->length - b->length + 1;
+	bool negative = a->negative != b->negative;
+	bool aNegative = a->negative;
+
+	if (compareLimbs(a->limbs, a->length, b->limbs, b->length) < 0) {
+		if (remainder != NULL && remainder != a && !copyBig(remainder, a)) return false;
+		return quotient == NULL || setBig(quotient, 0);
+	}
+	quotientLimbs = malloc(length * sizeof(uint32_t));
+	remainderLimbs = malloc(b->length * sizeof(uint32_t));
+	if (quotientLimbs == NULL || remainderLimbs == NULL
+		|| !divideLimbs(quotientLimbs, remainderLimbs, a->limbs, a->length, b->limbs, b->length)) {
+		free(quotientLimbs);
+		free(remainderLimbs);
+		return false;
+	}
+	if (remainder != NULL) {
+		replaceLimbs(remainder, remainderLimbs, b->length, aNegative);
+	}
+	else {
+		free(remainderLimbs);
+	}
+	if (quotient != NULL) {
+		replaceLimbs(quotient, quotientLimbs, length, negative);
+	}
+	else {
+		free(quotientLimbs);
+	}
+	return true;
+}
+
+// Number of bits of the magnitude, 0 for zero
+long long int bigBitLength(const bigInteger* value) {
+
+	int bits = 0;
+
+	if (value->length == 0) return 0;
+	while (bits < 32 && (value->limbs[value->length - 1] >> bits) != 0) bits++;
+	return 32LL * (value->length - 1) + bits;
+}
+
+static long long int trailingZeros(const bigInteger* value) {
+	// Number of zero bits below the lowest set bit of a number that isn't zero
+	int limb = 0;
+	int bits = 0;
+
+	while (value->limbs[limb] == 0) limb++;
+	while (!((value->limbs[limb] >> bits) & 1)) bits++;
+	return 32LL * limb + bits;
+}
+
+// Multiplies the magnitude by 2^bits
+bool shiftBigLeft(bigInteger* value, long long int bits) {
+
+	int words = (int)(bits / 32);
+	int shift = (int)(bits % 32);
+	int length = value->length;
+	uint32_t* limbs = NULL;
+
+	if (length == 0) return true;
+	if (bits > 32LL * MAX_LIMBS || length + words + 1 > MAX_LIMBS || !reserveLimbs(value, length + words + 1)) return false;
+	limbs = value->limbs;
+	limbs[length + words] = (shift > 0) ? limbs[length - 1] >> (32 - shift) : 0;
+	for (int i = length - 1; i > 0; i--) {
+		limbs[i + words] = (limbs[i] << shift) | ((shift > 0) ? limbs[i - 1] >> (32 - shift) : 0);
+	}
+	limbs[words] = limbs[0] << shift;
+	for (int i = 0; i < words; i++) limbs[i] = 0;
+	value->length = length + words + 1;
+	trim(value);
+	return true;
+}
+
+// Divides the magnitude by 2^bits, rounding down
+void shiftBigRight(bigInteger* value, long long int bits) {
+
+	int words = 0;
+	int shift = 0;
+
+	if (bits >= 32LL * value->length) {
+		value->length = 0;
+		value->negative = false;
+		return;
+	}
+	words = (int)(bits / 32);
+	shift = (int)(bits % 32);
+	for (int i = 0; i < value->length - words; i++) {
+		value->limbs[i] = (value->limbs[i + words] >> shift)
+			| ((shift > 0 && i + words + 1 < value->length) ? value->limbs[i + words + 1] << (32 - shift) : 0);
+	}
+	value->length -= words;
+	trim(value);
+}
+
+static uint64_t wordValue(const bigInteger* value) {
+	// Magnitude of a number of at most two limbs
+	return (value->length == 0) ? 0 : (value->length == 1) ? value->limbs[0]
+		: ((uint64_t)value->limbs[1] << 32) | value->limbs[0];
+}
+
+static bool greatestDivisor(bigInteger* result, const bigInteger* a, const bigInteger* b) {
+	// Binary GCD of the magnitudes.  Common factors of 2 are taken out and both are made odd, then the smaller is taken
+	// from the larger, whose difference is made odd again, until both fit in 64 bits and Euclid's algorithm on machine
+	// words finishes.  While one is much longer than the other it is replaced by its remainder by the other instead
+	bigInteger u, v, swap;
+	long long int common = 0;
+	uint64_t x = 0;
+	uint64_t y = 0;
+	uint64_t rest = 0;
+	bool ok = true;
+
+	initBig(&u);
+	initBig(&v);
+	if (!copyBig(&u, a) || !copyBig(&v, b)) {
+		freeBig(&u);
+		freeBig(&v);
+		return false;
+	}
+	u.negative = false;
+	v.negative = false;
+	if (u.length > 0 && v.length > 0) {
+		common = (trailingZeros(&u) < trailingZeros(&v)) ? trailingZeros(&u) : trailingZeros(&v);
+		shiftBigRight(&u, trailingZeros(&u));
+		shiftBigRight(&v, trailingZeros(&v));
+	}
+	while (ok && u.length > 0 && v.length > 0 && (u.length > 2 || v.length > 2)) {
+		if (compareLimbs(u.limbs, u.length, v.limbs, v.length) < 0) {
+			swap = u;
+			u = v;
+			v = swap;
+		}
+		if (u.length > v.length + 1) {
+			ok = divideBig(NULL, &u, &u, &v);
+		}
+		else {
+			subtractLimbs(u.limbs, u.limbs, u.length, v.limbs, v.length);
+			trim(&u);
+		}
+		if (u.length > 0) shiftBigRight(&u, trailingZeros(&u));
+	}
+
+	x = wordValue(&u);
+	y = wordValue(&v);
+	while (y != 0) {
+		rest = x % y;
+		x = y;
+		y = rest;
+	}
+	if (ok && (u.length > 2 || v.length > 2)) {
+		// One of them is zero, and the other is the divisor
+		ok = copyBig(result, (u.length > 0) ? &u : &v);
+	}
+	else if (ok) {
+		ok = setMagnitude(result, x, false);
+	}
+	ok = ok && shiftBigLeft(result, common);
+	freeBig(&u);
+	freeBig(&v);
+	return ok;
+}
+
+static bool power(bigInteger* base, const bigInteger* exponent) {
+	// base = base^exponent, by repeated squaring.  Negative exponents, and results too large to keep, give false
+	bigInteger result, square;
+	long long int remaining = 0;
+	bool ok = true;
+
+	if (!bigToInteger(exponent, &remaining) || remaining < 0) return false;
+	if ((double)(bigBitLength(base) - 1) * (double)remaining > 32.0 * MAX_LIMBS) return false;
+	initBig(&result);
+	initBig(&square);
+	ok = setBig(&result, 1) && copyBig(&square, base);
+	while (ok && remaining > 0) {
+		if (remaining & 1) ok = multiplyBig(&result, &result, &square);
+		remaining >>= 1;
+		if (remaining > 0) ok = ok && multiplyBig(&square, &square, &square);
+	}
+	freeBig(&square);
+	if (ok) {
+		freeBig(base);
+		*base = result;
+	}
+	else {
+		freeBig(&result);
+	}
+	return ok;
+}
+
+static bool addFactor(factorList* list, uint64_t factor) {
+	// Adds a factor to a product.  Small factors are multiplied together while they fit in one limb
+	if (factor <= 0xFFFFFFFFu && list->pending <= 0xFFFFFFFFu / factor) {
+		list->pending *= factor;
+		return true;
+	}
+	if (!growBuffer(&list->values, &list->capacity, list->count + 1, sizeof(uint64_t))) return false;
+	list->values[list->count] = list->pending;
+	list->count++;
+	list->pending = factor;
+	return true;
+}
+
+static bool multiplyFactors(bigInteger* result, const uint64_t factors[], int count) {
+	// Sets result to the product of factors, each below 2^63.  The list is split in halves whose products are multiplied,
+	// so that the long products are of numbers of about the same size
+	bigInteger right;
+	bool ok = true;
+
+	if (count <= PRODUCT_LEAVES) {
+		ok = setBig(result, 1);
+		initBig(&right);
+		for (int i = 0; i < count && ok; i++) {
+			if (factors[i] <= 0xFFFFFFFFu) {
+				ok = multiplyBigSmall(result, (uint32_t)factors[i]);
+			}
+			else {
+				ok = setBig(&right, (long long int)factors[i]) && multiplyBig(result, result, &right);
+			}
+		}
+		freeBig(&right);
+		return ok;
+	}
+	initBig(&right);
+	ok = multiplyFactors(result, factors, count / 2) && multiplyFactors(&right, &factors[count / 2], count - count / 2)
+		&& multiplyBig(result, result, &right);
+	freeBig(&right);
+	return ok;
+}
+
+static bool multiplyList(bigInteger* result, factorList* list) {
+	// Sets result to the product of a list of factors, and frees the list
+	bool ok = growBuffer(&list->values, &list->capacity, list->count + 1, sizeof(uint64_t));
+
+	if (ok) {
+		list->values[list->count] = list->pending;
+		list->count++;
+		ok = multiplyFactors(result, list->values, list->count);
+	}
+	free(list->values);
+	return ok;
+}
+
+static unsigned char* sieve(long long int n) {
+	// Returns a table with a nonzero entry for every number up to n that isn't prime, or NULL if there is no memory
+	unsigned char* composite = calloc(n + 2, 1);
+
+	if (composite == NULL) return NULL;
+	composite[0] = 1;
+	composite[1] = 1;
+	for (long long int i = 2; i * i <= n; i++) {
+		if (composite[i]) continue;
+		for (long long int j = i * i; j <= n; j += i) composite[j] = 1;
+	}
+	return composite;
+}
+
+static long long int primeExponent(long long int n, long long int p) {
+	// Exponent of the prime p in n!, by Legendre's formula: the sum of n / p^i
+	long long int exponent = 0;
+
+	while (n > 0) {
+		n /= p;
+		exponent += n;
+	}
+	return exponent;
+}
+
+static bool swing(bigInteger* result, long long int n, const unsigned char composite[]) {
+	// The swinging factorial n! / (n/2)!^2.  The exponent of a prime p in it is the number of odd quotients n / p^i, so
+	// each prime power in it is at most n
+	factorList list = { NULL, 0, 0, 1 };
+	long long int quotient = 0;
+	uint64_t primePower = 1;
+	bool ok = true;
+
+	for (long long int p = 2; p <= n && ok; p++) {
+		if (composite[p]) continue;
+		primePower = 1;
+		for (quotient = n / p; quotient > 0; quotient /= p) {
+			if (quotient & 1) primePower *= p;
+		}
+		if (primePower > 1) ok = addFactor(&list, primePower);
+	}
+	if (!ok) {
+		free(list.values);
+		return false;
+	}
+	return multiplyList(result, &list);
+}
+
+static bool factorial(bigInteger* result, long long int n, const unsigned char composite[]) {
+	// n! = (n/2)!^2 swing(n)
+	bigInteger swung;
+	bool ok = true;
+
+	if (n < 2) return setBig(result, 1);
+	initBig(&swung);
+	ok = factorial(result, n / 2, composite) && multiplyBig(result, result, result) && swing(&swung, n, composite)
+		&& multiplyBig(result, result, &swung);
+	freeBig(&swung);
+	return ok;
+}
+
+static bool factorialOf(bigInteger* value) {
+	// value = value!, for values whose factorial isn't too large to keep
+	long long int n = 0;
+	unsigned char* composite = NULL;
+	bool ok = true;
+
+	if (!bigToInteger(value, &n) || n < 0 || lgamma(n + 1.0) / log(2.0) > 32.0 * MAX_LIMBS) return false;
+	composite = sieve(n);
+	if (composite == NULL) return false;
+	ok = factorial(value, n, composite);
+	free(composite);
+	return ok;
+}
+
+static bool choose(bigInteger* left, const bigInteger* right, bool ordered) {
+	// left = nCr(left, right), or nPr(left, right) if ordered.  When k is a large part of n, the exponent of every prime
+	// up to n is found, as its exponent in n! less those in (n - k)! and, for nCr, k!.  Otherwise the product
+	// n (n - 1) ... (n - k + 1) is taken, and for nCr divided by k!
+	factorList list = { NULL, 0, 0, 1 };
+	unsigned char* composite = NULL;
+	bigInteger divisor;
+	long long int n = 0;
+	long long int k = 0;
+	long long int exponent = 0;
+	bool ok = true;
+
+	if (!bigToInteger(left, &n) || !bigToInteger(right, &k) || n < 0 || k < 0) return false;
+	if (k > n) return setBig(left, 0);
+	if (!ordered && k > n - k) k = n - k;
+	if ((lgamma(n + 1.0) - lgamma(n - k + 1.0) - (ordered ? 0.0 : lgamma(k + 1.0))) / log(2.0) > 32.0 * MAX_LIMBS) {
+		return false;
+	}
+
+	if (n <= SIEVE_LIMIT && 16 * k >= n) {
+		composite = sieve(n);
+		ok = composite != NULL;
+		for (long long int p = 2; p <= n && ok; p++) {
+			if (composite[p]) continue;
+			exponent = primeExponent(n, p) - primeExponent(n - k, p) - (ordered ? 0 : primeExponent(k, p));
+			for (; exponent > 0 && ok; exponent--) ok = addFactor(&list, p);
+		}
+		free(composite);
+		if (!ok) {
+			free(list.values);
+			return false;
+		}
+		return multiplyList(left, &list);
+	}
+
+	for (long long int i = 0; i < k && ok; i++) ok = addFactor(&list, n - i);
+	if (!ok) {
+		free(list.values);
+		return false;
+	}
+	ok = multiplyList(left, &list);
+	if (ok && !ordered) {
+		initBig(&divisor);
+		ok = setBig(&divisor, k) && factorialOf(&divisor) && divideBig(left, NULL, left, &divisor);
+		freeBig(&divisor);
+	}
+	return ok;
+}
+
+static bool bitwise(unsigned int operand, bigInteger* left, const bigInteger* right) {
+	// AND, OR and XOR of the limbs of numbers that aren't negative
+	int length = (left->length > right->length) ? left->length : right->length;
+	uint32_t limb = 0;
+
+	if (left->negative || right->negative || !reserveLimbs(left, length)) return false;
+	for (int i = left->length; i < length; i++) left->limbs[i] = 0;
+	for (int i = 0; i < length; i++) {
+		limb = (i < right->length) ? right->limbs[i] : 0;
+		if (operand == OP_BITWISE_AND) left->limbs[i] &= limb;
+		else if (operand == OP_BITWISE_OR) left->limbs[i] |= limb;
+		else left->limbs[i] ^= limb;
+	}
+	left->length = length;
+	trim(left);
+	return true;
+}
+
+static bool shiftBig(unsigned int operand, bigInteger* left, const bigInteger* right) {
+	// Shifts multiply or divide by a power of 2, rounding down, as on 64-bit integers
+	long long int count = 0;
+
+	if (!bigToInteger(right, &count) || count < 0) return false;
+	if (operand == OP_LEFT_SHIFT) return shiftBigLeft(left, count);
+	if (!left->negative) {
+		shiftBigRight(left, count);
+		return true;
+	}
+	// -x >> n is -((x - 1) >> n) - 1
+	if (!addBigSmall(left, 1)) return false;
+	shiftBigRight(left, count);
+	return addBigSmall(left, -1);
+}
+
+static bool truth(bigInteger* value, bool condition) {
+	return setBig(value, condition ? 1 : 0);
+}
+
+// Applies a two-input operator to integers of any size, leaving the result in left.  Returns false if the result isn't
+// an integer, or is too large to keep
+bool applyBigBinary(unsigned int operand, bigInteger* left, const bigInteger* right) {
+
+	bigInteger divisor;
+	bool ok = true;
+
+	switch (operand) {
+	case OP_ADD:
+		return addBig(left, right, false);
+	case OP_SUB:
+		return addBig(left, right, true);
+	case OP_MUL:
+		return multiplyBig(left, left, right);
+	case OP_DIV_INT:
+		return right->length > 0 && divideBig(left, NULL, left, right);
+	case OP_MOD:
+		return right->length > 0 && divideBig(NULL, left, left, right);
+	case OP_EXP:
+		return power(left, right);
+	case OP_GCD:
+		return greatestDivisor(left, left, right);
+	case OP_LCM:
+		// |left / gcd * right|
+		initBig(&divisor);
+		ok = greatestDivisor(&divisor, left, right) && divisor.length > 0 && divideBig(left, NULL, left, &divisor)
+			&& multiplyBig(left, left, right);
+		left->negative = false;
+		freeBig(&divisor);
+		return ok;
+	case OP_NCR:
+		return choose(left, right, false);
+	case OP_NPR:
+		return choose(left, right, true);
+	case OP_LEFT_SHIFT:
+	case OP_RIGHT_SHIFT:
+		return shiftBig(operand, left, right);
+	case OP_BITWISE_AND:
+	case OP_BITWISE_OR:
+	case OP_BITWISE_XOR:
+		return bitwise(operand, left, right);
+	case OP_IS:
+		return truth(left, compareBig(left, right) == 0);
+	case OP_GREATER_THAN:
+		return truth(left, compareBig(left, right) > 0);
+	case OP_GREATER_THAN_EQUAL_TO:
+		return truth(left, compareBig(left, right) >= 0);
+	case OP_LESS_THAN:
+		return truth(left, compareBig(left, right) < 0);
+	case OP_LESS_THAN_EQUAL_TO:
+		return truth(left, compareBig(left, right) <= 0);
+	case OP_AND:
+		return truth(left, left->length > 0 && right->length > 0);
+	case OP_OR:
+		return truth(left, left->length > 0 || right->length > 0);
+	case OP_XOR:
+		return truth(left, (left->length > 0) != (right->length > 0));
+	case OP_IMPLIES:
+		return truth(left, left->length == 0 || right->length > 0);
+	case OP_IFF:
+		return truth(left, (left->length > 0) == (right->length > 0));
+	case OP_IMPLIED_BY:
+		return truth(left, left->length > 0 && right->length == 0);
+	default:
+		return false;
+	}
+}
+
+// Applies a single-input operator to an integer of any size.  Returns false if the result is too large to keep
+bool applyBigUnary(unsigned int operand, bigInteger* value) {
+
+	switch (operand) {
+	case OP_NEG:
+		value->negative = !value->negative && value->length > 0;
+		return true;
+	case OP_ABS:
+		value->negative = false;
+		return true;
+	case OP_NOT:
+		return truth(value, value->length == 0);
+	case OP_BITWISE_NOT:
+		// ~x is -x - 1
+		value->negative = !value->negative && value->length > 0;
+		return addBigSmall(value, -1);
+	case OP_SIGN:
+		return setBig(value, value->negative ? -1 : 1);
+	case OP_CEIL:
+	case OP_FLOOR:
+	case OP_ROUND:
+	case OP_TRUNC:
+		return true;
+	case OP_FACTORIAL:
+		return factorialOf(value);
+	default:
+		return false;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,1435 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "variables.h"
+#include "integer.h"
+#include "rpn.h"
+#include "compile.h"
+#include "global.h"
+
+#define MAX_TYPE_CHANGES 4  // Variables whose type a single statement can set
+
+// Kinds of frames of the walk emitting code.  A frame starts as the value or the array its node is needed as, and once
+// its node is started, becomes the kind of code the node has
+#define FRAME_VALUE 0       // Scalar, left on the value stack
+#define FRAME_ARRAY 1       // Array, left on the array stack
+#define FRAME_REAL_ARRAY 2  // Array that must hold real values
+#define FRAME_OPERATOR 3    // Plain operator, emitted after its arguments
+#define FRAME_LITERAL 4     // Array literal [a, b, ...]
+#define FRAME_OPERATION 5   // Operation on whole arrays, such as dot or a matrix product
+#define FRAME_REDUCTION 6   // sum, prod, max or min of an array that isn't computed element-wise
+#define FRAME_MAP 7         // Element-wise expression over arrays, evaluated in one loop
+#define FRAME_BOUND 8       // Higher order function, with a body in which a name is bound
+#define FRAME_GRADIENT 9
+#define FRAME_SAMPLING 10
+
+typedef struct {
+	unsigned int token;  // Operator, or the scratch slot holding a value
+	int* args;           // Indices of the nodes this operator acts on, in order
+	int nrArgs;
+	int local;           // Local of the body of an element-wise expression this node is an input of, or -1
+	char type;           // Type found by typeOf() while epoch is bindingEpoch
+	int nrInputs;        // Found by countInputs() along with the type
+	int epoch;
+} node;
+
+typedef struct {
+	unsigned int reduction;    // Applied to the values of the loop, or 0 to keep them as an array
+	int count;                 // Inputs bound to locals so far
+	unsigned int arrayMask;    // Bit set for each input that is an array
+	int slots[MAX_LOCALS];     // Variable each input reads, or -1, so that a variable used twice is only read once
+	int nodes[MAX_LOCALS];     // Node of each input, emitted before the loop
+} mapInputs;
+
+typedef struct {
+	int index;  // Node whose code is being emitted
+	int next;   // Argument emitted next, or -1 until the node is started
+	char kind;  // FRAME_ constant
+} frame;
+
+typedef struct {
+	int index;   // Element-wise node whose arguments are evaluated in the loop
+	int next;    // Argument looked at next
+	int end;     // Number of inputs the loop can have once the node's arguments are collected
+	int needed;  // Inputs the arguments after next need at least
+} inputFrame;
+
+typedef struct {
+	int slot;
+	char before;  // Type the variable had for the statements compiled before
+	char after;
+} typeChange;
+
+// The tree and the stacks used to walk it grow with the longest line compiled so far, and are kept for the next line.
+// Trees are walked with stacks of their own rather than by recursion, so that a line of any length can be compiled
+static node* nodes;           // Expression tree of the line currently being compiled
+static int* argPool;          // Arguments of all nodes.  Every node is the argument of at most one other
+static int* treeStack;        // Nodes waiting for an operator while the tree is built, or for their type
+static frame* frames;         // Nodes whose arguments are being emitted, innermost last
+static mapInputs* maps;       // Inputs of the element-wise loops whose frames are on the stack, innermost last
+static inputFrame* collecting;  // Element-wise nodes whose arguments are being made inputs of a loop
+static int nodesCapacity;
+static int argCapacity;
+static int treeCapacity;
+static int framesCapacity;
+static int mapsCapacity;
+static int collectingCapacity;
+static int nrFrames;
+static int nrMaps;
+static int bindingEpoch;      // Changes whenever the types of names may change, which clears what nodes have cached
+static int depth;             // Value stack depth reached by the code emitted so far
+static int maxDepth;
+static int deepest;           // Deepest value stack of the statement, including those of bodies of higher order functions
+static int arrayDepth;        // Array stack depth reached by the code emitted so far
+static bool arraysAllowed;    // Arrays can only be used in lines run by runProgram(), outside of bound expressions
+static char* boundNames[MAX_LOCALS];  // Index variables of the reductions enclosing the code being emitted
+static int nrBound;
+static bool integersAllowed;  // Scalars can only be integers in lines run by runProgram(), outside of bound expressions
+static bool emittedIntegers;  // Code on integers was emitted for the statement
+static typeChange typeChanges[MAX_TYPE_CHANGES];  // Types the statement being compiled set
+static int nrTypeChanges;
+static int reportedNode = -1; // montecarlo() at the top of a statement that prints its value, which reports on its samples
+static char sampleName[1];    // Bound in the body of montecarlo() and in formulas, where no name refers to it
+
+void initProgram(program* prog) {
+	// Sets up an empty program.  Buffers are allocated as code is emitted
+	prog->code = NULL;
+	prog->length = 0;
+	prog->capacity = 0;
+	prog->constants = NULL;
+	prog->nrConstants = 0;
+	prog->constCapacity = 0;
+	prog->literals = NULL;
+	prog->literalText = NULL;
+	prog->textLength = 0;
+	prog->textCapacity = 0;
+	prog->stackDepth = 0;
+	prog->types = NULL;
+	prog->typesCapacity = 0;
+}
+
+void clearProgram(program* prog) {
+	// Empties a program while keeping its buffers for reuse
+	prog->length = 0;
+	prog->nrConstants = 0;
+	prog->textLength = 0;
+	prog->stackDepth = 0;
+	if (prog->types != NULL) memset(prog->types, TYPE_FREE, prog->typesCapacity);
+}
+
+void freeProgram(program* prog) {
+	free(prog->code);
+	free(prog->constants);
+	free(prog->literals);
+	free(prog->literalText);
+	free(prog->types);
+	initProgram(prog);
+}
+
+void emitCode(program* prog, unsigned int word) {
+	// Appends an instruction or instruction argument, growing the code buffer as needed
+	if (!growBuffer(&prog->code, &prog->capacity, prog->length + 1, sizeof(unsigned int))) {
+		error = ERR_OVERFLOW;
+		return;
+	}
+	prog->code[prog->length] = word;
+	prog->length++;
+}
+
+int addConstant(program* prog, double value) {
+	// Stores a literal in the program's constant pool, returning its index
+	if (prog->nrConstants >= prog->constCapacity) {
+		int newCapacity = (prog->constCapacity > 0) ? 2 * prog->constCapacity : INPUT_HOLDER_SIZE;
+		double* newConstants = realloc(prog->constants, newCapacity * sizeof(double));
+		int* newLiterals = (newConstants == NULL) ? NULL : realloc(prog->literals, newCapacity * sizeof(int));
+		if (newConstants != NULL) prog->constants = newConstants;
+		if (newLiterals == NULL) {
+			error = ERR_OVERFLOW;
+			return 0;
+		}
+		prog->literals = newLiterals;
+		prog->constCapacity = newCapacity;
+	}
+	prog->constants[prog->nrConstants] = value;
+	prog->literals[prog->nrConstants] = -1;
+	return prog->nrConstants++;
+}
+
+int addLiteral(program* prog, double value, const char text[]) {
+	// Stores a number written in the program in the constant pool, along with its text, so that it can be read again
+	// to the precision set by "prec".  Returns its index
+	int index = addConstant(prog, value);
+	int length = (int)strlen(text);
+
+	if (error != NO_ERROR) return 0;
+	if (!growBuffer(&prog->literalText, &prog->textCapacity, prog->textLength + length + 1, sizeof(char))) {
+		error = ERR_OVERFLOW;
+		return 0;
+	}
+	memcpy(&prog->literalText[prog->textLength], text, length + 1);
+	prog->literals[index] = prog->textLength;
+	prog->textLength += length + 1;
+	return index;
+}
+
+static char variableType(const program* prog, int slot) {
+	// Returns the type of a variable when the statement being compiled runs: the type given to it by an earlier statement
+	// of the program, or else the type of its current value
+	if (slot < prog->typesCapacity && prog->types[slot] != TYPE_FREE) return prog->types[slot];
+	// Floats mapped from a file are read as doubles
+	return (getVariableType(slot) == TYPE_FLOAT_ARR) ? TYPE_DOUBLE_ARR : getVariableType(slot);
+}
+
+static void setVariableType(program* prog, int slot, char type) {
+	// Records the type a statement leaves in a variable, for the statements compiled after it
+	int newCapacity = prog->typesCapacity;
+	char* newTypes;
+
+	if (nrTypeChanges < MAX_TYPE_CHANGES) {
+		typeChanges[nrTypeChanges].slot = slot;
+		typeChanges[nrTypeChanges].before = (slot < prog->typesCapacity) ? prog->types[slot] : TYPE_FREE;
+		typeChanges[nrTypeChanges].after = type;
+		nrTypeChanges++;
+	}
+	if (slot >= prog->typesCapacity) {
+		while (newCapacity <= slot) newCapacity = (newCapacity > 0) ? 2 * newCapacity : USER_VAR_START;
+		newTypes = realloc(prog->types, newCapacity);
+		if (newTypes == NULL) {
+			error = ERR_OVERFLOW;
+			return;
+		}
+		memset(newTypes + prog->typesCapacity, TYPE_FREE, newCapacity - prog->typesCapacity);
+		prog->types = newTypes;
+		prog->typesCapacity = newCapacity;
+	}
+	prog->types[slot] = type;
+	bindingEpoch++;
+}
+
+static bool namesMatch(char a[], char b[]) {
+	for (int i = 0; i < INPUT_HOLDER_SIZE; i++) {
+		if (a[i] != b[i]) return false;
+		if (a[i] == '\0') return true;
+	}
+	return true;
+}
+
+static int operandSlot(unsigned int token) {
+	// Slot of the variable an operand names, 0 for a literal, or -1 for an undefined name
+	return operands[token - OPERAND_START].source;
+}
+
+static char* operandName(unsigned int token) {
+	return &operandNames[operands[token - OPERAND_START].name];
+}
+
+static bool isName(int index) {
+	// Returns true for nodes that are a name, rather than an operator or a literal
+	return isOperand(nodes[index].token) && operandSlot(nodes[index].token) != 0;
+}
+
+static void bindNames(int count) {
+	// Adds or removes names bound to locals.  Nodes may refer to other variables after this
+	nrBound += count;
+	bindingEpoch++;
+}
+
+static int findBoundName(unsigned int token) {
+	// Returns the local holding the bound variable an operand names, innermost first, or -1 if there is none
+	if (operandSlot(token) == 0) return -1;
+	for (int i = nrBound - 1; i >= 0; i--) {
+		if (namesMatch(boundNames[i], operandName(token))) return i;
+	}
+	return -1;
+}
+
+static void unknownName(unsigned int token) {
+	// Reports a name that is neither a function nor a defined variable.  Names that don't fit are printed with "..."
+	char* name = operandName(token);
+
+	error = ERR_UNKNOWN_TOKEN;
+	for (int i = 0; i < INPUT_HOLDER_SIZE && (i == 0 || name[i - 1] != '\0'); i++) {
+		unrecognizedToken[i] = name[i];
+	}
+}
+
+static int buildTree() {
+	// Converts expressionRPN into a tree of nodes, returning the index of the root, or -1 for an empty line
+	int stackLength = 0;
+	int nrArgs = 0;
+	int poolLength = 0;
+	int length = 0;
+
+	while (expressionRPN[length] != 0) length++;
+	if (!growBuffer(&nodes, &nodesCapacity, length, sizeof(node)) || !growBuffer(&argPool, &argCapacity, length, sizeof(int))
+		|| !growBuffer(&treeStack, &treeCapacity, length, sizeof(int))) {
+		error = ERR_OVERFLOW;
+		return -1;
+	}
+	bindingEpoch++;
+
+	for (int i = 0; i < length; i++) {
+		nodes[i].token = expressionRPN[i];
+		nodes[i].nrArgs = 0;
+		nodes[i].args = &argPool[poolLength];
+		nodes[i].local = -1;
+		nodes[i].epoch = -1;
+
+		if (!isOperand(expressionRPN[i])) {
+			nrArgs = (expressionArgs[i] > 0) ? expressionArgs[i] : nrArguments(expressionRPN[i]);
+			if (nrArgs == 0 || nrArgs > stackLength || nrArgs < minArguments(expressionRPN[i])
+				|| nrArgs > nrArguments(expressionRPN[i])) {
+				error = ERR_SYNTAX;
+				return -1;
+			}
+			stackLength -= nrArgs;
+			for (int j = 0; j < nrArgs; j++) {
+				nodes[i].args[j] = treeStack[stackLength + j];
+			}
+			nodes[i].nrArgs = nrArgs;
+			poolLength += nrArgs;
+		}
+		treeStack[stackLength] = i;
+		stackLength++;
+	}
+
+	if (stackLength > 1) {
+		// Values left without an operator, most likely from a misplaced argument separator
+		error = ERR_SYNTAX;
+	}
+	return (stackLength == 1) ? treeStack[0] : -1;
+}
+
+static void emitNode(program* prog, int index);
+static void emitOperators(program* prog, int index, char kind, bool body, bool integer);
+static int countInputs(const program* prog, int index);
+
+static bool isElementwise(unsigned int token) {
+	// Returns true for operators that act on each value of an array on its own
+	return (isBinaryOperator(token) && token != OP_MATMUL) || token == OP_NEG || token == OP_NOT || token == OP_BITWISE_NOT
+		|| (token >= UNARY_OPERATORS && token < ARRAY_OPERATORS);
+}
+
+static bool takesArray(unsigned int token, int arg) {
+	// Returns true for the arguments of array and matrix operations that are arrays rather than scalars
+	switch (token) {
+	case OP_DOT:
+	case OP_MATMUL:
+	case OP_LINSOLVE:
+	case OP_FFT:
+	case OP_IFFT:
+	case OP_CONV:
+	case OP_XCORR:
+	case OP_REAL:
+	case OP_IMAG:
+	case OP_MAGNITUDE:
+		return true;
+	case OP_TRANSPOSE:
+	case OP_DET:
+	case OP_INV:
+	case OP_RESHAPE:
+		return arg == 0;
+	default:
+		return false;
+	}
+}
+
+static bool isKnown(int index) {
+	return nodes[index].epoch == bindingEpoch;
+}
+
+static bool isScalar(char type) {
+	return type == TYPE_DOUBLE || type == TYPE_INT;
+}
+
+static char computeType(const program* prog, int index) {
+	// Returns the type of a node from the types of its arguments, which must be known if it is element-wise
+	node* current = &nodes[index];
+	int slot = 0;
+
+	if (isOperand(current->token)) {
+		slot = operandSlot(current->token);
+		if (slot == 0 && operands[current->token - OPERAND_START].integral && integersAllowed && nrBound == 0) {
+			return TYPE_INT;
+		}
+		if (slot <= 0 || findBoundName(current->token) >= 0) return TYPE_DOUBLE;
+		if (variableType(prog, slot) == TYPE_INT && !(integersAllowed && nrBound == 0)) return TYPE_DOUBLE;
+		return variableType(prog, slot);
+	}
+	switch (current->token) {
+	case OP_ARRAY:
+	case OP_LINSPACE:
+	case OP_MATMUL:
+	case OP_TRANSPOSE:
+	case OP_INV:
+	case OP_EYE:
+	case OP_RESHAPE:
+	case OP_CONV:
+	case OP_XCORR:
+	case OP_REAL:
+	case OP_IMAG:
+		return TYPE_DOUBLE_ARR;
+	case OP_FFT:
+	case OP_IFFT:
+		return TYPE_CPLX_RECT_ARR;
+	case OP_SOLVE:
+		// solve(A, b) solves a linear system, while solve with a bound name finds a root
+		return (current->nrArgs == 2) ? TYPE_DOUBLE_ARR : TYPE_DOUBLE;
+	}
+	if (!isElementwise(current->token)) return TYPE_DOUBLE;
+	for (int i = 0; i < current->nrArgs; i++) {
+		if (!isScalar(nodes[current->args[i]].type)) return TYPE_DOUBLE_ARR;
+	}
+	// Operators on integers that give integers are done exactly
+	if (!isIntegerOperator(current->token)) return TYPE_DOUBLE;
+	for (int i = 0; i < current->nrArgs; i++) {
+		if (nodes[current->args[i]].type != TYPE_INT) return TYPE_DOUBLE;
+	}
+	return TYPE_INT;
+}
+
+static char typeOf(const program* prog, int index) {
+	// Returns TYPE_DOUBLE_ARR for nodes whose value is an array, TYPE_CPLX_RECT_ARR for arrays of complex values,
+	// TYPE_INT for scalars that are done on integers, and TYPE_DOUBLE for other scalars.  Types are cached in the nodes,
+	// along with their number of inputs, and the arguments of element-wise operators are typed first, deepest first,
+	// using treeStack as the stack of nodes waiting for the types of their arguments
+	int stackLength = 0;
+	int top = 0;
+	bool ready = true;
+
+	if (isKnown(index)) return nodes[index].type;
+	treeStack[stackLength++] = index;
+	while (stackLength > 0) {
+		top = treeStack[stackLength - 1];
+		ready = true;
+		if (!isOperand(nodes[top].token) && isElementwise(nodes[top].token)) {
+			for (int i = 0; i < nodes[top].nrArgs; i++) {
+				if (!isKnown(nodes[top].args[i])) {
+					treeStack[stackLength++] = nodes[top].args[i];
+					ready = false;
+				}
+			}
+		}
+		if (ready) {
+			nodes[top].type = computeType(prog, top);
+			nodes[top].epoch = bindingEpoch;
+			nodes[top].nrInputs = countInputs(prog, top);
+			stackLength--;
+		}
+	}
+	return nodes[index].type;
+}
+
+static bool isMapped(const program* prog, int index) {
+	// Returns true for element-wise nodes evaluated in the loop of INST_MAP.  Those with a complex argument aren't: abs of
+	// a complex array is an operation on the whole array, and other operators don't take complex values
+	if (!isElementwise(nodes[index].token)) return false;
+	for (int i = 0; i < nodes[index].nrArgs; i++) {
+		if (typeOf(prog, nodes[index].args[i]) == TYPE_CPLX_RECT_ARR) return false;
+	}
+	return true;
+}
+
+static void pushArrays(int count) {
+	// Keeps track of the array stack depth of the code emitted so far
+	arrayDepth += count;
+}
+
+static void pushValue() {
+	depth++;
+	if (depth > maxDepth) maxDepth = depth;
+}
+
+static int countInputs(const program* prog, int index) {
+	// Returns the number of inputs the element-wise expression at a node has when it is evaluated in a single loop, from
+	// those of its arguments, which typeOf() has found first.  Single scalar values are loaded in the loop itself, and
+	// are not counted
+	node* current = &nodes[index];
+	int count = 0;
+
+	if (isScalar(current->type)) return isOperand(current->token) ? 0 : 1;
+	if (!isMapped(prog, index)) return 1;
+	for (int i = 0; i < current->nrArgs; i++) {
+		count += nodes[current->args[i]].nrInputs;
+	}
+	return count;
+}
+
+static bool hasInputs(const program* prog, int index) {
+	typeOf(prog, index);
+	return nodes[index].nrInputs > 0;
+}
+
+static void collectInputs(const program* prog, int index, mapInputs* inputs) {
+	// Finds the inputs of the element-wise expression at a node, in the order they are emitted, and binds each to a local
+	// of its loop.  Element-wise arguments are part of the same loop as long as each of their own arguments can have an
+	// input, while leaving one for each argument after them.  Those of their arguments that don't fit become inputs
+	// computed by loops of their own, so that a long expression is split into loops of about MAX_LOCALS inputs each.
+	// The element-wise nodes taken into the loop are walked with a stack of their own
+	int nrCollecting = 1;
+	int least = 0;  // Inputs an argument needs at least to be part of the loop
+	int arg = 0;
+	int slot = 0;
+	int local = 0;
+	inputFrame* top = NULL;
+
+	if (!growBuffer(&collecting, &collectingCapacity, 1, sizeof(inputFrame))) {
+		error = ERR_OVERFLOW;
+		return;
+	}
+	collecting[0].index = index;
+	collecting[0].next = 0;
+	collecting[0].end = MAX_LOCALS;
+	collecting[0].needed = 0;
+	for (int i = 0; i < nodes[index].nrArgs; i++) {
+		collecting[0].needed += hasInputs(prog, nodes[index].args[i]) ? 1 : 0;
+	}
+
+	while (nrCollecting > 0 && error == NO_ERROR) {
+		top = &collecting[nrCollecting - 1];
+		if (top->next >= nodes[top->index].nrArgs) {
+			nrCollecting--;
+			continue;
+		}
+		arg = nodes[top->index].args[top->next];
+		top->next++;
+		top->needed -= hasInputs(prog, arg) ? 1 : 0;
+
+		if (isScalar(typeOf(prog, arg)) && isOperand(nodes[arg].token)) {
+			// Loaded in the loop
+			continue;
+		}
+		if (!isScalar(typeOf(prog, arg)) && isMapped(prog, arg)) {
+			least = 0;
+			for (int j = 0; j < nodes[arg].nrArgs; j++) {
+				least += hasInputs(prog, nodes[arg].args[j]) ? 1 : 0;
+			}
+			if (least <= top->end - inputs->count - top->needed) {
+				if (!growBuffer(&collecting, &collectingCapacity, nrCollecting + 1, sizeof(inputFrame))) {
+					error = ERR_OVERFLOW;
+					return;
+				}
+				collecting[nrCollecting].index = arg;
+				collecting[nrCollecting].next = 0;
+				collecting[nrCollecting].end = collecting[nrCollecting - 1].end - collecting[nrCollecting - 1].needed;
+				collecting[nrCollecting].needed = least;
+				nrCollecting++;
+				continue;
+			}
+		}
+
+		slot = -1;
+		if (isOperand(nodes[arg].token)) {
+			// An array variable used more than once is an input only once
+			slot = operandSlot(nodes[arg].token);
+			for (local = 0; local < inputs->count && inputs->slots[local] != slot; local++);
+			if (local < inputs->count) {
+				nodes[arg].local = local;
+				continue;
+			}
+		}
+		if (!isScalar(typeOf(prog, arg))) {
+			inputs->arrayMask |= 1u << inputs->count;
+		}
+		nodes[arg].local = inputs->count;
+		inputs->slots[inputs->count] = slot;
+		inputs->nodes[inputs->count] = arg;
+		inputs->count++;
+	}
+}
+
+static void startMap(const program* prog, int index, unsigned int reduction) {
+	// An element-wise expression over arrays, such as sin(a)*b + c, is evaluated in one loop over the elements rather than
+	// one per operator, so that no array is made for the intermediate results.  The inputs of the loop, arrays and scalar
+	// subexpressions that aren't single values, are found here, and are emitted as the arguments of its frame
+	mapInputs* inputs = NULL;
+
+	if (!growBuffer(&maps, &mapsCapacity, nrMaps + 1, sizeof(mapInputs))) {
+		error = ERR_OVERFLOW;
+		return;
+	}
+	inputs = &maps[nrMaps];
+	nrMaps++;
+	inputs->reduction = reduction;
+	inputs->count = 0;
+	inputs->arrayMask = 0;
+	collectInputs(prog, index, inputs);
+}
+
+static void finishMap(program* prog, int index) {
+	// Emits INST_MAP after the inputs of its loop, followed by the reduction applied to the values or 0 to keep them as an
+	// array, the number of inputs, a mask of which inputs are arrays, the length of the body, and the body.  The body is
+	// the scalar expression for one element, in which the inputs are locals
+	mapInputs inputs = maps[nrMaps - 1];
+	int bodyStart = 0;
+	int outerDepth = 0;
+	int outerMaxDepth = 0;
+	int nrArrays = 0;
+	int local = nodes[index].local;
+
+	nrMaps--;
+	emitCode(prog, INST_MAP);
+	emitCode(prog, inputs.reduction);
+	emitCode(prog, inputs.count);
+	emitCode(prog, inputs.arrayMask);
+	emitCode(prog, 0);
+	bodyStart = prog->length;
+
+	for (int i = 0; i < inputs.count; i++) {
+		nrArrays += (inputs.arrayMask >> i) & 1;
+	}
+	outerDepth = depth - (inputs.count - nrArrays);
+	outerMaxDepth = maxDepth;
+	arrayDepth -= nrArrays;
+	depth = 0;
+	maxDepth = 0;
+
+	// The node may itself be an input of an enclosing loop, and keeps its local for the body of that one
+	nodes[index].local = -1;
+	emitOperators(prog, index, FRAME_VALUE, true, false);
+	nodes[index].local = local;
+
+	if (maxDepth > deepest) deepest = maxDepth;
+	depth = outerDepth;
+	maxDepth = outerMaxDepth;
+	if (error != NO_ERROR) return;
+	prog->code[bodyStart - 1] = prog->length - bodyStart;
+
+	if (inputs.reduction != 0) {
+		pushValue();
+	}
+	else {
+		pushArrays(1);
+	}
+}
+
+static unsigned int arrayInstruction(unsigned int token) {
+	// solve(A, b) and abs of a complex array have instructions of their own
+	if (token == OP_SOLVE) return OP_LINSOLVE;
+	if (token == OP_ABS) return OP_MAGNITUDE;
+	return token;
+}
+
+static char operationArgument(unsigned int token, int arg) {
+	// Returns the kind of frame emitting an argument of an operation on whole arrays.  Array arguments are left on the
+	// array stack and scalar ones on the value stack
+	token = arrayInstruction(token);
+	if (!takesArray(token, arg)) return FRAME_VALUE;
+	if (token == OP_FFT || token == OP_IFFT || token == OP_REAL || token == OP_IMAG || token == OP_MAGNITUDE) {
+		return FRAME_ARRAY;
+	}
+	return FRAME_REAL_ARRAY;
+}
+
+static void finishArrayOperation(program* prog, int index) {
+	// Emits an operation on whole arrays after its arguments.  It leaves an array or a scalar on its stack
+	node* current = &nodes[index];
+	unsigned int token = arrayInstruction(current->token);
+
+	for (int i = 0; i < current->nrArgs; i++) {
+		if (takesArray(token, i)) {
+			arrayDepth--;
+		}
+		else {
+			depth--;
+		}
+	}
+	emitCode(prog, token);
+	if (token == OP_DOT || token == OP_DET) {
+		pushValue();
+	}
+	else {
+		pushArrays(1);
+	}
+}
+
+static void finishBoundExpression(program* prog, node* current) {
+	// Higher order functions take a variable name, values, an expression in which the name is bound, and optional values:
+	// f(k, a, b, body, c).  The values are emitted first, with defaults for those left out.  Then comes the instruction,
+	// followed by the local k is bound to, the length of the body, and the body.  The body runs on a value stack of its own
+	int bodyStart = 0;
+	int outerDepth = 0;
+	int outerMaxDepth = 0;
+	int index = current->args[0];
+
+	emitCode(prog, current->token);
+	emitCode(prog, nrBound);
+	emitCode(prog, 0);
+	bodyStart = prog->length;
+
+	outerDepth = depth - (nrArguments(current->token) - 2) + 1;
+	outerMaxDepth = maxDepth;
+	depth = 0;
+	maxDepth = 0;
+	boundNames[nrBound] = operandName(nodes[index].token);
+	bindNames(1);
+
+	emitNode(prog, current->args[3]);
+
+	bindNames(-1);
+	if (maxDepth > deepest) deepest = maxDepth;
+	depth = outerDepth;
+	maxDepth = outerMaxDepth;
+	if (error != NO_ERROR) return;
+	prog->code[bodyStart - 1] = prog->length - bodyStart;
+}
+
+static void finishGradient(program* prog, node* current) {
+	// grad(f, x, y, ...) takes an expression and the names it is differentiated by.  The values of the names are emitted
+	// first.  Then comes the instruction, followed by the first of the locals the names are bound to, the number of names,
+	// the length of the body, and the body.  It leaves one partial derivative per name, the first on top
+	int bodyStart = 0;
+	int outerDepth = 0;
+	int outerMaxDepth = 0;
+	int nrNames = current->nrArgs - 1;
+
+	emitCode(prog, current->token);
+	emitCode(prog, nrBound);
+	emitCode(prog, nrNames);
+	emitCode(prog, 0);
+	bodyStart = prog->length;
+
+	outerDepth = depth;
+	outerMaxDepth = maxDepth;
+	depth = 0;
+	maxDepth = 0;
+	for (int i = 1; i <= nrNames; i++) {
+		boundNames[nrBound + i - 1] = operandName(nodes[current->args[i]].token);
+	}
+	bindNames(nrNames);
+
+	emitNode(prog, current->args[0]);
+
+	bindNames(-nrNames);
+	if (maxDepth > deepest) deepest = maxDepth;
+	depth = outerDepth;
+	maxDepth = outerMaxDepth;
+	if (error != NO_ERROR) return;
+	prog->code[bodyStart - 1] = prog->length - bodyStart;
+}
+
+static void finishSampling(program* prog, node* current, bool report) {
+	// montecarlo(N, body) takes the number of samples.  Then comes the instruction, followed by a local that no name
+	// refers to, whether to report on the samples, the length of the body, and the body.  Binding the local makes the
+	// body a bound expression, which is done on doubles and without arrays
+	int bodyStart = 0;
+	int outerDepth = 0;
+	int outerMaxDepth = 0;
+
+	emitCode(prog, current->token);
+	emitCode(prog, nrBound);
+	emitCode(prog, report);
+	emitCode(prog, 0);
+	bodyStart = prog->length;
+
+	outerDepth = depth;
+	outerMaxDepth = maxDepth;
+	depth = 0;
+	maxDepth = 0;
+	boundNames[nrBound] = sampleName;
+	bindNames(1);
+
+	emitNode(prog, current->args[1]);
+
+	bindNames(-1);
+	if (maxDepth > deepest) deepest = maxDepth;
+	depth = outerDepth;
+	maxDepth = outerMaxDepth;
+	if (error != NO_ERROR) return;
+	prog->code[bodyStart - 1] = prog->length - bodyStart;
+}
+
+static void emitFormula(program* prog, int index, int lineNumber) {
+	// Emits INST_DEFINE, followed by the variable it defines, which the caller fills in, the line number, the length of
+	// the expression of the formula, and the expression.  As in the body of montecarlo(), a local no name refers to is
+	// bound, so that the expression is a bound expression, done on doubles and without arrays
+	int bodyStart = 0;
+
+	emitCode(prog, INST_DEFINE);
+	emitCode(prog, 0);
+	emitCode(prog, lineNumber);
+	emitCode(prog, 0);
+	bodyStart = prog->length;
+
+	depth = 0;
+	maxDepth = 0;
+	boundNames[nrBound] = sampleName;
+	bindNames(1);
+
+	emitNode(prog, index);
+
+	bindNames(-1);
+	if (maxDepth > deepest) deepest = maxDepth;
+	depth = 0;
+	maxDepth = 0;
+	if (error != NO_ERROR) return;
+	prog->code[bodyStart - 1] = prog->length - bodyStart;
+}
+
+static bool isPlainOperator(const program* prog, int index, bool body) {
+	// Returns true for scalar operators that are emitted after their arguments, with nothing else to do.  In the body
+	// of an element-wise loop, the element-wise operators of its arrays are too
+	node* current = &nodes[index];
+
+	if (isOperand(current->token) || (body && current->local >= 0)) return false;
+	if (body && !isScalar(typeOf(prog, index))) return true;
+	if (!isScalar(typeOf(prog, index))) return false;
+	if (current->token == OP_SUM || current->token == OP_PROD || current->token == OP_MAX || current->token == OP_MIN
+		|| current->token == OP_DOT || current->token == OP_DET || current->token == OP_GRAD) return false;
+	return !(current->token >= HIGHER_ORDER_OPERATORS && current->token < END_FUNCS);
+}
+
+static char valueKind(node* current) {
+	// Returns the kind of code of a scalar node that is not a plain operator, or FRAME_VALUE for a single value
+	if (((current->token == OP_SUM || current->token == OP_PROD) && current->nrArgs == 1)
+		|| current->token == OP_MAX || current->token == OP_MIN) {
+		return FRAME_REDUCTION;
+	}
+	if (current->token == OP_DOT || current->token == OP_DET) return FRAME_OPERATION;
+	if (current->token == OP_GRAD) return FRAME_GRADIENT;
+	if (current->token == OP_MONTECARLO) return FRAME_SAMPLING;
+	if (current->token >= HIGHER_ORDER_OPERATORS && current->token < END_FUNCS) return FRAME_BOUND;
+	return FRAME_VALUE;
+}
+
+static void emitValue(program* prog, int index) {
+	// Emits the code of a single value: a literal, a variable, or a name bound to a local
+	node* current = &nodes[index];
+	int slot = 0;
+
+	if (isOperand(current->token)) {
+		slot = operandSlot(current->token);
+		if (findBoundName(current->token) >= 0) {
+			emitCode(prog, INST_LOAD_LOCAL);
+			emitCode(prog, findBoundName(current->token));
+		}
+		else if (slot == 0) {
+			emitCode(prog, INST_LOAD_CONST);
+			emitCode(prog, addLiteral(prog, operands[current->token - OPERAND_START].value,
+				&operandNames[operands[current->token - OPERAND_START].name]));
+		}
+		else if (slot > 0) {
+			emitCode(prog, INST_LOAD_VAR);
+			emitCode(prog, slot);
+		}
+		else {
+			unknownName(current->token);
+			return;
+		}
+		depth++;
+		if (depth > maxDepth) maxDepth = depth;
+		return;
+	}
+	error = ERR_SYNTAX;
+}
+
+static void emitIntegerValue(program* prog, int index) {
+	// Emits the code of a value of an expression done on integers: a literal, or a variable holding an integer.  Literals
+	// are kept in the constants bit for bit, and those too large for 64 bits as their text
+	unsigned int token = nodes[index].token;
+	double word = 0.0;
+
+	if (operandSlot(token) == 0 && operands[token - OPERAND_START].big) {
+		emitCode(prog, INST_LOAD_BIG);
+		emitCode(prog, addLiteral(prog, operands[token - OPERAND_START].value,
+			&operandNames[operands[token - OPERAND_START].name]));
+	}
+	else if (operandSlot(token) == 0) {
+		memcpy(&word, &operands[token - OPERAND_START].integer, sizeof(word));
+		emitCode(prog, INST_LOAD_CONST);
+		emitCode(prog, addConstant(prog, word));
+	}
+	else {
+		emitCode(prog, INST_LOAD_INT);
+		emitCode(prog, operandSlot(token));
+	}
+	emittedIntegers = true;
+	pushValue();
+}
+
+static bool startNode(program* prog, int top, bool body, bool integer) {
+	// Starts the code of the node of a frame.  A single value is emitted here.  Other nodes are checked, and their frame
+	// is given the kind of code they have, whose arguments are emitted next.  Returns false once the node is complete, or
+	// on an error
+	int index = 0;
+	node* current = NULL;
+
+	while (error == NO_ERROR) {
+		index = frames[top].index;
+		current = &nodes[index];
+		switch (frames[top].kind) {
+		case FRAME_VALUE:
+			if (!body && !integer && typeOf(prog, index) == TYPE_INT) {
+				// Nested calls on integers have no frames but those of plain operators
+				emitOperators(prog, index, FRAME_VALUE, false, true);
+				emitCode(prog, INST_TO_DOUBLE);
+				return false;
+			}
+			if (isPlainOperator(prog, index, body)) {
+				frames[top].kind = FRAME_OPERATOR;
+				return true;
+			}
+			if (integer) {
+				emitIntegerValue(prog, index);
+				return false;
+			}
+			if (body && current->local >= 0) {
+				emitCode(prog, INST_LOAD_LOCAL);
+				emitCode(prog, current->local);
+				pushValue();
+				return false;
+			}
+			if (!isScalar(typeOf(prog, index))) {
+				// Only the code for arrays can handle an array
+				error = ERR_SYNTAX;
+				return false;
+			}
+			frames[top].kind = valueKind(current);
+			if (frames[top].kind == FRAME_VALUE) {
+				emitValue(prog, index);
+				return false;
+			}
+			// Only a gradient by a single name is a single value
+			if (frames[top].kind == FRAME_GRADIENT && current->nrArgs != 2) error = ERR_SYNTAX;
+			break;
+		case FRAME_REAL_ARRAY:
+			if (typeOf(prog, index) == TYPE_CPLX_RECT_ARR) {
+				error = ERR_SYNTAX;
+				return false;
+			}
+			frames[top].kind = FRAME_ARRAY;
+			break;
+		case FRAME_ARRAY:
+			// Arrays are kept on a stack of their own, since the type of every value is known here
+			if (!arraysAllowed || nrBound > 0 || isScalar(typeOf(prog, index))) {
+				error = ERR_SYNTAX;
+				return false;
+			}
+			if (isOperand(current->token)) {
+				emitCode(prog, INST_LOAD_ARRAY);
+				emitCode(prog, operandSlot(current->token));
+				pushArrays(1);
+				return false;
+			}
+			if (current->token == OP_ARRAY) {
+				frames[top].kind = FRAME_LITERAL;
+				return true;
+			}
+			if (isMapped(prog, index)) {
+				startMap(prog, index, 0);
+				frames[top].kind = FRAME_MAP;
+				return true;
+			}
+			frames[top].kind = FRAME_OPERATION;
+			break;
+		case FRAME_REDUCTION:
+			// An element-wise expression is reduced in the loop evaluating it, and the reduction of a scalar is the scalar
+			// itself.  Either takes the place of the reduction in its frame
+			if (isScalar(typeOf(prog, current->args[0]))) {
+				frames[top].index = current->args[0];
+				frames[top].kind = FRAME_VALUE;
+				break;
+			}
+			if (isMapped(prog, current->args[0])) {
+				if (!arraysAllowed || nrBound > 0) {
+					error = ERR_SYNTAX;
+					return false;
+				}
+				startMap(prog, current->args[0], current->token);
+				frames[top].index = current->args[0];
+				frames[top].kind = FRAME_MAP;
+			}
+			return true;
+		case FRAME_OPERATION:
+			if (isElementwise(arrayInstruction(current->token))) error = ERR_SYNTAX;
+			return true;
+		case FRAME_BOUND:
+			if (current->nrArgs < 4 || !isName(current->args[0])) {
+				error = ERR_SYNTAX;
+			}
+			else if (nrBound >= MAX_LOCALS) {
+				error = ERR_OVERFLOW;
+			}
+			return true;
+		case FRAME_GRADIENT:
+			if (nrBound + current->nrArgs - 1 > MAX_LOCALS) error = ERR_OVERFLOW;
+			for (int i = 1; i < current->nrArgs && error == NO_ERROR; i++) {
+				if (!isName(current->args[i])) error = ERR_SYNTAX;
+			}
+			return true;
+		case FRAME_SAMPLING:
+			if (nrBound >= MAX_LOCALS) error = ERR_OVERFLOW;
+			return true;
+		default:
+			return true;
+		}
+	}
+	return false;
+}
+
+static int nextArgument(program* prog, int top, char* kind) {
+	// Returns the argument of the node of a frame emitted next, and sets the kind of frame emitting it, or returns -1 once
+	// they have all been emitted
+	node* current = &nodes[frames[top].index];
+	int next = frames[top].next;
+
+	*kind = FRAME_VALUE;
+	switch (frames[top].kind) {
+	case FRAME_OPERATOR:
+		if (next >= current->nrArgs) return -1;
+		break;
+	case FRAME_LITERAL:
+		// Literals hold values, or arrays that are the rows of a matrix
+		if (next >= current->nrArgs) return -1;
+		if (typeOf(prog, current->args[0]) == TYPE_DOUBLE_ARR) *kind = FRAME_REAL_ARRAY;
+		break;
+	case FRAME_OPERATION:
+		if (next >= current->nrArgs) return -1;
+		*kind = operationArgument(current->token, next);
+		break;
+	case FRAME_REDUCTION:
+		if (next >= 1) return -1;
+		*kind = FRAME_REAL_ARRAY;
+		break;
+	case FRAME_MAP:
+		if (next >= maps[nrMaps - 1].count) return -1;
+		frames[top].next++;
+		if (!isScalar(typeOf(prog, maps[nrMaps - 1].nodes[next]))) *kind = FRAME_REAL_ARRAY;
+		return maps[nrMaps - 1].nodes[next];
+	case FRAME_BOUND:
+		// The values of f(k, a, b, body, c) come after the name, and around the body.  The optional tolerance is given its
+		// default if it is left out
+		for (next++; next == 3 || (next >= current->nrArgs && next < nrArguments(current->token)); next++) {
+			if (next == 3) continue;
+			emitCode(prog, INST_LOAD_CONST);
+			emitCode(prog, addConstant(prog, DEFAULT_TOLERANCE));
+			pushValue();
+		}
+		frames[top].next = next;
+		return (next < nrArguments(current->token)) ? current->args[next] : -1;
+	case FRAME_GRADIENT:
+		// The names the body is differentiated by
+		if (next + 1 >= current->nrArgs) return -1;
+		frames[top].next++;
+		return current->args[next + 1];
+	case FRAME_SAMPLING:
+		// The number of samples
+		if (next >= 1) return -1;
+		break;
+	default:
+		return -1;
+	}
+	frames[top].next++;
+	return current->args[next];
+}
+
+static void finishNode(program* prog, int top, bool integer) {
+	// Emits the code of the node of a frame after that of its arguments
+	int index = frames[top].index;
+	node* current = &nodes[index];
+
+	switch (frames[top].kind) {
+	case FRAME_OPERATOR:
+		if (integer) emitCode(prog, INST_INT);
+		emitCode(prog, current->token);
+		depth -= current->nrArgs - 1;
+		break;
+	case FRAME_LITERAL:
+		// Literals [a, b, ...] are followed by their length, and by 1 if their elements are the rows of a matrix rather
+		// than values
+		emitCode(prog, OP_ARRAY);
+		emitCode(prog, current->nrArgs);
+		if (typeOf(prog, current->args[0]) == TYPE_DOUBLE_ARR) {
+			emitCode(prog, 1);
+			arrayDepth -= current->nrArgs;
+		}
+		else {
+			emitCode(prog, 0);
+			depth -= current->nrArgs;
+		}
+		pushArrays(1);
+		break;
+	case FRAME_OPERATION:
+		finishArrayOperation(prog, index);
+		break;
+	case FRAME_REDUCTION:
+		emitCode(prog, INST_REDUCE);
+		emitCode(prog, current->token);
+		arrayDepth--;
+		pushValue();
+		break;
+	case FRAME_MAP:
+		finishMap(prog, index);
+		break;
+	case FRAME_BOUND:
+		finishBoundExpression(prog, current);
+		break;
+	case FRAME_GRADIENT:
+		finishGradient(prog, current);
+		break;
+	case FRAME_SAMPLING:
+		finishSampling(prog, current, index == reportedNode);
+		break;
+	}
+}
+
+static void pushFrame(int index, char kind) {
+	if (!growBuffer(&frames, &framesCapacity, nrFrames + 1, sizeof(frame))) {
+		error = ERR_OVERFLOW;
+		return;
+	}
+	frames[nrFrames].index = index;
+	frames[nrFrames].next = -1;
+	frames[nrFrames].kind = kind;
+	nrFrames++;
+}
+
+static void emitOperators(program* prog, int index, char kind, bool body, bool integer) {
+	// Emits the code of a node after the code of each of its arguments, which are walked with a stack of frames rather
+	// than by recursion, so that expressions nested to any depth can be compiled.  A frame is started by startNode(), is
+	// given its arguments one at a time by nextArgument(), and is completed by finishNode().  Bodies are emitted by nested
+	// calls, which push their frames above those of the caller.  Each binds a name, apart from the body of an element-wise
+	// loop, in which inputs are loaded from their locals and nothing else is nested.  Nodes of TYPE_INT, all of whose
+	// arguments are too, are emitted on integers and then converted, unless integer is set, when the value is left as an
+	// integer
+	int base = nrFrames;
+	int mapBase = nrMaps;
+	int top = 0;
+	int arg = 0;
+	char argKind = FRAME_VALUE;
+
+	pushFrame(index, kind);
+	while (nrFrames > base && error == NO_ERROR) {
+		top = nrFrames - 1;
+		if (frames[top].next < 0) {
+			frames[top].next = 0;
+			if (!startNode(prog, top, body, integer)) nrFrames--;
+		}
+		else if ((arg = nextArgument(prog, top, &argKind)) >= 0) {
+			pushFrame(arg, argKind);
+		}
+		else {
+			finishNode(prog, top, integer);
+			nrFrames--;
+		}
+	}
+	if (error != NO_ERROR) {
+		nrFrames = base;
+		nrMaps = mapBase;
+	}
+}
+
+static void emitNode(program* prog, int index) {
+	// Emits the code leaving the value of a scalar node on the value stack, as a double
+	emitOperators(prog, index, FRAME_VALUE, false, false);
+}
+
+static void emitInteger(program* prog, int index) {
+	// Emits the code leaving the value of a node of TYPE_INT on the value stack, as an integer
+	emitOperators(prog, index, FRAME_VALUE, false, true);
+}
+
+static void emitArray(program* prog, int index) {
+	// Emits the code leaving the value of an array node on the array stack
+	emitOperators(prog, index, FRAME_ARRAY, false, false);
+}
+
+static void emitPrint(program* prog, int slot, char type, int lineNumber) {
+	// Prints the value of a variable, which also becomes "ans"
+	if (type == TYPE_INT && !integersAllowed) type = TYPE_DOUBLE;
+	if (type == TYPE_INT) {
+		emitCode(prog, INST_LOAD_INT);
+		emitCode(prog, slot);
+		emitCode(prog, INST_PRINT_INT);
+		emittedIntegers = true;
+	}
+	else {
+		emitCode(prog, isScalar(type) ? INST_LOAD_VAR : INST_LOAD_ARRAY);
+		emitCode(prog, slot);
+		emitCode(prog, isScalar(type) ? INST_PRINT : INST_PRINT_ARRAY);
+	}
+	emitCode(prog, lineNumber);
+	if (maxDepth < 1) maxDepth = 1;
+	setVariableType(prog, ANS_ADDR, type);
+}
+
+static void compileStatement(program* prog, int root, int lineNumber, int printMode) {
+	// Emits an assignment, the definition of a formula, or an expression whose value is the result of the statement
+	int target = 0;
+	int slot = 0;
+	int definition = 0;
+	char type = TYPE_DOUBLE;
+
+	if (nodes[root].token == INST_ASSIGN_VAL) {
+		// The left side of an assignment must be a lone variable name that is not a constant
+		target = nodes[root].args[0];
+		if (!isName(target)) {
+			error = ERR_SYNTAX;
+			return;
+		}
+		type = typeOf(prog, nodes[root].args[1]);
+		if (type == TYPE_INT) {
+			emitInteger(prog, nodes[root].args[1]);
+		}
+		else if (!isScalar(type)) {
+			emitArray(prog, nodes[root].args[1]);
+		}
+		else {
+			emitNode(prog, nodes[root].args[1]);
+		}
+		if (error != NO_ERROR) return;
+
+		slot = operandSlot(nodes[target].token);
+		if (slot < 0) {
+			// The name refers to the new variable from now on, also if the statement is compiled again
+			slot = addVariable(operandName(nodes[target].token));
+			if (error != NO_ERROR) return;
+			operands[nodes[target].token - OPERAND_START].source = slot;
+		}
+		else if (slot != ANS_ADDR && slot < USER_VAR_START) {
+			error = ERR_SYNTAX;
+			return;
+		}
+		emitCode(prog, (type == TYPE_INT) ? INST_ASSIGN_INT : isScalar(type) ? INST_ASSIGN_VAL : INST_ASSIGN_ARRAY);
+		emitCode(prog, slot);
+		emitCode(prog, lineNumber);
+		setVariableType(prog, slot, type);
+		if (printMode & PRINT_ASSIGNMENTS) {
+			emitPrint(prog, slot, type, lineNumber);
+		}
+	}
+	else if (nodes[root].token == INST_DEFINE) {
+		// A formula gives the variable the value of the expression, and again whenever a variable the expression reads
+		// is changed.  "ans" changes with every line, so a formula can't read it.  The nodes of the expression come
+		// between the name and its root
+		target = nodes[root].args[0];
+		if (!isName(target)) {
+			error = ERR_SYNTAX;
+			return;
+		}
+		for (int i = target + 1; i <= nodes[root].args[1]; i++) {
+			if (isOperand(nodes[i].token) && operandSlot(nodes[i].token) == ANS_ADDR) {
+				error = ERR_SYNTAX;
+				return;
+			}
+		}
+		definition = prog->length;
+		emitFormula(prog, nodes[root].args[1], lineNumber);
+		if (error != NO_ERROR) return;
+
+		slot = operandSlot(nodes[target].token);
+		if (slot < 0) {
+			slot = addVariable(operandName(nodes[target].token));
+			if (error != NO_ERROR) return;
+			operands[nodes[target].token - OPERAND_START].source = slot;
+		}
+		else if (slot < USER_VAR_START) {
+			error = ERR_SYNTAX;
+			return;
+		}
+		prog->code[definition + 1] = slot;
+		setVariableType(prog, slot, TYPE_DOUBLE);
+		if (printMode & PRINT_ASSIGNMENTS) {
+			emitPrint(prog, slot, TYPE_DOUBLE, lineNumber);
+		}
+	}
+	else if (nodes[root].token == KW_DEL) {
+		// The name stops referring to the variable for the statements compiled after this one, and the variable
+		// itself is deleted when the statement runs
+		target = nodes[root].args[0];
+		if (!isName(target)) {
+			error = ERR_SYNTAX;
+			return;
+		}
+		slot = operandSlot(nodes[target].token);
+		if (slot < 0) {
+			unknownName(nodes[target].token);
+			return;
+		}
+		if (slot < USER_VAR_START) {
+			error = ERR_SYNTAX;
+			return;
+		}
+		if (printMode & PRINT_ASSIGNMENTS) {
+			emitPrint(prog, slot, variableType(prog, slot), lineNumber);
+		}
+		emitCode(prog, INST_DELETE);
+		emitCode(prog, slot);
+		unbindVariable(operandName(nodes[target].token));
+	}
+	else if (nodes[root].token == OP_GRAD && nodes[root].nrArgs > 2) {
+		// A gradient by several names prints all its partial derivatives but the last, which is the statement's value
+		emitOperators(prog, root, FRAME_GRADIENT, false, false);
+		if (error != NO_ERROR) return;
+		for (int i = 2; i < nodes[root].nrArgs; i++) {
+			emitCode(prog, INST_PRINT);
+			emitCode(prog, lineNumber);
+		}
+		if (printMode & PRINT_RESULTS) {
+			emitCode(prog, INST_PRINT);
+			emitCode(prog, lineNumber);
+		}
+		setVariableType(prog, ANS_ADDR, TYPE_DOUBLE);
+	}
+	else if (!isScalar(typeOf(prog, root))) {
+		// An array has nowhere to go but the terminal
+		emitArray(prog, root);
+		if (error != NO_ERROR) return;
+		emitCode(prog, INST_PRINT_ARRAY);
+		emitCode(prog, lineNumber);
+		setVariableType(prog, ANS_ADDR, typeOf(prog, root));
+	}
+	else if (typeOf(prog, root) == TYPE_INT) {
+		// An integer is printed exactly.  One that isn't printed is left as the value of the statement
+		emitInteger(prog, root);
+		if (error != NO_ERROR) return;
+		if (printMode & PRINT_RESULTS) {
+			emitCode(prog, INST_PRINT_INT);
+			emitCode(prog, lineNumber);
+			setVariableType(prog, ANS_ADDR, TYPE_INT);
+		}
+		else {
+			emitCode(prog, INST_TO_DOUBLE);
+		}
+	}
+	else {
+		reportedNode = (nodes[root].token == OP_MONTECARLO && (printMode & PRINT_RESULTS)) ? root : -1;
+		emitNode(prog, root);
+		reportedNode = -1;
+		if (error != NO_ERROR) return;
+		if (printMode & PRINT_RESULTS) {
+			emitCode(prog, INST_PRINT);
+			emitCode(prog, lineNumber);
+			setVariableType(prog, ANS_ADDR, TYPE_DOUBLE);
+		}
+	}
+}
+
+static void compileOnDoubles(program* prog, int root, int lineNumber, int printMode, int start) {
+	// A statement that was emitted on integers, after INST_TRY_INT at start, is emitted again on doubles after it, for
+	// when its values don't fit.  The version on integers ends by jumping over it.  The types the statement gives
+	// variables are those of the version on integers, which is the one that normally runs
+	int nrChanges = nrTypeChanges;
+	typeChange changes[MAX_TYPE_CHANGES];
+	int fallbackStart = 0;
+
+	emitCode(prog, INST_JUMP);
+	emitCode(prog, 0);
+	fallbackStart = prog->length;
+	prog->code[start + 1] = fallbackStart - (start + 2);
+
+	memcpy(changes, typeChanges, sizeof(changes));
+	for (int i = nrChanges - 1; i >= 0; i--) prog->types[changes[i].slot] = changes[i].before;
+	integersAllowed = false;
+	bindingEpoch++;
+	depth = 0;
+	arrayDepth = 0;
+	compileStatement(prog, root, lineNumber, printMode);
+	integersAllowed = true;
+	if (error != NO_ERROR) return;
+
+	prog->code[fallbackStart - 1] = prog->length - fallbackStart;
+	for (int i = 0; i < nrChanges; i++) prog->types[changes[i].slot] = changes[i].after;
+	bindingEpoch++;
+}
+
+void compileLine(program* prog, int lineNumber, int printMode) {
+	// Appends the line in expressionRPN to a program as one statement.  Variables are resolved to their slots here,
+	// and assignments to new names define them, so that later lines can refer to them.  printMode holds PRINT_RESULTS
+	// and PRINT_ASSIGNMENTS flags.  A statement with integers in it starts with INST_TRY_INT, followed by the length of
+	// its version on integers, and is emitted a second time on doubles by compileOnDoubles()
+	int root = buildTree();
+	int start = prog->length;
+	int nrConstants = prog->nrConstants;
+	int textLength = prog->textLength;
+
+	if (error != NO_ERROR || root < 0) return;
+	depth = 0;
+	maxDepth = 0;
+	deepest = 0;
+	arrayDepth = 0;
+	arraysAllowed = true;
+	integersAllowed = true;
+	emittedIntegers = false;
+	nrTypeChanges = 0;
+	nrBound = 0;
+	nrFrames = 0;
+	nrMaps = 0;
+
+	emitCode(prog, INST_TRY_INT);
+	emitCode(prog, 0);
+	compileStatement(prog, root, lineNumber, printMode);
+	if (error == NO_ERROR && emittedIntegers) {
+		compileOnDoubles(prog, root, lineNumber, printMode, start);
+	}
+	else if (error == NO_ERROR) {
+		// Nothing was done on integers, so there is nothing to fall back from
+		memmove(&prog->code[start], &prog->code[start + 2], (prog->length - start - 2) * sizeof(unsigned int));
+		prog->length -= 2;
+	}
+	arraysAllowed = false;
+	integersAllowed = false;
+	if (maxDepth > deepest) {
+		deepest = maxDepth;
+	}
+
+	if (error != NO_ERROR) {
+		// Discard whatever part of the statement was emitted
+		prog->length = start;
+		prog->nrConstants = nrConstants;
+		prog->textLength = textLength;
+	}
+	else if (deepest > prog->stackDepth) {
+		prog->stackDepth = deepest;
+	}
+}
+
+// Compiles text holding a single expression, in which the given names are bound to locals 0, 1, ... in order.
+// Used to compile expressions given on the command line, which are then run with executeCode() or executeBatch()
+void compileExpression(program* prog, char text[], char* names[], int nrNames) {
+
+	double printVal = 0.0;
+	int root = -1;
+	int length = 0;
+
+	resetValues(&printVal);
+	while (text[length] != '\0' && text[length] != '\n') length++;
+	if (nrNames > MAX_LOCALS || !reserveInput(length + 2)) {
+		error = ERR_OVERFLOW;
+		return;
+	}
+	for (int i = 0; i < length; i++) {
+		terminalInput[i] = text[i];
+	}
+	terminalInput[length] = '\n';
+	terminalInput[length + 1] = '\0';
+
+	inputToRPN();
+	if (error == NO_ERROR) root = buildTree();
+	if (error != NO_ERROR) return;
+	if (root < 0 || nodes[root].token == INST_ASSIGN_VAL || nodes[root].token == INST_DEFINE) {
+		error = ERR_SYNTAX;
+		return;
+	}
+
+	depth = 0;
+	maxDepth = 0;
+	deepest = 0;
+	nrFrames = 0;
+	nrMaps = 0;
+	nrBound = 0;
+	integersAllowed = false;
+	for (int i = 0; i < nrNames; i++) {
+		boundNames[i] = names[i];
+	}
+	bindNames(nrNames);
+	emitNode(prog, root);
+	bindNames(-nrBound);
+
+	if (maxDepth > deepest) deepest = maxDepth;
+	if (deepest > prog->stackDepth) prog->stackDepth = deepest;
+}
\ No newline at end of file
@@ -0,0 +1,461 @@
+#define _POSIX_C_SOURCE 200112L  // mmap and posix_madvise
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "compile.h"
+#include "execute.h"
+#include "parallel.h"
+#include "aggregate.h"
+#include "csv.h"
+#include "global.h"
+
+#define CSV_CHUNK_SIZE (1 << 20)  // Bytes of the file parsed by one task
+#define CSV_CHUNKS 64             // Tasks run between two writes of the output
+#define MAX_EXPRESSIONS 64
+#define NUMBER_WIDTH 25           // Longest number printed with "%.17g", and a separator
+
+typedef struct {
+	char* text;
+	long long int length;
+	long long int capacity;
+} outputBuffer;
+
+typedef struct {
+	const program* prog;
+	const char* data;                // The whole file
+	long long int dataStart;         // First byte after the header
+	long long int dataEnd;
+	long long int roundStart;        // First byte of the current round of chunks
+	int nrColumns;                   // Columns in the header
+	int columnLocal[MAX_LOCALS * 4]; // Local each column is parsed into, or -1 if no expression uses it
+	int nrLocals;
+	int nrExpressions;
+	int bodyStart[MAX_EXPRESSIONS];
+	int bodyEnd[MAX_EXPRESSIONS];
+	bool binary;
+	outputBuffer outputs[CSV_CHUNKS];
+	aggregate* stats;                // With --stats, aggregates of each expression for each chunk of a round
+} csvTask;
+
+static const double powersOfTen[23] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static double parseNumber(const char* start, const char* end) {
+	// Converts a field to a double.  Numbers of up to 15 significant digits with small exponents are exact products or
+	// quotients of two doubles, so they are converted directly.  Others fall back to strtod.  Fields that are not
+	// numbers give NaN
+	const char* p = start;
+	unsigned long long int mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	int exponentValue = 0;
+	bool negative = false;
+	bool exponentNegative = false;
+	char holder[64];
+	char* parsed;
+	double value = 0.0;
+
+	while (p < end && *p == ' ') p++;
+	while (end > p && (end[-1] == ' ' || end[-1] == '\r')) end--;
+	start = p;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = (*p == '-');
+		p++;
+	}
+	if (p == end) return NAN;
+
+	while (p < end && *p >= '0' && *p <= '9') {
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			if (mantissa > 0) digits++;
+		}
+		else {
+			exponent++;
+		}
+		p++;
+	}
+	if (p < end && *p == '.') {
+		p++;
+		while (p < end && *p >= '0' && *p <= '9') {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa > 0) digits++;
+				exponent--;
+			}
+			p++;
+		}
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		p++;
+		if (p < end && (*p == '-' || *p == '+')) {
+			exponentNegative = (*p == '-');
+			p++;
+		}
+		if (p == end) return NAN;
+		while (p < end && *p >= '0' && *p <= '9') {
+			if (exponentValue < 100000) exponentValue = exponentValue * 10 + (*p - '0');
+			p++;
+		}
+		exponent += exponentNegative ? -exponentValue : exponentValue;
+	}
+
+	if (p == end && digits <= 15 && exponent >= -22 && exponent <= 22) {
+		value = (double)mantissa;
+		value = (exponent < 0) ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+		return negative ? -value : value;
+	}
+
+	// Slow path: too many digits, a large exponent, or something else such as "inf"
+	if (end - start >= (long long int)sizeof(holder)) return NAN;
+	memcpy(holder, start, end - start);
+	holder[end - start] = '\0';
+	value = strtod(holder, &parsed);
+	return (parsed == holder + (end - start) && parsed != holder) ? value : NAN;
+}
+
+static const char* skipField(const char* p, const char* end) {
+	// Returns the end of the field starting at p: the next comma or line ending outside of quotes
+	bool quoted = false;
+
+	while (p < end && (quoted || (*p != ',' && *p != '\n'))) {
+		if (*p == '"') quoted = !quoted;
+		p++;
+	}
+	return p;
+}
+
+static void appendOutput(outputBuffer* output, const void* data, long long int length) {
+	// Appends to a chunk's output, growing it as needed
+	long long int capacity = output->capacity;
+	char* text = output->text;
+
+	if (output->length + length > capacity) {
+		while (output->length + length > capacity) capacity = (capacity > 0) ? 2 * capacity : CSV_CHUNK_SIZE;
+		text = realloc(output->text, capacity);
+		if (text == NULL) return;
+		output->text = text;
+		output->capacity = capacity;
+	}
+	memcpy(output->text + output->length, data, length);
+	output->length += length;
+}
+
+static void evaluateRows(csvTask* task, const double* lanes[], int count, double* workspace, outputBuffer* output) {
+	// Evaluates every expression for a batch of parsed rows and appends the derived columns to the output
+	double results[MAX_EXPRESSIONS][BATCH_SIZE];
+	double locals[MAX_LOCALS] = { 0 };
+	double row[MAX_EXPRESSIONS];
+	char line[MAX_EXPRESSIONS * NUMBER_WIDTH + 1];
+	int length = 0;
+
+	for (int e = 0; e < task->nrExpressions; e++) {
+		executeBatch(task->prog, task->bodyStart[e], task->bodyEnd[e], locals, lanes, count, results[e], workspace);
+	}
+	if (task->stats != NULL) {
+		for (int e = 0; e < task->nrExpressions; e++) {
+			addValues(&task->stats[(output - task->outputs) * task->nrExpressions + e], results[e], count, 1);
+		}
+		return;
+	}
+	for (int j = 0; j < count; j++) {
+		if (task->binary) {
+			for (int e = 0; e < task->nrExpressions; e++) row[e] = results[e][j];
+			appendOutput(output, row, task->nrExpressions * sizeof(double));
+		}
+		else {
+			length = 0;
+			for (int e = 0; e < task->nrExpressions; e++) {
+				length += sprintf(line + length, (e > 0) ? ",%.17g" : "%.17g", results[e][j]);
+			}
+			line[length++] = '\n';
+			appendOutput(output, line, length);
+		}
+	}
+}
+
+static void csvChunk(void* context, int index) {
+	// Parses the rows that start in one chunk of the file, a batch of rows at a time, straight into one lane array per
+	// column in use, and evaluates the expressions on each batch
+	csvTask* task = context;
+	long long int start = task->roundStart + (long long int)index * CSV_CHUNK_SIZE;
+	long long int end = start + CSV_CHUNK_SIZE;
+	const char* p;
+	const char* limit;
+	const char* fileEnd = task->data + task->dataEnd;
+	const char* fieldEnd;
+	double columns[MAX_LOCALS][BATCH_SIZE];
+	const double* lanes[MAX_LOCALS] = { NULL };
+	int count = 0;
+	int column = 0;
+	outputBuffer* output = &task->outputs[index];
+	double* workspace = malloc(task->prog->stackDepth * BATCH_SIZE * sizeof(double));
+
+	output->length = 0;
+	if (workspace == NULL || start >= task->dataEnd) {
+		free(workspace);
+		return;
+	}
+	if (end > task->dataEnd) end = task->dataEnd;
+	for (int i = 0; i < task->nrLocals; i++) lanes[i] = columns[i];
+
+	// Rows belong to the chunk their first byte is in
+	p = task->data + start;
+	if (start > task->dataStart && p[-1] != '\n') {
+		while (p < fileEnd && *p != '\n') p++;
+		p++;
+	}
+	limit = task->data + end;
+
+	while (p < limit) {
+		if (*p == '\n' || (*p == '\r' && p + 1 < fileEnd && p[1] == '\n')) {
+			// Blank line
+			p += (*p == '\r') ? 2 : 1;
+			continue;
+		}
+		for (int i = 0; i < task->nrLocals; i++) columns[i][count] = NAN;
+		for (column = 0; p < fileEnd; column++) {
+			fieldEnd = skipField(p, fileEnd);
+			if (column < task->nrColumns && task->columnLocal[column] >= 0) {
+				columns[task->columnLocal[column]][count] = parseNumber(p, fieldEnd);
+			}
+			p = fieldEnd + 1;
+			if (fieldEnd >= fileEnd || *fieldEnd == '\n') break;
+		}
+		count++;
+		if (count == BATCH_SIZE) {
+			evaluateRows(task, lanes, count, workspace, output);
+			count = 0;
+		}
+	}
+	if (count > 0) {
+		evaluateRows(task, lanes, count, workspace, output);
+	}
+	free(workspace);
+}
+
+static bool usesName(const char* expression, const char* name) {
+	// Returns true if a name appears in an expression as a whole word
+	size_t length = strlen(name);
+	const char* p = expression;
+
+	while ((p = strstr(p, name)) != NULL) {
+		bool before = (p > expression) && (isalnum((unsigned char)p[-1]) || p[-1] == '_');
+		bool after = isalnum((unsigned char)p[length]) || p[length] == '_';
+		if (!before && !after) return true;
+		p += length;
+	}
+	return false;
+}
+
+// Evaluates expressions over every row of a CSV file, started as
+//   clc --csv data.csv "expression" ["name=expression" ...] [--binary file | --stats]
+// The column names in the header line are bound to the values in each row.  The file is memory mapped and split into
+// chunks that are parsed and evaluated in parallel, a round of chunks at a time, so memory use doesn't depend on the
+// size of the file.  Only the columns the expressions use are parsed.  The derived columns are written as CSV, or as
+// raw doubles, row by row, with --binary.  With --stats only summary statistics of each derived column are printed.
+// Each chunk of a round aggregates into its own slot, and the slots are merged in order at the end
+int runCsv(int argc, char* argv[]) {
+
+	program prog;
+	csvTask task;
+	char* expressions[MAX_EXPRESSIONS];
+	char headers[MAX_EXPRESSIONS][INPUT_HOLDER_SIZE];
+	char names[MAX_LOCALS][INPUT_HOLDER_SIZE];
+	char* nameList[MAX_LOCALS];
+	char name[INPUT_HOLDER_SIZE];
+	char* fileName = NULL;
+	char* binaryName = NULL;
+	FILE* out = stdout;
+	struct stat info;
+	int file = -1;
+	char* data = MAP_FAILED;
+	const char* p;
+	const char* fieldEnd;
+	int length = 0;
+	int nrChunks = 0;
+	int status = 0;
+	bool identifier = false;
+	bool stats = false;
+
+	task.nrExpressions = 0;
+	task.nrLocals = 0;
+	task.nrColumns = 0;
+	for (int i = 0; i < argc; i++) {
+		if (strcmp(argv[i], "--binary") == 0 && i + 1 < argc) {
+			binaryName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--stats") == 0) {
+			stats = true;
+		}
+		else if (fileName == NULL) {
+			fileName = argv[i];
+		}
+		else if (task.nrExpressions < MAX_EXPRESSIONS) {
+			// "name=expression" names the derived column, otherwise it is named by the expression
+			p = strchr(argv[i], '=');
+			identifier = (p != NULL && p > argv[i] && p - argv[i] < INPUT_HOLDER_SIZE && isalpha((unsigned char)argv[i][0]));
+			for (const char* c = argv[i]; identifier && c < p; c++) {
+				identifier = isalnum((unsigned char)*c) || *c == '_';
+			}
+			length = identifier ? (int)(p - argv[i]) : 0;
+			memcpy(headers[task.nrExpressions], argv[i], length);
+			headers[task.nrExpressions][length] = '\0';
+			expressions[task.nrExpressions] = identifier ? (char*)p + 1 : argv[i];
+			task.nrExpressions++;
+		}
+		else {
+			printf("  Too many expressions\n");
+			return 1;
+		}
+	}
+	if (fileName == NULL || task.nrExpressions == 0) {
+		printf("  Expected a file and at least one expression\n");
+		return 1;
+	}
+
+	file = open(fileName, O_RDONLY);
+	if (file < 0 || fstat(file, &info) != 0 || info.st_size == 0) {
+		printf("  Could not read %s\n", fileName);
+		if (file >= 0) close(file);
+		return 1;
+	}
+	data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED) {
+		printf("  Could not read %s\n", fileName);
+		return 1;
+	}
+	posix_madvise(data, info.st_size, POSIX_MADV_SEQUENTIAL);
+	task.data = data;
+	task.dataEnd = info.st_size;
+
+	// Header: bind the columns the expressions use to locals, in order
+	p = data;
+	while (p < data + info.st_size && *p != '\n' && status == 0) {
+		fieldEnd = skipField(p, data + info.st_size);
+		while (p < fieldEnd && (*p == ' ' || *p == '"')) p++;
+		length = (int)(fieldEnd - p);
+		while (length > 0 && (p[length - 1] == ' ' || p[length - 1] == '"' || p[length - 1] == '\r')) length--;
+
+		if (task.nrColumns >= MAX_LOCALS * 4) {
+			// Columns beyond this are never read
+			break;
+		}
+		task.columnLocal[task.nrColumns] = -1;
+		if (length > 0 && length < INPUT_HOLDER_SIZE) {
+			memcpy(name, p, length);
+			name[length] = '\0';
+			for (int e = 0; e < task.nrExpressions; e++) {
+				if (!usesName(expressions[e], name)) continue;
+				if (task.nrLocals >= MAX_LOCALS) {
+					printf("  Expressions use more than %d columns\n", MAX_LOCALS);
+					status = 1;
+					break;
+				}
+				memcpy(names[task.nrLocals], name, length + 1);
+				nameList[task.nrLocals] = names[task.nrLocals];
+				task.columnLocal[task.nrColumns] = task.nrLocals;
+				task.nrLocals++;
+				break;
+			}
+		}
+		task.nrColumns++;
+		p = (fieldEnd < data + info.st_size && *fieldEnd == ',') ? fieldEnd + 1 : fieldEnd;
+	}
+	while (p < data + info.st_size && *p != '\n') p++;
+	task.dataStart = (p < data + info.st_size) ? p + 1 - data : info.st_size;
+
+	// Compile the expressions one after another into one program
+	initProgram(&prog);
+	for (int e = 0; e < task.nrExpressions && status == 0; e++) {
+		task.bodyStart[e] = prog.length;
+		compileExpression(&prog, expressions[e], nameList, task.nrLocals);
+		task.bodyEnd[e] = prog.length;
+		if (error != NO_ERROR) {
+			printf("  %s:", expressions[e]);
+			printError();
+			status = 1;
+		}
+	}
+
+	task.stats = NULL;
+	if (status == 0 && stats) {
+		binaryName = NULL;
+		task.stats = malloc(CSV_CHUNKS * task.nrExpressions * sizeof(aggregate));
+		if (task.stats == NULL) {
+			printf("  Overflow error\n");
+			status = 1;
+		}
+		for (int i = 0; status == 0 && i < CSV_CHUNKS * task.nrExpressions; i++) initAggregate(&task.stats[i]);
+	}
+	if (status == 0 && binaryName != NULL) {
+		out = fopen(binaryName, "wb");
+		if (out == NULL) {
+			printf("  Could not open %s\n", binaryName);
+			status = 1;
+		}
+	}
+
+	if (status == 0) {
+		task.prog = &prog;
+		task.binary = (binaryName != NULL);
+		for (int i = 0; i < CSV_CHUNKS; i++) {
+			task.outputs[i].text = NULL;
+			task.outputs[i].length = 0;
+			task.outputs[i].capacity = 0;
+		}
+		if (!task.binary && !stats) {
+			for (int e = 0; e < task.nrExpressions; e++) {
+				if (headers[e][0] != '\0') printf((e > 0) ? ",%s" : "%s", headers[e]);
+				else printf((e > 0) ? ",\"%s\"" : "\"%s\"", expressions[e]);
+			}
+			printf("\n");
+		}
+
+		// Rounds of chunks are parsed in parallel, then written in order
+		for (task.roundStart = task.dataStart; task.roundStart < task.dataEnd;
+			task.roundStart += (long long int)CSV_CHUNKS * CSV_CHUNK_SIZE) {
+			nrChunks = (int)((task.dataEnd - task.roundStart + CSV_CHUNK_SIZE - 1) / CSV_CHUNK_SIZE);
+			if (nrChunks > CSV_CHUNKS) nrChunks = CSV_CHUNKS;
+			parallelFor(nrChunks, csvChunk, &task);
+			for (int i = 0; i < nrChunks; i++) {
+				fwrite(task.outputs[i].text, 1, task.outputs[i].length, out);
+			}
+		}
+
+		if (stats) {
+			printStatsHeader();
+			for (int e = 0; e < task.nrExpressions; e++) {
+				for (int i = 1; i < CSV_CHUNKS; i++) {
+					mergeAggregate(&task.stats[e], &task.stats[i * task.nrExpressions + e]);
+				}
+				if (headers[e][0] != '\0') printStats(headers[e], &task.stats[e]);
+				else {
+					// Quoted, since expressions can hold commas
+					snprintf(name, INPUT_HOLDER_SIZE, "\"%.*s\"", INPUT_HOLDER_SIZE - 3, expressions[e]);
+					printStats(name, &task.stats[e]);
+				}
+				freeAggregate(&task.stats[e]);
+			}
+		}
+
+		for (int i = 0; i < CSV_CHUNKS; i++) free(task.outputs[i].text);
+		if (out != stdout) fclose(out);
+	}
+	free(task.stats);
+
+	freeProgram(&prog);
+	munmap(data, info.st_size);
+	return status;
+}
\ No newline at end of file
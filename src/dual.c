@@ -0,0 +1,492 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "rpn.h"
+#include "compile.h"
+#include "execute.h"
+#include "dual.h"
+#include "variables.h"
+#include "random.h"
+#include "global.h"
+
+// Locals of an expression evaluated with dual numbers.  Each value carries one tangent per name the expression is
+// differentiated by
+typedef struct {
+	int nrTangents;
+	double values[MAX_LOCALS];
+	double tangents[MAX_LOCALS][MAX_LOCALS];
+	bool varies[MAX_LOCALS];  // False if all tangents of a local are zero
+} dualLocals;
+
+static double digamma(double x) {
+	// Derivative of lgamma(x), by the recurrence psi(x) = psi(x + 1) - 1/x and the asymptotic series for large x
+	double result = 0.0;
+	double inverse, square;
+
+	if (x <= 0.0 && x == floor(x)) return NAN;
+	if (x < 0.0) {
+		// Reflection formula
+		return digamma(1.0 - x) - pi / tan(pi * x);
+	}
+	while (x < 6.0) {
+		result -= 1.0 / x;
+		x += 1.0;
+	}
+	inverse = 1.0 / x;
+	square = inverse * inverse;
+	return result + log(x) - 0.5 * inverse
+		- square * (1.0 / 12 - square * (1.0 / 120 - square * (1.0 / 252 - square * (1.0 / 240 - square / 132))));
+}
+
+static void binaryPartials(unsigned int operand, double left, double right, double result, double* dLeft, double* dRight) {
+	// Finds the partial derivatives of a two-input operator by each input.  Operators that only take whole numbers or
+	// give truth values are flat, with derivatives of zero
+	double sum = 0.0;
+
+	*dLeft = 0.0;
+	*dRight = 0.0;
+	switch (operand) {
+	case OP_ADD:
+		*dLeft = 1.0;
+		*dRight = 1.0;
+		break;
+	case OP_SUB:
+		*dLeft = 1.0;
+		*dRight = -1.0;
+		break;
+	case OP_MUL:
+		*dLeft = right;
+		*dRight = left;
+		break;
+	case OP_DIV:
+		*dLeft = 1.0 / right;
+		*dRight = -result / right;
+		break;
+	case OP_EXP:
+		*dLeft = (right == 0.0) ? 0.0 : right * pow(left, right - 1.0);
+		*dRight = (left == 0.0 && right > 0.0) ? 0.0 : result * log(left);
+		break;
+	case OP_LOG:
+		*dLeft = -result / (left * log(left));
+		*dRight = 1.0 / (right * log(left));
+		break;
+	case OP_ROOT:
+		*dLeft = -result * log(right) / (left * left);
+		*dRight = result / (left * right);
+		break;
+	case OP_HYPOT:
+		*dLeft = left / result;
+		*dRight = right / result;
+		break;
+	case OP_ATAN2:
+		sum = left * left + right * right;
+		*dLeft = right / sum;
+		*dRight = -left / sum;
+		break;
+	case OP_REQLL:
+		sum = (left + right) * (left + right);
+		*dLeft = right * right / sum;
+		*dRight = left * left / sum;
+		break;
+	case OP_PERR:
+		*dLeft = 100 * applyUnaryOperator(OP_SIGN, left - right) / right;
+		*dRight = -(*dLeft) - result / right;
+		if (left == right) *dLeft = *dRight = 0.0;
+		break;
+	case OP_UNIFORM:
+		// A draw moves with its parameters: a + (b - a)u for the u it drew, and mu + sigma z for the z
+		*dRight = (right == left) ? 0.5 : (result - left) / (right - left);
+		*dLeft = 1.0 - *dRight;
+		break;
+	case OP_NORMAL:
+		*dLeft = 1.0;
+		*dRight = (right == 0.0) ? 0.0 : (result - left) / right;
+		break;
+	case OP_LOGNORMAL:
+		*dLeft = result;
+		*dRight = (right == 0.0) ? 0.0 : result * (log(result) - left) / right;
+		break;
+	default:
+		break;
+	}
+}
+
+static double unaryDerivative(unsigned int operand, double value, double result) {
+	// Returns the derivative of a single-input operator at a value, given the operator's result there
+	switch (operand) {
+	case OP_NEG:
+		return -1.0;
+	case OP_ABS:
+		return (value > 0.0) ? 1.0 : (value < 0.0) ? -1.0 : 0.0;
+	case OP_LN:
+		return 1.0 / value;
+	case OP_LOG10:
+		return 1.0 / (value * log(10.0));
+	case OP_LOG2:
+		return 1.0 / (value * log(2.0));
+	case OP_SQRT:
+		return 0.5 / result;
+	case OP_CBRT:
+		return 1.0 / (3.0 * result * result);
+	case OP_SIN:
+		return cos(value);
+	case OP_COS:
+		return -sin(value);
+	case OP_TAN:
+		return 1.0 + result * result;
+	case OP_SEC:
+		return result * tan(value);
+	case OP_CSC:
+		return -result / tan(value);
+	case OP_COT:
+		return -(1.0 + result * result);
+	case OP_ASIN:
+		return 1.0 / sqrt(1.0 - value * value);
+	case OP_ACOS:
+		return -1.0 / sqrt(1.0 - value * value);
+	case OP_ATAN:
+		return 1.0 / (1.0 + value * value);
+	case OP_ASEC:
+		return 1.0 / (fabs(value) * sqrt(value * value - 1.0));
+	case OP_ACSC:
+		return -1.0 / (fabs(value) * sqrt(value * value - 1.0));
+	case OP_ACOT:
+		return -1.0 / (1.0 + value * value);
+	case OP_SINH:
+		return cosh(value);
+	case OP_COSH:
+		return sinh(value);
+	case OP_TANH:
+		return 1.0 - result * result;
+	case OP_SECH:
+		return -result * tanh(value);
+	case OP_CSCH:
+		return -result / tanh(value);
+	case OP_COTH:
+		return 1.0 - result * result;
+	case OP_ASINH:
+		return 1.0 / sqrt(value * value + 1.0);
+	case OP_ACOSH:
+		return 1.0 / sqrt(value * value - 1.0);
+	case OP_ATANH:
+		return 1.0 / (1.0 - value * value);
+	case OP_ASECH:
+		return -1.0 / (value * sqrt(1.0 - value * value));
+	case OP_ACSCH:
+		return -1.0 / (fabs(value) * sqrt(1.0 + value * value));
+	case OP_ACOTH:
+		return 1.0 / (1.0 - value * value);
+	case OP_SINC:
+		return (value == 0.0) ? 0.0 : (cos(value) - result) / value;
+	case OP_NSINC:
+		return (value == 0.0) ? 0.0 : (cos(pi * value) - result) / value;
+	case OP_ERF:
+		return 2.0 / sqrt(pi) * exp(-value * value);
+	case OP_ERFC:
+		return -2.0 / sqrt(pi) * exp(-value * value);
+	case OP_GAMMA:
+		return result * digamma(value);
+	case OP_LGAMMA:
+		return digamma(value);
+	case OP_FACTORIAL:
+		return result * digamma(value + 1.0);
+	case OP_DEG:
+		return RAD_TO_DEG_CONST;
+	case OP_RAD:
+		return DEG_TO_RAD_CONST;
+	default:
+		// Rounding, sign, and logic are flat
+		return 0.0;
+	}
+}
+
+static bool dependsOnTangents(const program* prog, int start, int end, const dualLocals* locals) {
+	// Returns true if code reads a local that carries tangents, including from the bodies of functions nested in it
+	unsigned int instruction = 0;
+
+	for (int pc = start; pc < end; pc++) {
+		instruction = prog->code[pc];
+		if (instruction == INST_LOAD_LOCAL && locals->varies[prog->code[pc + 1]]) return true;
+		if (instruction == INST_LOAD_CONST || instruction == INST_LOAD_VAR || instruction == INST_LOAD_LOCAL) {
+			pc++;
+		}
+		else if (instruction >= HIGHER_ORDER_OPERATORS && instruction < END_FUNCS) {
+			// Step into the body
+			pc += bodyOffset(instruction) - 1;
+		}
+	}
+	return false;
+}
+
+static void executeDual(const program* prog, int start, int end, dualLocals* locals, double* value, double tangent[]);
+
+static bool callHigherOrderDual(const program* prog, int pc, double values[], double tangents[][MAX_LOCALS],
+	const bool varies[], dualLocals* locals, double* result, double tangent[]) {
+	// Runs a higher order function nested in an expression that is being differentiated, returning true if its
+	// result carries tangents.  Sums and products are differentiated term by term, roots of solve() by the implicit
+	// function theorem, and integrals by the fundamental theorem of calculus as long as only their bounds vary.  Means
+	// of samples are differentiated sample by sample, with the same draws.  Integrands, minima and gradients that
+	// depend on the names being differentiated by give an undefined result
+	unsigned int instruction = prog->code[pc];
+	int local = prog->code[pc + 1];
+	int n = locals->nrTangents;
+	int bodyStart = pc + bodyOffset(instruction);
+	int bodyEnd = bodyStart + prog->code[bodyStart - 1];
+	bool dependent = dependsOnTangents(prog, bodyStart, bodyEnd, locals);
+	double plainLocals[MAX_LOCALS];
+	double savedValue = locals->values[local];
+	bool savedVaries = locals->varies[local];
+	double term = 0.0;
+	double termTangent[MAX_LOCALS];
+	double low = 0.0;
+	double high = 0.0;
+	int nrValues = nrHigherOrderValues(prog, pc);
+	bool boundsVary = false;
+	long long int nrSamples = 0;
+	unsigned int stream = 0;
+	randomState previous;
+
+	for (int i = 0; i < MAX_LOCALS; i++) plainLocals[i] = locals->values[i];
+	for (int i = 0; i < nrValues; i++) boundsVary = boundsVary || varies[i];
+	if (!dependent || instruction == OP_SOLVE) {
+		*result = callHigherOrder(prog, pc, values, plainLocals);
+	}
+
+	if (!dependent) {
+		if (instruction != OP_INTEGRATE || !boundsVary) return false;
+
+		// Only the bounds of the integral vary
+		plainLocals[local] = values[1];
+		high = executeCode(prog, bodyStart, bodyEnd, plainLocals);
+		plainLocals[local] = values[0];
+		low = executeCode(prog, bodyStart, bodyEnd, plainLocals);
+		for (int i = 0; i < n; i++) {
+			tangent[i] = (varies[1] ? high * tangents[1][i] : 0.0) - (varies[0] ? low * tangents[0][i] : 0.0);
+		}
+		return true;
+	}
+
+	locals->varies[local] = false;
+	switch (instruction) {
+	case OP_SUM:
+	case OP_PROD:
+		*result = (instruction == OP_SUM) ? 0.0 : 1.0;
+		for (int i = 0; i < n; i++) tangent[i] = 0.0;
+		// The same integers as reduceRange: from ceil(low) to floor(high), with bounds past 9e15 undefined
+		if (isnan(values[0]) || isnan(values[1]) || fabs(values[0]) > 9e15 || fabs(values[1]) > 9e15) {
+			*result = NAN;
+			break;
+		}
+		for (long long int k = (long long int)ceil(values[0]); k <= (long long int)floor(values[1]) && error == NO_ERROR; k++) {
+			locals->values[local] = (double)k;
+			executeDual(prog, bodyStart, bodyEnd, locals, &term, termTangent);
+			if (instruction == OP_SUM) {
+				for (int i = 0; i < n; i++) tangent[i] += termTangent[i];
+				*result += term;
+			}
+			else {
+				for (int i = 0; i < n; i++) tangent[i] = tangent[i] * term + *result * termTangent[i];
+				*result *= term;
+			}
+		}
+		break;
+	case OP_SOLVE:
+		// At the root f(x, p) = 0, so dx/dp = -(df/dp) / (df/dx).  The derivative by x takes an extra tangent
+		if (n >= MAX_LOCALS || isnan(*result)) {
+			*result = NAN;
+			break;
+		}
+		locals->values[local] = *result;
+		locals->varies[local] = true;
+		for (int i = 0; i < n; i++) locals->tangents[local][i] = 0.0;
+		locals->tangents[local][n] = 1.0;
+		for (int i = 0; i < MAX_LOCALS; i++) {
+			if (i != local && locals->varies[i]) locals->tangents[i][n] = 0.0;
+		}
+		locals->nrTangents = n + 1;
+		executeDual(prog, bodyStart, bodyEnd, locals, &term, termTangent);
+		locals->nrTangents = n;
+		for (int i = 0; i < n; i++) tangent[i] = -termTangent[i] / termTangent[n];
+		break;
+	case OP_MONTECARLO:
+		*result = 0.0;
+		for (int i = 0; i < n; i++) tangent[i] = 0.0;
+		if (isnan(values[0]) || values[0] < 0.5 || values[0] > 9007199254740992.0) {
+			*result = NAN;
+			break;
+		}
+		nrSamples = doubleToInt(values[0]);
+		stream = newStream();
+		for (long long int k = 0; k < nrSamples && error == NO_ERROR; k++) {
+			previous = enterSamples(stream, k, false);
+			executeDual(prog, bodyStart, bodyEnd, locals, &term, termTangent);
+			leaveSamples(previous);
+			for (int i = 0; i < n; i++) tangent[i] += termTangent[i];
+			*result += term;
+		}
+		for (int i = 0; i < n; i++) tangent[i] /= nrSamples;
+		*result /= nrSamples;
+		break;
+	default:
+		*result = NAN;
+		break;
+	}
+	locals->values[local] = savedValue;
+	locals->varies[local] = savedVaries;
+	return true;
+}
+
+// Runs code on dual numbers: every value on the stack carries the tangents of the locals it was computed from.  Each
+// operator finds its result and its derivatives by its inputs once, then applies the chain rule to all tangents in one
+// loop, so that a whole gradient takes a single pass over the code
+static void runDual(const program* prog, int start, int end, dualLocals* locals, double* value, double tangent[],
+	double values[], double tangents[][MAX_LOCALS], bool varies[]) {
+
+	int stackLength = 0;
+	unsigned int instruction = 0;
+	int n = locals->nrTangents;
+	int top = 0;
+	int local = 0;
+	int nrValues = 0;
+	double result = 0.0;
+	double dLeft = 0.0;
+	double dRight = 0.0;
+
+	for (int pc = start; pc < end; pc++) {
+		instruction = prog->code[pc];
+		top = stackLength - 1;
+
+		switch (instruction) {
+		case INST_LOAD_CONST:
+			values[stackLength] = prog->constants[prog->code[++pc]];
+			varies[stackLength] = false;
+			stackLength++;
+			break;
+		case INST_LOAD_VAR:
+			values[stackLength] = getVariable(prog->code[++pc]);
+			varies[stackLength] = false;
+			stackLength++;
+			break;
+		case INST_LOAD_LOCAL:
+			local = prog->code[++pc];
+			values[stackLength] = locals->values[local];
+			varies[stackLength] = locals->varies[local];
+			if (varies[stackLength]) {
+				for (int i = 0; i < n; i++) tangents[stackLength][i] = locals->tangents[local][i];
+			}
+			stackLength++;
+			break;
+		case OP_SUM:
+		case OP_PROD:
+		case OP_INTEGRATE:
+		case OP_SOLVE:
+		case OP_MINIMIZE:
+		case OP_GRAD:
+		case OP_MONTECARLO:
+			nrValues = nrHigherOrderValues(prog, pc);
+			stackLength -= nrValues;
+			varies[stackLength] = callHigherOrderDual(prog, pc, &values[stackLength], &tangents[stackLength],
+				&varies[stackLength], locals, &result, tangents[stackLength]);
+			values[stackLength] = result;
+			stackLength++;
+			pc += bodyOffset(instruction) - 1 + prog->code[pc + bodyOffset(instruction) - 1];
+			break;
+		default:
+			if (isBinaryOperator(instruction)) {
+				result = applyBinaryOperator(instruction, values[top - 1], values[top]);
+				if (varies[top - 1] || varies[top]) {
+					binaryPartials(instruction, values[top - 1], values[top], result, &dLeft, &dRight);
+					if (!varies[top - 1]) {
+						for (int i = 0; i < n; i++) tangents[top - 1][i] = dRight * tangents[top][i];
+					}
+					else if (!varies[top]) {
+						for (int i = 0; i < n; i++) tangents[top - 1][i] *= dLeft;
+					}
+					else {
+						for (int i = 0; i < n; i++) {
+							tangents[top - 1][i] = dLeft * tangents[top - 1][i] + dRight * tangents[top][i];
+						}
+					}
+					varies[top - 1] = true;
+				}
+				values[top - 1] = result;
+				stackLength--;
+			}
+			else {
+				result = applyUnaryOperator(instruction, values[top]);
+				if (varies[top]) {
+					dLeft = unaryDerivative(instruction, values[top], result);
+					for (int i = 0; i < n; i++) tangents[top][i] *= dLeft;
+				}
+				values[top] = result;
+			}
+			break;
+		}
+	}
+
+	*value = (stackLength > 0) ? values[stackLength - 1] : 0.0;
+	for (int i = 0; i < n; i++) {
+		tangent[i] = (stackLength > 0 && varies[stackLength - 1]) ? tangents[stackLength - 1][i] : 0.0;
+	}
+}
+
+static void executeDual(const program* prog, int start, int end, dualLocals* locals, double* value, double tangent[]) {
+	// Runs runDual() on a stack on the C stack, unless the program needs more than STACK_SIZE values
+	double values[STACK_SIZE];
+	double tangents[STACK_SIZE][MAX_LOCALS];
+	bool varies[STACK_SIZE];
+	double* deepValues = NULL;
+	double (*deepTangents)[MAX_LOCALS] = NULL;
+	bool* deepVaries = NULL;
+
+	if (prog->stackDepth <= STACK_SIZE) {
+		runDual(prog, start, end, locals, value, tangent, values, tangents, varies);
+		return;
+	}
+	deepValues = malloc(prog->stackDepth * sizeof(double));
+	deepTangents = malloc(prog->stackDepth * sizeof(deepTangents[0]));
+	deepVaries = malloc(prog->stackDepth * sizeof(bool));
+	if (deepValues == NULL || deepTangents == NULL || deepVaries == NULL) {
+		error = ERR_OVERFLOW;
+		*value = NAN;
+	}
+	else {
+		runDual(prog, start, end, locals, value, tangent, deepValues, deepTangents, deepVaries);
+	}
+	free(deepValues);
+	free(deepTangents);
+	free(deepVaries);
+}
+
+// Finds the gradient of the body of the grad() at pc, at the point given by the values of its names.  Each name is
+// seeded with a tangent of its own, so that all partial derivatives come out of one pass over the body.  They are
+// stored last name first, so that the first ends up on top of the value stack.  point and partials may be the same
+void gradient(const program* prog, int pc, const double point[], const double locals[], double partials[]) {
+
+	dualLocals dual;
+	int first = prog->code[pc + 1];
+	int nrNames = prog->code[pc + 2];
+	int bodyStart = pc + 4;
+	int bodyEnd = bodyStart + prog->code[pc + 3];
+	double value = 0.0;
+	double tangent[MAX_LOCALS];
+
+	dual.nrTangents = nrNames;
+	for (int i = 0; i < MAX_LOCALS; i++) {
+		dual.values[i] = locals[i];
+		dual.varies[i] = false;
+	}
+	for (int i = 0; i < nrNames; i++) {
+		dual.values[first + i] = point[i];
+		dual.varies[first + i] = true;
+		for (int j = 0; j < MAX_LOCALS; j++) dual.tangents[first + i][j] = (i == j) ? 1.0 : 0.0;
+	}
+
+	executeDual(prog, bodyStart, bodyEnd, &dual, &value, tangent);
+	for (int i = 0; i < nrNames; i++) {
+		partials[nrNames - 1 - i] = isnan(value) ? NAN : tangent[i];
+	}
+}
\ No newline at end of file
@@ -0,0 +1,741 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <float.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "rpn.h"
+#include "compile.h"
+#include "execute.h"
+#include "reduce.h"
+#include "quadrature.h"
+#include "solve.h"
+#include "dual.h"
+#include "array.h"
+#include "variables.h"
+#include "integer.h"
+#include "bigint.h"
+#include "bigfloat.h"
+#include "profile.h"
+#include "random.h"
+#include "montecarlo.h"
+#include "formula.h"
+#include "global.h"
+
+int bodyOffset(unsigned int instruction) {
+	// Returns the distance from a higher order function to the start of its body.  The word before the body holds its length
+	return (instruction == OP_GRAD || instruction == OP_MONTECARLO) ? 4 : 3;
+}
+
+int nrHigherOrderValues(const program* prog, int pc) {
+	// Returns the amount of values the higher order function at pc takes from the value stack
+	if (prog->code[pc] == OP_MONTECARLO) return 1;
+	return (prog->code[pc] == OP_GRAD) ? (int)prog->code[pc + 2] : nrArguments(prog->code[pc]) - 2;
+}
+
+double callHigherOrder(const program* prog, int pc, const double values[], double locals[]) {
+	// Runs the higher order function at pc with the values it was given.  Its body follows the instruction at pc
+	unsigned int instruction = prog->code[pc];
+	int local = prog->code[pc + 1];
+	int bodyStart = pc + bodyOffset(instruction);
+	int bodyEnd = bodyStart + prog->code[bodyStart - 1];
+	double derivative = 0.0;
+
+	switch (instruction) {
+	case OP_SUM:
+	case OP_PROD:
+		return reduceRange(prog, instruction, bodyStart, bodyEnd, local, values[0], values[1], locals);
+	case OP_INTEGRATE:
+		return integrateRange(prog, bodyStart, bodyEnd, local, values[0], values[1], values[2], locals);
+	case OP_SOLVE:
+	case OP_MINIMIZE:
+		return solveRange(prog, instruction, bodyStart, bodyEnd, local, values[0], values[1], locals);
+	case OP_GRAD:
+		// Only ever by a single name here
+		gradient(prog, pc, values, locals, &derivative);
+		return derivative;
+	case OP_MONTECARLO:
+		return sampleMean(prog, bodyStart, bodyEnd, values[0], locals, prog->code[pc + 2] != 0);
+	default:
+		return NAN;
+	}
+}
+
+static bool runOnBigIntegers(const program* prog, int start, int end, double* result, bool* leftValue) {
+	// Runs the version on integers of a statement, from start to the jump that ends it, on integers of any size.  Sets
+	// the result of the statement, or the value it leaves on the value stack, with leftValue set.  Returns false if the
+	// statement does anything else than operators on integers, or if a result isn't an integer or is too large
+	bigInteger* stack = calloc(prog->stackDepth + 1, sizeof(bigInteger));
+	int stackLength = 0;
+	unsigned int instruction = 0;
+	long long int integer = 0;
+	int index = 0;
+	bool ok = stack != NULL;
+
+	for (int pc = start; pc < end && ok; pc++) {
+		instruction = prog->code[pc];
+
+		switch (instruction) {
+		case INST_LOAD_CONST:
+			memcpy(&integer, &prog->constants[prog->code[++pc]], sizeof(integer));
+			ok = setBig(&stack[stackLength], integer);
+			stackLength++;
+			break;
+		case INST_LOAD_INT:
+			ok = getBigInteger(prog->code[++pc], &stack[stackLength]);
+			stackLength++;
+			break;
+		case INST_LOAD_BIG:
+			index = prog->literals[prog->code[++pc]];
+			ok = setBigText(&stack[stackLength], &prog->literalText[index], (int)strlen(&prog->literalText[index]));
+			stackLength++;
+			break;
+		case INST_INT:
+			instruction = prog->code[++pc];
+			if (isBinaryOperator(instruction)) {
+				stackLength--;
+				ok = applyBigBinary(instruction, &stack[stackLength - 1], &stack[stackLength]);
+			}
+			else {
+				ok = applyBigUnary(instruction, &stack[stackLength - 1]);
+			}
+			break;
+		case INST_TO_DOUBLE:
+			// Only the value of the whole statement is converted.  Values converted within it are done on doubles
+			ok = pc == end - 1;
+			*result = bigToDouble(&stack[stackLength - 1]);
+			*leftValue = true;
+			break;
+		case INST_ASSIGN_INT:
+			stackLength--;
+			ok = setBigInteger(prog->code[pc + 1], &stack[stackLength]);
+			if (ok) assignedVariable(prog->code[pc + 1]);
+			*result = bigToDouble(&stack[stackLength]);
+			pc += 2;
+			break;
+		case INST_PRINT_INT:
+			stackLength--;
+			enterStage(STAGE_PRINT);
+			printBigInteger(&stack[stackLength]);
+			leaveStage();
+			ok = setBigInteger(ANS_ADDR, &stack[stackLength]);
+			*result = bigToDouble(&stack[stackLength]);
+			pc++;
+			break;
+		case INST_DELETE:
+			*result = getVariable(prog->code[pc + 1]);
+			delVariable(prog->code[pc + 1]);
+			deletedVariable(prog->code[pc + 1]);
+			pc++;
+			break;
+		default:
+			ok = false;
+			break;
+		}
+	}
+
+	// Too large for a double, the result is the largest one
+	if (isinf(*result)) *result = copysign(DBL_MAX, *result);
+	for (int i = 0; stack != NULL && i <= prog->stackDepth; i++) freeBig(&stack[i]);
+	free(stack);
+	return ok;
+}
+
+static int leaveIntegers(const program* prog, int start, int fallback, double stack[], int* stackLength, double* result) {
+	// Called when a statement on integers, whose version on integers starts at start, doesn't fit in 64 bits, with the
+	// value stack cut back to where the statement started.  With bigIntegers set, it is done again on integers of any
+	// size, and its version on doubles is skipped.  Returns the position before the instruction to go on from
+	double value = 0.0;
+	bool leftValue = false;
+
+	if (!bigIntegers || !runOnBigIntegers(prog, start, fallback - 2, &value, &leftValue)) return fallback - 1;
+	if (leftValue) {
+		stack[*stackLength] = value;
+		(*stackLength)++;
+	}
+	else {
+		*result = value;
+	}
+	return fallback + prog->code[fallback - 1] - 1;
+}
+
+#ifdef __GNUC__
+#define SPECIALIZED inline __attribute__((always_inline))
+#else
+#define SPECIALIZED inline
+#endif
+
+static SPECIALIZED double interpret(const program* prog, int start, int end, double locals[], double stack[],
+	bool counted) {
+	// The interpreter loop of runCode(), which counts its instructions if counted is set
+	int stackLength = 0;
+	double result = 0.0;
+	unsigned int instruction = 0;
+	int nrValues = 0;
+	int offset = 0;
+	int fallback = -1;      // Start of the version on doubles of the statement running on integers, or -1
+	int fallbackDepth = 0;  // Stack length when that statement started
+	int integerStart = 0;   // Start of its version on integers
+	long long int left = 0;
+	long long int right = 0;
+	bool exact = true;  // Whether the last operation on integers had an integer result
+	int weight = 0;      // Runs the count of each instruction stands for
+	bool timed = false;  // Whether the run is a sample, whose instructions are timed
+	profileCounters* counters = counted ? countRun(&weight, &timed) : NULL;
+
+	for (int pc = start; pc < end; pc++) {
+		instruction = prog->code[pc];
+		if (counted && counters != NULL) {
+			counters->counts[instruction - OPERATOR_START] += weight;
+			if (timed) timeInstruction(counters, instruction);
+		}
+
+		switch (instruction) {
+		case INST_LOAD_CONST:
+			stack[stackLength] = prog->constants[prog->code[++pc]];
+			stackLength++;
+			break;
+		case INST_LOAD_VAR:
+			offset = variableOffsets[prog->code[++pc]];
+			if (variableTypes[offset] == TYPE_INT) {
+				memcpy(&left, &variableMap[offset], sizeof(left));
+				stack[stackLength] = (double)left;
+			}
+			else if (variableTypes[offset] == TYPE_INT_HEAD || variableTypes[offset] == TYPE_PRECISE_HEAD) {
+				stack[stackLength] = getVariable(prog->code[pc]);
+			}
+			else {
+				stack[stackLength] = variableMap[offset];
+			}
+			stackLength++;
+			break;
+		case INST_TRY_INT:
+			// Followed by the length of the version of the statement on integers, which ends by jumping over the
+			// version on doubles that follows it
+			fallback = pc + 2 + prog->code[pc + 1];
+			fallbackDepth = stackLength;
+			integerStart = pc + 2;
+			pc++;
+			break;
+		case INST_JUMP:
+			// Followed by the number of words to skip
+			fallback = -1;
+			pc += 1 + prog->code[pc + 1];
+			break;
+		case INST_LOAD_INT:
+			// Integers are kept on the value stack bit for bit.  A variable that doesn't hold one can't be used
+			offset = variableOffsets[prog->code[++pc]];
+			stack[stackLength] = variableMap[offset];
+			stackLength++;
+			if (variableTypes[offset] != TYPE_INT) {
+				stackLength = fallbackDepth;
+				pc = leaveIntegers(prog, integerStart, fallback, stack, &stackLength, &result);
+				fallback = -1;
+			}
+			break;
+		case INST_LOAD_BIG:
+			// Followed by a literal too large for 64 bits, so the statement is only done on integers of any size
+			stackLength = fallbackDepth;
+			pc = leaveIntegers(prog, integerStart, fallback, stack, &stackLength, &result);
+			fallback = -1;
+			break;
+		case INST_INT:
+			// Followed by the operator
+			instruction = prog->code[++pc];
+			if (isBinaryOperator(instruction)) {
+				stackLength--;
+				memcpy(&left, &stack[stackLength - 1], sizeof(left));
+				memcpy(&right, &stack[stackLength], sizeof(right));
+				exact = applyIntegerBinary(instruction, left, right, &left);
+			}
+			else {
+				memcpy(&right, &stack[stackLength - 1], sizeof(right));
+				exact = applyIntegerUnary(instruction, right, &left);
+			}
+			memcpy(&stack[stackLength - 1], &left, sizeof(left));
+			if (!exact) {
+				// The statement can't be done on 64-bit integers, so it starts again on doubles
+				stackLength = fallbackDepth;
+				pc = leaveIntegers(prog, integerStart, fallback, stack, &stackLength, &result);
+				fallback = -1;
+			}
+			break;
+		case INST_TO_DOUBLE:
+			memcpy(&left, &stack[stackLength - 1], sizeof(left));
+			stack[stackLength - 1] = (double)left;
+			break;
+		case INST_ASSIGN_INT:
+			stackLength--;
+			memcpy(&left, &stack[stackLength], sizeof(left));
+			setInteger(prog->code[pc + 1], left);
+			assignedVariable(prog->code[pc + 1]);
+			result = (double)left;
+			pc += 2;
+			break;
+		case INST_PRINT_INT:
+			stackLength--;
+			memcpy(&left, &stack[stackLength], sizeof(left));
+			enterStage(STAGE_PRINT);
+			printInteger(left);
+			leaveStage();
+			setInteger(ANS_ADDR, left);
+			result = (double)left;
+			pc++;
+			break;
+		case INST_LOAD_LOCAL:
+			stack[stackLength] = locals[prog->code[++pc]];
+			stackLength++;
+			break;
+		case OP_SUM:
+		case OP_PROD:
+		case OP_INTEGRATE:
+		case OP_SOLVE:
+		case OP_MINIMIZE:
+			// Followed by the local of the bound variable, the length of the body, and the body
+			nrValues = nrArguments(instruction) - 2;
+			stackLength -= nrValues;
+			stack[stackLength] = callHigherOrder(prog, pc, &stack[stackLength], locals);
+			stackLength++;
+			pc += 2 + prog->code[pc + 2];
+			break;
+		case OP_GRAD:
+			// Followed by the first local of the names, the number of names, the length of the body, and the body.  The
+			// values of the names are replaced by the partial derivatives
+			nrValues = prog->code[pc + 2];
+			stackLength -= nrValues;
+			gradient(prog, pc, &stack[stackLength], locals, &stack[stackLength]);
+			stackLength += nrValues;
+			pc += 3 + prog->code[pc + 3];
+			break;
+		case OP_MONTECARLO:
+			// Followed by a local it doesn't use, whether to report on the samples, the length of the body, and the body
+			stack[stackLength - 1] = callHigherOrder(prog, pc, &stack[stackLength - 1], locals);
+			pc += 3 + prog->code[pc + 3];
+			break;
+		case INST_ASSIGN_VAL:
+			stackLength--;
+			result = stack[stackLength];
+			if (isnan(result) || isinf(result)) {
+				error = ERR_UNDEFINED;
+				errorLine = prog->code[pc + 2];
+				return 0.0;
+			}
+			setVariable(prog->code[pc + 1], result);
+			assignedVariable(prog->code[pc + 1]);
+			pc += 2;
+			break;
+		case INST_DEFINE:
+			// Followed by the variable, the line number, the length of the expression of the formula, and the expression
+			result = defineFormula(prog, pc);
+			if (error != NO_ERROR) {
+				errorLine = prog->code[pc + 2];
+				return 0.0;
+			}
+			pc += 3 + prog->code[pc + 3];
+			break;
+		case INST_PRINT:
+			stackLength--;
+			result = stack[stackLength];
+			if (isnan(result) || isinf(result)) {
+				error = ERR_UNDEFINED;
+				errorLine = prog->code[pc + 1];
+				return 0.0;
+			}
+			enterStage(STAGE_PRINT);
+			printResult(result);
+			leaveStage();
+			setVariable(ANS_ADDR, result);
+			pc++;
+			break;
+		case INST_DELETE:
+			// The value of a deleted variable is the result of the statement
+			result = getVariable(prog->code[pc + 1]);
+			delVariable(prog->code[pc + 1]);
+			deletedVariable(prog->code[pc + 1]);
+			pc++;
+			break;
+		case INST_LOAD_ARRAY:
+		case INST_ASSIGN_ARRAY:
+		case INST_PRINT_ARRAY:
+		case INST_MAP:
+		case INST_REDUCE:
+		case OP_ARRAY:
+		case OP_LINSPACE:
+		case OP_DOT:
+		case OP_MATMUL:
+		case OP_TRANSPOSE:
+		case OP_DET:
+		case OP_INV:
+		case OP_EYE:
+		case OP_RESHAPE:
+		case OP_LINSOLVE:
+		case OP_FFT:
+		case OP_IFFT:
+		case OP_CONV:
+		case OP_XCORR:
+		case OP_REAL:
+		case OP_IMAG:
+		case OP_MAGNITUDE:
+			pc = executeArrayInstruction(prog, pc, stack, &stackLength);
+			if (error != NO_ERROR) return 0.0;
+			break;
+		case OP_ADD:
+			// The most common operators are done here rather than through applyBinaryOperator()
+			stackLength--;
+			stack[stackLength - 1] += stack[stackLength];
+			break;
+		case OP_SUB:
+			stackLength--;
+			stack[stackLength - 1] -= stack[stackLength];
+			break;
+		case OP_MUL:
+			stackLength--;
+			stack[stackLength - 1] *= stack[stackLength];
+			break;
+		case OP_DIV:
+			stackLength--;
+			stack[stackLength - 1] = (stack[stackLength] == 0.0) ? NAN : stack[stackLength - 1] / stack[stackLength];
+			break;
+		case OP_NEG:
+			stack[stackLength - 1] = -stack[stackLength - 1];
+			break;
+		default:
+			if (isBinaryOperator(instruction)) {
+				stackLength--;
+				stack[stackLength - 1] = applyBinaryOperator(instruction, stack[stackLength - 1], stack[stackLength]);
+			}
+			else {
+				stack[stackLength - 1] = applyUnaryOperator(instruction, stack[stackLength - 1]);
+			}
+			break;
+		}
+	}
+
+	if (stackLength > 0) {
+		result = stack[stackLength - 1];
+	}
+	if (timed) endRun(counters);
+	return result;
+}
+
+static double runCode(const program* prog, int start, int end, double locals[], double stack[]) {
+	// Runs a copy of the interpreter loop made without instrumentation unless the run is counted, so that it costs nothing
+	// while instrumentation is off, and hardly more while it only samples runs
+	if (!profiling || (--profileCountdown > 0 && !profileDetail)) return interpret(prog, start, end, locals, stack, false);
+	return interpret(prog, start, end, locals, stack, true);
+}
+
+// Runs the instructions of a program between two positions on a value stack, and returns the last value produced.
+// Statements that store or print an undefined value stop execution and set the error.  The stack is on the C stack
+// unless the program needs more than STACK_SIZE values
+double executeCode(const program* prog, int start, int end, double locals[]) {
+
+	double stack[STACK_SIZE];
+	double* deepStack = NULL;
+	double result = 0.0;
+
+	if (prog->stackDepth <= STACK_SIZE) return runCode(prog, start, end, locals, stack);
+	deepStack = malloc(prog->stackDepth * sizeof(double));
+	if (deepStack == NULL) {
+		error = ERR_OVERFLOW;
+		return 0.0;
+	}
+	result = runCode(prog, start, end, locals, deepStack);
+	free(deepStack);
+	return result;
+}
+
+static bool runsOnFloats(const program* prog) {
+	// Whether every statement of a program can be done on floats of the precision set by "prec".  Those with arrays or
+	// higher order functions can't
+	for (int pc = 0; pc < prog->length; pc++) {
+		switch (prog->code[pc]) {
+		case INST_TRY_INT:
+			// Only the version on doubles is run
+			pc += 1 + prog->code[pc + 1];
+			break;
+		case INST_LOAD_CONST:
+		case INST_LOAD_VAR:
+		case INST_JUMP:
+		case INST_PRINT:
+		case INST_DELETE:
+			pc++;
+			break;
+		case INST_ASSIGN_VAL:
+			pc += 2;
+			break;
+		default:
+			if (!isFloatOperator(prog->code[pc])) return false;
+			break;
+		}
+	}
+	return true;
+}
+
+static bool setFromDouble(bigFloat* value, double number, long long int bits) {
+	// Sets a float to the shortest decimal that reads back as a double, so that a value such as 0.1 is the number its
+	// digits say rather than the double nearest to it
+	char text[32];
+
+	if (!isfinite(number)) return setFloat(value, number, bits);
+	for (int digits = 1; digits <= 17; digits++) {
+		sprintf(text, "%.*E", digits - 1, fabs(number));
+		if (strtod(text, NULL) == fabs(number)) break;
+	}
+	return setFloatText(value, text, bits) && (number >= 0.0 || applyFloatUnary(OP_NEG, value, bits));
+}
+
+static bool loadFloat(bigFloat* value, int slot, long long int bits) {
+	// Sets a float to the value of a variable.  The constants known to any precision are found to it
+	bigInteger integer;
+	bool ok = true;
+
+	if (getBigFloat(slot, value)) return true;
+	if (getVariableType(slot) == TYPE_INT) {
+		initBig(&integer);
+		ok = getBigInteger(slot, &integer) && setFloatInteger(value, &integer, bits);
+		freeBig(&integer);
+		return ok;
+	}
+	if (slot >= CONST_START && slot < USER_VAR_START && setFloatConstant(value, variableNames[slot], bits)) return true;
+	return setFromDouble(value, getVariable(slot), bits);
+}
+
+static double runOnFloats(const program* prog) {
+	// Runs a program on floats of the precision set by "prec", and returns the value of its last statement as a double.
+	// Literals are read again from their text.  Statements done on integers are done on floats instead
+	long long int bits = precisionBits(precisionDigits);
+	bigFloat* stack = calloc(prog->stackDepth + 1, sizeof(bigFloat));
+	int stackLength = 0;
+	unsigned int instruction = 0;
+	int index = 0;
+	double result = 0.0;
+	bool ok = stack != NULL;
+	int weight = 0;      // Runs the count of each instruction stands for
+	bool timed = false;  // Whether the run is a sample, whose instructions are timed
+	profileCounters* counters = (profiling && (--profileCountdown <= 0 || profileDetail))
+		? countRun(&weight, &timed) : NULL;
+
+	for (int i = 0; ok && i <= prog->stackDepth; i++) initFloat(&stack[i]);
+	for (int pc = 0; pc < prog->length && ok && error == NO_ERROR; pc++) {
+		instruction = prog->code[pc];
+		if (counters != NULL) {
+			counters->counts[instruction - OPERATOR_START] += weight;
+			if (timed) timeInstruction(counters, instruction);
+		}
+
+		switch (instruction) {
+		case INST_LOAD_CONST:
+			index = prog->code[++pc];
+			ok = (prog->literals[index] >= 0)
+				? setFloatText(&stack[stackLength], &prog->literalText[prog->literals[index]], bits)
+				: setFromDouble(&stack[stackLength], prog->constants[index], bits);
+			stackLength++;
+			break;
+		case INST_LOAD_VAR:
+			ok = loadFloat(&stack[stackLength], prog->code[++pc], bits);
+			stackLength++;
+			break;
+		case INST_TRY_INT:
+			pc += 1 + prog->code[pc + 1];
+			break;
+		case INST_JUMP:
+			pc += 1 + prog->code[pc + 1];
+			break;
+		case INST_ASSIGN_VAL:
+		case INST_PRINT:
+			stackLength--;
+			if (stack[stackLength].undefined) {
+				error = ERR_UNDEFINED;
+				errorLine = prog->code[pc + ((instruction == INST_PRINT) ? 1 : 2)];
+				break;
+			}
+			result = floatToDouble(&stack[stackLength]);
+			if (instruction == INST_PRINT) {
+				enterStage(STAGE_PRINT);
+				printBigFloat(&stack[stackLength], precisionDigits);
+				leaveStage();
+				ok = setBigFloat(ANS_ADDR, &stack[stackLength]);
+				pc++;
+			}
+			else {
+				ok = setBigFloat(prog->code[pc + 1], &stack[stackLength]);
+				if (ok) assignedVariable(prog->code[pc + 1]);
+				pc += 2;
+			}
+			break;
+		case INST_DELETE:
+			result = getVariable(prog->code[pc + 1]);
+			delVariable(prog->code[pc + 1]);
+			deletedVariable(prog->code[pc + 1]);
+			pc++;
+			break;
+		default:
+			if (isBinaryOperator(instruction)) {
+				stackLength--;
+				ok = applyFloatBinary(instruction, &stack[stackLength - 1], &stack[stackLength], bits);
+			}
+			else {
+				ok = applyFloatUnary(instruction, &stack[stackLength - 1], bits);
+			}
+			break;
+		}
+	}
+
+	if (timed) endRun(counters);
+	if (!ok) error = ERR_OVERFLOW;
+	if (error == NO_ERROR && stackLength > 0) {
+		result = stack[stackLength - 1].undefined ? NAN : floatToDouble(&stack[stackLength - 1]);
+	}
+	// Too large for a double, the result is the largest one
+	if (isinf(result)) result = copysign(DBL_MAX, result);
+	for (int i = 0; stack != NULL && i <= prog->stackDepth; i++) freeFloat(&stack[i]);
+	free(stack);
+	return result;
+}
+
+// Runs a whole program, returning the value of its last statement.  Once "prec" has set a precision, programs are run
+// on floats of that precision unless they use what floats can't do
+double runProgram(const program* prog) {
+
+	double locals[MAX_LOCALS] = { 0 };
+	double result = 0.0;
+
+	enterStage(STAGE_EXECUTE);
+	result = (precisionDigits > 0 && runsOnFloats(prog)) ? runOnFloats(prog) : executeCode(prog, 0, prog->length, locals);
+	clearArrays();
+	leaveStage();
+	if (error == NO_ERROR && (isnan(result) || isinf(result))) {
+		error = ERR_UNDEFINED;
+	}
+	return result;
+}
+
+static void fillLanes(double lanes[], double value, int count) {
+	for (int i = 0; i < count; i++) {
+		lanes[i] = value;
+	}
+}
+
+// Runs the body of a higher order function for several values of its bound variables at once.  Locals with lanes
+// take one value per lane from lanes[local], the others keep their value in locals.  Each value stack entry holds one
+// value per lane, and each operator loops over the lanes, so that arithmetic is vectorized by the compiler and the
+// cost of decoding instructions is shared.  The workspace must hold prog->stackDepth * BATCH_SIZE values
+void executeBatch(const program* prog, int start, int end, const double locals[], const double* lanes[],
+	int count, double results[], double* workspace) {
+
+	int stackLength = 0;
+	unsigned int instruction = 0;
+	int nrValues = 0;
+	double* top = workspace;    // Lanes of the entry on top of the stack
+	double* below = workspace;  // Lanes of the entry below it
+	double laneLocals[MAX_LOCALS];
+	double laneValues[MAX_ARGS];
+	randomState batch;
+	int weight = 0;      // Runs the count of each instruction stands for
+	bool timed = false;  // Whether the run is a sample, whose instructions are timed
+	profileCounters* counters = (profiling && (--profileCountdown <= 0 || profileDetail))
+		? countRun(&weight, &timed) : NULL;
+
+	for (int pc = start; pc < end; pc++) {
+		instruction = prog->code[pc];
+		if (counters != NULL) {
+			counters->counts[instruction - OPERATOR_START] += weight;
+			if (timed) timeInstruction(counters, instruction);
+		}
+		top = workspace + (stackLength - 1) * BATCH_SIZE;
+		below = top - BATCH_SIZE;
+
+		switch (instruction) {
+		case INST_LOAD_CONST:
+			fillLanes(top + BATCH_SIZE, prog->constants[prog->code[++pc]], count);
+			stackLength++;
+			break;
+		case INST_LOAD_VAR:
+			fillLanes(top + BATCH_SIZE, getVariable(prog->code[++pc]), count);
+			stackLength++;
+			break;
+		case INST_LOAD_LOCAL:
+			pc++;
+			if (lanes[prog->code[pc]] != NULL) {
+				for (int i = 0; i < count; i++) top[BATCH_SIZE + i] = lanes[prog->code[pc]][i];
+			}
+			else {
+				fillLanes(top + BATCH_SIZE, locals[prog->code[pc]], count);
+			}
+			stackLength++;
+			break;
+		case OP_SUM:
+		case OP_PROD:
+		case OP_INTEGRATE:
+		case OP_SOLVE:
+		case OP_MINIMIZE:
+		case OP_GRAD:
+		case OP_MONTECARLO:
+			// Nested higher order functions run lane by lane
+			nrValues = nrHigherOrderValues(prog, pc);
+			stackLength -= nrValues;
+			top = workspace + stackLength * BATCH_SIZE;
+			batch = enterLanes();
+			for (int i = 0; i < count; i++) {
+				selectLane(&batch, i);
+				for (int j = 0; j < MAX_LOCALS; j++) {
+					laneLocals[j] = (lanes[j] != NULL) ? lanes[j][i] : locals[j];
+				}
+				for (int j = 0; j < nrValues; j++) laneValues[j] = top[j * BATCH_SIZE + i];
+				top[i] = callHigherOrder(prog, pc, laneValues, laneLocals);
+			}
+			leaveLanes(&batch);
+			stackLength++;
+			pc += bodyOffset(instruction) - 1 + prog->code[pc + bodyOffset(instruction) - 1];
+			break;
+		case OP_ADD:
+			for (int i = 0; i < count; i++) below[i] += top[i];
+			stackLength--;
+			break;
+		case OP_SUB:
+			for (int i = 0; i < count; i++) below[i] -= top[i];
+			stackLength--;
+			break;
+		case OP_MUL:
+			for (int i = 0; i < count; i++) below[i] *= top[i];
+			stackLength--;
+			break;
+		case OP_DIV:
+			for (int i = 0; i < count; i++) below[i] = (top[i] == 0.0) ? NAN : below[i] / top[i];
+			stackLength--;
+			break;
+		case OP_NEG:
+			for (int i = 0; i < count; i++) top[i] = -top[i];
+			break;
+		case OP_SQRT:
+			for (int i = 0; i < count; i++) top[i] = sqrt(top[i]);
+			break;
+		case OP_ABS:
+			for (int i = 0; i < count; i++) top[i] = fabs(top[i]);
+			break;
+		case OP_UNIFORM:
+		case OP_NORMAL:
+		case OP_LOGNORMAL:
+			drawLanes(instruction, below, top, count);
+			stackLength--;
+			break;
+		default:
+			if (isBinaryOperator(instruction)) {
+				for (int i = 0; i < count; i++) below[i] = applyBinaryOperator(instruction, below[i], top[i]);
+				stackLength--;
+			}
+			else {
+				for (int i = 0; i < count; i++) top[i] = applyUnaryOperator(instruction, top[i]);
+			}
+			break;
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		results[i] = workspace[i];
+	}
+	if (timed) endRun(counters);
+}
\ No newline at end of file
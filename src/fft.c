@@ -0,0 +1,458 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "constants.h"
+#include "fft.h"
+
+// Discrete Fourier transforms of any length.  A length made of small factors is transformed by a Stockham FFT, which
+// goes through one stage per factor and reads and writes every value once per stage, switching between two buffers so
+// that no reordering pass is needed.  Values are kept with their real and imaginary parts in separate arrays, and the
+// loops of a stage run over consecutive elements of both, in the form the compiler vectorizes.  Lengths with a large
+// prime factor use Bluestein's algorithm, which turns the transform into a convolution of a length the FFT handles.
+// The twiddle factors of a length are worked out once, in a plan that is kept for later transforms of the same length
+#define FFT_MAX_RADIX 31      // Largest factor transformed directly.  Lengths with larger ones use Bluestein's algorithm
+#define FFT_MAX_STAGES 64
+#define FFT_CACHE_SIZE 8      // Plans kept for reuse
+#define CONV_DIRECT_LENGTH 64 // Convolutions are done directly if either array is no longer than this
+#define CONV_FFT_RATIO 8.0    // or if the direct way takes fewer multiplications than this times m log2(m) for the FFT
+
+typedef struct {
+	int radix;
+	long span;           // Length of the transforms this stage combines radix at a time
+	double* twiddleRe;   // exp(-2 pi i r t / (radix span)) for r from 1 to radix - 1 and t below span, r-major
+	double* twiddleIm;
+	double* rootRe;      // exp(-2 pi i k / radix) for factors without a butterfly of their own
+	double* rootIm;
+} fftStage;
+
+typedef struct fftPlan {
+	long n;
+	int nrStages;
+	fftStage stages[FFT_MAX_STAGES];
+	struct fftPlan* inner;  // Transform of the convolution of Bluestein's algorithm, or NULL
+	double* chirpRe;        // exp(-pi i j^2 / n)
+	double* chirpIm;
+	double* filterRe;       // Transform of the conjugate chirp, wrapped around
+	double* filterIm;
+} fftPlan;
+
+static fftPlan* plans[FFT_CACHE_SIZE];
+static int nextPlan;  // Cache entry replaced next
+
+static void freePlan(fftPlan* plan) {
+	if (plan == NULL) return;
+	for (int i = 0; i < plan->nrStages; i++) {
+		free(plan->stages[i].twiddleRe);
+		free(plan->stages[i].twiddleIm);
+		free(plan->stages[i].rootRe);
+		free(plan->stages[i].rootIm);
+	}
+	freePlan(plan->inner);
+	free(plan->chirpRe);
+	free(plan->chirpIm);
+	free(plan->filterRe);
+	free(plan->filterIm);
+	free(plan);
+}
+
+static int smallestFactor(long n) {
+	// Returns the factor of n the next stage takes.  Fours come first, since they need the fewest operations per value
+	if (n % 4 == 0) return 4;
+	for (int p = 2; p <= FFT_MAX_RADIX; p++) {
+		if (n % p == 0) return p;
+	}
+	return 0;
+}
+
+static bool addStage(fftPlan* plan, int radix, long span) {
+	fftStage* stage = &plan->stages[plan->nrStages];
+	long count = (radix - 1) * span;
+	double angle = 0.0;
+
+	plan->nrStages++;
+	stage->radix = radix;
+	stage->span = span;
+	stage->rootRe = NULL;
+	stage->rootIm = NULL;
+	stage->twiddleRe = malloc(count * sizeof(double));
+	stage->twiddleIm = malloc(count * sizeof(double));
+	if (stage->twiddleRe == NULL || stage->twiddleIm == NULL) return false;
+
+	for (int r = 1; r < radix; r++) {
+		for (long t = 0; t < span; t++) {
+			angle = -2.0 * pi * (double)(r * t) / (double)(radix * span);
+			stage->twiddleRe[(r - 1) * span + t] = cos(angle);
+			stage->twiddleIm[(r - 1) * span + t] = sin(angle);
+		}
+	}
+	if (radix > 4) {
+		stage->rootRe = malloc(radix * sizeof(double));
+		stage->rootIm = malloc(radix * sizeof(double));
+		if (stage->rootRe == NULL || stage->rootIm == NULL) return false;
+		for (int k = 0; k < radix; k++) {
+			stage->rootRe[k] = cos(-2.0 * pi * k / radix);
+			stage->rootIm[k] = sin(-2.0 * pi * k / radix);
+		}
+	}
+	return true;
+}
+
+static bool runPlan(const fftPlan* plan, double* re, double* im);
+
+static fftPlan* makePlan(long n) {
+	// Works out the stages of a transform of length n, or Bluestein's chirps for lengths with a large prime factor
+	fftPlan* plan = calloc(1, sizeof(fftPlan));
+	long remaining = n;
+	long span = 1;
+	long m = 1;
+	long square = 0;
+	int radix = 0;
+	bool smooth = true;  // Whether n has no factors larger than FFT_MAX_RADIX
+	bool ok = true;
+
+	if (plan == NULL) return NULL;
+	plan->n = n;
+
+	for (long rest = n; rest > 1; rest /= radix) {
+		radix = smallestFactor(rest);
+		if (radix == 0) {
+			smooth = false;
+			break;
+		}
+	}
+	if (smooth) {
+		while (remaining > 1 && ok) {
+			radix = smallestFactor(remaining);
+			ok = addStage(plan, radix, span);
+			span *= radix;
+			remaining /= radix;
+		}
+		if (ok) return plan;
+		freePlan(plan);
+		return NULL;
+	}
+
+	// Bluestein's algorithm, with a power of two at least 2n - 1 long for the convolution
+	while (m < 2 * n - 1) m *= 2;
+	plan->inner = makePlan(m);
+	plan->chirpRe = malloc(n * sizeof(double));
+	plan->chirpIm = malloc(n * sizeof(double));
+	plan->filterRe = calloc(m, sizeof(double));
+	plan->filterIm = calloc(m, sizeof(double));
+	if (plan->inner == NULL || plan->chirpRe == NULL || plan->chirpIm == NULL || plan->filterRe == NULL || plan->filterIm == NULL) {
+		freePlan(plan);
+		return NULL;
+	}
+	for (long j = 0; j < n; j++) {
+		// j^2 is taken modulo 2n first, so that the angle stays accurate for long transforms
+		square = (long)(((unsigned long long)j * (unsigned long long)j) % (unsigned long long)(2 * n));
+		plan->chirpRe[j] = cos(-pi * (double)square / (double)n);
+		plan->chirpIm[j] = sin(-pi * (double)square / (double)n);
+		plan->filterRe[j] = plan->chirpRe[j];
+		plan->filterIm[j] = -plan->chirpIm[j];
+		if (j > 0) {
+			plan->filterRe[m - j] = plan->chirpRe[j];
+			plan->filterIm[m - j] = -plan->chirpIm[j];
+		}
+	}
+	if (!runPlan(plan->inner, plan->filterRe, plan->filterIm)) {
+		freePlan(plan);
+		return NULL;
+	}
+	return plan;
+}
+
+static const fftPlan* findPlan(long n) {
+	// Returns the plan for transforms of length n, making it if it isn't one of those kept
+	fftPlan* plan = NULL;
+
+	for (int i = 0; i < FFT_CACHE_SIZE; i++) {
+		if (plans[i] != NULL && plans[i]->n == n) return plans[i];
+	}
+	plan = makePlan(n);
+	if (plan == NULL) return NULL;
+	freePlan(plans[nextPlan]);
+	plans[nextPlan] = plan;
+	nextPlan = (nextPlan + 1) % FFT_CACHE_SIZE;
+	return plan;
+}
+
+static void runStage(const fftStage* stage, long n, const double* xRe, const double* xIm, double* yRe, double* yIm) {
+	// Combines radix transforms of length span into transforms of length radix x span.  Input r of a butterfly is
+	// n / radix after input r - 1, and its outputs are span apart
+	int radix = stage->radix;
+	long span = stage->span;
+	long stride = n / radix;
+	const double* wRe = stage->twiddleRe;
+	const double* wIm = stage->twiddleIm;
+	const double *aRe, *aIm, *bRe, *bIm, *cRe, *cIm, *dRe, *dIm;
+	double *oRe, *oIm;
+	double sRe, sIm, tRe, tIm, uRe, uIm, vRe, vIm;
+	double valuesRe[FFT_MAX_RADIX], valuesIm[FFT_MAX_RADIX];
+	double sumRe, sumIm;
+	const double half = 0.5;
+	const double sine = 0.86602540378443864676;  // sin(2 pi / 3)
+
+	for (long block = 0; block < stride; block += span) {
+		aRe = xRe + block; aIm = xIm + block;
+		oRe = yRe + block * radix; oIm = yIm + block * radix;
+
+		switch (radix) {
+		case 2:
+			bRe = aRe + stride; bIm = aIm + stride;
+			for (long t = 0; t < span; t++) {
+				tRe = bRe[t] * wRe[t] - bIm[t] * wIm[t];
+				tIm = bRe[t] * wIm[t] + bIm[t] * wRe[t];
+				oRe[t] = aRe[t] + tRe;
+				oIm[t] = aIm[t] + tIm;
+				oRe[span + t] = aRe[t] - tRe;
+				oIm[span + t] = aIm[t] - tIm;
+			}
+			break;
+		case 3:
+			bRe = aRe + stride; bIm = aIm + stride;
+			cRe = bRe + stride; cIm = bIm + stride;
+			for (long t = 0; t < span; t++) {
+				tRe = bRe[t] * wRe[t] - bIm[t] * wIm[t];
+				tIm = bRe[t] * wIm[t] + bIm[t] * wRe[t];
+				uRe = cRe[t] * wRe[span + t] - cIm[t] * wIm[span + t];
+				uIm = cRe[t] * wIm[span + t] + cIm[t] * wRe[span + t];
+				sRe = tRe + uRe; sIm = tIm + uIm;
+				vRe = sine * (tIm - uIm); vIm = sine * (uRe - tRe);
+				oRe[t] = aRe[t] + sRe;
+				oIm[t] = aIm[t] + sIm;
+				oRe[span + t] = aRe[t] - half * sRe + vRe;
+				oIm[span + t] = aIm[t] - half * sIm + vIm;
+				oRe[2 * span + t] = aRe[t] - half * sRe - vRe;
+				oIm[2 * span + t] = aIm[t] - half * sIm - vIm;
+			}
+			break;
+		case 4:
+			bRe = aRe + stride; bIm = aIm + stride;
+			cRe = bRe + stride; cIm = bIm + stride;
+			dRe = cRe + stride; dIm = cIm + stride;
+			for (long t = 0; t < span; t++) {
+				double b0 = bRe[t] * wRe[t] - bIm[t] * wIm[t];
+				double b1 = bRe[t] * wIm[t] + bIm[t] * wRe[t];
+				double c0 = cRe[t] * wRe[span + t] - cIm[t] * wIm[span + t];
+				double c1 = cRe[t] * wIm[span + t] + cIm[t] * wRe[span + t];
+				double d0 = dRe[t] * wRe[2 * span + t] - dIm[t] * wIm[2 * span + t];
+				double d1 = dRe[t] * wIm[2 * span + t] + dIm[t] * wRe[2 * span + t];
+				sRe = aRe[t] + c0; sIm = aIm[t] + c1;
+				tRe = aRe[t] - c0; tIm = aIm[t] - c1;
+				uRe = b0 + d0; uIm = b1 + d1;
+				vRe = b1 - d1; vIm = d0 - b0;  // (b - d) times -i
+				oRe[t] = sRe + uRe;
+				oIm[t] = sIm + uIm;
+				oRe[span + t] = tRe + vRe;
+				oIm[span + t] = tIm + vIm;
+				oRe[2 * span + t] = sRe - uRe;
+				oIm[2 * span + t] = sIm - uIm;
+				oRe[3 * span + t] = tRe - vRe;
+				oIm[3 * span + t] = tIm - vIm;
+			}
+			break;
+		default:
+			// A direct transform of radix values
+			for (long t = 0; t < span; t++) {
+				valuesRe[0] = aRe[t];
+				valuesIm[0] = aIm[t];
+				for (int r = 1; r < radix; r++) {
+					tRe = aRe[r * stride + t];
+					tIm = aIm[r * stride + t];
+					valuesRe[r] = tRe * wRe[(r - 1) * span + t] - tIm * wIm[(r - 1) * span + t];
+					valuesIm[r] = tRe * wIm[(r - 1) * span + t] + tIm * wRe[(r - 1) * span + t];
+				}
+				for (int k = 0; k < radix; k++) {
+					sumRe = 0.0;
+					sumIm = 0.0;
+					for (int r = 0; r < radix; r++) {
+						sRe = stage->rootRe[(r * k) % radix];
+						sIm = stage->rootIm[(r * k) % radix];
+						sumRe += valuesRe[r] * sRe - valuesIm[r] * sIm;
+						sumIm += valuesRe[r] * sIm + valuesIm[r] * sRe;
+					}
+					oRe[k * span + t] = sumRe;
+					oIm[k * span + t] = sumIm;
+				}
+			}
+			break;
+		}
+	}
+}
+
+static void conjugate(double* im, long n) {
+	for (long i = 0; i < n; i++) im[i] = -im[i];
+}
+
+static bool runPlan(const fftPlan* plan, double* re, double* im) {
+	// Transforms n values in place.  Returns false if there was no memory for the work buffers
+	long n = plan->n;
+	long m = 0;
+	double* work = NULL;
+	double *xRe = re, *xIm = im, *yRe, *yIm, *swap;
+	double* aRe = NULL;
+	double* aIm = NULL;
+	double tRe = 0.0;
+
+	if (plan->inner == NULL) {
+		if (plan->nrStages == 0) return true;
+		work = malloc(2 * n * sizeof(double));
+		if (work == NULL) return false;
+		yRe = work;
+		yIm = work + n;
+		for (int i = 0; i < plan->nrStages; i++) {
+			runStage(&plan->stages[i], n, xRe, xIm, yRe, yIm);
+			swap = xRe; xRe = yRe; yRe = swap;
+			swap = xIm; xIm = yIm; yIm = swap;
+		}
+		if (xRe != re) {
+			memcpy(re, xRe, n * sizeof(double));
+			memcpy(im, xIm, n * sizeof(double));
+		}
+		free(work);
+		return true;
+	}
+
+	// Bluestein's algorithm: X[k] = chirp[k] (a * filter)[k], where a[j] = x[j] chirp[j]
+	m = plan->inner->n;
+	work = calloc(2 * m, sizeof(double));
+	if (work == NULL) return false;
+	aRe = work;
+	aIm = work + m;
+	for (long j = 0; j < n; j++) {
+		aRe[j] = re[j] * plan->chirpRe[j] - im[j] * plan->chirpIm[j];
+		aIm[j] = re[j] * plan->chirpIm[j] + im[j] * plan->chirpRe[j];
+	}
+	if (!runPlan(plan->inner, aRe, aIm)) {
+		free(work);
+		return false;
+	}
+	// Multiply by the filter and transform back, as the conjugate of the transform of the conjugate
+	for (long k = 0; k < m; k++) {
+		tRe = aRe[k] * plan->filterRe[k] - aIm[k] * plan->filterIm[k];
+		aIm[k] = -(aRe[k] * plan->filterIm[k] + aIm[k] * plan->filterRe[k]);
+		aRe[k] = tRe;
+	}
+	if (!runPlan(plan->inner, aRe, aIm)) {
+		free(work);
+		return false;
+	}
+	for (long k = 0; k < n; k++) {
+		tRe = aRe[k] / m;
+		aIm[k] = -aIm[k] / m;
+		re[k] = tRe * plan->chirpRe[k] - aIm[k] * plan->chirpIm[k];
+		im[k] = tRe * plan->chirpIm[k] + aIm[k] * plan->chirpRe[k];
+	}
+	free(work);
+	return true;
+}
+
+// Writes the discrete Fourier transform of n values to output as pairs of real and imaginary parts.  input holds n
+// real values, or n pairs if complexInput is set.  The inverse transform includes the division by n.  Returns false if
+// there was no memory
+bool fourierTransform(const double* input, bool complexInput, double* output, long n, bool inverse) {
+
+	const fftPlan* plan = findPlan(n);
+	double* re = malloc(2 * n * sizeof(double));
+	double* im = re + n;
+	double scale = inverse ? 1.0 / n : 1.0;
+
+	if (plan == NULL || re == NULL) {
+		free(re);
+		return false;
+	}
+	for (long i = 0; i < n; i++) {
+		re[i] = complexInput ? input[2 * i] : input[i];
+		im[i] = complexInput ? input[2 * i + 1] : 0.0;
+	}
+	// The inverse transform is the conjugate of the transform of the conjugate
+	if (inverse) conjugate(im, n);
+	if (!runPlan(plan, re, im)) {
+		free(re);
+		return false;
+	}
+	for (long i = 0; i < n; i++) {
+		output[2 * i] = re[i] * scale;
+		output[2 * i + 1] = (inverse ? -im[i] : im[i]) * scale;
+	}
+	free(re);
+	return true;
+}
+
+static long fastLength(long n) {
+	// Returns the smallest length of at least n that has no prime factors but 2, 3 and 5
+	long best = 1;
+	while (best < n) best *= 2;
+	for (long p5 = 1; p5 < best; p5 *= 5) {
+		for (long p35 = p5; p35 < best; p35 *= 3) {
+			long length = p35;
+			while (length < n) length *= 2;
+			if (length < best) best = length;
+		}
+	}
+	return best;
+}
+
+// Writes the full convolution of a and b, na + nb - 1 values, or their cross-correlation if correlate is set:
+// c[k] = sum of a[j + k - nb + 1] b[j].  Long arrays are convolved through the FFT, in which both are transformed at once
+// as the real and imaginary parts of one array.  Returns false if there was no memory
+bool convolve(const double* a, long na, const double* b, long nb, double* c, bool correlate) {
+
+	long length = na + nb - 1;
+	long m = fastLength(length);
+	const fftPlan* plan = NULL;
+	double* work = NULL;
+	double *re, *im, *productRe, *productIm;
+	double zRe, zIm, wRe, wIm, xRe, xIm, yRe, yIm;
+	long mirror = 0;
+	long shorter = (na < nb) ? na : nb;
+
+	if (shorter <= CONV_DIRECT_LENGTH || (double)na * nb < CONV_FFT_RATIO * m * log2((double)m)) {
+		for (long k = 0; k < length; k++) c[k] = 0.0;
+		for (long j = 0; j < nb; j++) {
+			double factor = b[correlate ? nb - 1 - j : j];
+			double* row = c + j;
+			for (long i = 0; i < na; i++) row[i] += a[i] * factor;
+		}
+		return true;
+	}
+
+	plan = findPlan(m);
+	work = calloc(4 * m, sizeof(double));
+	if (plan == NULL || work == NULL) {
+		free(work);
+		return false;
+	}
+	re = work;
+	im = work + m;
+	productRe = work + 2 * m;
+	productIm = work + 3 * m;
+	for (long i = 0; i < na; i++) re[i] = a[i];
+	for (long j = 0; j < nb; j++) im[j] = b[correlate ? nb - 1 - j : j];
+	if (!runPlan(plan, re, im)) {
+		free(work);
+		return false;
+	}
+
+	// With z = a + i b, A[k] = (Z[k] + conj(Z[m - k])) / 2 and B[k] = (Z[k] - conj(Z[m - k])) / 2i.  The conjugate of
+	// their product is transformed, to transform it back
+	for (long k = 0; k < m; k++) {
+		mirror = (m - k) % m;
+		zRe = re[k]; zIm = im[k];
+		wRe = re[mirror]; wIm = -im[mirror];
+		xRe = 0.5 * (zRe + wRe); xIm = 0.5 * (zIm + wIm);
+		yRe = 0.5 * (zIm - wIm); yIm = -0.5 * (zRe - wRe);
+		productRe[k] = xRe * yRe - xIm * yIm;
+		productIm[k] = -(xRe * yIm + xIm * yRe);
+	}
+	if (!runPlan(plan, productRe, productIm)) {
+		free(work);
+		return false;
+	}
+	for (long k = 0; k < length; k++) c[k] = productRe[k] / m;
+	free(work);
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "compile.h"
+#include "execute.h"
+#include "variables.h"
+#include "parallel.h"
+#include "formula.h"
+#include "global.h"
+
+// A variable defined by "name := expression" holds a formula: its value is found again whenever a variable the
+// expression reads changes, as in a spreadsheet.  Formulas and the variables they read make a graph, kept as the list
+// of the formulas that read each variable.  When a variable changes, the formulas that depend on it, directly or through
+// other formulas, are found first, along with how many of the inputs of each are among them.  They are then recomputed
+// in waves, each holding the formulas whose inputs are all up to date, so that each is recomputed once and after its
+// inputs, and the others are left alone.  The formulas of a wave don't read each other, so a large wave is spread over
+// the thread pool
+#define FORMULA_CHUNK 256  // Formulas of a wave recomputed by one task of the thread pool
+
+typedef struct {
+	program code;   // The expression, with constants of its own
+	int* inputs;    // Variables the expression reads, each once
+	int nrInputs;
+	int inputCapacity;
+} formula;
+
+typedef struct {
+	formula* definition;  // Formula of the variable, or NULL if it holds a plain value
+	int* dependents;      // Variables whose formulas read this one
+	int nrDependents;
+	int capacity;
+	int pending;          // Inputs of its formula the current update has yet to recompute
+	int mark;             // Epoch of the last search that reached the variable
+} vertex;
+
+typedef struct {
+	const int* slots;
+	int count;
+} waveTask;
+
+static vertex* graph;    // Vertex of each slot.  No formula reads or defines the slots past graphCapacity
+static int graphCapacity;
+static int* reached;     // Variables found by the last search, in the order they were found
+static int reachedCapacity;
+static int* waves;       // Formulas of the current update, wave after wave
+static int wavesCapacity;
+static int epoch;
+
+static bool reserveVertex(int slot) {
+	// Makes the graph cover a slot.  Returns false if there is no memory
+	int previous = graphCapacity;
+
+	if (!growBuffer(&graph, &graphCapacity, slot + 1, sizeof(vertex))) return false;
+	memset(&graph[previous], 0, (graphCapacity - previous) * sizeof(vertex));
+	return true;
+}
+
+static void freeFormula(formula* definition) {
+	freeProgram(&definition->code);
+	free(definition->inputs);
+	free(definition);
+}
+
+static formula* copyFormula(const program* prog, int start, int end) {
+	// Makes a formula of the expression of a program from start to end, with its own copy of the constants it loads, and
+	// finds the variables it reads.  Higher order functions are followed by words of their own and then by their body,
+	// which is read on as part of the expression.  Returns NULL if there is no memory
+	formula* definition = calloc(1, sizeof(formula));
+	unsigned int instruction = 0;
+	int slot = 0;
+	bool known = false;
+
+	if (definition == NULL) return NULL;
+	initProgram(&definition->code);
+	definition->code.stackDepth = prog->stackDepth;
+	for (int pc = start; pc < end && error == NO_ERROR; pc++) {
+		instruction = prog->code[pc];
+		emitCode(&definition->code, instruction);
+		if (instruction == INST_LOAD_CONST) {
+			emitCode(&definition->code, addConstant(&definition->code, prog->constants[prog->code[++pc]]));
+		}
+		else if (instruction == INST_LOAD_VAR) {
+			// Constants never change, so only the variables of the user are inputs
+			slot = prog->code[++pc];
+			emitCode(&definition->code, slot);
+			known = slot < USER_VAR_START;
+			for (int i = 0; i < definition->nrInputs && !known; i++) known = definition->inputs[i] == slot;
+			if (known) continue;
+			if (!growBuffer(&definition->inputs, &definition->inputCapacity, definition->nrInputs + 1, sizeof(int))) {
+				error = ERR_OVERFLOW;
+				break;
+			}
+			definition->inputs[definition->nrInputs] = slot;
+			definition->nrInputs++;
+		}
+		else if (instruction == INST_LOAD_LOCAL) {
+			emitCode(&definition->code, prog->code[++pc]);
+		}
+		else if (instruction >= HIGHER_ORDER_OPERATORS && instruction < END_FUNCS) {
+			for (int i = 1; i < bodyOffset(instruction); i++) emitCode(&definition->code, prog->code[++pc]);
+		}
+	}
+
+	if (error != NO_ERROR) {
+		freeFormula(definition);
+		return NULL;
+	}
+	return definition;
+}
+
+static double evaluate(const formula* definition) {
+	// Runs the expression of a formula.  It is undefined if a variable it reads has been given an array since
+	double locals[MAX_LOCALS] = { 0 };
+	char type = TYPE_DOUBLE;
+
+	for (int i = 0; i < definition->nrInputs; i++) {
+		type = getVariableType(definition->inputs[i]);
+		if (type != TYPE_DOUBLE && type != TYPE_INT) return NAN;
+	}
+	return executeCode(&definition->code, 0, definition->code.length, locals);
+}
+
+static bool addDependent(int slot, int dependent) {
+	vertex* current = &graph[slot];
+
+	if (!growBuffer(&current->dependents, &current->capacity, current->nrDependents + 1, sizeof(int))) return false;
+	current->dependents[current->nrDependents] = dependent;
+	current->nrDependents++;
+	return true;
+}
+
+static void removeDependent(int slot, int dependent) {
+	// The order of the dependents doesn't matter, so the last one takes the place of the one removed
+	vertex* current = &graph[slot];
+
+	for (int i = 0; i < current->nrDependents; i++) {
+		if (current->dependents[i] == dependent) {
+			current->nrDependents--;
+			current->dependents[i] = current->dependents[current->nrDependents];
+			return;
+		}
+	}
+}
+
+static void dropFormula(int slot) {
+	// Makes a variable hold a plain value, which nothing recomputes
+	formula* definition = graph[slot].definition;
+
+	if (definition == NULL) return;
+	for (int i = 0; i < definition->nrInputs; i++) {
+		removeDependent(definition->inputs[i], slot);
+	}
+	freeFormula(definition);
+	graph[slot].definition = NULL;
+}
+
+static int reach(int slot) {
+	// Finds a variable and the formulas that depend on it, breadth first, into reached.  Each is marked with a new epoch,
+	// and the pending count of each formula is set to the number of its inputs among them.  Returns how many were found,
+	// or -1 if there is no memory
+	int count = 1;
+	int dependent = 0;
+	vertex* current = NULL;
+
+	epoch++;
+	if (!growBuffer(&reached, &reachedCapacity, 1, sizeof(int))) return -1;
+	reached[0] = slot;
+	graph[slot].mark = epoch;
+	for (int i = 0; i < count; i++) {
+		current = &graph[reached[i]];
+		for (int j = 0; j < current->nrDependents; j++) {
+			dependent = current->dependents[j];
+			if (graph[dependent].mark != epoch) {
+				if (!growBuffer(&reached, &reachedCapacity, count + 1, sizeof(int))) return -1;
+				graph[dependent].mark = epoch;
+				graph[dependent].pending = 0;
+				reached[count] = dependent;
+				count++;
+			}
+			graph[dependent].pending++;
+		}
+	}
+	return count;
+}
+
+static void recomputeChunk(void* context, int index) {
+	// Recomputes up to FORMULA_CHUNK formulas of a wave
+	const waveTask* task = context;
+	int end = (index + 1) * FORMULA_CHUNK;
+
+	if (end > task->count) end = task->count;
+	for (int i = index * FORMULA_CHUNK; i < end; i++) {
+		setVariable(task->slots[i], evaluate(graph[task->slots[i]].definition));
+	}
+}
+
+static void updateDependents(int slot) {
+	// Recomputes the formulas that depend on a variable that changed.  The first wave is the variable itself, and a
+	// formula joins the wave after the one that recomputed the last of its inputs
+	int count = 0;
+	int start = 0;
+	int end = 1;
+	int next = 0;
+	int dependent = 0;
+	char kind = TYPE_DOUBLE;
+	vertex* current = NULL;
+	waveTask task;
+
+	if (graph[slot].nrDependents == 0) return;
+	count = reach(slot);
+	if (count < 0 || !growBuffer(&waves, &wavesCapacity, count, sizeof(int))) {
+		error = ERR_OVERFLOW;
+		return;
+	}
+	// Variables with formulas hold doubles, unless "load" has given one a value of another kind since.  Those are made
+	// scalars again first, so that storing the values of a wave doesn't move anything in variableMap
+	for (int i = 1; i < count; i++) {
+		kind = variableTypes[variableOffsets[reached[i]]];
+		if (kind != TYPE_DOUBLE && kind != TYPE_INT) setVariable(reached[i], NAN);
+	}
+
+	waves[0] = slot;
+	while (end > start) {
+		if (start > 0) {
+			task.slots = &waves[start];
+			task.count = end - start;
+			parallelFor((task.count + FORMULA_CHUNK - 1) / FORMULA_CHUNK, recomputeChunk, &task);
+		}
+		next = end;
+		for (int i = start; i < end; i++) {
+			current = &graph[waves[i]];
+			for (int j = 0; j < current->nrDependents; j++) {
+				dependent = current->dependents[j];
+				graph[dependent].pending--;
+				if (graph[dependent].pending == 0) {
+					waves[next] = dependent;
+					next++;
+				}
+			}
+		}
+		start = end;
+		end = next;
+	}
+}
+
+// Runs INST_DEFINE at pc, which is followed by a variable, the line number, and the length of an expression and the
+// expression.  The variable is defined by the expression from now on, in place of any formula it had, and is given its
+// value, and the formulas that depend on it are recomputed.  If the formula would depend on itself, or its value is
+// undefined, the error is set and nothing changes.  Returns the value
+double defineFormula(const program* prog, int pc) {
+
+	int slot = prog->code[pc + 1];
+	formula* definition = copyFormula(prog, pc + 4, pc + 4 + prog->code[pc + 3]);
+	double value = 0.0;
+	bool ok = definition != NULL && reserveVertex(slot);
+
+	for (int i = 0; ok && i < definition->nrInputs; i++) {
+		ok = reserveVertex(definition->inputs[i]);
+	}
+	if (!ok || reach(slot) < 0) {
+		error = ERR_OVERFLOW;
+		if (definition != NULL) freeFormula(definition);
+		return 0.0;
+	}
+
+	// The variable, and those whose formulas depend on it, were marked by reach()
+	for (int i = 0; i < definition->nrInputs && error == NO_ERROR; i++) {
+		if (graph[definition->inputs[i]].mark == epoch) error = ERR_CIRCULAR;
+	}
+	if (error == NO_ERROR) value = evaluate(definition);
+	if (error == NO_ERROR && (isnan(value) || isinf(value))) error = ERR_UNDEFINED;
+	for (int i = 0; i < definition->nrInputs && error == NO_ERROR; i++) {
+		if (!addDependent(definition->inputs[i], slot)) {
+			error = ERR_OVERFLOW;
+			for (int j = 0; j < i; j++) removeDependent(definition->inputs[j], slot);
+		}
+	}
+	if (error != NO_ERROR) {
+		freeFormula(definition);
+		return 0.0;
+	}
+
+	dropFormula(slot);
+	graph[slot].definition = definition;
+	setVariable(slot, value);
+	updateDependents(slot);
+	return value;
+}
+
+// Called when a statement stores a value in a variable.  A variable that had a formula holds the plain value from now
+// on, and the formulas that depend on it are recomputed
+void assignedVariable(int slot) {
+
+	if (slot >= graphCapacity) return;
+	dropFormula(slot);
+	updateDependents(slot);
+}
+
+// Called when a variable is deleted.  Its formula is dropped, and so are those that read it, whose variables keep their
+// last value, since the slot may be given to another variable
+void deletedVariable(int slot) {
+
+	if (slot >= graphCapacity) return;
+	dropFormula(slot);
+	while (graph[slot].nrDependents > 0) {
+		dropFormula(graph[slot].dependents[graph[slot].nrDependents - 1]);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include <stdbool.h>
+#include "constants.h"
+#include "global.h"
+
+// State shared by the whole interpreter, declared in global.h.  It is defined apart from main(), so that the
+// benchmarks of bench/ link the same definitions as the calculator
+char error;
+int errorLine;
+char outputFormat = OUTPUT_DECIMAL;
+bool bigIntegers = false;
+int precisionDigits = 0;
+char* terminalInput;   // Entered by user
+char unrecognizedToken[INPUT_HOLDER_SIZE]; // Printed to alert user of invalid input
+unsigned int* expressionRPN;  // Printed to the terminal
+int* expressionArgs;
+double* variableMap;  // Memory for all variables, regardless of type or size
+char* variableTypes;  // Stores type of each word of variableMap, or if space is currently unallocated
+char (*variableNames)[INPUT_HOLDER_SIZE];
+int* variableOffsets;
+operand* operands;  // Numbers and names read from the current line
+char* operandNames;
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include <stdbool.h>
+#include <limits.h>
+#include "constants.h"
+#include "integer.h"
+
+// Exact arithmetic on 64-bit integers.  Statements whose values are all whole numbers are compiled to run on integers,
+// with a version on doubles to fall back to.  The operations here return false whenever their result can't be an
+// integer: on overflow, division by zero, a negative power or a shift out of range.  The statement then runs again on
+// doubles, where the same operation gives a double or NaN, so that integers are never wrong, only sometimes not used
+
+// Returns true for operators that give an integer when all their arguments are integers
+bool isIntegerOperator(unsigned int token) {
+
+	switch (token) {
+	case OP_ADD:
+	case OP_SUB:
+	case OP_MUL:
+	case OP_MOD:
+	case OP_NEG:
+	case OP_DIV_INT:
+	case OP_EXP:
+	case OP_IS:
+	case OP_GREATER_THAN:
+	case OP_LESS_THAN:
+	case OP_GREATER_THAN_EQUAL_TO:
+	case OP_LESS_THAN_EQUAL_TO:
+	case OP_AND:
+	case OP_OR:
+	case OP_NOT:
+	case OP_XOR:
+	case OP_IMPLIES:
+	case OP_IFF:
+	case OP_IMPLIED_BY:
+	case OP_RIGHT_SHIFT:
+	case OP_LEFT_SHIFT:
+	case OP_BITWISE_AND:
+	case OP_BITWISE_OR:
+	case OP_BITWISE_NOT:
+	case OP_BITWISE_XOR:
+	case OP_GCD:
+	case OP_LCM:
+	case OP_NCR:
+	case OP_NPR:
+	case OP_CEIL:
+	case OP_FLOOR:
+	case OP_ROUND:
+	case OP_TRUNC:
+	case OP_SIGN:
+	case OP_ABS:
+	case OP_FACTORIAL:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool multiply(long long int left, long long int right, long long int* result) {
+#ifdef __GNUC__
+	return !__builtin_mul_overflow(left, right, result);
+#else
+	if (left != 0 && right != 0) {
+		if ((left == -1 && right == LLONG_MIN) || (right == -1 && left == LLONG_MIN)) return false;
+		if (left != -1 && right != -1 && (left * right) / right != left) return false;
+	}
+	*result = left * right;
+	return true;
+#endif
+}
+
+static bool power(long long int base, long long int exponent, long long int* result) {
+	// Raises to a power by repeated squaring.  The base is only squared while more bits of the exponent remain, so that
+	// the last squaring can't overflow when the result doesn't
+	long long int value = 1;
+
+	if (exponent < 0) return false;
+	while (exponent > 0) {
+		if ((exponent & 1) && !multiply(value, base, &value)) return false;
+		exponent >>= 1;
+		if (exponent > 0 && !multiply(base, base, &base)) return false;
+	}
+	*result = value;
+	return true;
+}
+
+static bool choose(long long int n, long long int k, bool ordered, long long int* result) {
+	// nCr, or nPr if ordered, as the product of (n - k + i) / i, or of n - k + i alone, for i from 1 to k.  For nCr each
+	// step first divides out the common factor of the product so far and i, so that the result only overflows if it
+	// doesn't fit
+	long long int value = 1;
+	long long int common = 0;
+	long long int divisor = 0;
+	long long int swap = 0;
+
+	if (n < 0 || k < 0) return false;
+	if (k > n) {
+		*result = 0;
+		return true;
+	}
+	if (!ordered && k > n - k) k = n - k;
+	for (long long int i = 1; i <= k; i++) {
+		if (ordered) {
+			if (!multiply(value, n - k + i, &value)) return false;
+			continue;
+		}
+		// value (n - k + i) is divisible by i, so once their common factor is out of value, n - k + i is divisible by
+		// what is left of i
+		common = value;
+		divisor = i;
+		while (divisor != 0) {
+			swap = divisor;
+			divisor = common % divisor;
+			common = swap;
+		}
+		if (!multiply(value / common, (n - k + i) / (i / common), &value)) return false;
+	}
+	*result = value;
+	return true;
+}
+
+static long long int greatestDivisor(long long int a, long long int b) {
+	// The Euclidean algorithm, with the same signs as gcd() on doubles
+	long long int swap = 0;
+
+	while (b != 0) {
+		swap = b;
+		b = (b == -1) ? 0 : a % b;
+		a = swap;
+	}
+	return a;
+}
+
+// Applies a two-input operator to integers.  Returns false if the result isn't an integer that fits in 64 bits
+bool applyIntegerBinary(unsigned int operand, long long int left, long long int right, long long int* result) {
+
+	long long int divisor = 0;
+
+	switch (operand) {
+	case OP_ADD:
+		if ((right > 0 && left > LLONG_MAX - right) || (right < 0 && left < LLONG_MIN - right)) return false;
+		*result = left + right;
+		return true;
+	case OP_SUB:
+		if ((right < 0 && left > LLONG_MAX + right) || (right > 0 && left < LLONG_MIN + right)) return false;
+		*result = left - right;
+		return true;
+	case OP_MUL:
+		return multiply(left, right, result);
+	case OP_DIV_INT:
+		if (right == 0 || (left == LLONG_MIN && right == -1)) return false;
+		*result = left / right;
+		return true;
+	case OP_MOD:
+		if (right == 0) return false;
+		*result = (right == -1) ? 0 : left % right;
+		return true;
+	case OP_EXP:
+		return power(left, right, result);
+	case OP_GCD:
+		*result = greatestDivisor(right, left);
+		return true;
+	case OP_LCM:
+		divisor = greatestDivisor(right, left);
+		if (divisor == 0 || (right == LLONG_MIN && divisor == -1)) return false;
+		return multiply(right / divisor, left, result);
+	case OP_NCR:
+		return choose(left, right, false, result);
+	case OP_NPR:
+		return choose(left, right, true, result);
+	case OP_LEFT_SHIFT:
+		if (right < 0 || right > 63) return false;
+		*result = (long long int)((unsigned long long int)left << right);
+		return (*result >> right) == left;
+	case OP_RIGHT_SHIFT:
+		if (right < 0) return false;
+		*result = (right > 63) ? ((left < 0) ? -1 : 0) : left >> right;
+		return true;
+	case OP_BITWISE_AND:
+		*result = left & right;
+		return true;
+	case OP_BITWISE_OR:
+		*result = left | right;
+		return true;
+	case OP_BITWISE_XOR:
+		*result = left ^ right;
+		return true;
+	case OP_IS:
+		*result = left == right;
+		return true;
+	case OP_GREATER_THAN:
+		*result = left > right;
+		return true;
+	case OP_GREATER_THAN_EQUAL_TO:
+		*result = left >= right;
+		return true;
+	case OP_LESS_THAN:
+		*result = left < right;
+		return true;
+	case OP_LESS_THAN_EQUAL_TO:
+		*result = left <= right;
+		return true;
+	case OP_AND:
+		*result = left && right;
+		return true;
+	case OP_OR:
+		*result = left || right;
+		return true;
+	case OP_XOR:
+		*result = !(left) != !(right);
+		return true;
+	case OP_IMPLIES:
+		*result = !(left) || right;
+		return true;
+	case OP_IFF:
+		*result = !(left) == !(right);
+		return true;
+	case OP_IMPLIED_BY:
+		*result = left && !right;
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Applies a single-input operator to an integer.  Returns false if the result doesn't fit in 64 bits
+bool applyIntegerUnary(unsigned int operand, long long int value, long long int* result) {
+
+	switch (operand) {
+	case OP_NEG:
+		if (value == LLONG_MIN) return false;
+		*result = -value;
+		return true;
+	case OP_ABS:
+		if (value == LLONG_MIN) return false;
+		*result = (value < 0) ? -value : value;
+		return true;
+	case OP_NOT:
+		*result = !value;
+		return true;
+	case OP_BITWISE_NOT:
+		*result = ~value;
+		return true;
+	case OP_SIGN:
+		*result = (value >= 0) ? 1 : -1;
+		return true;
+	case OP_CEIL:
+	case OP_FLOOR:
+	case OP_ROUND:
+	case OP_TRUNC:
+		*result = value;
+		return true;
+	case OP_FACTORIAL:
+		if (value < 0) return false;
+		*result = 1;
+		for (long long int i = 2; i <= value; i++) {
+			if (!multiply(*result, i, result)) return false;
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Reads a number written as digits alone, such as the text of a literal.  Returns false if it has other characters or
+// doesn't fit in 64 bits
+bool parseInteger(const char text[], int length, long long int* value) {
+
+	long long int result = 0;
+
+	if (length < 1) return false;
+	for (int i = 0; i < length; i++) {
+		if (text[i] < '0' || text[i] > '9') return false;
+		if (result > (LLONG_MAX - (text[i] - '0')) / 10) return false;
+		result = 10 * result + (text[i] - '0');
+	}
+	*value = result;
+	return true;
+}
\ No newline at end of file
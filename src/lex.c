@@ -0,0 +1,395 @@
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include "constants.h"
+#include "lex.h"
+
+// Splits a line into lexemes in one pass.  Every character is classified by a lookup in a table of 256 entries rather
+// than by chains of comparisons.  Runs of digits, of name characters and of spaces are found from masks with one bit per
+// character of a block of 64, made with SSE2, or AVX2 when the compiler targets it, so that the end of a run is found
+// with a bit scan rather than by looking at each character.  A number is found whole from masks of the 32 characters
+// from its start, without a branch for each of its digits, points and exponents.  A run that ends at its first
+// character, such as the single spaces around operators, is found from the table, which is cheaper than a mask.  Build
+// with -DLEX_NO_SIMD to scan every run through the table
+#if !defined(LEX_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define LEX_AVX2
+#elif !defined(LEX_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define LEX_SSE2
+#endif
+
+#define CLASS_DIGIT 1
+#define CLASS_LETTER 2
+#define CLASS_NAME 4    // Letters, digits and '_', which may continue a name
+#define CLASS_SPACE 8
+#define BLOCK_SIZE 64
+#define LITERAL_SIZE 32  // Characters a number is found from at once
+
+typedef struct {
+	int start;          // Position of the first character of the block
+	uint64_t digits;    // Bit i is set if character start + i is of the class
+	uint64_t names;
+	uint64_t spaces;
+} block;
+
+static unsigned char classes[256];
+static unsigned int symbols[256];  // Token of each character that is a whole lexeme on its own, or 0
+static bool tablesReady;
+
+static void buildTables() {
+	for (int c = '0'; c <= '9'; c++) classes[c] = CLASS_DIGIT | CLASS_NAME;
+	for (int c = 'a'; c <= 'z'; c++) classes[c] = CLASS_LETTER | CLASS_NAME;
+	for (int c = 'A'; c <= 'Z'; c++) classes[c] = CLASS_LETTER | CLASS_NAME;
+	classes['_'] = CLASS_NAME;
+	classes[' '] = CLASS_SPACE;
+
+	symbols[','] = ARG_SEPARATOR;
+	symbols['('] = LEFT_PARENTH;
+	symbols[')'] = RIGHT_PARENTH;
+	symbols['['] = LEFT_BRACKET;
+	symbols[']'] = RIGHT_BRACKET;
+	symbols['+'] = OP_ADD;
+	symbols['*'] = OP_MUL;
+	symbols['/'] = OP_DIV;
+	symbols['^'] = OP_EXP;
+	symbols['@'] = OP_MATMUL;
+	symbols['='] = LEX_EQUALS;
+	tablesReady = true;
+}
+
+static bool isExponentStart(const char input[]) {
+	// Returns true if the characters after an 'e' in a number form an exponent, such as "8" in 1e8 or "-6" in 1e-6
+	if (input[0] == '-') input++;
+	return input[0] >= '0' && input[0] <= '9';
+}
+
+#if defined(LEX_AVX2) || defined(LEX_SSE2)
+static int lowestBit(uint64_t bits) {
+	// Position of the lowest set bit, which must exist
+#ifdef __GNUC__
+	return __builtin_ctzll(bits);
+#else
+	int position = 0;
+	while (!(bits & 1)) {
+		bits >>= 1;
+		position++;
+	}
+	return position;
+#endif
+}
+
+static void classify(const char text[], int start, int length, block* current) {
+	// Makes the masks of the block starting at start.  A block running past length is copied into one padded with zeros,
+	// which are of no class, so that nothing after the line is read
+	const char* bytes = &text[start];
+	char padded[BLOCK_SIZE];
+
+	current->start = start;
+	if (length - start < BLOCK_SIZE) {
+		memset(padded, 0, BLOCK_SIZE);
+		memcpy(padded, bytes, length - start);
+		bytes = padded;
+	}
+	current->digits = 0;
+	current->names = 0;
+	current->spaces = 0;
+
+	// Bytes above 127 are negative, so they are never within a range.  Letters are matched in lower case
+#ifdef LEX_AVX2
+	for (int i = 0; i < BLOCK_SIZE; i += 32) {
+		__m256i chunk = _mm256_loadu_si256((const __m256i*)&bytes[i]);
+		__m256i lower = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+		__m256i digits = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('0' - 1)),
+			_mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chunk));
+		__m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+			_mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+		__m256i names = _mm256_or_si256(_mm256_or_si256(digits, letters), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('_')));
+
+		current->digits |= (uint64_t)(uint32_t)_mm256_movemask_epi8(digits) << i;
+		current->names |= (uint64_t)(uint32_t)_mm256_movemask_epi8(names) << i;
+		current->spaces |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' '))) << i;
+	}
+#else
+	for (int i = 0; i < BLOCK_SIZE; i += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)&bytes[i]);
+		__m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+		__m128i digits = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), chunk));
+		__m128i letters = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), lower));
+		__m128i names = _mm_or_si128(_mm_or_si128(digits, letters), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_')));
+
+		current->digits |= (uint64_t)_mm_movemask_epi8(digits) << i;
+		current->names |= (uint64_t)_mm_movemask_epi8(names) << i;
+		current->spaces |= (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '))) << i;
+	}
+#endif
+}
+
+static int scanRun(const char text[], int i, int length, block* current, int kind) {
+	// Returns the position of the first character from i on that is not of the class CLASS_DIGIT, CLASS_NAME or
+	// CLASS_SPACE, moving the block on as needed
+	uint64_t others = 0;  // Characters of the block from i on that are not of the class
+	int offset = 0;
+
+	if (i < length && !(classes[(unsigned char)text[i]] & kind)) return i;
+	while (i < length) {
+		if (i >= current->start + BLOCK_SIZE) classify(text, i, length, current);
+		offset = i - current->start;
+		others = ~(((kind == CLASS_DIGIT) ? current->digits : (kind == CLASS_NAME) ? current->names : current->spaces) >> offset);
+		// Shifting brings in zeros, which look like the end of the run at the end of the block
+		if (others != 0 && lowestBit(others) < BLOCK_SIZE - offset) return i + lowestBit(others);
+		i = current->start + BLOCK_SIZE;
+	}
+	return length;
+}
+
+static uint32_t matchBytes(const char bytes[], char c) {
+	// Bit i is set if bytes[i] is c, for the first LITERAL_SIZE bytes
+#ifdef LEX_AVX2
+	__m256i chunk = _mm256_loadu_si256((const __m256i*)bytes);
+	return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(c)));
+#else
+	__m128i low = _mm_loadu_si128((const __m128i*)bytes);
+	__m128i high = _mm_loadu_si128((const __m128i*)&bytes[16]);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(low, _mm_set1_epi8(c)))
+		| (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_set1_epi8(c))) << 16;
+#endif
+}
+
+static uint32_t matchDigits(const char bytes[]) {
+	// Bit i is set if bytes[i] is a digit, for the first LITERAL_SIZE bytes
+#ifdef LEX_AVX2
+	__m256i chunk = _mm256_loadu_si256((const __m256i*)bytes);
+	return (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('0' - 1)),
+		_mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chunk)));
+#else
+	__m128i low = _mm_loadu_si128((const __m128i*)bytes);
+	__m128i high = _mm_loadu_si128((const __m128i*)&bytes[16]);
+	return (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(low, _mm_set1_epi8('0' - 1)),
+			_mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), low)))
+		| (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(high, _mm_set1_epi8('0' - 1)),
+			_mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), high))) << 16;
+#endif
+}
+
+static int scanLiteral(const char text[], int i, int length, unsigned int* kind) {
+	// Finds the end of the number at i, by the rules of scanNumber(), from masks of the LITERAL_SIZE characters from i,
+	// without a branch per character, and sets its kind.  Returns -1, leaving the number to scanNumber(), if it may be
+	// longer than that
+	const char* bytes = &text[i];
+	char padded[LITERAL_SIZE];
+	uint32_t digits = 0;
+	uint32_t dots = 0;
+	uint32_t minuses = 0;
+	uint32_t lowerE = 0;
+	uint32_t exponents = 0;  // 'E', and 'e' followed by a digit or by '-' and a digit
+	uint32_t stops = 0;      // Characters the number can't go on through
+	uint32_t first = 0;      // Its first exponent
+	uint32_t late = 0;       // Decimal points after it
+	int end = 0;
+
+	if (length - i < LITERAL_SIZE) {
+		memset(padded, 0, LITERAL_SIZE);
+		memcpy(padded, bytes, length - i);
+		bytes = padded;
+	}
+	digits = matchDigits(bytes);
+	dots = matchBytes(bytes, '.');
+	minuses = matchBytes(bytes, '-');
+	lowerE = matchBytes(bytes, 'e');
+	exponents = matchBytes(bytes, 'E') | (lowerE & ((digits >> 1) | ((minuses >> 1) & (digits >> 2))));
+	// A '-' only straight after an exponent.  Whether an 'e' near the end starts one depends on characters past them
+	stops = ~(digits | dots | exponents | (minuses & (exponents << 1)));
+	if (stops == 0 || lowestBit(stops) >= LITERAL_SIZE - 2) return -1;
+	end = lowestBit(stops);
+
+	// A second exponent ends the number, and a '.' after the first makes it bad
+	*kind = LEX_NUMBER;
+	exponents &= (1u << end) - 1;
+	if (exponents != 0) {
+		first = exponents & (0u - exponents);
+		if ((exponents & (exponents - 1)) != 0) end = lowestBit(exponents & (exponents - 1));
+		late = dots & ~(first - 1) & ((1u << end) - 1);
+		if (late != 0) {
+			end = lowestBit(late);
+			*kind = LEX_BAD_NUMBER;
+		}
+	}
+	dots &= (1u << end) - 1;
+	if ((dots & (dots - 1)) != 0) *kind = LEX_BAD_NUMBER;
+	return i + end;
+}
+#else
+static void classify(const char text[], int start, int length, block* current) {
+	// Without SIMD runs are scanned through the table, and there are no masks
+	(void)text;
+	(void)length;
+	current->start = start;
+}
+
+static int scanRun(const char text[], int i, int length, block* current, int kind) {
+	(void)current;
+	while (i < length && (classes[(unsigned char)text[i]] & kind)) i++;
+	return i;
+}
+
+static int scanLiteral(const char text[], int i, int length, unsigned int* kind) {
+	// Every number is left to scanNumber()
+	(void)text;
+	(void)i;
+	(void)length;
+	(void)kind;
+	return -1;
+}
+#endif
+
+static unsigned int scanNumber(const char text[], int* index, int length, block* current) {
+	// Numbers are digits with at most one '.', and an exponent after 'E', or after 'e' when a digit or a negative exponent
+	// follows, so that "2e" still multiplies by e.  A '-' is only part of a number straight after the 'E'.  Returns
+	// LEX_NUMBER, or LEX_BAD_NUMBER for a '.' in the exponent or several decimal points
+	int i = *index;
+	int next = 0;
+	int decimals = 0;
+	int exponents = 0;
+	bool afterE = false;
+	unsigned int kind = LEX_NUMBER;
+	char c = 0;
+
+	next = scanLiteral(text, i, length, &kind);
+	if (next >= 0) {
+		*index = next;
+		return kind;
+	}
+	while (i < length) {
+		next = scanRun(text, i, length, current, CLASS_DIGIT);
+		if (next > i) {
+			afterE = false;
+			i = next;
+			if (i >= length) break;
+		}
+		c = text[i];
+		if (c == '-') {
+			if (!afterE) break;
+			afterE = false;
+		}
+		else if (c == '.') {
+			if (exponents > 0) {
+				kind = LEX_BAD_NUMBER;
+				break;
+			}
+			afterE = false;
+			decimals++;
+		}
+		else if (c == 'E' || (c == 'e' && isExponentStart(&text[i + 1]))) {
+			exponents++;
+			afterE = true;
+			if (exponents > 1) break;
+		}
+		else {
+			break;
+		}
+		i++;
+	}
+	*index = i;
+	return (decimals > 1) ? LEX_BAD_NUMBER : kind;
+}
+
+// Splits text, up to its line break or end, into lexemes.  Numbers and names are left as their position and length,
+// operators and brackets become their tokens, and spaces are skipped.  '-' and '=' depend on what comes before them,
+// and are left to the parser.  At most capacity lexemes are stored, and the number the line has is returned, so that
+// the caller can grow the array and lex the line again if it was too small
+int lexLine(const char text[], lexeme lexemes[], int capacity) {
+
+	int length = (int)strcspn(text, "\n");
+	int count = 0;
+	int i = 0;
+	int start = 0;
+	unsigned char c = 0;
+	unsigned int token = 0;
+	block current;
+
+	if (!tablesReady) buildTables();
+	classify(text, 0, length, &current);
+
+	while (i < length) {
+		c = (unsigned char)text[i];
+		start = i;
+
+		if (classes[c] & CLASS_SPACE) {
+			i = scanRun(text, i + 1, length, &current, CLASS_SPACE);
+			continue;
+		}
+		if (classes[c] & CLASS_DIGIT) {
+			token = scanNumber(text, &i, length, &current);
+		}
+		else if (classes[c] & CLASS_LETTER) {
+			i = scanRun(text, i + 1, length, &current, CLASS_NAME);
+			token = LEX_NAME;
+		}
+		else if (symbols[c] != 0) {
+			token = symbols[c];
+			i++;
+		}
+		else {
+			// Operators of one or more characters that start with '<', '>' or '-', and ":="
+			i++;
+			switch (c) {
+			case '<':
+				token = OP_LESS_THAN;
+				if (text[i] == '=') {
+					token = OP_LESS_THAN_EQUAL_TO;
+					i++;
+				}
+				else if (text[i] == '<') {
+					token = OP_LEFT_SHIFT;
+					i++;
+				}
+				else if (text[i] == '-') {
+					token = OP_IMPLIED_BY;
+					i++;
+					if (text[i] == '>') {
+						token = OP_IFF;
+						i++;
+					}
+				}
+				break;
+			case '>':
+				token = OP_GREATER_THAN;
+				if (text[i] == '=') {
+					token = OP_GREATER_THAN_EQUAL_TO;
+					i++;
+				}
+				else if (text[i] == '>') {
+					token = OP_RIGHT_SHIFT;
+					i++;
+				}
+				break;
+			case '-':
+				token = LEX_MINUS;
+				if (text[i] == '>') {
+					token = OP_IMPLIES;
+					i++;
+				}
+				break;
+			case ':':
+				token = LEX_UNKNOWN;
+				if (text[i] == '=') {
+					token = LEX_DEFINE;
+					i++;
+				}
+				break;
+			default:
+				token = LEX_UNKNOWN;
+				break;
+			}
+		}
+
+		if (count < capacity) {
+			lexemes[count].token = token;
+			lexemes[count].start = start;
+			lexemes[count].length = i - start;
+		}
+		count++;
+	}
+	return count;
+}
\ No newline at end of file
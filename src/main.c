@@ -1,107 +1,301 @@
-/*
-Created by Juliusz Jakobowski
-
-A command line program that recieves a mathematical expression as input, evaluates the expression, and returns the result.
-Implemented using a shunting yard algorithm modified to accept functions, implicit multiplication, and ability to distinguish
-unary negation and binary subtraction.
-
-Released under the MIT License.
-*/
-
-#include <stdio.h>
-#include <math.h>
-#include <stdlib.h>
-#include <stdbool.h>
-#include "constants.h"
-#include "tokenize.h"
-#include "auxiliary.h"
-#include "variables.h"
-#include "rpn.h"
-#include "global.h"
-
-typedef struct {
-	char size;
-	char dim[7];
-} array_header;
-
-// *(int*)(A+1);   To access multiple positions of char array as a single int
-// variableMap[position] = malloc(sizeof(double));
-// *((double*)variableMap[position]) = value;
-
-char error;
-char terminalInput[INPUT_SIZE];   // Entered by user
-char unrecognizedToken[INPUT_HOLDER_SIZE]; // Printed to alert user of invalid input
-unsigned int expressionRPN[RPN_SIZE];  // Printed to the terminal
-double variableMap[VAR_MAP_SIZE];  // Memory for all variables, regardless of type or size
-char variableNames[VAR_NAME_SIZE][10];
-char variableTypes[VAR_MAP_SIZE];  // Stores type of each variable, or if space is currently unallocated
-
-// User enters an expression as input.  It is evaluated and the result is returned, barring any errors
-int main() {
-
-	double printVal;  // Value resulting from computation
-	bool scientificNotation = false;
-
-	variableNames[1][0] = 'a'; variableNames[1][1] = 'n'; variableNames[1][2] = 's';
-	loadVariables(CONST_START, USER_VAR_START, "consts.txt"); // Load constants
-
-	printf("> ");
-	while (fgets(terminalInput, INPUT_SIZE, stdin)) {
-
-		if (terminalInput[INPUT_SIZE - 2] != '\0') {
-			error = ERR_OVERFLOW;
-		}
-		
-		// Perform calculation
-		if (error == NO_ERROR) {
-			inputToRPN();   
-		}
-		if (error == NO_ERROR) {
-			printVal = evaluateRPN(); ////////// IN PROGRESS
-		}
-
-		// Print output, depending on errors and other conditions
-		switch (error) {
-		case NO_ERROR:
-			if (scientificNotation) {
-				printf("  %.15E\n", printVal);
-			}
-			else {
-				printf("  %.*lf\n", findNumDecimals(printVal), printVal);
-			}
-
-			// Set "ans" to the latest result
-			variableMap[ANS_ADDR] = printVal;
-
-			break;
-		case ERR_SYNTAX:
-			printf("  Syntax error\n");
-			break;
-		case ERR_UNKNOWN_TOKEN:
-			printf("  Unrecognized token \"");
-			for (int i = 0; i < INPUT_HOLDER_SIZE-1; i++) {
-				if (unrecognizedToken[i] == '\0') break;
-				if (unrecognizedToken[i] == '\t') {
-					printf("[tab]");
-				}
-				else {
-					printf("%c", unrecognizedToken[i]);
-				}
-			}
-			if (unrecognizedToken[INPUT_HOLDER_SIZE - 1] != 0) printf("...");
-			printf("\"\n");
-			break;
-		case ERR_OVERFLOW:
-			printf("  Overflow error\n");
-			break;
-		case ERR_UNDEFINED:
-			printf("  Undefined or out of bounds\n");
-			break;
-		}
-
-		printf("\n> ");
-		resetValues(&printVal);
-	}
-
-	return 0;
+/*
+Created by Juliusz Jakobowski
+
+A command line program that recieves a mathematical expression as input, evaluates the expression, and returns the result.
+Implemented using a shunting yard algorithm modified to accept functions, implicit multiplication, and ability to distinguish
+unary negation and binary subtraction.
+
+Released under the MIT License.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include "constants.h"
+#include "tokenize.h"
+#include "auxiliary.h"
+#include "variables.h"
+#include "rpn.h"
+#include "script.h"
+#include "parallel.h"
+#include "solve.h"
+#include "ode.h"
+#include "sweep.h"
+#include "csv.h"
+#include "montecarlo.h"
+#include "random.h"
+#include "profile.h"
+#include "global.h"
+
+static bool mapOption(char option[], bool single) {
+	// Binds the variable of a "name=file" option to the values of the file
+	char* equals = strchr(option, '=');
+	bool identifier = equals != NULL && equals > option && isalpha((unsigned char)option[0]);
+
+	for (const char* c = option; identifier && c < equals; c++) {
+		identifier = isalnum((unsigned char)*c) || *c == '_';
+	}
+	if (!identifier) {
+		printf("  Expected name=file, not \"%s\"\n", option);
+		return false;
+	}
+	*equals = '\0';
+	return mapVariable(option, equals + 1, single);
+}
+
+static const char* profileName;  // File the counters of --profile are written to at exit
+
+static void dumpProfile() {
+	// Writes the instrumentation counters as JSON at exit to the file given with --profile, or else to stderr if
+	// instrumentation is on
+	FILE* file = stderr;
+
+	if (!profiling && profileName == NULL) return;
+	stopProfile();
+	if (profileName != NULL) file = fopen(profileName, "w");
+	if ((file == NULL || !writeProfile(file)) && profileName != NULL) fprintf(stderr, "  Could not write %s\n", profileName);
+	if (file != NULL && file != stderr) fclose(file);
+}
+
+static bool runStatsCommand() {
+	// "stats" prints what instrumentation has counted, "stats on" and "stats off" turn it on and off, "stats detail"
+	// turns it on counting every instruction, and "stats reset" forgets the counts.  Returns false if the line is not
+	// one of them
+	char* word = &terminalInput[5];
+	int length = 0;
+
+	if (strncmp(terminalInput, "stats", 5) != 0 || !isspace((unsigned char)terminalInput[5])) return false;
+	while (*word == ' ' || *word == '\t') word++;
+	length = (int)strlen(word);
+	while (length > 0 && isspace((unsigned char)word[length - 1])) length--;
+	word[length] = '\0';
+	if (length == 0) {
+		printProfile();
+	}
+	else if (strcmp(word, "on") == 0) {
+		startProfile(false);
+	}
+	else if (strcmp(word, "detail") == 0) {
+		startProfile(true);
+	}
+	else if (strcmp(word, "off") == 0) {
+		stopProfile();
+	}
+	else if (strcmp(word, "reset") == 0) {
+		resetProfile();
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+static bool runSessionCommand() {
+	// "save file" and "load file" save the variables of the session to a file, and restore them, "bigint on" and
+	// "bigint off" turn integers of any size on and off, "prec N" and "prec off" set the number of significant digits
+	// calculations are done to, and go back to doubles, and "seed N" starts random draws over from a seed, which "seed"
+	// prints.  Returns false if the line is not one of them
+	char* fileName = &terminalInput[5];
+	char* word = NULL;
+	char* end = NULL;
+	long digits = 0;
+	unsigned long long int seed = 0;
+	int length = 0;
+
+	if (strncmp(terminalInput, "prec off", 8) == 0 && isspace((unsigned char)terminalInput[8])) {
+		precisionDigits = 0;
+		return true;
+	}
+	if (strncmp(terminalInput, "prec ", 5) == 0) {
+		digits = strtol(&terminalInput[5], &end, 10);
+		if (end == &terminalInput[5] || !isspace((unsigned char)*end)) return false;
+		if (digits < 1 || digits > MAX_PRECISION) {
+			printf("  The precision must be from 1 to %d digits\n", MAX_PRECISION);
+		}
+		else {
+			precisionDigits = (int)digits;
+		}
+		return true;
+	}
+	if (strncmp(terminalInput, "seed", 4) == 0 && isspace((unsigned char)terminalInput[4])) {
+		word = &terminalInput[4];
+		while (isspace((unsigned char)*word)) word++;
+		if (*word == '\0') {
+			printf("  %llu\n", getSeed());
+			return true;
+		}
+		if (!isdigit((unsigned char)*word)) return false;
+		seed = strtoull(word, &end, 10);
+		if (!isspace((unsigned char)*end)) return false;
+		seedRandom(seed);
+		return true;
+	}
+	if (strncmp(terminalInput, "bigint on", 9) == 0 && isspace((unsigned char)terminalInput[9])) {
+		bigIntegers = true;
+		return true;
+	}
+	if (strncmp(terminalInput, "bigint off", 10) == 0 && isspace((unsigned char)terminalInput[10])) {
+		bigIntegers = false;
+		return true;
+	}
+	if (strncmp(terminalInput, "save ", 5) != 0 && strncmp(terminalInput, "load ", 5) != 0) return false;
+	while (*fileName == ' ' || *fileName == '\t') fileName++;
+	length = (int)strlen(fileName);
+	while (length > 0 && isspace((unsigned char)fileName[length - 1])) length--;
+	if (length == 0) return false;
+	fileName[length] = '\0';
+
+	if (terminalInput[0] == 's') {
+		saveSession(fileName);
+	}
+	else {
+		loadSession(fileName);
+	}
+	return true;
+}
+
+// User enters an expression as input.  It is evaluated and the result is returned, barring any errors
+// Started as "clc -f script.clc", the whole file is compiled and then run instead.  "-j N" sets the thread count
+int main(int argc, char* argv[]) {
+
+	double printVal;  // Value resulting from computation
+	char* scriptName = NULL;
+	char** solveArgs = NULL;
+	char** odeArgs = NULL;
+	int nrOdeArgs = 0;
+	char** sweepArgs = NULL;
+	int nrSweepArgs = 0;
+	char** csvArgs = NULL;
+	int nrCsvArgs = 0;
+	char** monteCarloArgs = NULL;
+	int nrMonteCarloArgs = 0;
+	bool minimize = false;
+	int* mapOptions = calloc(argc, sizeof(int));  // Position of each --map and --mapf option
+	int nrMapOptions = 0;
+	char* sessionName = NULL;
+	bool command = false;  // Whether the line was "save" or "load" rather than an expression
+
+	if (mapOptions == NULL) return 1;
+	atexit(dumpProfile);
+	// Command line options: -f <script>, -j <threads>, --solve/--minimize <expression> <x=low:high> <p=first:step:last>,
+	// --odesolve <t=start:step:end> <equations and initial values...>, --sweep <ranges...> <expression>,
+	// --csv <file> <expressions...>, and --montecarlo <samples> <expressions...>, which take the rest of the line.
+	// --map <name=file> makes a variable an array of the doubles of a file, or of a .npy file, and --mapf <name=file> one
+	// of floats, without reading the file.  --load <file> restores a session saved with "save file", --bigint keeps
+	// integers of any size exactly, --prec <digits> does calculations to that many significant digits, and --seed <number>
+	// seeds random draws.  --profile <file> turns instrumentation on and writes what it counted to the file as JSON at
+	// exit, and --profile-detail <file> does too, counting every instruction
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			scriptName = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--solve") == 0 || strcmp(argv[i], "--minimize") == 0) && i + 3 < argc) {
+			minimize = (strcmp(argv[i], "--minimize") == 0);
+			solveArgs = &argv[i + 1];
+			i += 3;
+		}
+		else if (strcmp(argv[i], "--odesolve") == 0) {
+			odeArgs = &argv[i + 1];
+			nrOdeArgs = argc - i - 1;
+			break;
+		}
+		else if (strcmp(argv[i], "--sweep") == 0) {
+			sweepArgs = &argv[i + 1];
+			nrSweepArgs = argc - i - 1;
+			break;
+		}
+		else if (strcmp(argv[i], "--csv") == 0) {
+			csvArgs = &argv[i + 1];
+			nrCsvArgs = argc - i - 1;
+			break;
+		}
+		else if (strcmp(argv[i], "--montecarlo") == 0) {
+			monteCarloArgs = &argv[i + 1];
+			nrMonteCarloArgs = argc - i - 1;
+			break;
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) {
+			seedRandom(strtoull(argv[++i], NULL, 10));
+		}
+		else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			setNrThreads(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--bigint") == 0) {
+			bigIntegers = true;
+		}
+		else if (strcmp(argv[i], "--prec") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 1
+			&& atoi(argv[i + 1]) <= MAX_PRECISION) {
+			precisionDigits = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--profile") == 0 || strcmp(argv[i], "--profile-detail") == 0) && i + 1 < argc) {
+			startProfile(strcmp(argv[i], "--profile-detail") == 0);
+			profileName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+			sessionName = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--map") == 0 || strcmp(argv[i], "--mapf") == 0) && i + 1 < argc) {
+			mapOptions[nrMapOptions++] = i;
+			i++;
+		}
+		else {
+			printf("  Unrecognized option \"%s\"\n", argv[i]);
+			return 1;
+		}
+	}
+
+	initVariables();
+	loadVariables(CONST_START, USER_VAR_START, "consts.txt"); // Load constants
+	for (int i = 0; i < nrMapOptions; i++) {
+		if (!mapOption(argv[mapOptions[i] + 1], strcmp(argv[mapOptions[i]], "--mapf") == 0)) return 1;
+	}
+	free(mapOptions);
+	if (sessionName != NULL && !loadSession(sessionName)) return 1;
+
+	if (scriptName != NULL) {
+		return runScript(scriptName);
+	}
+	if (solveArgs != NULL) {
+		return runSolveBatch(minimize, solveArgs[0], solveArgs[1], solveArgs[2]);
+	}
+	if (odeArgs != NULL) {
+		return runOdeSolve(nrOdeArgs, odeArgs);
+	}
+	if (sweepArgs != NULL) {
+		return runSweep(nrSweepArgs, sweepArgs);
+	}
+	if (csvArgs != NULL) {
+		return runCsv(nrCsvArgs, csvArgs);
+	}
+	if (monteCarloArgs != NULL) {
+		return runMonteCarlo(nrMonteCarloArgs, monteCarloArgs);
+	}
+
+	printf("> ");
+	while (readLine(stdin)) {
+
+		// Perform calculation
+		command = (error == NO_ERROR) && (runSessionCommand() || runStatsCommand());
+		if (error == NO_ERROR && !command) {
+			enterStage(STAGE_PARSE);
+			inputToRPN();
+			leaveStage();
+		}
+		if (error == NO_ERROR && !command) {
+			// Prints the result, which becomes "ans"
+			printVal = evaluateRPN();
+		}
+		if (error != NO_ERROR) {
+			printError();
+		}
+
+		printf("\n> ");
+		resetValues(&printVal);
+		compactVariables();
+	}
+
+	return 0;
 }
\ No newline at end of file
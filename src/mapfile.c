@@ -0,0 +1,173 @@
+#define _POSIX_C_SOURCE 200112L  // mmap and posix_madvise
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "constants.h"
+#include "mapfile.h"
+
+// Arrays read straight from binary files.  The file is mapped read-only and its values are used where they are, so
+// nothing is parsed or copied, and pages are only read from disk when the values on them are first used.  Files are
+// either raw little-endian doubles or floats, or NumPy .npy files of one of those, with one or two dimensions
+#define NPY_MAGIC "\x93NUMPY"
+
+static bool isLittleEndian() {
+	uint16_t probe = 1;
+	return *(unsigned char*)&probe == 1;
+}
+
+static const char* findKey(const char* header, long length, const char* key) {
+	// Returns the position after the colon following a quoted key of the header of a .npy file, or NULL
+	long keyLength = (long)strlen(key);
+
+	for (long i = 1; i + keyLength + 1 < length; i++) {
+		if ((header[i - 1] == '\'' || header[i - 1] == '"') && strncmp(&header[i], key, keyLength) == 0
+			&& header[i + keyLength] == header[i - 1]) {
+			for (i += keyLength + 1; i < length && header[i] != ':'; i++);
+			return (i < length) ? &header[i + 1] : NULL;
+		}
+	}
+	return NULL;
+}
+
+static bool readNpyHeader(const unsigned char* data, long long int size, mappedArray* array) {
+	// Reads the type and shape of the values of a .npy file, and where they start.  The header is a Python dictionary
+	// such as {'descr': '<f8', 'fortran_order': False, 'shape': (100, 3), }
+	long long int headerLength = 0;
+	long long int headerStart = 0;
+	const char* header = NULL;
+	const char* value = NULL;
+	char* end = NULL;
+	long dimensions[3] = { 0 };
+	int nrDimensions = 0;
+
+	if (size < 10 || memcmp(data, NPY_MAGIC, 6) != 0) return false;
+	if (data[6] == 1) {
+		headerLength = data[8] | (data[9] << 8);
+		headerStart = 10;
+	}
+	else if (size >= 12) {
+		headerLength = data[8] | (data[9] << 8) | ((long long int)data[10] << 16) | ((long long int)data[11] << 24);
+		headerStart = 12;
+	}
+	if (headerStart == 0 || headerStart + headerLength > size) return false;
+	header = (const char*)data + headerStart;
+
+	value = findKey(header, (long)headerLength, "descr");
+	if (value == NULL) return false;
+	while (*value == ' ') value++;
+	value++;
+	if (strncmp(value, "<f8", 3) == 0) {
+		array->type = TYPE_DOUBLE_ARR;
+	}
+	else if (strncmp(value, "<f4", 3) == 0) {
+		array->type = TYPE_FLOAT_ARR;
+	}
+	else {
+		return false;
+	}
+
+	value = findKey(header, (long)headerLength, "shape");
+	if (value == NULL) return false;
+	while (*value == ' ') value++;
+	if (*value != '(') return false;
+	value++;
+	while (nrDimensions < 3) {
+		while (*value == ' ' || *value == ',') value++;
+		if (*value == ')') break;
+		dimensions[nrDimensions] = strtol(value, &end, 10);
+		if (end == value || dimensions[nrDimensions] < 1) return false;
+		nrDimensions++;
+		value = end;
+	}
+	if (nrDimensions < 1 || nrDimensions > 2) return false;
+
+	// Matrices must be stored row by row
+	value = findKey(header, (long)headerLength, "fortran_order");
+	if (value == NULL) return false;
+	while (*value == ' ') value++;
+	if (strncmp(value, "False", 5) != 0 && nrDimensions == 2 && dimensions[0] > 1 && dimensions[1] > 1) return false;
+
+	array->length = dimensions[0] * ((nrDimensions == 2) ? dimensions[1] : 1);
+	array->columns = (nrDimensions == 2) ? dimensions[1] : 0;
+	array->offset = headerStart + headerLength;
+	return true;
+}
+
+// Maps a whole file read-only, setting the address and size of the mapping.  Returns false, after printing why, if the
+// file can't be read
+bool mapFile(const char fileName[], mappedArray* array) {
+
+	int file = -1;
+	struct stat info;
+
+	array->address = NULL;
+	if (!isLittleEndian()) {
+		printf("  Binary files can only be read on little-endian machines\n");
+		return false;
+	}
+	file = open(fileName, O_RDONLY);
+	if (file < 0 || fstat(file, &info) != 0 || info.st_size == 0) {
+		printf("  Could not read %s\n", fileName);
+		if (file >= 0) close(file);
+		return false;
+	}
+	array->address = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (array->address == MAP_FAILED) {
+		array->address = NULL;
+		printf("  Could not read %s\n", fileName);
+		return false;
+	}
+	array->size = info.st_size;
+	return true;
+}
+
+// Maps a file of values read-only.  Files ending in .npy are read as NumPy arrays, and others as raw little-endian
+// doubles, or floats if single is set.  Returns false, after printing why, if the file can't be used
+bool mapArrayFile(const char fileName[], bool single, mappedArray* array) {
+
+	long length = (long)strlen(fileName);
+	long long int size = 0;
+	long long int valueSize = 0;
+	bool npy = length > 4 && strcmp(&fileName[length - 4], ".npy") == 0;
+
+	if (!mapFile(fileName, array)) return false;
+	size = array->size;
+
+	if (npy) {
+		if (!readNpyHeader(array->address, size, array)) {
+			printf("  %s is not a .npy file of little-endian doubles or floats with one or two dimensions\n", fileName);
+			unmapArrayFile(array);
+			return false;
+		}
+	}
+	else {
+		array->type = single ? TYPE_FLOAT_ARR : TYPE_DOUBLE_ARR;
+		array->offset = 0;
+		array->columns = 0;
+		array->length = (long)(size / ((array->type == TYPE_FLOAT_ARR) ? sizeof(float) : sizeof(double)));
+	}
+
+	valueSize = (array->type == TYPE_FLOAT_ARR) ? sizeof(float) : sizeof(double);
+	if (array->length < 1 || array->offset % valueSize != 0 || array->offset + array->length * valueSize > size
+		|| (!npy && size % valueSize != 0)) {
+		printf("  %s does not hold a whole number of values\n", fileName);
+		unmapArrayFile(array);
+		return false;
+	}
+	array->values = (const char*)array->address + array->offset;
+	posix_madvise(array->address, size, POSIX_MADV_SEQUENTIAL);
+	return true;
+}
+
+void unmapArrayFile(mappedArray* array) {
+	if (array->address != NULL) munmap(array->address, array->size);
+	array->address = NULL;
+}
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "constants.h"
+#include "parallel.h"
+#include "matrix.h"
+
+// Dense linear algebra on row-major matrices.  Multiplication follows the usual blocked scheme: C is split into blocks
+// of BLOCK_ROWS x BLOCK_COLUMNS, each computed by one task.  For every slice of BLOCK_DEPTH along the inner dimension, the
+// slices of A and B are copied ("packed") into buffers laid out in the order the kernel reads them, so that it streams
+// through memory that stays in cache.  The kernel keeps a KERNEL_ROWS x KERNEL_COLUMNS block of C in registers, and its
+// loops are plain C written to be vectorized by the compiler.  Every element of C is summed in the same order whatever
+// the thread count, so results are repeatable
+#define KERNEL_ROWS 4       // The kernel is written out for exactly four rows
+#define KERNEL_COLUMNS 4
+#define BLOCK_ROWS 64       // Multiple of KERNEL_ROWS.  A packed slice of A is 128 KB
+#define BLOCK_COLUMNS 256   // Multiple of KERNEL_COLUMNS
+#define BLOCK_DEPTH 256
+#define PARALLEL_WORK 262144  // Multiply-adds below which a product is done in the calling thread
+#define LU_BLOCK 64         // Columns factored at a time before the rest of the matrix is updated by multiplication
+#define TRANSPOSE_BLOCK 32
+
+typedef struct {
+	long m, n, k;
+	const double* a; long lda;
+	const double* b; long ldb;
+	double* c; long ldc;
+	bool subtract;
+	long columnBlocks;  // Blocks along the columns of C
+	bool failed;        // Set if a task could not allocate its buffers
+} product;
+
+static void packA(const double* a, long lda, long rows, long depth, double* packed, bool negate) {
+	// Copies rows x depth of A into strips of KERNEL_ROWS rows, stored column by column.  Missing rows are zero
+	double sign = negate ? -1.0 : 1.0;
+
+	for (long i = 0; i < rows; i += KERNEL_ROWS) {
+		for (long p = 0; p < depth; p++) {
+			for (long r = 0; r < KERNEL_ROWS; r++) {
+				*packed++ = (i + r < rows) ? sign * a[(i + r) * lda + p] : 0.0;
+			}
+		}
+	}
+}
+
+static void packB(const double* b, long ldb, long depth, long columns, double* packed) {
+	// Copies depth x columns of B into strips of KERNEL_COLUMNS columns, stored row by row.  Missing columns are zero
+	for (long j = 0; j < columns; j += KERNEL_COLUMNS) {
+		for (long p = 0; p < depth; p++) {
+			for (long s = 0; s < KERNEL_COLUMNS; s++) {
+				*packed++ = (j + s < columns) ? b[p * ldb + j + s] : 0.0;
+			}
+		}
+	}
+}
+
+static void kernel(long depth, const double* a, const double* b, double* c, long ldc, long rows, long columns) {
+	// Adds the product of a packed strip of A and a packed strip of B to a block of up to KERNEL_ROWS x KERNEL_COLUMNS of C.
+	// Each row of the block has its own accumulators, as the compiler only vectorizes the innermost loops
+	double row0[KERNEL_COLUMNS] = { 0.0 };
+	double row1[KERNEL_COLUMNS] = { 0.0 };
+	double row2[KERNEL_COLUMNS] = { 0.0 };
+	double row3[KERNEL_COLUMNS] = { 0.0 };
+	double* sums[KERNEL_ROWS] = { row0, row1, row2, row3 };
+
+	for (long p = 0; p < depth; p++) {
+		for (int s = 0; s < KERNEL_COLUMNS; s++) row0[s] += a[0] * b[s];
+		for (int s = 0; s < KERNEL_COLUMNS; s++) row1[s] += a[1] * b[s];
+		for (int s = 0; s < KERNEL_COLUMNS; s++) row2[s] += a[2] * b[s];
+		for (int s = 0; s < KERNEL_COLUMNS; s++) row3[s] += a[3] * b[s];
+		a += KERNEL_ROWS;
+		b += KERNEL_COLUMNS;
+	}
+	for (long r = 0; r < rows; r++) {
+		for (long s = 0; s < columns; s++) {
+			c[r * ldc + s] += sums[r][s];
+		}
+	}
+}
+
+static void multiplyBlock(void* context, int index) {
+	// Computes one block of C
+	product* task = context;
+	long row = (index / task->columnBlocks) * BLOCK_ROWS;
+	long column = (index % task->columnBlocks) * BLOCK_COLUMNS;
+	long rows = (task->m - row < BLOCK_ROWS) ? task->m - row : BLOCK_ROWS;
+	long columns = (task->n - column < BLOCK_COLUMNS) ? task->n - column : BLOCK_COLUMNS;
+	long depth = 0;
+	double* packedA = malloc(BLOCK_ROWS * BLOCK_DEPTH * sizeof(double));
+	double* packedB = malloc(BLOCK_DEPTH * BLOCK_COLUMNS * sizeof(double));
+
+	if (packedA == NULL || packedB == NULL) {
+		free(packedA);
+		free(packedB);
+		task->failed = true;
+		return;
+	}
+
+	for (long p = 0; p < task->k; p += BLOCK_DEPTH) {
+		depth = (task->k - p < BLOCK_DEPTH) ? task->k - p : BLOCK_DEPTH;
+		packA(task->a + row * task->lda + p, task->lda, rows, depth, packedA, task->subtract);
+		packB(task->b + p * task->ldb + column, task->ldb, depth, columns, packedB);
+
+		for (long j = 0; j < columns; j += KERNEL_COLUMNS) {
+			for (long i = 0; i < rows; i += KERNEL_ROWS) {
+				kernel(depth, packedA + i * depth, packedB + j * depth, task->c + (row + i) * task->ldc + column + j, task->ldc,
+					(rows - i < KERNEL_ROWS) ? rows - i : KERNEL_ROWS, (columns - j < KERNEL_COLUMNS) ? columns - j : KERNEL_COLUMNS);
+			}
+		}
+	}
+	free(packedA);
+	free(packedB);
+}
+
+// Adds the product of the m x k matrix A and the k x n matrix B to the m x n matrix C, or subtracts it.  lda, ldb and ldc
+// are the distances between the rows of each matrix.  Large products are split over all threads.  Returns false if
+// there was no memory for the packing buffers
+bool multiplyMatrices(long m, long n, long k, const double* a, long lda, const double* b, long ldb, double* c, long ldc,
+	bool subtract) {
+
+	product task = { m, n, k, a, lda, b, ldb, c, ldc, subtract, 0, false };
+	long nrBlocks = 0;
+
+	if (m <= 0 || n <= 0 || k <= 0) return true;
+	task.columnBlocks = (n + BLOCK_COLUMNS - 1) / BLOCK_COLUMNS;
+	nrBlocks = ((m + BLOCK_ROWS - 1) / BLOCK_ROWS) * task.columnBlocks;
+	if (nrBlocks > 0x7FFFFFFF) return false;
+
+	if ((double)m * n * k < PARALLEL_WORK) {
+		for (long i = 0; i < nrBlocks; i++) multiplyBlock(&task, (int)i);
+	}
+	else {
+		parallelFor((int)nrBlocks, multiplyBlock, &task);
+	}
+	return !task.failed;
+}
+
+// Writes the transpose of a rows x columns matrix.  Done in tiles, so that both the rows read and the rows written stay
+// in cache
+void transposeMatrix(const double* a, double* t, long rows, long columns) {
+
+	for (long i = 0; i < rows; i += TRANSPOSE_BLOCK) {
+		for (long j = 0; j < columns; j += TRANSPOSE_BLOCK) {
+			for (long r = i; r < rows && r < i + TRANSPOSE_BLOCK; r++) {
+				for (long s = j; s < columns && s < j + TRANSPOSE_BLOCK; s++) {
+					t[s * rows + r] = a[r * columns + s];
+				}
+			}
+		}
+	}
+}
+
+static void swapRows(double* a, long n, long first, long second) {
+	double swap;
+
+	if (first == second) return;
+	for (long j = 0; j < n; j++) {
+		swap = a[first * n + j];
+		a[first * n + j] = a[second * n + j];
+		a[second * n + j] = swap;
+	}
+}
+
+// Factors an n x n matrix in place into PA = LU with partial pivoting.  L has a unit diagonal, which isn't stored.  Row i
+// of the factors is row pivots[i] of the original matrix, and *sign is the sign of the permutation.  Columns are factored
+// LU_BLOCK at a time, after which the rest of the matrix is updated with one multiplication, which does nearly all the
+// work.  Returns false for a singular matrix, or if there was no memory, in which case the factors are undefined
+bool factorLU(double* a, long n, long pivots[], int* sign) {
+
+	long width = 0;
+	long pivot = 0;
+	long swap = 0;
+	long end = 0;
+	double factor = 0.0;
+	bool singular = false;
+
+	*sign = 1;
+	for (long i = 0; i < n; i++) pivots[i] = i;
+
+	for (long block = 0; block < n; block += LU_BLOCK) {
+		width = (n - block < LU_BLOCK) ? n - block : LU_BLOCK;
+		end = block + width;
+
+		// Factor the columns of the block, all the way down
+		for (long j = block; j < end; j++) {
+			pivot = j;
+			for (long i = j + 1; i < n; i++) {
+				if (fabs(a[i * n + j]) > fabs(a[pivot * n + j])) pivot = i;
+			}
+			if (a[pivot * n + j] == 0.0) {
+				singular = true;
+				continue;
+			}
+			if (pivot != j) {
+				swapRows(a, n, j, pivot);
+				swap = pivots[j];
+				pivots[j] = pivots[pivot];
+				pivots[pivot] = swap;
+				*sign = -*sign;
+			}
+			for (long i = j + 1; i < n; i++) {
+				factor = a[i * n + j] / a[j * n + j];
+				a[i * n + j] = factor;
+				for (long s = j + 1; s < end; s++) {
+					a[i * n + s] -= factor * a[j * n + s];
+				}
+			}
+		}
+		if (end == n) break;
+
+		// Rows of U to the right of the block
+		for (long j = block; j < end; j++) {
+			for (long i = j + 1; i < end; i++) {
+				factor = a[i * n + j];
+				for (long s = end; s < n; s++) {
+					a[i * n + s] -= factor * a[j * n + s];
+				}
+			}
+		}
+
+		// The rest of the matrix, less the product of the block's columns of L and rows of U
+		if (!multiplyMatrices(n - end, n - end, width, a + end * n + block, n, a + block * n + end, n, a + end * n + end, n, true)) {
+			for (long i = 0; i < n * n; i++) a[i] = NAN;
+			return false;
+		}
+	}
+	return !singular;
+}
+
+// Solves LU x = P b for the columns of the n x columns matrix x, which holds b on entry, using the factors from factorLU()
+void solveLU(const double* lu, const long pivots[], long n, double* x, long columns) {
+
+	double* permuted = malloc(n * columns * sizeof(double));
+	double factor = 0.0;
+
+	if (permuted == NULL) {
+		for (long i = 0; i < n * columns; i++) x[i] = NAN;
+		return;
+	}
+	for (long i = 0; i < n; i++) {
+		memcpy(&permuted[i * columns], &x[pivots[i] * columns], columns * sizeof(double));
+	}
+	memcpy(x, permuted, n * columns * sizeof(double));
+	free(permuted);
+
+	// Forward substitution with L, then back substitution with U, a whole row of x at a time
+	for (long i = 0; i < n; i++) {
+		for (long j = 0; j < i; j++) {
+			factor = lu[i * n + j];
+			for (long s = 0; s < columns; s++) x[i * columns + s] -= factor * x[j * columns + s];
+		}
+	}
+	for (long i = n - 1; i >= 0; i--) {
+		for (long j = i + 1; j < n; j++) {
+			factor = lu[i * n + j];
+			for (long s = 0; s < columns; s++) x[i * columns + s] -= factor * x[j * columns + s];
+		}
+		factor = 1.0 / lu[i * n + i];
+		for (long s = 0; s < columns; s++) x[i * columns + s] *= factor;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,379 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "compile.h"
+#include "execute.h"
+#include "parallel.h"
+#include "reduce.h"
+#include "aggregate.h"
+#include "random.h"
+#include "montecarlo.h"
+#include "global.h"
+
+// Samples per chunk.  Each chunk is split into batches evaluated in parallel, whose draws are numbered by sample, and
+// partial results are combined in order, so a result only depends on the seed and the number of samples
+#define MONTECARLO_BLOCKS 1024
+#define MONTECARLO_CHUNK (MONTECARLO_BLOCKS * BATCH_SIZE)
+#define MAX_EXPRESSIONS 16
+#define REPORT_BINS 20
+#define MAX_BINS 1000
+#define BAR_WIDTH 40
+
+typedef struct {
+	const program* prog;
+	int nrExpressions;
+	int bodyStart[MAX_EXPRESSIONS];
+	int bodyEnd[MAX_EXPRESSIONS];
+	const double* locals;
+	unsigned int stream;
+	long long int start;                      // First sample of the current chunk
+	long long int nrSamples;                  // Samples in the current chunk
+	double* results;                          // MONTECARLO_CHUNK values of each expression
+	aggregate (*stripes)[AGGREGATE_STRIPES];  // Aggregates of each expression, or NULL if only the mean is needed
+	double sum[MONTECARLO_BLOCKS];            // Without aggregates, the sum of the first expression for each batch
+	double compensation[MONTECARLO_BLOCKS];
+	bool undefined[MONTECARLO_BLOCKS];
+	long long int* counts;                    // When set, MAX_BINS + 2 counts of each expression, in the bins below
+	double low[MAX_EXPRESSIONS];
+	double high[MAX_EXPRESSIONS];
+	int nrBins[MAX_EXPRESSIONS];
+} sampleTask;
+
+static void sampleBatch(void* context, int index) {
+	// Evaluates each expression for up to BATCH_SIZE samples of the current chunk in one batch.  Every expression draws
+	// the same values for a sample
+	sampleTask* task = context;
+	const double* lanes[MAX_LOCALS] = { NULL };
+	long long int first = (long long int)index * BATCH_SIZE;
+	int count = (int)((task->nrSamples - first < BATCH_SIZE) ? task->nrSamples - first : BATCH_SIZE);
+	double* workspace = malloc(task->prog->stackDepth * BATCH_SIZE * sizeof(double));
+	double* results = NULL;
+	randomState previous;
+
+	for (int e = 0; e < task->nrExpressions; e++) {
+		results = &task->results[(long long int)e * MONTECARLO_CHUNK + first];
+		if (workspace == NULL) {
+			for (int j = 0; j < count; j++) results[j] = NAN;
+			continue;
+		}
+		previous = enterSamples(task->stream, task->start + first, true);
+		executeBatch(task->prog, task->bodyStart[e], task->bodyEnd[e], task->locals, lanes, count, results, workspace);
+		leaveSamples(previous);
+	}
+	free(workspace);
+
+	if (task->stripes == NULL) {
+		task->sum[index] = 0.0;
+		task->compensation[index] = 0.0;
+		task->undefined[index] = false;
+		for (int j = 0; j < count; j++) {
+			if (isnan(task->results[first + j])) task->undefined[index] = true;
+			else neumaierAdd(&task->sum[index], &task->compensation[index], task->results[first + j]);
+		}
+	}
+}
+
+static void countBins(sampleTask* task) {
+	// Counts the values of the current chunk into nrBins equal bins from low to high of each expression.  The first
+	// count is of those below low, and the one after the bins of those above high
+	long long int* counts = NULL;
+	double value = 0.0;
+	double width = 0.0;
+	int bin = 0;
+
+	for (int e = 0; e < task->nrExpressions; e++) {
+		counts = &task->counts[e * (MAX_BINS + 2)];
+		width = (task->high[e] - task->low[e]) / task->nrBins[e];
+		for (long long int j = 0; j < task->nrSamples; j++) {
+			value = task->results[(long long int)e * MONTECARLO_CHUNK + j];
+			if (isnan(value)) continue;
+			if (value < task->low[e]) bin = 0;
+			else if (value > task->high[e]) bin = task->nrBins[e] + 1;
+			else if (width > 0.0) bin = 1 + (int)fmin((value - task->low[e]) / width, task->nrBins[e] - 1);
+			else bin = 1;
+			counts[bin]++;
+		}
+	}
+}
+
+static bool runSamples(sampleTask* task, long long int nrSamples, double* sum, double* compensation) {
+	// Evaluates the expressions of a task for samples 0 to nrSamples - 1 of its stream, a chunk at a time.  Without
+	// aggregates or counts, sets the sum of the first expression, and returns false if one of its values was undefined
+	bool defined = true;
+	int nrBatches = 0;
+
+	task->results = malloc((long long int)task->nrExpressions * MONTECARLO_CHUNK * sizeof(double));
+	if (task->results == NULL) {
+		error = ERR_OVERFLOW;
+		return false;
+	}
+	*sum = 0.0;
+	*compensation = 0.0;
+	for (task->start = 0; task->start < nrSamples && error == NO_ERROR; task->start += MONTECARLO_CHUNK) {
+		task->nrSamples = (nrSamples - task->start < MONTECARLO_CHUNK) ? nrSamples - task->start : MONTECARLO_CHUNK;
+		nrBatches = (int)((task->nrSamples + BATCH_SIZE - 1) / BATCH_SIZE);
+		parallelFor(nrBatches, sampleBatch, task);
+		if (task->counts != NULL) {
+			countBins(task);
+			continue;
+		}
+		if (task->stripes != NULL) {
+			for (int e = 0; e < task->nrExpressions; e++) {
+				addValuesParallel(task->stripes[e], &task->results[(long long int)e * MONTECARLO_CHUNK], task->nrSamples);
+			}
+			continue;
+		}
+		for (int i = 0; i < nrBatches; i++) {
+			defined = defined && !task->undefined[i];
+			neumaierAdd(sum, compensation, task->sum[i]);
+			neumaierAdd(sum, compensation, task->compensation[i]);
+		}
+	}
+	free(task->results);
+	return defined;
+}
+
+static bool countHistograms(sampleTask* task, long long int nrSamples, aggregate (*stripes)[AGGREGATE_STRIPES],
+	int nrBins) {
+	// Counts the values of each expression into a histogram of nrBins bins, by drawing the samples again, which gives
+	// the same values.  The values were summarized in the first of the stripes of each.  A histogram goes from the
+	// smallest value to the largest, except that a tail reaching far out from the other values is cut at its outer
+	// 0.5%, which is counted as below or above.  It has a single bin if all values are the same
+	const aggregate* stats = NULL;
+	double inner = 0.0;
+	double sum = 0.0;
+	double compensation = 0.0;
+
+	task->counts = calloc((long long int)task->nrExpressions * (MAX_BINS + 2), sizeof(long long int));
+	if (task->counts == NULL) return false;
+	for (int e = 0; e < task->nrExpressions; e++) {
+		stats = &stripes[e][0];
+		task->low[e] = findQuantile(stats, 0.005);
+		task->high[e] = findQuantile(stats, 0.995);
+		inner = task->high[e] - task->low[e];
+		if (task->low[e] - stats->min <= 0.5 * inner) task->low[e] = stats->min;
+		if (stats->max - task->high[e] <= 0.5 * inner) task->high[e] = stats->max;
+		task->nrBins[e] = (task->high[e] > task->low[e]) ? nrBins : 1;
+	}
+	task->stripes = NULL;
+	runSamples(task, nrSamples, &sum, &compensation);
+	return true;
+}
+
+static void printReport(const sampleTask* task, const aggregate* stats) {
+	// Prints a summary of the samples of a montecarlo() that is printed, with the histogram of their values
+	const long long int* counts = task->counts;
+	double sum = stats->sum + stats->compensation;
+	double deviation = (stats->count > 1) ? sqrt(stats->m2 / (stats->count - 1)) : 0.0;
+	double low = task->low[0];
+	double high = task->high[0];
+	long long int most = 0;
+	int nrBins = task->nrBins[0];
+	int width = 0;
+
+	printf("  %lld samples", stats->count + stats->undefined);
+	if (stats->undefined > 0) printf(", %lld undefined", stats->undefined);
+	printf("\n");
+	if (stats->count == 0) return;
+	printf("  mean %.10g, standard error %.3g, standard deviation %.10g\n", sum / stats->count,
+		deviation / sqrt((double)stats->count), deviation);
+	printf("  min %.6g, p5 %.6g, median %.6g, p95 %.6g, max %.6g\n", stats->min, findQuantile(stats, 0.05),
+		findQuantile(stats, 0.5), findQuantile(stats, 0.95), stats->max);
+
+	if (counts == NULL) return;
+	for (int i = 1; i <= nrBins; i++) {
+		if (counts[i] > most) most = counts[i];
+	}
+	if (counts[0] > 0) printf("  below %.6g: %lld\n", low, counts[0]);
+	for (int i = 1; i <= nrBins; i++) {
+		width = (int)((double)BAR_WIDTH * counts[i] / most + 0.5);
+		printf("  %12.6g to %12.6g |", low + (high - low) * (i - 1) / nrBins, low + (high - low) * i / nrBins);
+		for (int j = 0; j < BAR_WIDTH; j++) putchar((j < width) ? '#' : ' ');
+		printf(" %lld\n", counts[i]);
+	}
+	if (counts[nrBins + 1] > 0) printf("  above %.6g: %lld\n", high, counts[nrBins + 1]);
+}
+
+// Runs the body of montecarlo(N, expression) for N samples and returns the mean of its values, or NaN if any is
+// undefined.  Printed at the top of a statement, it prints a summary and histogram of the values first
+double sampleMean(const program* prog, int bodyStart, int bodyEnd, double count, const double locals[], bool report) {
+
+	sampleTask* task;
+	aggregate stripes[1][AGGREGATE_STRIPES];
+	long long int nrSamples = 0;
+	double sum = 0.0;
+	double compensation = 0.0;
+	bool defined = false;
+
+	if (isnan(count) || count < 0.5 || count > 9007199254740992.0) return NAN;
+	nrSamples = doubleToInt(count);
+	task = malloc(sizeof(sampleTask));
+	if (task == NULL) {
+		error = ERR_OVERFLOW;
+		return NAN;
+	}
+	task->prog = prog;
+	task->nrExpressions = 1;
+	task->bodyStart[0] = bodyStart;
+	task->bodyEnd[0] = bodyEnd;
+	task->locals = locals;
+	task->stream = newStream();
+	task->stripes = NULL;
+	task->counts = NULL;
+	if (report) {
+		task->stripes = stripes;
+		for (int i = 0; i < AGGREGATE_STRIPES; i++) initAggregate(&stripes[0][i]);
+	}
+
+	defined = runSamples(task, nrSamples, &sum, &compensation);
+	if (report) {
+		for (int i = 1; i < AGGREGATE_STRIPES; i++) mergeAggregate(&stripes[0][0], &stripes[0][i]);
+		sum = stripes[0][0].sum;
+		compensation = stripes[0][0].compensation;
+		defined = stripes[0][0].undefined == 0;
+		if (error == NO_ERROR && stripes[0][0].count > 0 && !countHistograms(task, nrSamples, stripes, REPORT_BINS)) {
+			error = ERR_OVERFLOW;
+		}
+		if (error == NO_ERROR) printReport(task, &stripes[0][0]);
+		free(task->counts);
+		freeAggregate(&stripes[0][0]);
+	}
+	free(task);
+	return defined ? (sum + compensation) / nrSamples : NAN;
+}
+
+// Draws samples of one or more expressions, started as
+//   clc --montecarlo N "expression" ["name=expression" ...] [--bins K]
+// Each sample evaluates every expression with the same draws, so that expressions of the same random values can be
+// compared.  Prints summary statistics of each expression as CSV, followed by a histogram of K bins of each, as lines
+// "name,low,high,count".  Bins below and above the range of a histogram are those of outlying values
+int runMonteCarlo(int argc, char* argv[]) {
+
+	program prog;
+	sampleTask* task = NULL;
+	aggregate (*stripes)[AGGREGATE_STRIPES] = NULL;
+	char* expressions[MAX_EXPRESSIONS];
+	double locals[MAX_LOCALS] = { 0 };
+	char names[MAX_EXPRESSIONS][INPUT_HOLDER_SIZE + 2];
+	char* end = NULL;
+	const char* p = NULL;
+	const long long int* counts = NULL;
+	double low = 0.0;
+	double high = 0.0;
+	double sum = 0.0;
+	double compensation = 0.0;
+	long long int nrSamples = 0;
+	int nrExpressions = 0;
+	int nrBins = REPORT_BINS;
+	int length = 0;
+	int status = 0;
+	bool identifier = false;
+
+	if (argc > 0) nrSamples = strtoll(argv[0], &end, 10);
+	if (argc == 0 || *end != '\0' || nrSamples < 1) {
+		printf("  Expected a number of samples and an expression\n");
+		return 1;
+	}
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--bins") == 0 && i + 1 < argc) {
+			nrBins = atoi(argv[++i]);
+			if (nrBins < 1 || nrBins > MAX_BINS) {
+				printf("  The number of bins must be from 1 to %d\n", MAX_BINS);
+				return 1;
+			}
+		}
+		else if (nrExpressions < MAX_EXPRESSIONS) {
+			// "name=expression" names the expression, otherwise it is named by the expression
+			p = strchr(argv[i], '=');
+			identifier = (p != NULL && p > argv[i] && p - argv[i] < INPUT_HOLDER_SIZE && isalpha((unsigned char)argv[i][0]));
+			for (const char* c = argv[i]; identifier && c < p; c++) {
+				identifier = isalnum((unsigned char)*c) || *c == '_';
+			}
+			length = identifier ? (int)(p - argv[i]) : 0;
+			if (identifier) snprintf(names[nrExpressions], sizeof(names[0]), "%.*s", length, argv[i]);
+			else snprintf(names[nrExpressions], sizeof(names[0]), "\"%.*s\"", INPUT_HOLDER_SIZE - 1, argv[i]);
+			expressions[nrExpressions] = identifier ? (char*)p + 1 : argv[i];
+			nrExpressions++;
+		}
+		else {
+			printf("  Too many expressions\n");
+			return 1;
+		}
+	}
+	if (nrExpressions == 0) {
+		printf("  Expected a number of samples and an expression\n");
+		return 1;
+	}
+
+	initProgram(&prog);
+	task = calloc(1, sizeof(sampleTask));
+	stripes = malloc(nrExpressions * sizeof(stripes[0]));
+	if (task == NULL || stripes == NULL) {
+		printf("  Overflow error\n");
+		status = 1;
+	}
+	for (int e = 0; e < nrExpressions && status == 0; e++) {
+		for (int i = 0; i < AGGREGATE_STRIPES; i++) initAggregate(&stripes[e][i]);
+	}
+	for (int e = 0; e < nrExpressions && status == 0; e++) {
+		task->bodyStart[e] = prog.length;
+		compileExpression(&prog, expressions[e], NULL, 0);
+		task->bodyEnd[e] = prog.length;
+		if (error != NO_ERROR) {
+			printf("  %s:", expressions[e]);
+			printError();
+			status = 1;
+		}
+	}
+
+	if (status == 0) {
+		task->prog = &prog;
+		task->nrExpressions = nrExpressions;
+		task->locals = locals;
+		task->stream = newStream();
+		task->stripes = stripes;
+		task->counts = NULL;
+		runSamples(task, nrSamples, &sum, &compensation);
+		for (int e = 0; e < nrExpressions; e++) {
+			for (int i = 1; i < AGGREGATE_STRIPES; i++) mergeAggregate(&stripes[e][0], &stripes[e][i]);
+		}
+		if (error == NO_ERROR && !countHistograms(task, nrSamples, stripes, nrBins)) error = ERR_OVERFLOW;
+		if (error != NO_ERROR) {
+			printError();
+			status = 1;
+		}
+	}
+
+	if (status == 0) {
+		printStatsHeader();
+		for (int e = 0; e < nrExpressions; e++) printStats(names[e], &stripes[e][0]);
+		printf("\nname,low,high,count\n");
+		for (int e = 0; e < nrExpressions; e++) {
+			if (stripes[e][0].count == 0) continue;
+			counts = &task->counts[e * (MAX_BINS + 2)];
+			low = task->low[e];
+			high = task->high[e];
+			nrBins = task->nrBins[e];
+			printf("%s,-inf,%.17g,%lld\n", names[e], low, counts[0]);
+			for (int i = 1; i <= nrBins; i++) {
+				printf("%s,%.17g,%.17g,%lld\n", names[e], low + (high - low) * (i - 1) / nrBins,
+					(i == nrBins) ? high : low + (high - low) * i / nrBins, counts[i]);
+			}
+			printf("%s,%.17g,inf,%lld\n", names[e], high, counts[nrBins + 1]);
+		}
+	}
+
+	for (int e = 0; task != NULL && stripes != NULL && e < nrExpressions; e++) {
+		for (int i = 0; i < AGGREGATE_STRIPES; i++) freeAggregate(&stripes[e][i]);
+	}
+	if (task != NULL) free(task->counts);
+	free(stripes);
+	free(task);
+	freeProgram(&prog);
+	return status;
+}
\ No newline at end of file
@@ -0,0 +1,387 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <float.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "compile.h"
+#include "execute.h"
+#include "parallel.h"
+#include "ode.h"
+#include "global.h"
+
+#define MAX_STATES (MAX_LOCALS - 1)  // Local 0 holds the time
+#define MAX_ODE_STEPS 1000000        // Steps one run may take between two output times before it is abandoned
+#define NR_STAGES 7
+
+// Dormand-Prince 5(4) tableau.  The last stage is evaluated at the new point, so it is reused as the first stage of the
+// next step
+static const double stageTimes[NR_STAGES] = { 0.0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1.0, 1.0 };
+static const double stageWeights[NR_STAGES][NR_STAGES - 1] = {
+	{ 0 },
+	{ 1.0 / 5 },
+	{ 3.0 / 40, 9.0 / 40 },
+	{ 44.0 / 45, -56.0 / 15, 32.0 / 9 },
+	{ 19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729 },
+	{ 9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656 },
+	{ 35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84 }
+};
+// Difference between the fifth and fourth order solutions, per stage
+static const double errorWeights[NR_STAGES] = {
+	71.0 / 57600, 0.0, -71.0 / 16695, 71.0 / 1920, -17253.0 / 339200, 22.0 / 525, -1.0 / 40
+};
+
+typedef struct {
+	const program* prog;
+	int nrStates;
+	int bodyStart[MAX_STATES];   // Code of the right-hand side of each state's equation
+	int bodyEnd[MAX_STATES];
+	int nrRuns;
+	double** states;             // Structure of arrays: states[i][run]
+	double** slopes;             // Derivative at the current point of each run, kept between steps
+	double* times;
+	double* steps;               // Step size each run will try next
+	double target;               // Time every run is integrated to
+	double tolerance;
+} odeBatch;
+
+static void evaluateSlopes(odeBatch* task, const double* lanes[], int count, double* slopes[], double* workspace) {
+	// Evaluates every right-hand side for a batch of lanes
+	double locals[MAX_LOCALS] = { 0 };
+	for (int i = 0; i < task->nrStates; i++) {
+		executeBatch(task->prog, task->bodyStart[i], task->bodyEnd[i], locals, lanes, count, slopes[i], workspace);
+	}
+}
+
+static void integrateBlock(void* context, int index) {
+	// Advances up to BATCH_SIZE runs to the target time in lockstep.  Each run keeps its own step size, and the runs
+	// that still need steps are packed to the front of every batch
+	odeBatch* task = context;
+	int first = index * BATCH_SIZE;
+	int count = task->nrRuns - first;
+	int n = task->nrStates;
+	int active[BATCH_SIZE];
+	int nrActive = 0;
+	int stillActive = 0;
+	int run = 0;
+	int nrSteps = 0;
+	double k[NR_STAGES][MAX_STATES][BATCH_SIZE];
+	double input[MAX_STATES][BATCH_SIZE];
+	double stageTime[BATCH_SIZE];
+	double step[BATCH_SIZE];
+	double* slopes[MAX_STATES];
+	const double* lanes[MAX_LOCALS] = { NULL };
+	double norm, scale, difference, value, factor;
+	double* workspace = malloc(task->prog->stackDepth * BATCH_SIZE * sizeof(double));
+
+	if (count > BATCH_SIZE) count = BATCH_SIZE;
+	if (workspace == NULL) {
+		for (int j = 0; j < count; j++) task->times[first + j] = NAN;
+		return;
+	}
+	lanes[0] = stageTime;
+	for (int i = 0; i < n; i++) lanes[i + 1] = input[i];
+
+	for (int j = 0; j < count; j++) {
+		if (task->times[first + j] < task->target) active[nrActive++] = j;
+	}
+
+	while (nrActive > 0 && nrSteps < MAX_ODE_STEPS) {
+		nrSteps++;
+
+		// First stage is the slope kept from the previous step
+		for (int j = 0; j < nrActive; j++) {
+			run = first + active[j];
+			step[j] = fmin(task->steps[run], task->target - task->times[run]);
+			for (int i = 0; i < n; i++) k[0][i][j] = task->slopes[i][run];
+		}
+
+		for (int s = 1; s < NR_STAGES; s++) {
+			for (int j = 0; j < nrActive; j++) {
+				run = first + active[j];
+				stageTime[j] = task->times[run] + stageTimes[s] * step[j];
+				for (int i = 0; i < n; i++) {
+					value = 0.0;
+					for (int m = 0; m < s; m++) value += stageWeights[s][m] * k[m][i][j];
+					input[i][j] = task->states[i][run] + step[j] * value;
+				}
+			}
+			for (int i = 0; i < n; i++) slopes[i] = k[s][i];
+			evaluateSlopes(task, lanes, nrActive, slopes, workspace);
+		}
+
+		// The last stage was evaluated at the fifth order solution, which is still in input
+		stillActive = 0;
+		for (int j = 0; j < nrActive; j++) {
+			run = first + active[j];
+			norm = 0.0;
+			for (int i = 0; i < n; i++) {
+				difference = 0.0;
+				for (int s = 0; s < NR_STAGES; s++) difference += errorWeights[s] * k[s][i][j];
+				scale = task->tolerance * (1.0 + fmax(fabs(task->states[i][run]), fabs(input[i][j])));
+				norm += (step[j] * difference / scale) * (step[j] * difference / scale);
+			}
+			norm = sqrt(norm / n);
+
+			if (isnan(norm) || step[j] <= 16 * DBL_EPSILON * fabs(task->times[run])) {
+				// Solution blew up, or the step can't get any smaller
+				for (int i = 0; i < n; i++) task->states[i][run] = NAN;
+				task->times[run] = task->target;
+				continue;
+			}
+			if (norm <= 1.0) {
+				task->times[run] = (step[j] == task->target - task->times[run]) ? task->target : task->times[run] + step[j];
+				for (int i = 0; i < n; i++) {
+					task->states[i][run] = input[i][j];
+					task->slopes[i][run] = k[NR_STAGES - 1][i][j];
+				}
+			}
+
+			factor = (norm == 0.0) ? 5.0 : fmin(5.0, fmax(0.2, 0.9 * pow(norm, -0.2)));
+			if (norm > 1.0 && factor > 1.0) factor = 1.0;
+			task->steps[run] = step[j] * factor;
+
+			if (task->times[run] < task->target) active[stillActive++] = active[j];
+		}
+		nrActive = stillActive;
+	}
+
+	for (int j = 0; j < nrActive; j++) {
+		// Took too many steps
+		run = first + active[j];
+		for (int i = 0; i < n; i++) task->states[i][run] = NAN;
+		task->times[run] = task->target;
+	}
+	free(workspace);
+}
+
+static void initialSlopes(void* context, int index) {
+	// Evaluates the derivative at the initial point of one block of runs
+	odeBatch* task = context;
+	int first = index * BATCH_SIZE;
+	int count = task->nrRuns - first;
+	double time[BATCH_SIZE];
+	double* slopes[MAX_STATES];
+	const double* lanes[MAX_LOCALS] = { NULL };
+	double* workspace = malloc(task->prog->stackDepth * BATCH_SIZE * sizeof(double));
+
+	if (count > BATCH_SIZE) count = BATCH_SIZE;
+	if (workspace == NULL) return;
+	for (int j = 0; j < count; j++) time[j] = task->times[first + j];
+	lanes[0] = time;
+	for (int i = 0; i < task->nrStates; i++) {
+		lanes[i + 1] = &task->states[i][first];
+		slopes[i] = &task->slopes[i][first];
+	}
+	evaluateSlopes(task, lanes, count, slopes, workspace);
+	free(workspace);
+}
+
+static void writeRows(odeBatch* task, double time, FILE* binary) {
+	// Writes the state of every run at an output time, as "t,run,states" lines or as raw doubles
+	double value;
+
+	for (int run = 0; run < task->nrRuns; run++) {
+		if (binary != NULL) {
+			fwrite(&time, sizeof(double), 1, binary);
+			for (int i = 0; i < task->nrStates; i++) {
+				value = task->states[i][run];
+				fwrite(&value, sizeof(double), 1, binary);
+			}
+		}
+		else {
+			printf("%.17g,%d", time, run);
+			for (int i = 0; i < task->nrStates; i++) {
+				printf(",%.17g", task->states[i][run]);
+			}
+			printf("\n");
+		}
+	}
+}
+
+// Integrates a system of ordinary differential equations with the adaptive Dormand-Prince method, started as
+//   clc --odesolve t=0:0.1:10 "x'=v" "v'=-x" x=1 v=0:0.5:2 [--tol 1e-8] [--binary out.bin]
+// Each equation gives the derivative of a state as an expression of t and the states.  Initial values given as ranges
+// start one run for every combination, and all runs are integrated together, a batch of runs per pass over each
+// right-hand side, with batches spread over the thread pool.  The state of every run is written at each output time
+// as comma separated lines, or as raw doubles (t, then the states) with --binary
+int runOdeSolve(int argc, char* argv[]) {
+
+	program prog;
+	odeBatch task;
+	char names[MAX_LOCALS][INPUT_HOLDER_SIZE] = { { 0 } };
+	char* nameList[MAX_LOCALS];
+	char* equations[MAX_STATES] = { NULL };
+	char name[INPUT_HOLDER_SIZE];
+	double initial[MAX_STATES][3];
+	int nrInitial[MAX_STATES] = { 0 };
+	int nrValues = 0;
+	double timeRange[3];
+	int nrTimes = 0;
+	int nrStates = 0;
+	int state = 0;
+	long long int nrRuns = 1;
+	long long int nrOutputs = 0;
+	long long int combination = 0;
+	int nrBlocks = 0;
+	double values[3];
+	double tolerance = 1E-8;
+	char* binaryName = NULL;
+	FILE* binary = NULL;
+	char* equals;
+	int status = 0;
+
+	if (argc < 1 || !parseRange(argv[0], names[0], timeRange, 3, &nrTimes) || nrTimes < 2
+		|| (nrTimes == 3 && timeRange[1] <= 0) || timeRange[nrTimes - 1] < timeRange[0]) {
+		printf("  Expected t=start:end or t=start:step:end, with a name of at most %d characters\n", INPUT_HOLDER_SIZE - 1);
+		return 1;
+	}
+
+	// Equations first, so that initial values can be matched to their states
+	for (int i = 1; i < argc; i++) {
+		equals = strchr(argv[i], '=');
+		if (argv[i][0] == '-' || equals == NULL || equals == argv[i] || equals[-1] != '\'') continue;
+		if (nrStates >= MAX_STATES || equals - argv[i] - 1 > INPUT_HOLDER_SIZE - 1 || equals - argv[i] - 1 == 0) {
+			printf("  Too many states, or state name longer than %d characters: %s\n", INPUT_HOLDER_SIZE - 1, argv[i]);
+			return 1;
+		}
+		memcpy(names[nrStates + 1], argv[i], equals - argv[i] - 1);
+		equations[nrStates] = equals + 1;
+		nrStates++;
+	}
+	for (int i = 1; i < argc; i++) {
+		equals = strchr(argv[i], '=');
+		if (strcmp(argv[i], "--tol") == 0 && i + 1 < argc) {
+			tolerance = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--binary") == 0 && i + 1 < argc) {
+			binaryName = argv[++i];
+		}
+		else if (equals != NULL && equals != argv[i] && equals[-1] == '\'') {
+			continue;
+		}
+		else if (parseRange(argv[i], name, values, 3, &nrValues) && nrValues != 2) {
+			for (state = 0; state < nrStates && strcmp(names[state + 1], name) != 0; state++);
+			if (state == nrStates || (nrValues == 3 && (values[1] == 0.0 || (values[2] - values[0]) / values[1] < 0))) {
+				printf("  No equation for %s, or invalid range\n", name);
+				return 1;
+			}
+			for (int j = 0; j < nrValues; j++) initial[state][j] = values[j];
+			nrInitial[state] = nrValues;
+		}
+		else {
+			printf("  Unrecognized argument, or name longer than %d characters: \"%s\"\n", INPUT_HOLDER_SIZE - 1, argv[i]);
+			return 1;
+		}
+	}
+	if (nrStates == 0 || tolerance <= 0) {
+		printf("  Expected at least one equation, such as \"x'=-x\"\n");
+		return 1;
+	}
+
+	for (int i = 0; i < nrStates; i++) {
+		if (nrInitial[i] == 0) {
+			printf("  No initial value for %s\n", names[i + 1]);
+			return 1;
+		}
+		if (nrInitial[i] == 3) {
+			// Range of initial values
+			initial[i][2] = floor((initial[i][2] - initial[i][0]) / initial[i][1] + 1e-9) + 1;
+			nrRuns *= (long long int)initial[i][2];
+		}
+		else {
+			initial[i][1] = 0.0;
+			initial[i][2] = 1;
+		}
+		if (nrRuns > 0x7FFFFFFF - BATCH_SIZE) {
+			printf("  Overflow error\n");
+			return 1;
+		}
+	}
+
+	// Compile the right-hand sides one after another into one program
+	initProgram(&prog);
+	for (int i = 0; i <= nrStates; i++) nameList[i] = names[i];
+	for (int i = 0; i < nrStates && error == NO_ERROR; i++) {
+		task.bodyStart[i] = prog.length;
+		compileExpression(&prog, equations[i], nameList, nrStates + 1);
+		task.bodyEnd[i] = prog.length;
+		if (error != NO_ERROR) printf("  %s'=%s:", names[i + 1], equations[i]);
+	}
+	if (error != NO_ERROR) {
+		printError();
+		freeProgram(&prog);
+		return 1;
+	}
+
+	task.prog = &prog;
+	task.nrStates = nrStates;
+	task.nrRuns = (int)nrRuns;
+	task.tolerance = tolerance;
+	task.states = calloc(nrStates, sizeof(double*));
+	task.slopes = calloc(nrStates, sizeof(double*));
+	task.times = malloc(nrRuns * sizeof(double));
+	task.steps = malloc(nrRuns * sizeof(double));
+	if (task.states == NULL || task.slopes == NULL || task.times == NULL || task.steps == NULL) {
+		status = 1;
+	}
+	for (int i = 0; i < nrStates && status == 0; i++) {
+		task.states[i] = malloc(nrRuns * sizeof(double));
+		task.slopes[i] = malloc(nrRuns * sizeof(double));
+		if (task.states[i] == NULL || task.slopes[i] == NULL) status = 1;
+	}
+	if (binaryName != NULL && status == 0) {
+		binary = fopen(binaryName, "wb");
+		if (binary == NULL) {
+			printf("  Could not open %s\n", binaryName);
+			status = 1;
+		}
+	}
+
+	if (status == 0) {
+		// Initial values of each run, the last state varying fastest
+		for (long long int run = 0; run < nrRuns; run++) {
+			combination = run;
+			for (int i = nrStates - 1; i >= 0; i--) {
+				task.states[i][run] = initial[i][0] + (combination % (long long int)initial[i][2]) * initial[i][1];
+				combination /= (long long int)initial[i][2];
+			}
+			task.times[run] = timeRange[0];
+			task.steps[run] = 1E-3 * (timeRange[nrTimes - 1] - timeRange[0]);
+		}
+		nrBlocks = (int)((nrRuns + BATCH_SIZE - 1) / BATCH_SIZE);
+		parallelFor(nrBlocks, initialSlopes, &task);
+
+		if (binary == NULL) {
+			printf("%s,run", names[0]);
+			for (int i = 0; i < nrStates; i++) printf(",%s", names[i + 1]);
+			printf("\n");
+		}
+		writeRows(&task, timeRange[0], binary);
+
+		// Integrate from one output time to the next, writing every run's state in between
+		nrOutputs = (nrTimes == 3) ? (long long int)ceil((timeRange[2] - timeRange[0]) / timeRange[1] - 1e-9) : 1;
+		for (long long int i = 1; i <= nrOutputs; i++) {
+			task.target = (i == nrOutputs) ? timeRange[nrTimes - 1] : timeRange[0] + i * timeRange[1];
+			parallelFor(nrBlocks, integrateBlock, &task);
+			writeRows(&task, task.target, binary);
+		}
+	}
+	else if (binary == NULL) {
+		printf("  Overflow error\n");
+	}
+
+	if (binary != NULL) fclose(binary);
+	for (int i = 0; task.states != NULL && task.slopes != NULL && i < nrStates; i++) {
+		free(task.states[i]);
+		free(task.slopes[i]);
+	}
+	free(task.states);
+	free(task.slopes);
+	free(task.times);
+	free(task.steps);
+	freeProgram(&prog);
+	return status;
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <threads.h>
+#include "constants.h"
+#include "parallel.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+// Pool of worker threads, started on first use and kept for the rest of the session.  The calling thread works
+// alongside the pool, so a pool of N threads has N - 1 workers
+
+static thrd_t workers[MAX_THREADS];
+static int nrWorkers = 0;
+static int nrThreads = 0;     // Threads used by parallelFor, including the caller.  0 until first configured
+static bool poolStarted = false;
+
+static mtx_t poolLock;
+static cnd_t wakeWorkers;
+static cnd_t jobFinished;
+static unsigned int generation = 0;  // Incremented for every job, so workers can tell a new job from a spurious wakeup
+static int activeWorkers = 0;
+
+static parallelTask jobTask;
+static void* jobContext;
+static int jobSize;
+static atomic_int nextTask;
+
+static _Thread_local bool inPool = false;  // Set while running tasks, so nested calls run in the calling thread
+
+static void runTasks() {
+	// Takes tasks from the current job until none are left
+	int index;
+	while ((index = atomic_fetch_add(&nextTask, 1)) < jobSize) {
+		jobTask(jobContext, index);
+	}
+}
+
+static int workerLoop(void* arg) {
+	unsigned int seen = 0;
+	(void)arg;
+	inPool = true;
+
+	while (true) {
+		mtx_lock(&poolLock);
+		while (generation == seen) {
+			cnd_wait(&wakeWorkers, &poolLock);
+		}
+		seen = generation;
+		mtx_unlock(&poolLock);
+
+		runTasks();
+
+		mtx_lock(&poolLock);
+		activeWorkers--;
+		if (activeWorkers == 0) cnd_signal(&jobFinished);
+		mtx_unlock(&poolLock);
+	}
+	return 0;
+}
+
+void setNrThreads(int count) {
+	// Sets how many threads work on parallel jobs.  Only takes effect before the pool is started
+	if (poolStarted) return;
+	if (count < 1) count = 1;
+	if (count > MAX_THREADS) count = MAX_THREADS;
+	nrThreads = count;
+}
+
+int getNrThreads() {
+	// Returns the configured thread count, defaulting to the amount of online processors
+	if (nrThreads == 0) {
+#if defined(_SC_NPROCESSORS_ONLN)
+		setNrThreads((int)sysconf(_SC_NPROCESSORS_ONLN));
+#else
+		setNrThreads(1);
+#endif
+	}
+	return nrThreads;
+}
+
+static bool startPool() {
+	// Starts the worker threads.  If a thread can't be started, the pool runs with the ones that did
+	if (mtx_init(&poolLock, mtx_plain) != thrd_success || cnd_init(&wakeWorkers) != thrd_success
+		|| cnd_init(&jobFinished) != thrd_success) {
+		nrThreads = 1;
+		return false;
+	}
+	for (int i = 0; i < getNrThreads() - 1; i++) {
+		if (thrd_create(&workers[i], workerLoop, NULL) != thrd_success) break;
+		thrd_detach(workers[i]);
+		nrWorkers++;
+	}
+	nrThreads = nrWorkers + 1;
+	poolStarted = true;
+	return true;
+}
+
+// Calls task(context, i) for every i from 0 to nrTasks - 1, spread over the pool.  Returns once all tasks are done.
+// Tasks are handed out in no particular order, so each one should write its result to a place of its own
+void parallelFor(int nrTasks, parallelTask task, void* context) {
+
+	if (nrTasks <= 0) return;
+	if (nrTasks == 1 || inPool || getNrThreads() <= 1 || (!poolStarted && !startPool()) || nrWorkers == 0) {
+		for (int i = 0; i < nrTasks; i++) {
+			task(context, i);
+		}
+		return;
+	}
+
+	mtx_lock(&poolLock);
+	jobTask = task;
+	jobContext = context;
+	jobSize = nrTasks;
+	atomic_store(&nextTask, 0);
+	activeWorkers = nrWorkers;
+	generation++;
+	cnd_broadcast(&wakeWorkers);
+	mtx_unlock(&poolLock);
+
+	inPool = true;
+	runTasks();
+	inPool = false;
+
+	mtx_lock(&poolLock);
+	while (activeWorkers > 0) {
+		cnd_wait(&jobFinished, &poolLock);
+	}
+	mtx_unlock(&poolLock);
+}
\ No newline at end of file
@@ -0,0 +1,473 @@
+#define _POSIX_C_SOURCE 200112L  // clock_gettime and the CPU clock of a thread
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+#include "constants.h"
+#include "profile.h"
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <x86intrin.h>
+#define PROFILE_RDTSC
+#endif
+
+// Instrumentation that is compiled in and turned on with "stats on".  Stages of the pipeline are timed by the cycle
+// counter when they are entered and left, and each one is charged only for the time spent in it and not in the stages
+// it enters, so that the times add up to the whole.  Instructions are sampled by runs of the interpreter loops, each of
+// which evaluates an expression or a body once: about one run in SAMPLE_PERIOD counts its instructions, standing for
+// all the runs since the sample before it, and times each of them up to the start of the next, so that the count and
+// the time of each opcode are estimated from the samples, the time less the cost of taking one.  That cost is only
+// known roughly, so an opcode that takes less than it has no time shown, rather than one mostly made of the timing.
+// Times are kept by segments of a sampled run, up to its end or to an instruction that runs code of its own, and a
+// segment during which the thread was switched out is dropped, as its times would include what ran instead.  Times
+// of all threads are added up, so that they are CPU time, which is more than the time of the execute stage when bodies
+// run on several threads.  The other runs go through a copy of the loop without instrumentation, so that code runs
+// about 5% slower, and up to 8% with bodies of a single instruction, most of it the countdown to the next sample and
+// the reading of the CPU clock.  The gaps between samples are drawn at random, as any fixed gap keeps falling on the
+// same run of a loop whose length divides it.  "stats detail" also counts the instructions of every run exactly, which
+// slows short expressions down by about a third.  Counters of instructions and symbol lookups are kept per thread, as
+// bodies of sums run on every thread, and added up when printed.  A stage or a lookup costs a test of profiling
+#define SAMPLE_PERIOD 4096    // Mean number of runs from one sample to the next, a power of 2
+#define CALIBRATION_SAMPLES 101
+#define MAX_STAGE_DEPTH 16
+#define MIN_TIMED_COST 2.0    // Least mean time of an opcode, in costs of timing one, for which a time is shown
+#define IDLE_SECONDS 1e-5     // Time a segment may spend switched out and still be kept, plus IDLE_SHARE of its length
+#define IDLE_SHARE 0.01
+#define RESYNC_SECONDS 1e-3   // Time from the end of a segment after which the next one reads the CPU clock again
+
+// Names of the opcodes, in the order of OPERATORS, up to the last instruction
+static const char* opcodeNames[] = { "null", "+", "-", "*", "/", "%", "neg",
+	"is", ">", "<", ">=", "<=", "and", "or", "not", "xor", "->", "iff", "<-",
+	">>", "<<", "AND", "OR", "NOT", "XOR", "@", "^", "log", "root",
+	"div", "gcd", "lcm", "nCr", "nPr", "atan2", "hypot", "reqll", "perr",
+	"uniform", "normal", "lognormal",
+	"log2", "log10", "ln", "sqrt", "cbrt",
+	"sin", "cos", "tan", "sec", "csc", "cot", "asin", "acos", "atan", "asec", "acsc", "acot",
+	"sinh", "cosh", "tanh", "sech", "csch", "coth", "asinh", "acosh", "atanh", "asech", "acsch", "acoth",
+	"ceil", "floor", "round", "trunc", "sgn", "abs", "fact", "sinc", "nsinc", "deg", "rad",
+	"erf", "erfc", "gamma", "lgamma",
+	"array", "linspace", "dot", "max", "min", "transpose", "det", "inv", "eye", "reshape", "linsolve",
+	"fft", "ifft", "conv", "xcorr", "real", "imag", "magnitude",
+	"sum", "prod", "integrate", "solve", "minimize", "grad", "montecarlo",
+	"assign", "jump", "jump_if_false", "load_const", "load_var", "load_local", "print", "delete",
+	"load_array", "assign_array", "print_array", "map", "reduce",
+	"try_int", "int", "load_int", "load_big", "to_double", "assign_int", "print_int", "define"
+};
+_Static_assert(sizeof(opcodeNames) / sizeof(opcodeNames[0]) == NR_OPCODES, "an opcode has no name");
+static const char* stageNames[NR_STAGES] = { "other", "read", "lex", "parse", "compile", "execute", "print" };
+static const char* lookupNames[NR_LOOKUPS] = { "function", "variable" };
+
+bool profiling = false;
+bool profileDetail = false;
+_Thread_local int profileCountdown = SAMPLE_PERIOD;
+static uint64_t stageTicks[NR_STAGES];
+static uint64_t stageCalls[NR_STAGES];
+static int stageStack[MAX_STAGE_DEPTH];
+static int stageDepth;
+static int currentStage;
+static uint64_t stageStart;
+static uint64_t startTicks;     // Counter and clock when instrumentation was started, to find the rate of the counter
+static double startSeconds;
+static uint64_t sampleCost;     // Ticks the timing of an instruction that does nothing takes
+static profileCounters* threadTables[MAX_THREADS + 1];
+static atomic_int nrThreadTables;
+static _Thread_local profileCounters* ownCounters;  // Counters of the thread
+
+static double seconds() {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+	return now.tv_sec + 1e-9 * now.tv_nsec;
+}
+
+static uint64_t readTicks() {
+	// The cycle counter where there is one, and nanoseconds otherwise
+#ifdef PROFILE_RDTSC
+	return __rdtsc();
+#else
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+	return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
+
+static double threadSeconds() {
+	// CPU time the calling thread has taken
+	struct timespec now;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+	return now.tv_sec + 1e-9 * now.tv_nsec;
+}
+
+static double ticksPerSecond() {
+	// Found from the time instrumentation has been on, as the rate of the cycle counter isn't known beforehand
+	double elapsed = seconds() - startSeconds;
+
+#ifdef PROFILE_RDTSC
+	return (elapsed > 0.0) ? (double)(readTicks() - startTicks) / elapsed : 1e9;
+#else
+	return 1e9;
+#endif
+}
+
+static int nextGap(profileCounters* counters) {
+	// Number of runs to the next sample, from SAMPLE_PERIOD / 2 to 3 * SAMPLE_PERIOD / 2 - 1
+	counters->seed = counters->seed * 1103515245u + 12345u;
+	return SAMPLE_PERIOD / 2 + (int)((counters->seed >> 16) & (SAMPLE_PERIOD - 1));
+}
+
+// Returns the counters of the calling thread, which are made on its first use, or NULL if there is no memory or no room
+// for them
+profileCounters* threadProfile() {
+
+	int index = 0;
+
+	if (ownCounters != NULL) return ownCounters;
+	index = atomic_fetch_add(&nrThreadTables, 1);
+	if (index > MAX_THREADS) {
+		atomic_fetch_sub(&nrThreadTables, 1);
+		return NULL;
+	}
+	ownCounters = calloc(1, sizeof(profileCounters));
+	if (ownCounters != NULL) {
+		ownCounters->seed = (unsigned int)index;
+		ownCounters->gap = SAMPLE_PERIOD;
+	}
+	threadTables[index] = ownCounters;
+	return ownCounters;
+}
+
+static bool runsCode(unsigned int instruction) {
+	// Whether an instruction runs code of its own, which is counted and timed by itself
+	return (instruction >= HIGHER_ORDER_OPERATORS && instruction < END_FUNCS) || instruction == INST_MAP
+		|| instruction == INST_REDUCE || instruction == INST_DEFINE;
+}
+
+static void calibrate() {
+	// Finds the cost of timing an instruction, which is taken off every one timed.  It is the median of many timings of
+	// nothing, as the least of them is well below what a timing usually costs, in a virtual machine most of all
+	profileCounters scratch;
+	uint64_t costs[CALIBRATION_SAMPLES];
+	uint64_t swap = 0;
+
+	memset(&scratch, 0, sizeof(profileCounters));
+	for (int i = 0; i < CALIBRATION_SAMPLES; i++) {
+		timeInstruction(&scratch, OPERATOR_START);
+		timeInstruction(&scratch, OPERATOR_START);
+		costs[i] = scratch.segmentTicks[0];
+		scratch.segmentLength = 0;
+		scratch.sampled = 0;
+	}
+	for (int i = 1; i < CALIBRATION_SAMPLES; i++) {
+		for (int j = i; j > 0 && costs[j] < costs[j - 1]; j--) {
+			swap = costs[j];
+			costs[j] = costs[j - 1];
+			costs[j - 1] = swap;
+		}
+	}
+	sampleCost = costs[CALIBRATION_SAMPLES / 2];
+}
+
+static void catchUp() {
+	// Charges the time up to now to the current stage, so that what is printed is up to date
+	uint64_t now = readTicks();
+
+	stageTicks[currentStage] += now - stageStart;
+	stageStart = now;
+}
+
+// Turns instrumentation on, keeping what was counted before.  With detail, every instruction is counted rather than
+// estimated from samples
+void startProfile(bool detail) {
+
+	profileDetail = detail;
+	if (profiling) return;
+	if (startSeconds == 0.0) {
+		calibrate();
+		startSeconds = seconds();
+		startTicks = readTicks();
+	}
+	currentStage = STAGE_OTHER;
+	stageDepth = 0;
+	stageStart = readTicks();
+	profiling = true;
+}
+
+void stopProfile() {
+	// Turns instrumentation off, charging the time since the last stage was entered or left
+	if (!profiling) return;
+	catchUp();
+	profiling = false;
+}
+
+// Forgets everything counted so far.  Must not be called while a parallel job runs
+void resetProfile() {
+
+	int nrTables = atomic_load(&nrThreadTables);
+
+	memset(stageTicks, 0, sizeof(stageTicks));
+	memset(stageCalls, 0, sizeof(stageCalls));
+	for (int i = 0; i < nrTables && i <= MAX_THREADS; i++) {
+		if (threadTables[i] == NULL) continue;
+		memset(threadTables[i], 0, sizeof(profileCounters));
+		threadTables[i]->seed = (unsigned int)i;
+		threadTables[i]->gap = SAMPLE_PERIOD;
+	}
+	startSeconds = seconds();
+	startTicks = readTicks();
+	stageStart = startTicks;
+}
+
+// Starts charging time to a stage, until leaveStage() goes back to the stage that was running before
+void enterStage(int stage) {
+
+	uint64_t now = 0;
+
+	if (!profiling) return;
+	now = readTicks();
+	stageTicks[currentStage] += now - stageStart;
+	stageStart = now;
+	stageCalls[stage]++;
+	if (stageDepth < MAX_STAGE_DEPTH) stageStack[stageDepth] = currentStage;
+	stageDepth++;
+	currentStage = stage;
+}
+
+void leaveStage() {
+	// Charges the time since the last stage was entered or left to the current one, and goes back to the one before
+	uint64_t now = 0;
+
+	if (!profiling) return;
+	now = readTicks();
+	stageTicks[currentStage] += now - stageStart;
+	stageStart = now;
+	if (stageDepth == 0) {
+		currentStage = STAGE_OTHER;
+		return;
+	}
+	stageDepth--;
+	if (stageDepth < MAX_STAGE_DEPTH) currentStage = stageStack[stageDepth];
+}
+
+void countLookup(int kind) {
+	// Counts a search of the table of functions or of variables
+	profileCounters* table = NULL;
+
+	if (!profiling || (table = threadProfile()) == NULL) return;
+	table->lookups[kind]++;
+}
+
+static void endSegment(profileCounters* counters, bool keep) {
+	// Adds the times of the segment being timed to those of the opcodes, if it is to be kept and the thread wasn't
+	// switched out during it
+	double wall = 0.0;
+	double cpu = 0.0;
+
+	if (!counters->inSegment) return;
+	wall = seconds();
+	cpu = threadSeconds();
+	keep = keep && (wall - counters->lastWall) - (cpu - counters->lastCpu)
+		< IDLE_SECONDS + IDLE_SHARE * (wall - counters->lastWall);
+	counters->lastWall = wall;
+	counters->lastCpu = cpu;
+	for (int i = 0; keep && i < counters->segmentLength; i++) {
+		counters->sampledTicks[counters->segmentOps[i]] += counters->segmentTicks[i];
+		counters->samples[counters->segmentOps[i]]++;
+	}
+	counters->segmentLength = 0;
+	counters->inSegment = false;
+}
+
+static void beginSegment(profileCounters* counters) {
+	// Reading the CPU clock is slow, so a segment that begins soon after the last one ended is measured from that end,
+	// and dropped if the thread was switched out at any time since
+	double wall = seconds();
+
+	if (wall - counters->lastWall > RESYNC_SECONDS) {
+		counters->lastWall = wall;
+		counters->lastCpu = threadSeconds();
+	}
+	counters->inSegment = true;
+}
+
+static void addToSegment(profileCounters* counters, uint64_t ticks) {
+	// Ends the timing of the instruction being timed, and the segment if it is full
+	counters->segmentOps[counters->segmentLength] = (unsigned short)(counters->sampled - 1);
+	counters->segmentTicks[counters->segmentLength] = ticks;
+	counters->segmentLength++;
+	counters->sampled = 0;
+	if (counters->segmentLength == SEGMENT_LENGTH) endSegment(counters, true);
+}
+
+// Called by an interpreter loop that counts the instructions of a run, as the run is a sample, which profileCountdown
+// reaching 0 marks, or as profileDetail is set.  Sets the number of runs each instruction is counted for and whether
+// they are timed, and returns the counters of the thread, or NULL if there are none
+profileCounters* countRun(int* weight, bool* timed) {
+
+	profileCounters* counters = threadProfile();
+
+	*weight = 1;
+	*timed = false;
+	if (profileCountdown > 0) return counters;
+	if (counters == NULL) {
+		profileCountdown = SAMPLE_PERIOD;
+		return NULL;
+	}
+	if (!profileDetail) *weight = counters->gap;
+	counters->gap = nextGap(counters);
+	profileCountdown = counters->gap;
+	// A run that stopped on an error may have left the timing of its last instruction running, and its segment
+	counters->sampled = 0;
+	endSegment(counters, false);
+	*timed = true;
+	return counters;
+}
+
+// Starts timing an instruction of a sampled run that is about to run, and ends the timing of the one before it.  One
+// that runs code of its own isn't timed, as that code would be timed twice, and ends the segment
+void timeInstruction(profileCounters* counters, unsigned int instruction) {
+
+	uint64_t now = readTicks();
+
+	if (counters->sampled != 0) addToSegment(counters, now - counters->sampleStart);
+	if (runsCode(instruction)) {
+		endSegment(counters, true);
+		return;
+	}
+	if (!counters->inSegment) {
+		beginSegment(counters);
+		now = readTicks();
+	}
+	counters->sampled = instruction - OPERATOR_START + 1;
+	counters->sampleStart = now;
+}
+
+void endRun(profileCounters* counters) {
+	// Ends the timing of the last instruction of a sampled run, and its segment
+	if (counters->sampled != 0) addToSegment(counters, readTicks() - counters->sampleStart);
+	endSegment(counters, true);
+}
+
+static void addTables(profileCounters* total) {
+	// Adds up the counters of every thread
+	int nrTables = atomic_load(&nrThreadTables);
+
+	memset(total, 0, sizeof(profileCounters));
+	for (int i = 0; i < nrTables && i <= MAX_THREADS; i++) {
+		if (threadTables[i] == NULL) continue;
+		for (int op = 0; op < NR_OPCODES; op++) {
+			total->counts[op] += threadTables[i]->counts[op];
+			total->samples[op] += threadTables[i]->samples[op];
+			total->sampledTicks[op] += threadTables[i]->sampledTicks[op];
+		}
+		for (int kind = 0; kind < NR_LOOKUPS; kind++) total->lookups[kind] += threadTables[i]->lookups[kind];
+	}
+}
+
+static double opcodeSeconds(const profileCounters* total, int op, double rate) {
+	// CPU time an opcode took in all, estimated from the ones that were timed, or -1 if it wasn't timed or took about as
+	// long as the timing itself
+	double cost = (double)total->samples[op] * sampleCost;
+
+	if (total->samples[op] == 0 || total->sampledTicks[op] < MIN_TIMED_COST * cost) return -1.0;
+	return ((double)total->sampledTicks[op] - cost) / total->samples[op] * total->counts[op] / rate;
+}
+
+// Prints the time spent in each stage, the number of lookups, and the count and estimated CPU time of each opcode run,
+// the slowest first, with "-" for a time that couldn't be told from the cost of timing
+void printProfile() {
+
+	profileCounters* total = malloc(sizeof(profileCounters));
+	int order[NR_OPCODES];
+	int nrUsed = 0;
+	double rate = ticksPerSecond();
+	double sum = 0.0;
+	double seconds = 0.0;
+	int swap = 0;
+
+	if (total == NULL) {
+		printf("  Out of memory\n");
+		return;
+	}
+	if (profiling) catchUp();
+	addTables(total);
+	for (int stage = 0; stage < NR_STAGES; stage++) sum += stageTicks[stage] / rate;
+	printf("  %s\n", !profiling ? "Instrumentation is off"
+		: profileDetail ? "Instrumentation is on, counting every instruction" : "Instrumentation is on, sampling runs");
+	printf("  %-10s %12s %12s %7s\n", "stage", "calls", "seconds", "share");
+	for (int stage = 0; stage < NR_STAGES; stage++) {
+		printf("  %-10s %12llu %12.6f %6.1f%%\n", stageNames[stage], (unsigned long long)stageCalls[stage],
+			stageTicks[stage] / rate, (sum > 0.0) ? 100.0 * stageTicks[stage] / rate / sum : 0.0);
+	}
+	printf("  %-10s %12s\n", "lookups", "count");
+	for (int kind = 0; kind < NR_LOOKUPS; kind++) {
+		printf("  %-10s %12llu\n", lookupNames[kind], (unsigned long long)total->lookups[kind]);
+	}
+
+	for (int op = 0; op < NR_OPCODES; op++) {
+		if (total->counts[op] > 0) order[nrUsed++] = op;
+	}
+	// Few opcodes are ever used, so they are sorted by insertion
+	for (int i = 1; i < nrUsed; i++) {
+		for (int j = i; j > 0 && opcodeSeconds(total, order[j], rate) > opcodeSeconds(total, order[j - 1], rate); j--) {
+			swap = order[j];
+			order[j] = order[j - 1];
+			order[j - 1] = swap;
+		}
+	}
+	if (nrUsed > 0) printf("  %-14s %14s %12s\n", "opcode", "count", "cpu seconds");
+	for (int i = 0; i < nrUsed; i++) {
+		seconds = opcodeSeconds(total, order[i], rate);
+		printf("  %-14s %14llu ", opcodeNames[order[i]], (unsigned long long)total->counts[order[i]]);
+		if (seconds < 0.0) {
+			printf("%12s\n", "-");
+		}
+		else {
+			printf("%12.6f\n", seconds);
+		}
+	}
+	free(total);
+}
+
+// Writes everything printProfile() prints to a file as JSON, with null for an opcode time that isn't shown.  Returns
+// false if it couldn't be written
+bool writeProfile(FILE* file) {
+
+	profileCounters* total = malloc(sizeof(profileCounters));
+	double rate = ticksPerSecond();
+	double seconds = 0.0;
+	bool first = true;
+
+	if (total == NULL) return false;
+	if (profiling) catchUp();
+	addTables(total);
+	fprintf(file, "{\n  \"ticks_per_second\": %.6e,\n  \"timing_cost_seconds\": %.3e,\n  \"exact_counts\": %s,\n"
+		"  \"stages\": {", rate, sampleCost / rate, profileDetail ? "true" : "false");
+	for (int stage = 0; stage < NR_STAGES; stage++) {
+		fprintf(file, "%s\n    \"%s\": {\"calls\": %llu, \"seconds\": %.9f}", (stage > 0) ? "," : "",
+			stageNames[stage], (unsigned long long)stageCalls[stage], stageTicks[stage] / rate);
+	}
+	fprintf(file, "\n  },\n  \"lookups\": {");
+	for (int kind = 0; kind < NR_LOOKUPS; kind++) {
+		fprintf(file, "%s\"%s\": %llu", (kind > 0) ? ", " : "", lookupNames[kind],
+			(unsigned long long)total->lookups[kind]);
+	}
+	fprintf(file, "},\n  \"opcodes\": {");
+	for (int op = 0; op < NR_OPCODES; op++) {
+		if (total->counts[op] == 0) continue;
+		seconds = opcodeSeconds(total, op, rate);
+		fprintf(file, "%s\n    \"%s\": {\"count\": %llu, \"samples\": %llu, \"cpu_seconds\": ", first ? "" : ",",
+			opcodeNames[op], (unsigned long long)total->counts[op], (unsigned long long)total->samples[op]);
+		if (seconds < 0.0) {
+			fprintf(file, "null}");
+		}
+		else {
+			fprintf(file, "%.9f}", seconds);
+		}
+		first = false;
+	}
+	fprintf(file, "%s}\n}\n", first ? "" : "\n  ");
+	free(total);
+	return !ferror(file);
+}
\ No newline at end of file
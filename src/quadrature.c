@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <float.h>
+#include "constants.h"
+#include "compile.h"
+#include "execute.h"
+#include "parallel.h"
+#include "reduce.h"
+#include "quadrature.h"
+
+#define INTEGRATE_PIECES 16         // Subintervals integrated independently.  Fixed so results don't depend on thread count
+#define MAX_SUBDIVISIONS 2000       // Intervals one piece may be split into before its estimate is accepted as is
+#define NR_KRONROD_NODES 15
+
+// 15-point Gauss-Kronrod rule.  Nodes on [0, 1) of the symmetric rule, largest first, with the centre last
+static const double kronrodNodes[8] = {
+	0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+	0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+	0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+	0.207784955007898467600689403773245, 0.000000000000000000000000000000000
+};
+static const double kronrodWeights[8] = {
+	0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+	0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+	0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+	0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+};
+// Weights of the embedded 7-point Gauss rule, which uses the odd Kronrod nodes
+static const double gaussWeights[4] = {
+	0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+	0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+};
+
+typedef struct {
+	double low;
+	double high;
+	double integral;
+	double error;
+} interval;
+
+typedef struct {
+	const program* prog;
+	int bodyStart;
+	int bodyEnd;
+	int local;
+	double low;
+	double width;           // Width of each piece
+	double tolerance;       // Allowed error per unit of width
+	const double* locals;
+	double* integral;       // Result of each piece
+	double* compensation;
+	double* unresolved;     // Error of the intervals of each piece that were accepted without meeting the tolerance
+} quadrature;
+
+static void kronrodNodesOf(double low, double high, double nodes[]) {
+	// Places the 15 nodes of the rule on an interval
+	double centre = 0.5 * (low + high);
+	double halfWidth = 0.5 * (high - low);
+	for (int i = 0; i < 7; i++) {
+		nodes[2 * i] = centre - halfWidth * kronrodNodes[i];
+		nodes[2 * i + 1] = centre + halfWidth * kronrodNodes[i];
+	}
+	nodes[14] = centre;
+}
+
+static void applyRule(interval* part, const double values[]) {
+	// Computes the Kronrod estimate of an interval and its difference from the Gauss estimate
+	double halfWidth = 0.5 * (part->high - part->low);
+	double kronrod = kronrodWeights[7] * values[14];
+	double gauss = gaussWeights[3] * values[14];
+
+	for (int i = 0; i < 7; i++) {
+		kronrod += kronrodWeights[i] * (values[2 * i] + values[2 * i + 1]);
+		if (i % 2 == 1) {
+			gauss += gaussWeights[i / 2] * (values[2 * i] + values[2 * i + 1]);
+		}
+	}
+	part->integral = kronrod * halfWidth;
+	part->error = fabs((kronrod - gauss) * halfWidth);
+}
+
+static bool isAccurate(const interval* part, double tolerance) {
+	// An interval is done when its error is within its share of the tolerance, or can't be reduced by rounding anymore
+	return part->error <= tolerance * (part->high - part->low)
+		|| part->error <= 50 * DBL_EPSILON * fabs(part->integral)
+		|| part->high - part->low <= 4 * DBL_EPSILON * fmax(fabs(part->low), fabs(part->high));
+}
+
+static void integratePiece(void* context, int index) {
+	// Adaptive bisection of one piece.  Both halves of a split interval are evaluated in a single batch of 30 nodes
+	quadrature* task = context;
+	interval pending[64];  // Depth first, so the stack never holds more than one interval per level of bisection
+	int nrPending = 0;
+	int nrSplits = 0;
+	double nodes[BATCH_SIZE];
+	double values[BATCH_SIZE];
+	double locals[MAX_LOCALS];
+	const double* lanes[MAX_LOCALS] = { NULL };
+	double sum = 0.0;
+	double compensation = 0.0;
+	double unresolved = 0.0;
+	double middle;
+	interval current;
+	double* workspace = malloc(task->prog->stackDepth * BATCH_SIZE * sizeof(double));
+
+	if (workspace == NULL) {
+		task->integral[index] = NAN;
+		task->compensation[index] = 0.0;
+		task->unresolved[index] = 0.0;
+		return;
+	}
+	for (int i = 0; i < MAX_LOCALS; i++) {
+		locals[i] = task->locals[i];
+	}
+	lanes[task->local] = nodes;
+
+	current.low = task->low + index * task->width;
+	current.high = (index == INTEGRATE_PIECES - 1) ? task->low + INTEGRATE_PIECES * task->width : current.low + task->width;
+	kronrodNodesOf(current.low, current.high, nodes);
+	executeBatch(task->prog, task->bodyStart, task->bodyEnd, locals, lanes, NR_KRONROD_NODES, values, workspace);
+	applyRule(&current, values);
+	pending[nrPending++] = current;
+
+	while (nrPending > 0) {
+		current = pending[--nrPending];
+
+		if (isnan(current.integral)) {
+			sum = NAN;
+			break;
+		}
+		if (isAccurate(&current, task->tolerance)) {
+			neumaierAdd(&sum, &compensation, current.integral);
+			continue;
+		}
+		if (nrSplits >= MAX_SUBDIVISIONS || nrPending >= 62) {
+			neumaierAdd(&sum, &compensation, current.integral);
+			unresolved += current.error;
+			continue;
+		}
+
+		// Split in two and evaluate both halves together
+		middle = 0.5 * (current.low + current.high);
+		kronrodNodesOf(current.low, middle, nodes);
+		kronrodNodesOf(middle, current.high, nodes + NR_KRONROD_NODES);
+		executeBatch(task->prog, task->bodyStart, task->bodyEnd, locals, lanes, 2 * NR_KRONROD_NODES, values, workspace);
+
+		pending[nrPending].low = middle;
+		pending[nrPending].high = current.high;
+		applyRule(&pending[nrPending], values + NR_KRONROD_NODES);
+		nrPending++;
+		pending[nrPending].low = current.low;
+		pending[nrPending].high = middle;
+		applyRule(&pending[nrPending], values);
+		nrPending++;
+		nrSplits++;
+	}
+
+	free(workspace);
+	task->integral[index] = sum;
+	task->compensation[index] = compensation;
+	task->unresolved[index] = unresolved;
+}
+
+// Integrates the body of integrate(x, low, high, body, tolerance) over x with adaptive Gauss-Kronrod quadrature.
+// The range is cut into pieces that are refined independently on the thread pool, each getting a share of the
+// tolerance in proportion to its width.  Returns NaN if the integral doesn't converge to within the tolerance
+double integrateRange(const program* prog, int bodyStart, int bodyEnd, int local,
+	double low, double high, double tolerance, double locals[]) {
+
+	quadrature task;
+	double integral[INTEGRATE_PIECES];
+	double compensation[INTEGRATE_PIECES];
+	double unresolved[INTEGRATE_PIECES];
+	double totalUnresolved = 0.0;
+	double result = 0.0;
+	double resultCompensation = 0.0;
+
+	if (isnan(low) || isnan(high) || isinf(low) || isinf(high) || isnan(tolerance)) return NAN;
+	if (low == high) return 0.0;
+	if (low > high) return -integrateRange(prog, bodyStart, bodyEnd, local, high, low, tolerance, locals);
+
+	task.prog = prog;
+	task.bodyStart = bodyStart;
+	task.bodyEnd = bodyEnd;
+	task.local = local;
+	task.low = low;
+	task.width = (high - low) / INTEGRATE_PIECES;
+	task.tolerance = fabs(tolerance) / (high - low);
+	task.locals = locals;
+	task.integral = integral;
+	task.compensation = compensation;
+	task.unresolved = unresolved;
+
+	parallelFor(INTEGRATE_PIECES, integratePiece, &task);
+
+	for (int i = 0; i < INTEGRATE_PIECES; i++) {
+		neumaierAdd(&result, &resultCompensation, integral[i]);
+		resultCompensation += compensation[i];
+		totalUnresolved += unresolved[i];
+	}
+	if (totalUnresolved > fabs(tolerance)) return NAN;
+	return result + resultCompensation;
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "constants.h"
+#include "random.h"
+
+// Random draws come from Philox4x32-10, a counter-based generator: each draw is a fixed function of the seed and a
+// number of 128 bits, so any draw can be made on any thread without sharing or advancing a state.  A draw of
+// montecarlo() is numbered by its stream, its sample, and the draws its sample made before it, so results only
+// depend on the seed and the number of samples, and not on how many threads evaluate them
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+static unsigned long long int seed = 0;
+static atomic_ullong sessionDraws;                // Draws made outside of montecarlo(), which number the next one
+static _Thread_local randomState current;
+
+static void philox(uint32_t blocks[4][BATCH_SIZE], int count) {
+	// Replaces the counters of up to BATCH_SIZE draws by their random words, round by round over all of them, so that
+	// the loop over the draws is vectorized
+	uint32_t key0 = (uint32_t)seed;
+	uint32_t key1 = (uint32_t)(seed >> 32);
+	uint64_t product0 = 0;
+	uint64_t product1 = 0;
+
+	for (int round = 0; round < PHILOX_ROUNDS; round++) {
+		for (int i = 0; i < count; i++) {
+			product0 = (uint64_t)PHILOX_M0 * blocks[0][i];
+			product1 = (uint64_t)PHILOX_M1 * blocks[2][i];
+			blocks[0][i] = (uint32_t)(product1 >> 32) ^ blocks[1][i] ^ key0;
+			blocks[2][i] = (uint32_t)(product0 >> 32) ^ blocks[3][i] ^ key1;
+			blocks[1][i] = (uint32_t)product1;
+			blocks[3][i] = (uint32_t)product0;
+		}
+		key0 += PHILOX_W0;
+		key1 += PHILOX_W1;
+	}
+}
+
+static void setCounter(uint32_t blocks[4][BATCH_SIZE], int i, unsigned long long int number, unsigned int draw,
+	unsigned int stream) {
+
+	blocks[0][i] = (uint32_t)number;
+	blocks[1][i] = (uint32_t)(number >> 32);
+	blocks[2][i] = draw;
+	blocks[3][i] = stream;
+}
+
+static double toUniform(uint32_t high, uint32_t low) {
+	// Makes a double in [0, 1) of 53 random bits
+	return (double)(((uint64_t)high << 21) ^ (low >> 11)) * 0x1p-53;
+}
+
+static double distribution(unsigned int operand, double left, double right, uint32_t blocks[4][BATCH_SIZE], int i) {
+	// Turns the random words of a draw into a value of a distribution.  Normal values are made by the Box-Muller
+	// transform, from 1 - u, which is never 0, and a second uniform value
+	double z = 0.0;
+
+	if (operand == OP_UNIFORM) return left + (right - left) * toUniform(blocks[0][i], blocks[1][i]);
+	if (right < 0.0) return NAN;
+	z = sqrt(-2.0 * log(1.0 - toUniform(blocks[0][i], blocks[1][i]))) * cos(2.0 * pi * toUniform(blocks[2][i], blocks[3][i]));
+	return (operand == OP_NORMAL) ? left + right * z : exp(left + right * z);
+}
+
+static void numberDraw(uint32_t blocks[4][BATCH_SIZE], int i) {
+	// Sets the counter of the next draw of the calling thread
+	if (current.stream == 0) {
+		setCounter(blocks, i, atomic_fetch_add(&sessionDraws, 1), 0, 0);
+	}
+	else {
+		setCounter(blocks, i, current.sample + current.lane, current.draw, current.stream);
+		current.draw++;
+	}
+}
+
+void seedRandom(unsigned long long int value) {
+	// Starts the draws over from a seed
+	seed = value;
+	atomic_store(&sessionDraws, 0);
+}
+
+unsigned long long int getSeed() {
+	return seed;
+}
+
+unsigned int newStream() {
+	// Returns the stream of a montecarlo() that is about to start.  It is a draw itself, from the session or from the
+	// sample of the montecarlo() it is nested in, so that nested ones don't repeat the same draws
+	uint32_t blocks[4][BATCH_SIZE];
+
+	numberDraw(blocks, 0);
+	philox(blocks, 1);
+	return (blocks[0][0] == 0) ? 1 : blocks[0][0];
+}
+
+randomState enterSamples(unsigned int stream, unsigned long long int first, bool lanes) {
+	// Makes the draws of the calling thread those of samples from first on, a sample per lane if lanes is set.
+	// Returns the state to give back to leaveSamples()
+	randomState previous = current;
+
+	current.stream = stream;
+	current.sample = first;
+	current.lane = 0;
+	current.draw = 0;
+	current.lanes = lanes;
+	current.lastDraw = 0;
+	return previous;
+}
+
+void leaveSamples(randomState previous) {
+	current = previous;
+}
+
+randomState enterLanes() {
+	// Starts running the lanes of a batch one at a time, each from the draw the batch is at
+	randomState batch = current;
+
+	batch.lastDraw = current.draw;
+	return batch;
+}
+
+void selectLane(randomState* batch, int lane) {
+	// Makes the draws those of one lane of a batch
+	if (current.draw > batch->lastDraw) batch->lastDraw = current.draw;
+	current = *batch;
+	if (batch->lanes) current.lane = batch->lane + lane;
+	current.lanes = false;
+}
+
+void leaveLanes(randomState* batch) {
+	// Goes back to the whole batch, past the draws of the lane that made the most
+	if (current.draw > batch->lastDraw) batch->lastDraw = current.draw;
+	current = *batch;
+	current.draw = batch->lastDraw;
+}
+
+double drawValue(unsigned int operand, double left, double right) {
+	// Draws a value of uniform(a, b), normal(mu, sigma), or lognormal(mu, sigma)
+	uint32_t blocks[4][BATCH_SIZE];
+
+	numberDraw(blocks, 0);
+	philox(blocks, 1);
+	return distribution(operand, left, right, blocks, 0);
+}
+
+void drawLanes(unsigned int operand, double below[], const double top[], int count) {
+	// Draws a value for each lane of a batch, in place of the first argument.  When the lanes are samples, each draws
+	// from its own sample.  When they are points of a single sample, they share one draw
+	uint32_t blocks[4][BATCH_SIZE];
+	unsigned long long int first = 0;
+
+	if (current.stream == 0) {
+		first = atomic_fetch_add(&sessionDraws, count);
+		for (int i = 0; i < count; i++) setCounter(blocks, i, first + i, 0, 0);
+		philox(blocks, count);
+	}
+	else if (current.lanes) {
+		for (int i = 0; i < count; i++) setCounter(blocks, i, current.sample + i, current.draw, current.stream);
+		current.draw++;
+		philox(blocks, count);
+	}
+	else {
+		numberDraw(blocks, 0);
+		philox(blocks, 1);
+		for (int j = 0; j < 4; j++) {
+			for (int i = 1; i < count; i++) blocks[j][i] = blocks[j][0];
+		}
+	}
+	for (int i = 0; i < count; i++) {
+		below[i] = distribution(operand, below[i], top[i], blocks, i);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "compile.h"
+#include "execute.h"
+#include "parallel.h"
+#include "reduce.h"
+
+// Iterations per chunk.  Chunks are always split the same way, and their partial results combined in order,
+// so that a reduction gives the same result whatever the thread count
+#define REDUCE_CHUNK_SIZE 16384
+
+typedef struct {
+	const program* prog;
+	unsigned int operand;   // OP_SUM or OP_PROD
+	int bodyStart;
+	int bodyEnd;
+	int local;              // Slot of the index variable in locals
+	long long int first;    // First value of the index
+	long long int count;    // Amount of values of the index
+	const double* locals;   // Bound variables of the enclosing expression
+	double* partial;        // Result of each chunk
+	double* compensation;   // Accumulated rounding error of each chunk
+} reduction;
+
+void neumaierAdd(double* sum, double* compensation, double value) {
+	// Adds a value to a sum, keeping the rounding error of the addition in a separate compensation term
+	double total = *sum + value;
+	if (fabs(*sum) >= fabs(value)) {
+		*compensation += (*sum - total) + value;
+	}
+	else {
+		*compensation += (value - total) + *sum;
+	}
+	*sum = total;
+}
+
+static void productMultiply(double* product, double* compensation, double value) {
+	// Multiplies a product by a value, keeping the rounding error of the multiplication in the compensation term
+	double total = *product * value;
+	*compensation = *compensation * value + fma(*product, value, -total);
+	*product = total;
+}
+
+static void reduceChunk(void* context, int index) {
+	// Evaluates the body for every index value of one chunk
+	reduction* task = context;
+	double locals[MAX_LOCALS];
+	long long int start = (long long int)index * REDUCE_CHUNK_SIZE;
+	long long int end = start + REDUCE_CHUNK_SIZE;
+	double result = (task->operand == OP_SUM) ? 0.0 : 1.0;
+	double compensation = 0.0;
+	double value;
+
+	if (end > task->count) end = task->count;
+	for (int i = 0; i < MAX_LOCALS; i++) {
+		locals[i] = task->locals[i];
+	}
+
+	for (long long int i = start; i < end; i++) {
+		locals[task->local] = (double)(task->first + i);
+		value = executeCode(task->prog, task->bodyStart, task->bodyEnd, locals);
+		if (task->operand == OP_SUM) {
+			neumaierAdd(&result, &compensation, value);
+		}
+		else {
+			productMultiply(&result, &compensation, value);
+		}
+	}
+
+	task->partial[index] = result;
+	task->compensation[index] = compensation;
+}
+
+// Sums or multiplies the body of sum(k, low, high, body) over every integer k from low to high, that is from ceil(low) to
+// floor(high).  Bounds past 9e15, where doubles are no longer every integer, are undefined.  The range is split into
+// chunks that are reduced in parallel with compensated arithmetic
+double reduceRange(const program* prog, unsigned int operand, int bodyStart, int bodyEnd, int local,
+	double low, double high, double locals[]) {
+
+	reduction task;
+	long long int nrChunks;
+	double result = (operand == OP_SUM) ? 0.0 : 1.0;
+	double compensation = 0.0;
+	double previous;
+
+	if (isnan(low) || isnan(high) || isinf(low) || isinf(high) || fabs(low) > 9e15 || fabs(high) > 9e15) return NAN;
+	low = ceil(low);
+	high = floor(high);
+	if (low > high) return result;
+
+	task.prog = prog;
+	task.operand = operand;
+	task.bodyStart = bodyStart;
+	task.bodyEnd = bodyEnd;
+	task.local = local;
+	task.first = (long long int)low;
+	task.count = (long long int)high - task.first + 1;
+	task.locals = locals;
+
+	nrChunks = (task.count + REDUCE_CHUNK_SIZE - 1) / REDUCE_CHUNK_SIZE;
+	if (nrChunks > 0x7FFFFFFF) return NAN;
+	task.partial = malloc(nrChunks * sizeof(double));
+	task.compensation = malloc(nrChunks * sizeof(double));
+	if (task.partial == NULL || task.compensation == NULL) {
+		free(task.partial);
+		free(task.compensation);
+		return NAN;
+	}
+
+	parallelFor((int)nrChunks, reduceChunk, &task);
+
+	// Combine chunks in order
+	for (long long int i = 0; i < nrChunks; i++) {
+		if (operand == OP_SUM) {
+			neumaierAdd(&result, &compensation, task.partial[i]);
+			compensation += task.compensation[i];
+		}
+		else {
+			previous = result;
+			productMultiply(&result, &compensation, task.partial[i]);
+			compensation += previous * task.compensation[i];
+		}
+	}
+
+	free(task.partial);
+	free(task.compensation);
+	return result + compensation;
+}
\ No newline at end of file
@@ -1,487 +1,559 @@
-#include <stdio.h>
-#include <math.h>
-#include <stdlib.h>
-#include <stdbool.h>
-#include "constants.h"
-#include "auxiliary.h"
-#include "tokenize.h"
-#include "rpn.h"
-#include "global.h"
-
-// Pushes given token and some tokens on stack to the output such that output is in postfix
-void pushOperator(unsigned int token, unsigned int stack[], int* stackLength, int* outputLength) {
-
-	int topOfStack = 0;
-
-	int precedence[26] = {
-		0,  // NULL	
-		10, // ADD
-		10, // SUB
-		11, // MUL
-		11, // DIV
-		11, // MOD
-		12, // NEG
-		8,  // IS
-		8,  // GREATER_THAN 
-		8,  // LESS_THAN 
-		8,  // GREATER_THAN_OR_EQUAL_TO 
-		8,  // LESS_THAN_OR_EQUAL_TO
-		4,  // AND
-		2,  // OR
-		12, // NOT 
-		3,  // XOR
-		1,  // IMPLIES
-		1,  // IFF 
-		1,  // IMPLIED BY
-		9,  // LEFT SHIFT
-		9,  // RIGHT SHIFT
-		4,  // BITWISE AND
-		5,  // BITWISE OR
-		12, // BITWISE NOT
-		6,  // BITWISE XOR
-		14, // EXP
-	};
-
-	int stackPrecedence = 0; int tokenPrecedence = 0;
-
-	if (stackIsEmpty(stack)) {
-		push(stack, token, stackLength, STACK_SIZE);
-		if (error != NO_ERROR) return;
-	}
-	else {
-		// Push all higher precedence tokens from stack to output, then push current token to stack
-		while (!stackIsEmpty(stack)) {
-			topOfStack = stack[*stackLength - 1];
-			if (topOfStack < END_FUNCS) {
-				if (topOfStack < END_OPS) {
-					// Operations.  Are offset because operators start at OP_NULL
-					stackPrecedence = precedence[topOfStack - OP_NULL];
-					tokenPrecedence = precedence[token - OP_NULL];
-
-					if ((token != OP_EXP && tokenPrecedence <= stackPrecedence)
-						|| (token == OP_EXP && tokenPrecedence < stackPrecedence)) {
-						push(expressionRPN, pop(stack, stackLength), outputLength, RPN_SIZE);
-						if (error != NO_ERROR) return;
-					}
-					else break;
-				}
-				else {
-					// Functions, being in prefix rather than infix notation, are simply pushed
-					push(expressionRPN, pop(stack, stackLength), outputLength, RPN_SIZE);
-					if (error != NO_ERROR) return;
-				}
-			}
-			else {
-				// Neither operators nor functions (parentheses, etc)
-				break;
-			}
-		}
-		push(stack, token, stackLength, STACK_SIZE);
-	}
-}
-
-void inputToRPN() {
-	// Converts infix input to array of postfix tokens
-
-	unsigned int stack[STACK_SIZE] = { 0 }; int stackLength = 0;
-	int outputLength = 0;
-	unsigned int token = 0;
-	int keywordState = KWS_READY;
-	int indentCnt = 0;
-	int evalVarHead = EVAL_VARS_START;
-
-	bool implicitMultiplication = false;
-	// Whether or not the next token has the ability to be implicitly multiplied, such as with parentheses: 3(5) = 15
-
-	bool unaryNegation = true;
-	// Whether the next '-' encountered should be interpreted as negation (true) or subtraction (false)
-
-	int index = 0;
-
-	// Count indentation
-	while (index < INPUT_SIZE && terminalInput[index] == '\t') {
-		indentCnt++;
-		index++;
-	}
-
-	while (index < INPUT_SIZE) {
-		if (terminalInput[index] == '\n') {
-			// If end of input has been reached
-			break;
-		}
-		token = tokenize(&index, &evalVarHead, unaryNegation, &keywordState);
-		if (error != NO_ERROR) return;
-		if (token == OP_NULL) continue;
-
-		else if (token == ARG_SEPARATOR) {
-			// Comma that separates function arguments.  Operators are popped until left parentheses encountered
-			while (stack[stackLength - 1] != LEFT_PARENTH && !stackIsEmpty(stack)) {
-				push(expressionRPN, pop(stack, &stackLength), &outputLength, RPN_SIZE);
-				if (error != 0) return;
-			}
-			unaryNegation = true;
-			implicitMultiplication = false;
-		}
-		else if (token == OP_NEG || token == OP_NOT) {
-			// Negation may be applied to number to its right directly after an operator, so cannot pop any operators from stack
-			push(stack, token, &stackLength, STACK_SIZE);
-		}
-		else if (isFunction(token)) {
-			if (implicitMultiplication) {
-				pushOperator(OP_MUL, stack, &stackLength, &outputLength);
-			}
-			push(stack, token, &stackLength, STACK_SIZE);
-			implicitMultiplication = false;
-			unaryNegation = true;
-		}
-		else if (isOperator(token)) {
-			// Non-function operators
-			pushOperator(token, stack, &stackLength, &outputLength);
-			implicitMultiplication = false;
-			unaryNegation = true;
-		}
-		else if (token == LEFT_PARENTH) {
-			if (implicitMultiplication) {
-				pushOperator(OP_MUL, stack, &stackLength, &outputLength);
-			}
-			push(stack, LEFT_PARENTH, &stackLength, STACK_SIZE);
-			implicitMultiplication = false;
-			unaryNegation = true;
-		}
-		else if (token == RIGHT_PARENTH) {
-			// Pop operators until left parentheses encountered, then pop the left parenthesis
-			if (!stackIsEmpty(stack)) {
-				while (stack[stackLength - 1] != LEFT_PARENTH && !stackIsEmpty(stack)) {
-					push(expressionRPN, pop(stack, &stackLength), &outputLength, RPN_SIZE);
-					if (error != NO_ERROR) return;
-				}
-				pop(stack, &stackLength);
-			}
-		}
-		else {
-			// If token is a variable
-			if (implicitMultiplication) {
-				pushOperator(OP_MUL, stack, &stackLength, &outputLength);
-			}
-			push(expressionRPN, token, &outputLength, RPN_SIZE);
-			implicitMultiplication = true;
-			unaryNegation = false;
-		}
-	}
-
-	while (!(stack[0] == 0)) {
-		// Push all remaining operators from stack
-		push(expressionRPN, pop(stack, &stackLength), &outputLength, RPN_SIZE);
-		if (error != NO_ERROR) return;
-	}
-}
-
-// Given input in RPN format and a list of variable values, performs the actual calculations of the program 
-// in the given order and returns the final result
-double evaluateRPN() {
-
-	// ============= TEST =============
-
-	unsigned int stack[STACK_SIZE] = { 0 }; int stackLength = 0;
-	int valueIndexLeft = 0; int valueIndexRight = 0;
-	unsigned int operand = 0;
-	bool binary;
-
-	for (int indexRPN = 0; indexRPN < RPN_SIZE; indexRPN++) {
-		if (expressionRPN[indexRPN] == 0) {
-			break;
-		}
-		binary = false;
-
-		// If current input is variable or there is no operator on the stack, the input is pushed
-		if (expressionRPN[indexRPN] < OPERATOR_START || stackIsEmpty(stack) || (stack[stackLength - 1] > OPERATOR_START && stack[stackLength - 1] < END_FUNCS)) {
-			push(stack, expressionRPN[indexRPN], &stackLength, STACK_SIZE);
-			if (error != NO_ERROR) return 0.0;
-		}
-		// Otherwise, the operation atop the stack is executed using the variables directly below it; lower variable recieves the result
-		else {
-			push(stack, expressionRPN[indexRPN], &stackLength, STACK_SIZE);
-			if (error != NO_ERROR) return 0.0;
-			if (stackLength >= 2) {
-				operand = stack[stackLength - 1];
-				valueIndexRight = stack[stackLength - 2];
-				if (isBinaryOperator(operand)) {
-					// Binary operators will act on two values
-					// TODO: Change to a loop to support functions of any number of variables
-					if (stackLength >= 3) {
-						valueIndexLeft = stack[stackLength - 3];
-						binary = true;
-					}
-					else {
-						error = ERR_SYNTAX;
-						return 0.0;
-					}
-				}
-				switch (operand) {
-				case OP_ADD:
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] + variableMap[valueIndexRight];
-					break;
-				case OP_SUB:
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] - variableMap[valueIndexRight];
-					break;
-				case OP_NEG:
-					variableMap[valueIndexRight] = -(variableMap[valueIndexRight]);
-					break;
-				case OP_MUL:
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] * variableMap[valueIndexRight];
-					break;
-				case OP_DIV:
-					if (variableMap[valueIndexRight] == 0.0) {
-						error = ERR_UNDEFINED;
-						return 0.0;
-					}
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] / variableMap[valueIndexRight];
-					break;
-				case OP_EXP:
-					variableMap[valueIndexLeft] = pow(variableMap[valueIndexLeft], variableMap[valueIndexRight]);
-					break;
-				case OP_DIV_INT:
-					variableMap[valueIndexLeft] = (double)(doubleToInt(variableMap[valueIndexLeft])
-						/ doubleToInt(variableMap[valueIndexRight]));
-					break;
-				case OP_MOD:
-					if (doubleToInt(variableMap[valueIndexRight]) == 0) {
-						error = ERR_UNDEFINED;
-						return 0.0;
-					}
-					else
-						variableMap[valueIndexLeft] = (double)(doubleToInt(variableMap[valueIndexLeft])
-							% doubleToInt(variableMap[valueIndexRight]));
-					break;
-				case OP_GCD:
-					variableMap[valueIndexLeft] = gcd(variableMap[valueIndexRight], variableMap[valueIndexLeft]);
-					break;
-				case OP_LCM:
-					variableMap[valueIndexLeft] = (variableMap[valueIndexRight] /
-						gcd(variableMap[valueIndexRight], variableMap[valueIndexLeft])) *
-						variableMap[valueIndexLeft];
-					break;
-				case OP_CEIL:
-					variableMap[valueIndexRight] = ceil(variableMap[valueIndexRight]);
-					break;
-				case OP_FLOOR:
-					variableMap[valueIndexRight] = floor(variableMap[valueIndexRight]);
-					break;
-				case OP_ROUND:
-					variableMap[valueIndexRight] = round(variableMap[valueIndexRight]);
-					break;
-				case OP_TRUNC:
-					variableMap[valueIndexRight] = trunc(variableMap[valueIndexRight]);
-					break;
-				case OP_SIGN:
-					if (variableMap[valueIndexRight] >= 0.0)
-						variableMap[valueIndexRight] = 1.0;
-					else
-						variableMap[valueIndexRight] = -1.0;
-					break;
-				case OP_ABS:
-					variableMap[valueIndexRight] = fabs(variableMap[valueIndexRight]);
-					break;
-				case OP_LOG:
-					variableMap[valueIndexLeft] = log10(variableMap[valueIndexRight]) / log10(variableMap[valueIndexLeft]);
-					break;
-				case OP_LN:
-					variableMap[valueIndexRight] = log(variableMap[valueIndexRight]);
-					break;
-				case OP_LOG10:
-					variableMap[valueIndexRight] = log10(variableMap[valueIndexRight]);
-					break;
-				case OP_ROOT:
-					variableMap[valueIndexLeft] = pow(variableMap[valueIndexRight], (1 / variableMap[valueIndexLeft]));
-					break;
-				case OP_SQRT:
-					variableMap[valueIndexRight] = sqrt(variableMap[valueIndexRight]);
-					break;
-				case OP_CBRT:
-					variableMap[valueIndexRight] = cbrt(variableMap[valueIndexRight]);
-					break;
-				case OP_HYPOT:
-					variableMap[valueIndexLeft] = hypot(variableMap[valueIndexLeft], variableMap[valueIndexRight]);
-					break;
-				case OP_SIN:
-					variableMap[valueIndexRight] = sin(variableMap[valueIndexRight]);
-					break;
-				case OP_COS:
-					variableMap[valueIndexRight] = cos(variableMap[valueIndexRight]);
-					break;
-				case OP_TAN:
-					variableMap[valueIndexRight] = tan(variableMap[valueIndexRight]);
-					break;
-				case OP_SEC:
-					variableMap[valueIndexRight] = 1 / cos(variableMap[valueIndexRight]);
-					break;
-				case OP_CSC:
-					variableMap[valueIndexRight] = 1 / sin(variableMap[valueIndexRight]);
-					break;
-				case OP_COT:
-					variableMap[valueIndexRight] = 1 / tan(variableMap[valueIndexRight]);
-					break;
-				case OP_ASIN:
-					variableMap[valueIndexRight] = asin(variableMap[valueIndexRight]);
-					break;
-				case OP_ACOS:
-					variableMap[valueIndexRight] = acos(variableMap[valueIndexRight]);
-					break;
-				case OP_ATAN:
-					variableMap[valueIndexRight] = atan(variableMap[valueIndexRight]);
-					break;
-				case OP_ASEC:
-					variableMap[valueIndexRight] = acos(1 / (variableMap[valueIndexRight]));
-					break;
-				case OP_ACSC:
-					variableMap[valueIndexRight] = asin(1 / (variableMap[valueIndexRight]));
-					break;
-				case OP_ACOT:
-					if (variableMap[valueIndexRight] > 0) {
-						variableMap[valueIndexRight] = atan(1 / variableMap[valueIndexRight]);
-					}
-					else if (variableMap[valueIndexRight] < 0) {
-						variableMap[valueIndexRight] = atan(1 / variableMap[valueIndexRight]) + pi;
-					}
-					else variableMap[valueIndexRight] = pi / 2;
-					break;
-				case OP_SINH:
-					variableMap[valueIndexRight] = sinh(variableMap[valueIndexRight]);
-					break;
-				case OP_COSH:
-					variableMap[valueIndexRight] = cosh(variableMap[valueIndexRight]);
-					break;
-				case OP_TANH:
-					variableMap[valueIndexRight] = tanh(variableMap[valueIndexRight]);
-					break;
-				case OP_SECH:
-					variableMap[valueIndexRight] = 1 / cosh(variableMap[valueIndexRight]);
-					break;
-				case OP_CSCH:
-					variableMap[valueIndexRight] = 1 / sinh(variableMap[valueIndexRight]);
-					break;
-				case OP_COTH:
-					variableMap[valueIndexRight] = 1 / tanh(variableMap[valueIndexRight]);
-					break;
-				case OP_ASINH:
-					variableMap[valueIndexRight] = asinh(variableMap[valueIndexRight]);
-					break;
-				case OP_ACOSH:
-					variableMap[valueIndexRight] = acosh(variableMap[valueIndexRight]);
-					break;
-				case OP_ATANH:
-					variableMap[valueIndexRight] = atanh(variableMap[valueIndexRight]);
-					break;
-				case OP_ASECH:
-					variableMap[valueIndexRight] = acosh(1 / (variableMap[valueIndexRight]));
-					break;
-				case OP_ACSCH:
-					variableMap[valueIndexRight] = asinh(1 / (variableMap[valueIndexRight]));
-					break;
-				case OP_ACOTH:
-					variableMap[valueIndexRight] = atanh(1 / (variableMap[valueIndexRight]));
-					break;
-				case OP_ATAN2:
-					variableMap[valueIndexLeft] = atan2(variableMap[valueIndexLeft], variableMap[valueIndexRight]);
-					break;
-				case OP_SINC:
-					if (variableMap[valueIndexRight] == 0.0) variableMap[valueIndexRight] = 1.0;
-					else variableMap[valueIndexRight] = sin(variableMap[valueIndexRight]) / variableMap[valueIndexRight];
-					break;
-				case OP_NSINC:
-					if (variableMap[valueIndexRight] == 0.0) variableMap[valueIndexRight] = 1.0;
-					else variableMap[valueIndexRight] = sin(pi * variableMap[valueIndexRight])
-						/ (pi * variableMap[valueIndexRight]);
-					break;
-				case OP_ERF:
-					variableMap[valueIndexRight] = erf(variableMap[valueIndexRight]);
-					break;
-				case OP_ERFC:
-					variableMap[valueIndexRight] = erfc(variableMap[valueIndexRight]);
-					break;
-				case OP_GAMMA:
-					variableMap[valueIndexRight] = tgamma(variableMap[valueIndexRight]);
-					break;
-				case OP_LGAMMA:
-					variableMap[valueIndexRight] = lgamma(variableMap[valueIndexRight]);
-					break;
-				case OP_REQLL:
-					variableMap[valueIndexLeft] = (variableMap[valueIndexLeft] * variableMap[valueIndexRight])
-						/ (variableMap[valueIndexLeft] + variableMap[valueIndexRight]);
-					break;
-				case OP_PERR:
-					variableMap[valueIndexLeft] = 100 * (fabs(variableMap[valueIndexLeft] -
-						variableMap[valueIndexRight]) / variableMap[valueIndexRight]);
-					break;
-				case OP_DEG:
-					variableMap[valueIndexRight] *= RAD_TO_DEG_CONST;
-					break;
-				case OP_RAD:
-					variableMap[valueIndexRight] *= DEG_TO_RAD_CONST;
-					break;
-				case OP_LOG2:
-					variableMap[valueIndexRight] = log2(variableMap[valueIndexRight]);
-					break;
-				case OP_IS:
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] == variableMap[valueIndexRight];
-					break;
-				case OP_GREATER_THAN:
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] > variableMap[valueIndexRight];
-					break;
-				case OP_GREATER_THAN_EQUAL_TO:
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] >= variableMap[valueIndexRight];
-					break;
-				case OP_LESS_THAN:
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] < variableMap[valueIndexRight];
-					break;
-				case OP_LESS_THAN_EQUAL_TO:
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] <= variableMap[valueIndexRight];
-					break;
-				case OP_AND:
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] && variableMap[valueIndexRight];
-					break;
-				case OP_OR:
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] || variableMap[valueIndexRight];
-					break;
-				case OP_NOT:
-					variableMap[valueIndexRight] = !(variableMap[valueIndexRight]);
-					break;
-				case OP_XOR:
-					variableMap[valueIndexLeft] = !(variableMap[valueIndexLeft]) != !(variableMap[valueIndexRight]);
-					break;
-				case OP_IMPLIES:
-					variableMap[valueIndexLeft] = !(variableMap[valueIndexLeft]) || variableMap[valueIndexRight];
-					break;
-				case OP_IFF:
-					variableMap[valueIndexLeft] = !(variableMap[valueIndexLeft]) == !(variableMap[valueIndexRight]);
-					break;
-				case OP_IMPLIED_BY:
-					variableMap[valueIndexLeft] = variableMap[valueIndexLeft] && !variableMap[valueIndexRight];
-					break;
-				default:
-					error = ERR_SYNTAX;
-					return 0.0;
-				}
-
-				pop(stack, &stackLength);
-				if (binary) {
-					pop(stack, &stackLength);
-				}
-			}
-			else {
-				error = ERR_SYNTAX;
-				return 0.0;
-			}
-		}
-	}
-
-	if ((stack[0] > OP_NULL && stack[0] < END_FUNCS) || stack[1] != 0) {
-		// If a function is left on the stack, there were too many operators
-		// If there is more than one thing left on the stack, an error occurred (most likely a misplaced argument separator)
-		error = ERR_SYNTAX;
-	}
-	if (isnan(variableMap[0]) || isinf(variableMap[0])) {
-		error = ERR_UNDEFINED;
-	}
-	return variableMap[EVAL_VARS_START];
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "tokenize.h"
+#include "rpn.h"
+#include "compile.h"
+#include "execute.h"
+#include "profile.h"
+#include "random.h"
+#include "global.h"
+
+// The operator stack and the output grow as needed, and are kept from line to line
+static unsigned int* stack;      // Operators waiting for their operands, ended by 0
+static int* argCount;            // Arguments of the call each left parenthesis on the stack opened, 0 for grouping
+static int stackCapacity;
+static int argCapacity;
+static int outputCapacity;
+static int argsCapacity;
+
+static void pushStack(unsigned int token, int* stackLength) {
+	// Pushes a token on the operator stack, which stays ended by 0
+	if (!growBuffer(&stack, &stackCapacity, *stackLength + 2, sizeof(unsigned int))
+		|| !growBuffer(&argCount, &argCapacity, *stackLength + 2, sizeof(int))) {
+		error = ERR_OVERFLOW;
+		return;
+	}
+	stack[*stackLength] = token;
+	argCount[*stackLength] = 0;
+	(*stackLength)++;
+	stack[*stackLength] = 0;
+}
+
+static void pushOutput(unsigned int token, int* outputLength) {
+	// Appends a token to expressionRPN, which stays ended by 0
+	if (!growBuffer(&expressionRPN, &outputCapacity, *outputLength + 2, sizeof(unsigned int))
+		|| !growBuffer(&expressionArgs, &argsCapacity, *outputLength + 2, sizeof(int))) {
+		error = ERR_OVERFLOW;
+		return;
+	}
+	expressionRPN[*outputLength] = token;
+	expressionArgs[*outputLength] = 0;
+	(*outputLength)++;
+	expressionRPN[*outputLength] = 0;
+	expressionArgs[*outputLength] = 0;
+}
+
+// Pushes given token and some tokens on stack to the output such that output is in postfix
+static void pushOperator(unsigned int token, int* stackLength, int* outputLength) {
+
+	int topOfStack = 0;
+
+	int precedence[27] = {
+		0,  // NULL	
+		10, // ADD
+		10, // SUB
+		11, // MUL
+		11, // DIV
+		11, // MOD
+		12, // NEG
+		8,  // IS
+		8,  // GREATER_THAN 
+		8,  // LESS_THAN 
+		8,  // GREATER_THAN_OR_EQUAL_TO 
+		8,  // LESS_THAN_OR_EQUAL_TO
+		4,  // AND
+		2,  // OR
+		12, // NOT 
+		3,  // XOR
+		1,  // IMPLIES
+		1,  // IFF 
+		1,  // IMPLIED BY
+		9,  // LEFT SHIFT
+		9,  // RIGHT SHIFT
+		4,  // BITWISE AND
+		5,  // BITWISE OR
+		12, // BITWISE NOT
+		6,  // BITWISE XOR
+		11, // MATMUL
+		14, // EXP
+	};
+
+	int stackPrecedence = 0; int tokenPrecedence = 0;
+
+	if (stackIsEmpty(stack)) {
+		pushStack(token, stackLength);
+		if (error != NO_ERROR) return;
+	}
+	else {
+		// Push all higher precedence tokens from stack to output, then push current token to stack
+		while (!stackIsEmpty(stack)) {
+			topOfStack = stack[*stackLength - 1];
+			if (topOfStack < END_FUNCS) {
+				if (topOfStack < END_OPS) {
+					// Operations.  Are offset because operators start at OP_NULL
+					stackPrecedence = precedence[topOfStack - OP_NULL];
+					tokenPrecedence = precedence[token - OP_NULL];
+
+					if ((token != OP_EXP && tokenPrecedence <= stackPrecedence)
+						|| (token == OP_EXP && tokenPrecedence < stackPrecedence)) {
+						pushOutput(pop(stack, stackLength), outputLength);
+						if (error != NO_ERROR) return;
+					}
+					else break;
+				}
+				else {
+					// Functions, being in prefix rather than infix notation, are simply pushed
+					pushOutput(pop(stack, stackLength), outputLength);
+					if (error != NO_ERROR) return;
+				}
+			}
+			else {
+				// Neither operators nor functions (parentheses, etc)
+				break;
+			}
+		}
+		pushStack(token, stackLength);
+	}
+}
+
+void inputToRPN() {
+	// Converts infix input to array of postfix tokens
+
+	int stackLength = 0;
+	int outputLength = 0;
+	unsigned int token = 0;
+	int keywordState = KWS_READY;
+	int indentCnt = 0;
+	unsigned int previousToken = OP_NULL;
+	int callArgs = 0;
+	bool isCall = false;
+
+	bool implicitMultiplication = false;
+	// Whether or not the next token has the ability to be implicitly multiplied, such as with parentheses: 3(5) = 15
+
+	bool unaryNegation = true;
+	// Whether the next '-' encountered should be interpreted as negation (true) or subtraction (false)
+
+	int index = 0;
+	int nrLexemes = 0;
+
+	clearOperands();
+	pushStack(0, &stackLength);
+	pushOutput(0, &outputLength);
+	if (error != NO_ERROR) return;
+	stackLength = 0;
+	outputLength = 0;
+	stack[0] = 0;
+	expressionRPN[0] = 0;
+
+	// Count indentation
+	while (terminalInput[index] == '\t') {
+		indentCnt++;
+		index++;
+	}
+
+	// The rest of the line is split into lexemes, which are then read one at a time
+	nrLexemes = lexInput(index);
+	if (nrLexemes < 0) {
+		error = ERR_OVERFLOW;
+		return;
+	}
+	index = 0;
+
+	while (index < nrLexemes) {
+		token = tokenize(&index, unaryNegation, &keywordState);
+		if (error != NO_ERROR) return;
+		if (token == OP_NULL) continue;
+
+		else if (token == ARG_SEPARATOR) {
+			// Comma that separates function arguments.  Operators are popped until left parentheses encountered
+			while (!stackIsEmpty(stack) && stack[stackLength - 1] != LEFT_PARENTH && stack[stackLength - 1] != LEFT_BRACKET) {
+				pushOutput(pop(stack, &stackLength), &outputLength);
+				if (error != 0) return;
+			}
+			// A comma outside of any parentheses or brackets separates nothing
+			if (stackIsEmpty(stack)) {
+				error = ERR_SYNTAX;
+				return;
+			}
+			if (argCount[stackLength - 1] > 0) {
+				argCount[stackLength - 1]++;
+			}
+			unaryNegation = true;
+			implicitMultiplication = false;
+		}
+		else if (token == OP_NEG || token == OP_NOT || token == OP_BITWISE_NOT) {
+			// Negation may be applied to number to its right directly after an operator, so cannot pop any operators from stack
+			pushStack(token, &stackLength);
+		}
+		else if (token == KW_DEL) {
+			// "del name" deletes a variable.  Like assignment, it applies to the rest of the line
+			if (outputLength > 0 || !stackIsEmpty(stack)) {
+				error = ERR_SYNTAX;
+				return;
+			}
+			pushStack(token, &stackLength);
+			unaryNegation = true;
+		}
+		else if (token == INST_ASSIGN_VAL || token == INST_DEFINE) {
+			// Assignment, and the definition of a formula, have the lowest precedence, so they stay at the bottom of the
+			// stack until the end of the line
+			pushStack(token, &stackLength);
+			implicitMultiplication = false;
+			unaryNegation = true;
+		}
+		else if (isFunction(token)) {
+			if (implicitMultiplication) {
+				pushOperator(OP_MUL, &stackLength, &outputLength);
+			}
+			pushStack(token, &stackLength);
+			implicitMultiplication = false;
+			unaryNegation = true;
+		}
+		else if (isOperator(token)) {
+			// Non-function operators
+			pushOperator(token, &stackLength, &outputLength);
+			implicitMultiplication = false;
+			unaryNegation = true;
+		}
+		else if (token == LEFT_PARENTH) {
+			if (implicitMultiplication) {
+				pushOperator(OP_MUL, &stackLength, &outputLength);
+			}
+			// A parenthesis directly after a function name opens its argument list
+			isCall = isFunction(previousToken) && !stackIsEmpty(stack) && stack[stackLength - 1] == previousToken;
+			pushStack(LEFT_PARENTH, &stackLength);
+			if (error != NO_ERROR) return;
+			argCount[stackLength - 1] = isCall ? 1 : 0;
+			implicitMultiplication = false;
+			unaryNegation = true;
+		}
+		else if (token == RIGHT_PARENTH) {
+			// Pop operators until left parentheses encountered, then pop the left parenthesis.  A parenthesis that closes
+			// nothing, or encloses nothing, is an error
+			if (previousToken == LEFT_PARENTH) {
+				error = ERR_SYNTAX;
+				return;
+			}
+			while (!stackIsEmpty(stack) && stack[stackLength - 1] != LEFT_PARENTH) {
+				if (stack[stackLength - 1] == LEFT_BRACKET) {
+					error = ERR_SYNTAX;
+					return;
+				}
+				pushOutput(pop(stack, &stackLength), &outputLength);
+				if (error != NO_ERROR) return;
+			}
+			if (stackIsEmpty(stack)) {
+				error = ERR_SYNTAX;
+				return;
+			}
+			callArgs = argCount[stackLength - 1];
+			pop(stack, &stackLength);
+
+			// The argument list of a call is complete, so the function goes to the output along with its argument count
+			if (callArgs > 0) {
+				pushOutput(pop(stack, &stackLength), &outputLength);
+				if (error != NO_ERROR) return;
+				expressionArgs[outputLength - 1] = callArgs;
+			}
+		}
+		else if (token == LEFT_BRACKET) {
+			// An array literal [a, b, ...] is read as a call of OP_ARRAY with the values as its arguments.  Brackets
+			// directly after a value are kept for indexing, rather than being multiplied
+			if (implicitMultiplication) {
+				error = ERR_SYNTAX;
+				return;
+			}
+			pushStack(OP_ARRAY, &stackLength);
+			pushStack(LEFT_BRACKET, &stackLength);
+			if (error != NO_ERROR) return;
+			argCount[stackLength - 1] = 1;
+			unaryNegation = true;
+		}
+		else if (token == RIGHT_BRACKET) {
+			while (!stackIsEmpty(stack) && stack[stackLength - 1] != LEFT_BRACKET) {
+				if (stack[stackLength - 1] == LEFT_PARENTH) break;
+				pushOutput(pop(stack, &stackLength), &outputLength);
+				if (error != NO_ERROR) return;
+			}
+			if (stackIsEmpty(stack) || stack[stackLength - 1] != LEFT_BRACKET || previousToken == LEFT_BRACKET) {
+				error = ERR_SYNTAX;
+				return;
+			}
+			callArgs = argCount[stackLength - 1];
+			pop(stack, &stackLength);
+			pushOutput(pop(stack, &stackLength), &outputLength);
+			if (error != NO_ERROR) return;
+			expressionArgs[outputLength - 1] = callArgs;
+		}
+		else {
+			// If token is a variable
+			if (implicitMultiplication) {
+				pushOperator(OP_MUL, &stackLength, &outputLength);
+			}
+			pushOutput(token, &outputLength);
+			implicitMultiplication = true;
+			unaryNegation = false;
+		}
+		previousToken = token;
+	}
+
+	while (!(stack[0] == 0)) {
+		// Push all remaining operators from stack
+		pushOutput(pop(stack, &stackLength), &outputLength);
+		if (error != NO_ERROR) return;
+	}
+}
+
+// Compiles the expression in expressionRPN into a single statement and runs it, printing and returning the result
+double evaluateRPN() {
+
+	static program lineProgram;  // Reused between lines so that its buffers are only allocated once
+
+	clearProgram(&lineProgram);
+	enterStage(STAGE_COMPILE);
+	compileLine(&lineProgram, 0, PRINT_RESULTS | PRINT_ASSIGNMENTS);
+	leaveStage();
+	if (error != NO_ERROR) return 0.0;
+
+	return runProgram(&lineProgram);
+}
+
+static bool isWhole(double value) {
+	// Returns true for integral values that fit in 64 bits, which bitwise operators can act on
+	return value == trunc(value) && value >= -9223372036854775808.0 && value < 9223372036854775808.0;
+}
+
+static double choose(double n, double k, bool ordered) {
+	// nCr, or nPr if ordered, of whole numbers.  Found as a product while it has few factors, which is exact as long as
+	// it fits in 53 bits, and otherwise from the logarithms of the factorials
+	double result = 1.0;
+
+	if (!isWhole(n) || !isWhole(k) || n < 0 || k < 0) return NAN;
+	if (k > n) return 0.0;
+	if (!ordered && k > n - k) k = n - k;
+	if (k > 1000) {
+		return round(exp(lgamma(n + 1) - lgamma(n - k + 1) - (ordered ? 0.0 : lgamma(k + 1))));
+	}
+	for (double i = 1; i <= k && !isinf(result); i++) {
+		result = ordered ? result * (n - k + i) : result * (n - k + i) / i;
+	}
+	return ordered ? result : round(result);
+}
+
+static double factorial(double value) {
+	// n! of whole numbers is a product, exact while it fits in 53 bits, and the gamma function for others
+	double result = 1.0;
+
+	if (!isWhole(value)) return (value < 0 && value == floor(value)) ? NAN : tgamma(value + 1);
+	if (value < 0) return NAN;
+	for (double i = 2; i <= value && !isinf(result); i++) {
+		result *= i;
+	}
+	return result;
+}
+
+// Performs a two-input operation or function.  Results that are undefined are returned as NaN
+double applyBinaryOperator(unsigned int operand, double left, double right) {
+
+	switch (operand) {
+	case OP_ADD:
+		return left + right;
+	case OP_SUB:
+		return left - right;
+	case OP_MUL:
+		return left * right;
+	case OP_DIV:
+		if (right == 0.0) return NAN;
+		return left / right;
+	case OP_EXP:
+		return pow(left, right);
+	case OP_DIV_INT:
+		// Whole numbers past 64 bits give NaN, and so does dividing by zero.  LLONG_MIN / -1 is 2^63, which is a double
+		if (!fitsInteger(left) || !fitsInteger(right) || doubleToInt(right) == 0) return NAN;
+		if (doubleToInt(right) == -1) return 0.0 - (double)doubleToInt(left);
+		return (double)(doubleToInt(left) / doubleToInt(right));
+	case OP_MOD:
+		if (!fitsInteger(left) || !fitsInteger(right) || doubleToInt(right) == 0) return NAN;
+		if (doubleToInt(right) == -1) return 0.0;
+		return (double)(doubleToInt(left) % doubleToInt(right));
+	case OP_GCD:
+		return gcd(right, left);
+	case OP_LCM:
+		return (right / gcd(right, left)) * left;
+	case OP_NCR:
+		return choose(left, right, false);
+	case OP_NPR:
+		return choose(left, right, true);
+	case OP_LOG:
+		return log10(right) / log10(left);
+	case OP_ROOT:
+		return pow(right, (1 / left));
+	case OP_HYPOT:
+		return hypot(left, right);
+	case OP_ATAN2:
+		return atan2(left, right);
+	case OP_REQLL:
+		return (left * right) / (left + right);
+	case OP_PERR:
+		return 100 * (fabs(left - right) / right);
+	case OP_UNIFORM:
+	case OP_NORMAL:
+	case OP_LOGNORMAL:
+		return drawValue(operand, left, right);
+	case OP_IS:
+		return left == right;
+	case OP_GREATER_THAN:
+		return left > right;
+	case OP_GREATER_THAN_EQUAL_TO:
+		return left >= right;
+	case OP_LESS_THAN:
+		return left < right;
+	case OP_LESS_THAN_EQUAL_TO:
+		return left <= right;
+	case OP_AND:
+		return left && right;
+	case OP_OR:
+		return left || right;
+	case OP_XOR:
+		return !(left) != !(right);
+	case OP_IMPLIES:
+		return !(left) || right;
+	case OP_IFF:
+		return !(left) == !(right);
+	case OP_IMPLIED_BY:
+		return left && !right;
+	case OP_LEFT_SHIFT:
+		// Shifts of whole numbers multiply or divide by powers of 2, rounding down
+		if (!isWhole(left) || !isWhole(right) || right < 0) return NAN;
+		return ldexp(left, (right > 4096) ? 4096 : (int)right);
+	case OP_RIGHT_SHIFT:
+		if (!isWhole(left) || !isWhole(right) || right < 0) return NAN;
+		return floor(ldexp(left, (right > 4096) ? -4096 : -(int)right));
+	case OP_BITWISE_AND:
+		if (!isWhole(left) || !isWhole(right)) return NAN;
+		return (double)((long long int)left & (long long int)right);
+	case OP_BITWISE_OR:
+		if (!isWhole(left) || !isWhole(right)) return NAN;
+		return (double)((long long int)left | (long long int)right);
+	case OP_BITWISE_XOR:
+		if (!isWhole(left) || !isWhole(right)) return NAN;
+		return (double)((long long int)left ^ (long long int)right);
+	default:
+		error = ERR_SYNTAX;
+		return 0.0;
+	}
+}
+
+// Performs a single-input operation or function.  Results that are undefined are returned as NaN
+double applyUnaryOperator(unsigned int operand, double value) {
+
+	switch (operand) {
+	case OP_NEG:
+		return -(value);
+	case OP_NOT:
+		return !(value);
+	case OP_BITWISE_NOT:
+		if (!isWhole(value)) return NAN;
+		return (double)~(long long int)value;
+	case OP_CEIL:
+		return ceil(value);
+	case OP_FLOOR:
+		return floor(value);
+	case OP_ROUND:
+		return round(value);
+	case OP_TRUNC:
+		return trunc(value);
+	case OP_SIGN:
+		return (value >= 0.0) ? 1.0 : -1.0;
+	case OP_ABS:
+		return fabs(value);
+	case OP_FACTORIAL:
+		return factorial(value);
+	case OP_LN:
+		return log(value);
+	case OP_LOG10:
+		return log10(value);
+	case OP_LOG2:
+		return log2(value);
+	case OP_SQRT:
+		return sqrt(value);
+	case OP_CBRT:
+		return cbrt(value);
+	case OP_SIN:
+		return sin(value);
+	case OP_COS:
+		return cos(value);
+	case OP_TAN:
+		return tan(value);
+	case OP_SEC:
+		return 1 / cos(value);
+	case OP_CSC:
+		return 1 / sin(value);
+	case OP_COT:
+		return 1 / tan(value);
+	case OP_ASIN:
+		return asin(value);
+	case OP_ACOS:
+		return acos(value);
+	case OP_ATAN:
+		return atan(value);
+	case OP_ASEC:
+		return acos(1 / (value));
+	case OP_ACSC:
+		return asin(1 / (value));
+	case OP_ACOT:
+		if (value > 0) return atan(1 / value);
+		else if (value < 0) return atan(1 / value) + pi;
+		else return pi / 2;
+	case OP_SINH:
+		return sinh(value);
+	case OP_COSH:
+		return cosh(value);
+	case OP_TANH:
+		return tanh(value);
+	case OP_SECH:
+		return 1 / cosh(value);
+	case OP_CSCH:
+		return 1 / sinh(value);
+	case OP_COTH:
+		return 1 / tanh(value);
+	case OP_ASINH:
+		return asinh(value);
+	case OP_ACOSH:
+		return acosh(value);
+	case OP_ATANH:
+		return atanh(value);
+	case OP_ASECH:
+		return acosh(1 / (value));
+	case OP_ACSCH:
+		return asinh(1 / (value));
+	case OP_ACOTH:
+		return atanh(1 / (value));
+	case OP_SINC:
+		if (value == 0.0) return 1.0;
+		return sin(value) / value;
+	case OP_NSINC:
+		if (value == 0.0) return 1.0;
+		return sin(pi * value) / (pi * value);
+	case OP_ERF:
+		return erf(value);
+	case OP_ERFC:
+		return erfc(value);
+	case OP_GAMMA:
+		return tgamma(value);
+	case OP_LGAMMA:
+		return lgamma(value);
+	case OP_DEG:
+		return value * RAD_TO_DEG_CONST;
+	case OP_RAD:
+		return value * DEG_TO_RAD_CONST;
+	default:
+		error = ERR_SYNTAX;
+		return 0.0;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "rpn.h"
+#include "compile.h"
+#include "execute.h"
+#include "script.h"
+#include "profile.h"
+#include "global.h"
+
+static bool isBlankLine() {
+	// Returns true if the line in terminalInput is empty or a comment starting with '#'
+	for (int i = 0; terminalInput[i] != '\0'; i++) {
+		if (terminalInput[i] == '#' || terminalInput[i] == '\n' || terminalInput[i] == '\r') return true;
+		if (terminalInput[i] != ' ' && terminalInput[i] != '\t') return false;
+	}
+	return true;
+}
+
+// Compiles every line of a file into one program, and runs it only if all lines compiled.  Lines that are expressions
+// print their result, lines that are assignments define or update variables.  Returns the program's exit status
+int runScript(char filename[]) {
+
+	FILE* file = fopen(filename, "r");
+	program script;
+	int lineNumber = 0;
+	int nrErrors = 0;
+	int length = 0;
+	double printVal = 0.0;
+
+	if (file == NULL) {
+		printf("  Could not load %s\n", filename);
+		return 1;
+	}
+	initProgram(&script);
+
+	while (readLine(file)) {
+		lineNumber++;
+
+		length = 0;
+		while (terminalInput[length] != '\0') length++;
+		if (length > 1 && terminalInput[length - 2] == '\r') {
+			// Windows line ending
+			terminalInput[length - 2] = '\n';
+			terminalInput[length - 1] = '\0';
+		}
+
+		if (error == NO_ERROR && !isBlankLine()) {
+			enterStage(STAGE_PARSE);
+			inputToRPN();
+			leaveStage();
+			if (error == NO_ERROR) {
+				enterStage(STAGE_COMPILE);
+				compileLine(&script, lineNumber, PRINT_RESULTS);
+				leaveStage();
+			}
+		}
+		if (error != NO_ERROR) {
+			printf("  Line %d:", lineNumber);
+			printError();
+			nrErrors++;
+		}
+		resetValues(&printVal);
+	}
+	fclose(file);
+
+	if (nrErrors == 0) {
+		runProgram(&script);
+		if (error != NO_ERROR) {
+			printf("  Line %d:", errorLine);
+			printError();
+			nrErrors++;
+		}
+	}
+
+	freeProgram(&script);
+	return (nrErrors == 0) ? 0 : 1;
+}
\ No newline at end of file
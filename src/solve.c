@@ -0,0 +1,388 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <float.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "compile.h"
+#include "execute.h"
+#include "parallel.h"
+#include "solve.h"
+#include "global.h"
+
+#define MAX_SOLVE_ITERATIONS 1000
+#define GOLDEN_SECTION 0.3819660112501051518  // (3 - sqrt(5)) / 2
+
+// Brent's methods are written as state machines that are given one function value at a time and answer with the next
+// point to evaluate, so that a batch of independent searches can share each evaluation pass
+
+typedef struct {
+	double a, b, c;        // Roots: b is the best estimate, [b, c] brackets the root.  Minima: bracket [a, b]
+	double fa, fb, fc;
+	double d, e;           // Last and second to last steps
+	double x, w, v, u;     // Minima: best, second best and previous second best points, and the point being evaluated
+	double fx, fw, fv;
+	double low, high;      // Original bracket
+	double result;
+	int stage;             // Function values received so far, up to 2
+	int iterations;
+	bool done;
+} brent;
+
+static void startBrent(brent* search, double low, double high, bool minimize, double* next) {
+	// Sets up a search over [low, high] and gives the first point to evaluate
+	search->low = low;
+	search->high = high;
+	search->stage = 0;
+	search->iterations = 0;
+	search->done = false;
+	search->result = NAN;
+
+	if (minimize) {
+		search->a = low;
+		search->b = high;
+		search->x = search->w = search->v = low + GOLDEN_SECTION * (high - low);
+		search->d = search->e = 0.0;
+		*next = search->x;
+	}
+	else {
+		*next = low;
+	}
+}
+
+static bool stepRoot(brent* search, double value, double* next) {
+	// Takes the function value at the last point given, and returns true with the next point, or false once done
+	double tolerance, middle, s, p, q, r, min1, min2;
+
+	if (search->stage == 0) {
+		search->a = search->low;
+		search->fa = value;
+		search->stage++;
+		*next = search->high;
+		return true;
+	}
+	if (search->stage == 1) {
+		search->b = search->high;
+		search->fb = value;
+		search->stage++;
+		if (isnan(search->fa) || isnan(search->fb) || ((search->fa > 0) == (search->fb > 0) && search->fa != 0 && search->fb != 0)) {
+			// No sign change, so the interval doesn't bracket a root
+			search->done = true;
+			return false;
+		}
+		if (search->fa == 0) {
+			search->result = search->a;
+			search->done = true;
+			return false;
+		}
+		search->c = search->b;
+		search->fc = search->fb;
+	}
+	else {
+		search->fb = value;
+	}
+
+	search->iterations++;
+	if (isnan(search->fb) || search->iterations > MAX_SOLVE_ITERATIONS) {
+		search->done = true;
+		return false;
+	}
+
+	if ((search->fb > 0 && search->fc > 0) || (search->fb < 0 && search->fc < 0)) {
+		search->c = search->a;
+		search->fc = search->fa;
+		search->d = search->e = search->b - search->a;
+	}
+	if (fabs(search->fc) < fabs(search->fb)) {
+		search->a = search->b; search->b = search->c; search->c = search->a;
+		search->fa = search->fb; search->fb = search->fc; search->fc = search->fa;
+	}
+
+	tolerance = 2 * DBL_EPSILON * fabs(search->b) + DBL_MIN;
+	middle = 0.5 * (search->c - search->b);
+	if (fabs(middle) <= tolerance || search->fb == 0) {
+		search->result = search->b;
+		search->done = true;
+		return false;
+	}
+
+	if (fabs(search->e) >= tolerance && fabs(search->fa) > fabs(search->fb)) {
+		// Inverse quadratic interpolation, or the secant method when only two points are known
+		s = search->fb / search->fa;
+		if (search->a == search->c) {
+			p = 2 * middle * s;
+			q = 1 - s;
+		}
+		else {
+			q = search->fa / search->fc;
+			r = search->fb / search->fc;
+			p = s * (2 * middle * q * (q - r) - (search->b - search->a) * (r - 1));
+			q = (q - 1) * (r - 1) * (s - 1);
+		}
+		if (p > 0) q = -q;
+		p = fabs(p);
+		min1 = 3 * middle * q - fabs(tolerance * q);
+		min2 = fabs(search->e * q);
+		if (2 * p < ((min1 < min2) ? min1 : min2)) {
+			search->e = search->d;
+			search->d = p / q;
+		}
+		else {
+			search->d = middle;
+			search->e = search->d;
+		}
+	}
+	else {
+		// Bisection
+		search->d = middle;
+		search->e = search->d;
+	}
+
+	search->a = search->b;
+	search->fa = search->fb;
+	search->b += (fabs(search->d) > tolerance) ? search->d : copysign(tolerance, middle);
+	*next = search->b;
+	return true;
+}
+
+static bool stepMinimum(brent* search, double value, double* next) {
+	// Takes the function value at the last point given, and returns true with the next point, or false once done
+	double middle, tolerance, p, q, r;
+
+	if (search->stage == 0) {
+		search->fx = search->fw = search->fv = value;
+		search->stage++;
+	}
+	else {
+		// Update the bracket and best points with the value at u
+		if (value <= search->fx) {
+			if (search->u >= search->x) search->a = search->x;
+			else search->b = search->x;
+			search->v = search->w; search->fv = search->fw;
+			search->w = search->x; search->fw = search->fx;
+			search->x = search->u; search->fx = value;
+		}
+		else {
+			if (search->u < search->x) search->a = search->u;
+			else search->b = search->u;
+			if (value <= search->fw || search->w == search->x) {
+				search->v = search->w; search->fv = search->fw;
+				search->w = search->u; search->fw = value;
+			}
+			else if (value <= search->fv || search->v == search->x || search->v == search->w) {
+				search->v = search->u; search->fv = value;
+			}
+		}
+	}
+
+	search->iterations++;
+	if (isnan(search->fx) || search->iterations > MAX_SOLVE_ITERATIONS) {
+		search->done = true;
+		return false;
+	}
+
+	middle = 0.5 * (search->a + search->b);
+	tolerance = sqrt(DBL_EPSILON) * fabs(search->x) + DBL_EPSILON * (search->high - search->low) / 3;
+	if (fabs(search->x - middle) <= 2 * tolerance - 0.5 * (search->b - search->a)) {
+		search->result = search->x;
+		search->done = true;
+		return false;
+	}
+
+	if (fabs(search->e) > tolerance) {
+		// Fit a parabola through x, w and v
+		r = (search->x - search->w) * (search->fx - search->fv);
+		q = (search->x - search->v) * (search->fx - search->fw);
+		p = (search->x - search->v) * q - (search->x - search->w) * r;
+		q = 2 * (q - r);
+		if (q > 0) p = -p;
+		q = fabs(q);
+		r = search->e;
+		search->e = search->d;
+
+		if (fabs(p) >= fabs(0.5 * q * r) || p <= q * (search->a - search->x) || p >= q * (search->b - search->x)) {
+			search->e = (search->x >= middle) ? search->a - search->x : search->b - search->x;
+			search->d = GOLDEN_SECTION * search->e;
+		}
+		else {
+			search->d = p / q;
+			search->u = search->x + search->d;
+			if (search->u - search->a < 2 * tolerance || search->b - search->u < 2 * tolerance) {
+				search->d = copysign(tolerance, middle - search->x);
+			}
+		}
+	}
+	else {
+		// Golden section step into the larger part of the bracket
+		search->e = (search->x >= middle) ? search->a - search->x : search->b - search->x;
+		search->d = GOLDEN_SECTION * search->e;
+	}
+
+	search->u = search->x + ((fabs(search->d) >= tolerance) ? search->d : copysign(tolerance, search->d));
+	*next = search->u;
+	return true;
+}
+
+static bool stepBrent(brent* search, bool minimize, double value, double* next) {
+	return minimize ? stepMinimum(search, value, next) : stepRoot(search, value, next);
+}
+
+// Finds the root (solve) or the minimum (minimize) of the body over its bound variable within [low, high]
+// with Brent's method.  A root must be bracketed by a change of sign.  Returns NaN if the search fails
+double solveRange(const program* prog, unsigned int operand, int bodyStart, int bodyEnd, int local,
+	double low, double high, double locals[]) {
+
+	brent search;
+	double point = 0.0;
+	double bodyLocals[MAX_LOCALS];
+	bool minimize = (operand == OP_MINIMIZE);
+
+	if (isnan(low) || isnan(high) || isinf(low) || isinf(high)) return NAN;
+	if (low > high) return solveRange(prog, operand, bodyStart, bodyEnd, local, high, low, locals);
+
+	for (int i = 0; i < MAX_LOCALS; i++) {
+		bodyLocals[i] = locals[i];
+	}
+
+	startBrent(&search, low, high, minimize, &point);
+	do {
+		bodyLocals[local] = point;
+	} while (stepBrent(&search, minimize, executeCode(prog, bodyStart, bodyEnd, bodyLocals), &point));
+
+	return search.result;
+}
+
+typedef struct {
+	const program* prog;
+	bool minimize;
+	double low;
+	double high;
+	const double* parameters;
+	int nrParameters;
+	double* results;
+} solveBatch;
+
+static void solveBlock(void* context, int index) {
+	// Runs up to BATCH_SIZE searches in lockstep, one per parameter value.  Every pass evaluates the next point of
+	// each search that isn't done yet in a single batch
+	solveBatch* task = context;
+	brent searches[BATCH_SIZE];
+	int active[BATCH_SIZE];       // Search each lane of the batch belongs to
+	double points[BATCH_SIZE];
+	double parameters[BATCH_SIZE];
+	double values[BATCH_SIZE];
+	double next[BATCH_SIZE];
+	double locals[MAX_LOCALS] = { 0 };
+	const double* lanes[MAX_LOCALS] = { NULL };
+	int first = index * BATCH_SIZE;
+	int count = task->nrParameters - first;
+	int nrActive = 0;
+	int stillActive = 0;
+	double* workspace = malloc(task->prog->stackDepth * BATCH_SIZE * sizeof(double));
+
+	if (count > BATCH_SIZE) count = BATCH_SIZE;
+	if (workspace == NULL) {
+		for (int i = 0; i < count; i++) task->results[first + i] = NAN;
+		return;
+	}
+	lanes[0] = points;
+	lanes[1] = parameters;
+
+	for (int i = 0; i < count; i++) {
+		startBrent(&searches[i], task->low, task->high, task->minimize, &next[i]);
+	}
+	nrActive = count;
+	for (int i = 0; i < count; i++) active[i] = i;
+
+	while (nrActive > 0) {
+		for (int i = 0; i < nrActive; i++) {
+			points[i] = next[active[i]];
+			parameters[i] = task->parameters[first + active[i]];
+		}
+		executeBatch(task->prog, 0, task->prog->length, locals, lanes, nrActive, values, workspace);
+
+		// Advance every search, and pack the ones that still need values to the front
+		stillActive = 0;
+		for (int i = 0; i < nrActive; i++) {
+			if (stepBrent(&searches[active[i]], task->minimize, values[i], &next[active[i]])) {
+				active[stillActive] = active[i];
+				stillActive++;
+			}
+		}
+		nrActive = stillActive;
+	}
+
+	for (int i = 0; i < count; i++) {
+		task->results[first + i] = searches[i].result;
+	}
+	free(workspace);
+}
+
+// Batch form of solve and minimize, started as "clc --solve <expression> x=low:high p=first:step:last".  Finds a root
+// or minimum over x in [low, high] for every value of the parameter p, and prints them as comma separated "p,x" lines.
+// Searches run in lockstep batches of BATCH_SIZE, with batches spread over the thread pool
+int runSolveBatch(bool minimize, char expression[], char bracket[], char parameter[]) {
+
+	program prog;
+	solveBatch task;
+	char variableName[INPUT_HOLDER_SIZE] = { 0 };
+	char parameterName[INPUT_HOLDER_SIZE] = { 0 };
+	char* names[2] = { variableName, parameterName };
+	double limits[2];
+	double range[3];
+	int nrLimits = 0;
+	int nrRange = 0;
+	long long int nrParameters = 0;
+	double* parameters;
+	double* results;
+
+	if (!parseRange(bracket, variableName, limits, 2, &nrLimits) || nrLimits != 2
+		|| !parseRange(parameter, parameterName, range, 3, &nrRange) || nrRange != 3 || range[1] == 0.0
+		|| (range[2] - range[0]) / range[1] < 0) {
+		printf("  Expected x=low:high and p=first:step:last, with names of at most %d characters\n", INPUT_HOLDER_SIZE - 1);
+		return 1;
+	}
+
+	initProgram(&prog);
+	compileExpression(&prog, expression, names, 2);
+	if (error != NO_ERROR) {
+		printError();
+		freeProgram(&prog);
+		return 1;
+	}
+
+	nrParameters = (long long int)floor((range[2] - range[0]) / range[1] + 1e-9) + 1;
+	parameters = malloc(nrParameters * sizeof(double));
+	results = malloc(nrParameters * sizeof(double));
+	if (parameters == NULL || results == NULL || nrParameters > 0x7FFFFFFF - BATCH_SIZE) {
+		printf("  Overflow error\n");
+		free(parameters);
+		free(results);
+		freeProgram(&prog);
+		return 1;
+	}
+	for (long long int i = 0; i < nrParameters; i++) {
+		parameters[i] = range[0] + i * range[1];
+	}
+
+	task.prog = &prog;
+	task.minimize = minimize;
+	task.low = (limits[0] < limits[1]) ? limits[0] : limits[1];
+	task.high = (limits[0] < limits[1]) ? limits[1] : limits[0];
+	task.parameters = parameters;
+	task.nrParameters = (int)nrParameters;
+	task.results = results;
+	parallelFor((int)((nrParameters + BATCH_SIZE - 1) / BATCH_SIZE), solveBlock, &task);
+
+	printf("%s,%s\n", parameterName, variableName);
+	for (long long int i = 0; i < nrParameters; i++) {
+		printf("%.17g,%.17g\n", parameters[i], results[i]);
+	}
+
+	free(parameters);
+	free(results);
+	freeProgram(&prog);
+	return 0;
+}
\ No newline at end of file
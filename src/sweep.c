@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "compile.h"
+#include "execute.h"
+#include "parallel.h"
+#include "aggregate.h"
+#include "sweep.h"
+#include "global.h"
+
+#define SWEEP_BLOCKS 1024                         // Batches evaluated between two writes of the output
+#define SWEEP_CHUNK (SWEEP_BLOCKS * BATCH_SIZE)
+#define NUMBER_WIDTH 25                           // Longest number printed with "%.17g", and a separator
+
+typedef struct {
+	const program* prog;
+	int nrVariables;
+	double first[MAX_LOCALS];
+	double step[MAX_LOCALS];
+	long long int count[MAX_LOCALS];  // Values of each variable
+	long long int start;              // Point the current chunk starts at
+	long long int nrPoints;           // Points in the current chunk
+	double* results;
+	char* text;                       // Lines of the current chunk, BATCH_SIZE * rowWidth characters per batch
+	int textLength[SWEEP_BLOCKS];
+	int rowWidth;
+	bool stats;                       // Summarize the values instead of writing them
+	aggregate stripes[AGGREGATE_STRIPES];
+} sweepTask;
+
+static void gridPoint(const sweepTask* task, long long int point, double coordinates[]) {
+	// Finds the values of the variables at a point of the grid.  The last variable varies fastest
+	for (int i = task->nrVariables - 1; i >= 0; i--) {
+		coordinates[i] = task->first[i] + (double)(point % task->count[i]) * task->step[i];
+		point /= task->count[i];
+	}
+}
+
+static void sweepBlock(void* context, int index) {
+	// Evaluates the expression at up to BATCH_SIZE points of the current chunk in one batch.  For text output the lines
+	// are printed here too, since formatting takes longer than evaluating
+	sweepTask* task = context;
+	double coordinates[MAX_LOCALS];
+	double values[MAX_LOCALS][BATCH_SIZE];
+	double locals[MAX_LOCALS] = { 0 };
+	const double* lanes[MAX_LOCALS] = { NULL };
+	long long int first = (long long int)index * BATCH_SIZE;
+	int count = (int)((task->nrPoints - first < BATCH_SIZE) ? task->nrPoints - first : BATCH_SIZE);
+	double* workspace = malloc(task->prog->stackDepth * BATCH_SIZE * sizeof(double));
+
+	if (workspace == NULL) {
+		for (int j = 0; j < count; j++) task->results[first + j] = NAN;
+		return;
+	}
+	for (int i = 0; i < task->nrVariables; i++) lanes[i] = values[i];
+	for (int j = 0; j < count; j++) {
+		gridPoint(task, task->start + first + j, coordinates);
+		for (int i = 0; i < task->nrVariables; i++) values[i][j] = coordinates[i];
+	}
+	executeBatch(task->prog, 0, task->prog->length, locals, lanes, count, &task->results[first], workspace);
+	free(workspace);
+
+	if (task->text != NULL) {
+		char* line = task->text + first * task->rowWidth;
+		int length = 0;
+		for (int j = 0; j < count; j++) {
+			for (int i = 0; i < task->nrVariables; i++) {
+				length += sprintf(line + length, "%.17g,", values[i][j]);
+			}
+			length += sprintf(line + length, "%.17g\n", task->results[first + j]);
+		}
+		task->textLength[index] = length;
+	}
+}
+
+static void writeChunk(const sweepTask* task, FILE* binary) {
+	// Writes the points of the current chunk, each as a line "variables,value" or as raw doubles
+	double row[MAX_LOCALS + 1];
+	int n = task->nrVariables;
+
+	if (binary == NULL) {
+		for (int i = 0; i < (task->nrPoints + BATCH_SIZE - 1) / BATCH_SIZE; i++) {
+			fwrite(task->text + (long long int)i * BATCH_SIZE * task->rowWidth, 1, task->textLength[i], stdout);
+		}
+		return;
+	}
+	for (long long int j = 0; j < task->nrPoints; j++) {
+		gridPoint(task, task->start + j, row);
+		row[n] = task->results[j];
+		fwrite(row, sizeof(double), n + 1, binary);
+	}
+}
+
+// Evaluates an expression over a range of one variable, or a grid of several, started as
+//   clc --sweep x=0:1e-6:10 [y=first:step:last ...] "expression" [--binary file | --stats]
+// The expression is compiled once.  Points are evaluated a chunk at a time, in batches spread over the thread pool,
+// and each chunk is written before the next is evaluated, so memory use doesn't depend on the number of points.  The
+// output is a line per point with the value of each variable and of the expression, or raw doubles in the same order.
+// With --stats only summary statistics of the values are printed
+int runSweep(int argc, char* argv[]) {
+
+	program prog;
+	sweepTask task;
+	char names[MAX_LOCALS][INPUT_HOLDER_SIZE] = { { 0 } };
+	char* nameList[MAX_LOCALS];
+	char* expression = NULL;
+	char* binaryName = NULL;
+	FILE* binary = NULL;
+	double values[3];
+	int nrValues = 0;
+	long long int nrPoints = 1;
+
+	task.nrVariables = 0;
+	task.stats = false;
+	for (int i = 0; i < argc; i++) {
+		if (strcmp(argv[i], "--binary") == 0 && i + 1 < argc) {
+			binaryName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--stats") == 0) {
+			task.stats = true;
+		}
+		else if (parseRange(argv[i], names[task.nrVariables], values, 3, &nrValues) && nrValues != 2) {
+			if (task.nrVariables >= MAX_LOCALS
+				|| (nrValues == 3 && (values[1] == 0.0 || (values[2] - values[0]) / values[1] < 0))) {
+				printf("  Too many variables, or invalid range \"%s\"\n", argv[i]);
+				return 1;
+			}
+			task.first[task.nrVariables] = values[0];
+			task.step[task.nrVariables] = (nrValues == 3) ? values[1] : 0.0;
+			task.count[task.nrVariables] = (nrValues == 3) ? (long long int)floor((values[2] - values[0]) / values[1] + 1e-9) + 1 : 1;
+			if (task.count[task.nrVariables] > 0x7FFFFFFFFFFFFFFF / nrPoints) {
+				printf("  Overflow error\n");
+				return 1;
+			}
+			nrPoints *= task.count[task.nrVariables];
+			task.nrVariables++;
+		}
+		else if (expression == NULL) {
+			expression = argv[i];
+		}
+		else {
+			printf("  Unrecognized argument, or name longer than %d characters: \"%s\"\n", INPUT_HOLDER_SIZE - 1, argv[i]);
+			return 1;
+		}
+	}
+	if (expression == NULL || task.nrVariables == 0) {
+		printf("  Expected x=first:step:last and an expression\n");
+		return 1;
+	}
+
+	initProgram(&prog);
+	for (int i = 0; i < task.nrVariables; i++) nameList[i] = names[i];
+	compileExpression(&prog, expression, nameList, task.nrVariables);
+	if (error != NO_ERROR) {
+		printError();
+		freeProgram(&prog);
+		return 1;
+	}
+
+	task.prog = &prog;
+	task.results = malloc(SWEEP_CHUNK * sizeof(double));
+	task.text = NULL;
+	task.rowWidth = (task.nrVariables + 1) * NUMBER_WIDTH + 1;
+	if (task.stats) {
+		binaryName = NULL;
+		for (int i = 0; i < AGGREGATE_STRIPES; i++) initAggregate(&task.stripes[i]);
+	}
+	else if (binaryName != NULL) {
+		binary = fopen(binaryName, "wb");
+	}
+	else {
+		task.text = malloc((long long int)SWEEP_CHUNK * task.rowWidth);
+	}
+	if (task.results == NULL || (binaryName != NULL && binary == NULL)
+		|| (binaryName == NULL && !task.stats && task.text == NULL)) {
+		if (binaryName != NULL && binary == NULL) printf("  Could not open %s\n", binaryName);
+		else printf("  Overflow error\n");
+		if (binary != NULL) fclose(binary);
+		free(task.results);
+		free(task.text);
+		freeProgram(&prog);
+		return 1;
+	}
+
+	if (binary == NULL && !task.stats) {
+		for (int i = 0; i < task.nrVariables; i++) printf("%s,", names[i]);
+		printf("value\n");
+	}
+	for (task.start = 0; task.start < nrPoints; task.start += SWEEP_CHUNK) {
+		task.nrPoints = (nrPoints - task.start < SWEEP_CHUNK) ? nrPoints - task.start : SWEEP_CHUNK;
+		parallelFor((int)((task.nrPoints + BATCH_SIZE - 1) / BATCH_SIZE), sweepBlock, &task);
+		if (task.stats) {
+			addValuesParallel(task.stripes, task.results, task.nrPoints);
+		}
+		else {
+			writeChunk(&task, binary);
+		}
+	}
+
+	if (task.stats) {
+		for (int i = 1; i < AGGREGATE_STRIPES; i++) mergeAggregate(&task.stripes[0], &task.stripes[i]);
+		printStatsHeader();
+		printStats("value", &task.stripes[0]);
+		freeAggregate(&task.stripes[0]);
+	}
+
+	if (binary != NULL) fclose(binary);
+	free(task.results);
+	free(task.text);
+	freeProgram(&prog);
+	return 0;
+}
\ No newline at end of file
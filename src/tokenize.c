@@ -1,200 +1,146 @@
-#include <stdio.h>
-#include <math.h>
-#include <stdlib.h>
-#include <stdbool.h>
-#include "constants.h"
-#include "auxiliary.h"
-#include "tokenize.h"
-#include "global.h"
-#include "variables.h"
-
-unsigned int tokenize(int* indexPtr, int* evalVarHead, bool unaryNegation, int* keywordState) {
-	// Converts multi-character inputs (such as function names) into their representative tokens
-
-	unsigned int currChar = terminalInput[*indexPtr];
-	char inputHolder[INPUT_HOLDER_SIZE] = { 0 }; int inputHolderIndex = 0;
-	int numDecimalPlaces = 0; // If this exeeds one for a number, throw error
-	int numE = 0; // Amount of times 'E' is encountered in a number
-	bool prevCharIsE = false;
-	bool negativeAnswerIndex = false;
-	unsigned int outputToken = 0;
-	int varMapHead = 0;  // variableMap indices beyond this value are guaranteed to be unallocated
-
-	if ((currChar >= '0' && currChar <= '9')) {
-		// If token is a value, scan all characters until no longer part of a value
-		while ((currChar >= '0' && currChar <= '9') || currChar == '.' || currChar == 'E' || currChar == '-') {
-			
-			// Catches notation errors related to negation, decimal points, and scientific notation
-			if (currChar == '-') {
-				if (!prevCharIsE) {
-					break;
-				}
-			}
-			prevCharIsE = false;
-			if (currChar == '.') {
-				if (numE > 0) {
-					error = ERR_SYNTAX;
-					break;
-				}
-				numDecimalPlaces++;
-			}
-			else if (currChar == 'E') {
-				numE++;
-				prevCharIsE = true;
-			}
-			if (numE > 1) break;
-
-			if (inputHolderIndex >= INPUT_HOLDER_SIZE) {
-				error = ERR_OVERFLOW;
-				break;
-			}
-
-			inputHolder[inputHolderIndex] = currChar;
-			inputHolderIndex++;
-			(*indexPtr)++;
-			currChar = terminalInput[*indexPtr];
-		}
-
-		// Validate number, convert to double and store
-		if (numDecimalPlaces > 1) return OP_NULL;
-		if (*evalVarHead >= VAR_MAP_SIZE) {
-			error = ERR_OVERFLOW;
-			return OP_NULL;
-		}
-		variableMap[*evalVarHead] = atof(inputHolder);
-		// TODO: Add support for different data types
-
-		outputToken = *evalVarHead;
-		(*evalVarHead)++;
-	}
-	else if ((currChar >= 'a' && currChar <= 'z') || (currChar >= 'A' && currChar <= 'Z')) {
-		// If token is a function or variable
-		while ((currChar >= 'a' && currChar <= 'z') || (currChar >= 'A' && currChar <= 'Z') || (currChar >= '0' && currChar <= '9')
-			|| currChar == '_') {
-			if (inputHolderIndex >= INPUT_HOLDER_SIZE) {
-				break;
-			}
-
-			// Scan characters until no longer can be part of a function or variable
-			inputHolder[inputHolderIndex] = currChar;
-			(*indexPtr)++;
-			inputHolderIndex++;
-			currChar = terminalInput[*indexPtr];
-		}
-
-		outputToken = findFunction(inputHolder);
-
-		// If token wasn't a function, test for variables
-		if (outputToken == OP_NULL) {
-			variableMap[*evalVarHead] = findVariable(inputHolder);
-			outputToken = *evalVarHead;
-			(*evalVarHead)++;
-		}
-	}
-	else if (currChar == '<') {
-		(*indexPtr)++;
-		currChar = terminalInput[*indexPtr];
-
-		if (currChar == '=') {
-			outputToken = OP_LESS_THAN_EQUAL_TO;
-			(*indexPtr)++;
-		}
-		else if (currChar == '-') {
-			(*indexPtr)++;
-			currChar = terminalInput[*indexPtr];
-
-			if (currChar == '>') {
-				outputToken = OP_IFF;
-				(*indexPtr)++;
-			}
-			else {
-				outputToken = OP_IMPLIED_BY;
-			}
-		}
-		else if (currChar == '<') {
-			outputToken = OP_LEFT_SHIFT;
-			(*indexPtr)++;
-		}
-		else {
-			outputToken = OP_LESS_THAN;
-		}
-	}
-	else if (currChar == '>') {
-		(*indexPtr)++;
-		currChar = terminalInput[*indexPtr];
-
-		if (currChar == '=') {
-			outputToken = OP_GREATER_THAN_EQUAL_TO;
-			(*indexPtr)++;
-		}
-		else if (currChar == '>') {
-			outputToken = OP_RIGHT_SHIFT;
-			(*indexPtr)++;
-		}
-		else {
-			outputToken = OP_GREATER_THAN;
-		}
-	}
-	else if (currChar == '-') {
-		(*indexPtr)++;
-		currChar = terminalInput[*indexPtr];
-
-		if (currChar == '>') {
-			outputToken = OP_IMPLIES;
-			(*indexPtr)++;
-		}
-		else {
-			outputToken = (unaryNegation) ? OP_NEG : OP_SUB;
-		}
-	}
-	else {
-		// If none of the above applied, single character tokens are tested for
-		switch (currChar) {
-		case '\n':
-			outputToken = OP_NULL;
-			break;
-		case ' ':
-			outputToken = OP_NULL;
-			break;
-		case ',':
-			outputToken = ARG_SEPARATOR;
-			break;
-		case '(':
-			outputToken = LEFT_PARENTH;
-			break;
-		case ')':
-			outputToken = RIGHT_PARENTH;
-			break;
-		case '+':
-			outputToken = OP_ADD;
-			break;
-		case '*':
-			outputToken = OP_MUL;
-			break;
-		case '/':
-			outputToken = OP_DIV;
-			break;
-		case '^':
-			outputToken = OP_EXP;
-			break;
-		case '=':
-			if (*keywordState == KWS_ASSIGN) {
-				outputToken = INST_ASSIGN_VAL;
-				*keywordState = KWS_NULL;
-			}
-			else {
-				error = ERR_SYNTAX;
-				return 0;
-			}
-			break;
-		default:
-			outputToken = OP_NULL;
-			error = ERR_UNKNOWN_TOKEN;
-			unrecognizedToken[0] = currChar;
-			break;
-		}
-		(*indexPtr)++;
-	}
-
-	return outputToken;
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "constants.h"
+#include "auxiliary.h"
+#include "tokenize.h"
+#include "global.h"
+#include "variables.h"
+#include "lex.h"
+#include "integer.h"
+#include "profile.h"
+
+// A line is split into lexemes by lexLine() first, in one pass, and tokenize() then turns them into tokens one at a time.
+// Numbers and names become operands: entries of a table that grows as needed and is reused from line to line, with
+// their text kept one after the other in operandNames.  Nothing is allocated for each token
+static lexeme* lexemes;
+static int lexemeCapacity;
+static int lexStart;  // Position in terminalInput of the text that was lexed
+static int nrOperands;
+static int operandCapacity;
+static int namesLength;
+static int namesCapacity;
+
+// Forgets the operands of the previous line
+void clearOperands() {
+	nrOperands = 0;
+	namesLength = 0;
+}
+
+// Splits terminalInput from start to the end of the line into lexemes, and returns how many there are, or -1 if there is
+// no memory for them
+int lexInput(int start) {
+
+	int count = 0;
+
+	enterStage(STAGE_LEX);
+	count = lexLine(&terminalInput[start], lexemes, lexemeCapacity);
+	lexStart = start;
+	if (count > lexemeCapacity) {
+		if (!growBuffer(&lexemes, &lexemeCapacity, count, sizeof(lexeme))) count = -1;
+		if (count > 0) lexLine(&terminalInput[start], lexemes, lexemeCapacity);
+	}
+	leaveStage();
+	return count;
+}
+
+static unsigned int addOperand(int start, int length, int source) {
+	// Adds the text of terminalInput from start on as an operand, and returns its token, or OP_NULL if there is no memory
+	if (!growBuffer(&operands, &operandCapacity, nrOperands + 1, sizeof(operand))
+		|| !growBuffer(&operandNames, &namesCapacity, namesLength + length + 1, sizeof(char))) {
+		error = ERR_OVERFLOW;
+		return OP_NULL;
+	}
+	memcpy(&operandNames[namesLength], &terminalInput[start], length);
+	operandNames[namesLength + length] = '\0';
+	operands[nrOperands].name = namesLength;
+	operands[nrOperands].source = source;
+	operands[nrOperands].value = 0.0;
+	operands[nrOperands].integral = false;
+	operands[nrOperands].big = false;
+	namesLength += length + 1;
+	nrOperands++;
+	return OPERAND_START + nrOperands - 1;
+}
+
+unsigned int tokenize(int* indexPtr, bool unaryNegation, int* keywordState) {
+	// Converts the lexeme at *indexPtr into its token, and moves on to the next one.  Numbers and names become operands
+
+	const lexeme* current = &lexemes[*indexPtr];
+	unsigned int outputToken = current->token;
+	unsigned int function = OP_NULL;
+	const char* name = NULL;
+	bool isVariableName = false;
+
+	(*indexPtr)++;
+	switch (current->token) {
+	case LEX_NUMBER:
+		outputToken = addOperand(lexStart + current->start, current->length, 0);
+		if (outputToken == OP_NULL) return OP_NULL;
+		name = &operandNames[operands[outputToken - OPERAND_START].name];
+		operands[outputToken - OPERAND_START].value = atof(name);
+		// Numbers written as digits alone are also kept exactly, for when they are used as integers.  Those too large for
+		// 64 bits are only integers of any size, which are read from their text
+		operands[outputToken - OPERAND_START].integral = parseInteger(name, current->length,
+			&operands[outputToken - OPERAND_START].integer);
+		if (!operands[outputToken - OPERAND_START].integral && bigIntegers && strspn(name, "0123456789") == current->length) {
+			operands[outputToken - OPERAND_START].integral = true;
+			operands[outputToken - OPERAND_START].big = true;
+		}
+		break;
+	case LEX_BAD_NUMBER:
+		// Several decimal points, or one in an exponent
+		error = ERR_SYNTAX;
+		return OP_NULL;
+	case LEX_NAME:
+		// The name is stored first, so that it can be looked up, and forgotten again if it is a function
+		outputToken = addOperand(lexStart + current->start, current->length, 0);
+		if (outputToken == OP_NULL) return OP_NULL;
+		name = &operandNames[operands[outputToken - OPERAND_START].name];
+		function = findFunction((char*)name);
+		if (function != OP_NULL) {
+			outputToken = function;
+			nrOperands--;
+			namesLength = operands[nrOperands].name;
+		}
+		else {
+			// If token wasn't a function, test for variables.  Names not yet defined are left for the compiler to resolve
+			operands[outputToken - OPERAND_START].source = findVariableSlot((char*)name);
+			isVariableName = true;
+		}
+		break;
+	case LEX_MINUS:
+		outputToken = (unaryNegation) ? OP_NEG : OP_SUB;
+		break;
+	case LEX_EQUALS:
+		if (*keywordState != KWS_ASSIGN) {
+			error = ERR_SYNTAX;
+			return OP_NULL;
+		}
+		outputToken = INST_ASSIGN_VAL;
+		*keywordState = KWS_NULL;
+		break;
+	case LEX_DEFINE:
+		// "name := expression" defines a formula, in the same place as an assignment
+		if (*keywordState != KWS_ASSIGN) {
+			error = ERR_SYNTAX;
+			return OP_NULL;
+		}
+		outputToken = INST_DEFINE;
+		*keywordState = KWS_NULL;
+		break;
+	case LEX_UNKNOWN:
+		error = ERR_UNKNOWN_TOKEN;
+		unrecognizedToken[0] = terminalInput[lexStart + current->start];
+		return OP_NULL;
+	}
+
+	// Only a variable name at the very start of a line may be assigned to
+	if (outputToken != INST_ASSIGN_VAL && outputToken != INST_DEFINE) {
+		*keywordState = (*keywordState == KWS_READY && isVariableName) ? KWS_ASSIGN : KWS_NULL;
+	}
+
+	return outputToken;
 }
\ No newline at end of file
@@ -1,132 +1,1068 @@
-#include <stdio.h>
-#include <math.h>
-#include <stdlib.h>
-#include <stdbool.h>
-#include "constants.h"
-#include "variables.h"
-#include "global.h"
-
-void loadVariables(int VAR_START_POSITION, int VAR_END_POSITION, char filename[64]) {
-	// Loads variables from file into memory
-	FILE* file = NULL;
-	file = fopen(filename, "r");
-	char textInput[LOAD_VAR_HOLDER_SIZE] = { '\0' };
-	char holder[LOAD_VAR_HOLDER_SIZE] = { '\0' };
-	bool lineError[LOAD_VAR_HOLDER_SIZE] = { false };
-	int j = 0; // iterator
-	int jHolder = 0;
-	bool noLoadFail = true;
-
-	if (file == NULL) {
-		printf("  Could not load %s\n", filename);
-	}
-	else {
-		// Iterates line by line. Starts at 1 because element 0 is "ans"
-		for (int i = VAR_START_POSITION; i <= VAR_END_POSITION && fgets(textInput, LOAD_VAR_HOLDER_SIZE, file); i++) {
-			if ((textInput[0] >= 'a' && textInput[0] <= 'z') || (textInput[0] >= 'A' && textInput[0] <= 'Z')) {
-
-				// Gets variable name
-				for (j = 0; j <= 20 && ((textInput[j] >= 'a' && textInput[j] <= 'z') || (textInput[j] >= 'A' && textInput[j] <= 'Z')
-					|| (textInput[j] >= '0' && textInput[j] <= '9') || textInput[j] == '_'); j++) {
-					variableNames[i][j] = textInput[j];
-				}
-
-				// Skips over space.  If character isn't a space, skip this line
-				if (textInput[j] != ' ' && textInput[j] != '\t') {
-					lineError[i] = true;
-					continue;
-				}
-				else j++;
-
-				// Gets variable values
-				for (; j < 118 && ((textInput[j] >= '0' && textInput[j] <= '9') || textInput[j] == '.' || textInput[j] == 'E'
-					|| textInput[j] == '-'); j++) {
-					holder[jHolder] = textInput[j];
-					jHolder++;
-				}
-
-				// Puts variable values into memory
-				variableMap[i] = atof(holder);
-				// TODO:  Add support for different variable types
-
-				// Clears holder
-				while (jHolder > 0) {
-					holder[jHolder] = '\0';
-					jHolder--;
-				}
-				holder[jHolder] = '\0';
-			}
-			else if (textInput[0] == '\0') continue;
-			else lineError[i] = true;
-		}
-	}
-
-	for (int i = 0; i < LOAD_VAR_HOLDER_SIZE; i++) {
-		if (lineError[i]) {
-			printf("  Failed to parse line %d from file %s\n", i, filename);
-			noLoadFail = false;
-		}
-	}
-	if (!noLoadFail) printf("\n");
-
-	if (file != NULL) fclose(file);
-}
-
-// Saves variables to file
-void saveVariable(int VAR_START_POSITION, int VAR_END_POSITION, char filename[]) {
-	// Start and end positions will be different depending on whether constants or regular variables are being saved
-	// Positions should be chosen such that unnamed variables are not saved
-
-	FILE* file = NULL;
-	file = fopen(filename, "w");
-
-	if (file == NULL) {
-		printf("  Could not load %s\n", filename);
-	}
-	else {
-		for (int i = VAR_START_POSITION; i < VAR_END_POSITION && variableNames[i][0] != '\0'; i++) {
-			printf("%s", variableNames[i]);
-			printf(" ");
-			printf("%lf\n", variableMap[i]);
-		}
-	}
-
-	if (file != NULL) fclose(file);
-}
-
-// Allocates memory for variable, assigns variable
-int addVariable() {
-
-
-}
-
-// Memory for particular variable is freed.  TODO: Auto-defrag?
-void delVariable() {
-
-
-}
-
-// Finds variable's value from its name, and returns it
-// TODO: Will need heavy modification when multiple data types will need to be supported
-// TODO: Will need heavy modification when new instruction compilation scheme is implemented
-double findVariable(char input[]) {
-
-	for (int i = 0; i < VAR_NAME_SIZE; i++) { // variable loop
-		for (int j = 0; j < 10; j++) { // character loop
-			if (input[j] != variableNames[i][j]) {
-				// If at any point the input and current variable don't match, try next variable
-				break;
-			}
-			else if (j == 9 && input[10] == '\0') {
-				// Return if end of the input has been reached and all have matched
-				return variableMap[i];
-			}
-		}
-	}
-	error = ERR_UNKNOWN_TOKEN;
-	for (int i = 0; i < INPUT_HOLDER_SIZE; i++) {
-		unrecognizedToken[i] = input[i];
-	}
-
-	return 0.0;
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include "constants.h"
+#include "variables.h"
+#include "mapfile.h"
+#include "bigint.h"
+#include "bigfloat.h"
+#include "profile.h"
+#include "global.h"
+
+// Variables are reached through slots, which stay the same for as long as a variable exists, so that compiled code can
+// refer to them.  Each slot has a name and the position of its value in variableMap.  Slots below USER_VAR_START ("ans"
+// and the constants) sit at their own position while they hold a scalar, and all other values live in an arena after
+// them.  A scalar takes one word of the arena, holding either a double or, for TYPE_INT, the bits of a 64-bit integer.
+// Larger values, such as arrays, integers too long for 64 bits and numbers of any precision, start with a TYPE_*_HEAD
+// word holding the number of words that follow.  Deleting a variable leaves a hole, and holes are closed by
+// compactVariables(), which moves a bounded number of words per call between statements.  Names are found through a
+// hash table.  Arrays mapped from files keep their values in the file: their block holds the number of columns and the
+// index of the mapping, which is shared by every variable holding the same array
+#define ARENA_START USER_VAR_START
+#define COMPACT_BUDGET 4096     // Words compactVariables() may scan or move per call
+#define EMPTY_ENTRY -1
+#define DELETED_ENTRY -2
+
+// Sessions are saved as a header followed by one record per variable, all in little-endian words of 8 bytes.  The
+// header holds SESSION_MAGIC, the format version, the number of records, and the length and checksum of the records.
+// A record starts with a word holding its kind and the length of the name, then the name, padded to a whole word.  A
+// scalar or an integer is followed by its value, an array by its length, its number of columns, and its values, and a
+// longer integer by its number of limbs, negative if it is, and its limbs.  A number of the precision set by "prec" is
+// followed by its binary exponent, then its limbs as for an integer
+#define SESSION_MAGIC "clcsess\0"
+#define SESSION_VERSION 1
+#define SESSION_HEADER_SIZE 32
+#define RECORD_SCALAR 0
+#define RECORD_ARRAY 1
+#define RECORD_COMPLEX_ARRAY 2
+#define RECORD_INTEGER 3        // A scalar whose value is the bits of a 64-bit integer
+#define RECORD_BIG_INTEGER 4    // An integer too long for 64 bits
+#define RECORD_PRECISE 5        // A number of the precision set by "prec"
+
+static int mapCapacity;         // Words allocated for variableMap and variableTypes
+static int arenaLength;         // End of the used part of variableMap
+static int* arenaOwners;        // Slot whose value starts at each word of the arena, or -1
+static int freeWords;           // Words in holes left by deleted variables
+static int compactCursor;       // The arena is free of holes below this position
+static int slotCapacity;
+static int nrSlots;             // Slots ever handed out
+static int* freeSlots;          // Slots of deleted variables, to be handed out again
+static int nrFreeSlots;
+static int* nameTable;          // Open addressing hash table of slots, by name
+static int tableCapacity;
+static int tableUsed;           // Entries that are not empty, including deleted ones
+
+typedef struct {
+	mappedArray file;
+	int users;                  // Variables holding the array.  The file is unmapped when there are none left
+} fileMapping;
+
+static fileMapping* mappings;
+static int nrMappings;
+
+static unsigned int hashName(const char name[]) {
+	// FNV-1a hash of a name
+	unsigned int hash = 2166136261u;
+	for (int i = 0; i < INPUT_HOLDER_SIZE && name[i] != '\0'; i++) {
+		hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+	}
+	return hash;
+}
+
+static int findEntry(const char name[]) {
+	// Returns the table entry holding a name, or the empty entry where it would go
+	unsigned int index = hashName(name) & (tableCapacity - 1);
+	int deleted = -1;
+
+	while (nameTable[index] != EMPTY_ENTRY) {
+		if (nameTable[index] == DELETED_ENTRY) {
+			if (deleted < 0) deleted = index;
+		}
+		else if (strncmp(variableNames[nameTable[index]], name, INPUT_HOLDER_SIZE) == 0) {
+			return index;
+		}
+		index = (index + 1) & (tableCapacity - 1);
+	}
+	return (deleted >= 0) ? deleted : (int)index;
+}
+
+static bool growTable() {
+	// Doubles the hash table, dropping deleted entries
+	int* oldTable = nameTable;
+	int oldCapacity = tableCapacity;
+	int* newTable = malloc(2 * oldCapacity * sizeof(int));
+
+	if (newTable == NULL) return false;
+	nameTable = newTable;
+	tableCapacity = 2 * oldCapacity;
+	tableUsed = 0;
+	for (int i = 0; i < tableCapacity; i++) nameTable[i] = EMPTY_ENTRY;
+	for (int i = 0; i < oldCapacity; i++) {
+		if (oldTable[i] >= 0) {
+			nameTable[findEntry(variableNames[oldTable[i]])] = oldTable[i];
+			tableUsed++;
+		}
+	}
+	free(oldTable);
+	return true;
+}
+
+static void bindName(const char name[], int slot) {
+	// Makes a name refer to a slot
+	int index = 0;
+
+	if (2 * (tableUsed + 1) > tableCapacity && !growTable()) {
+		error = ERR_OVERFLOW;
+		return;
+	}
+	index = findEntry(name);
+	if (nameTable[index] == EMPTY_ENTRY) tableUsed++;
+	nameTable[index] = slot;
+}
+
+static bool growMap(int words) {
+	// Makes room for at least this many more words at the end of the arena
+	int capacity = mapCapacity;
+	double* map;
+	char* types;
+	int* owners;
+
+	if (arenaLength + words <= mapCapacity) return true;
+	if (words > 0x3FFFFFFF - arenaLength) return false;
+	while (capacity < arenaLength + words) capacity *= 2;
+
+	map = realloc(variableMap, capacity * sizeof(double));
+	if (map == NULL) return false;
+	variableMap = map;
+	types = realloc(variableTypes, capacity);
+	if (types == NULL) return false;
+	variableTypes = types;
+	owners = realloc(arenaOwners, capacity * sizeof(int));
+	if (owners == NULL) return false;
+	arenaOwners = owners;
+
+	for (int i = mapCapacity; i < capacity; i++) {
+		variableMap[i] = 0.0;
+		variableTypes[i] = TYPE_FREE;
+		arenaOwners[i] = -1;
+	}
+	mapCapacity = capacity;
+	return true;
+}
+
+static int newSlot() {
+	// Hands out the slot of a deleted variable, or a new one
+	int capacity = slotCapacity;
+	int* offsets;
+	char (*names)[INPUT_HOLDER_SIZE];
+
+	if (nrFreeSlots > 0) {
+		nrFreeSlots--;
+		return freeSlots[nrFreeSlots];
+	}
+	if (nrSlots >= slotCapacity) {
+		capacity = 2 * slotCapacity;
+		offsets = realloc(variableOffsets, capacity * sizeof(int));
+		if (offsets == NULL) return -1;
+		variableOffsets = offsets;
+		names = realloc(variableNames, capacity * sizeof(variableNames[0]));
+		if (names == NULL) return -1;
+		variableNames = names;
+		offsets = realloc(freeSlots, capacity * sizeof(int));
+		if (offsets == NULL) return -1;
+		freeSlots = offsets;
+		memset(variableNames[slotCapacity], 0, (capacity - slotCapacity) * sizeof(variableNames[0]));
+		slotCapacity = capacity;
+	}
+	nrSlots++;
+	return nrSlots - 1;
+}
+
+static int blockLength(int offset) {
+	// Returns the number of words taken by the value starting at a position of the arena
+	if (variableTypes[offset] >= TYPE_STRING_HEAD && variableTypes[offset] <= TYPE_PRECISE_HEAD) {
+		return 1 + (int)variableMap[offset];
+	}
+	return 1;
+}
+
+static int mappingOf(int offset) {
+	// Returns the mapping of the array starting at a position of the arena, or -1 if its values are in the arena
+	if (variableTypes[offset] != TYPE_DOUBLE_HEAD && variableTypes[offset] != TYPE_FLOAT_HEAD) return -1;
+	return (variableTypes[offset + 2] == TYPE_INT) ? (int)variableMap[offset + 2] : -1;
+}
+
+static void releaseBlock(int offset) {
+	// Frees the words of the value starting at a position of the arena.  Values of the fixed slots are not in the arena
+	int length = blockLength(offset);
+	int mapping = mappingOf(offset);
+
+	if (mapping >= 0) {
+		mappings[mapping].users--;
+		if (mappings[mapping].users == 0) unmapArrayFile(&mappings[mapping].file);
+	}
+	if (offset < ARENA_START) return;
+	for (int i = offset; i < offset + length; i++) {
+		variableTypes[i] = TYPE_FREE;
+	}
+	arenaOwners[offset] = -1;
+	if (offset + length == arenaLength) {
+		// Last in the arena, so there is no hole
+		arenaLength = offset;
+		while (arenaLength > ARENA_START && variableTypes[arenaLength - 1] == TYPE_FREE) {
+			arenaLength--;
+			freeWords--;
+		}
+		if (compactCursor > arenaLength) compactCursor = arenaLength;
+	}
+	else {
+		freeWords += length;
+		if (offset < compactCursor) compactCursor = offset;
+	}
+}
+
+// Sets up the fixed slots, "ans" and the constants, and an empty arena.  Must be called before anything else
+void initVariables() {
+
+	mapCapacity = 2 * ARENA_START;
+	arenaLength = ARENA_START;
+	variableMap = calloc(mapCapacity, sizeof(double));
+	variableTypes = calloc(mapCapacity, 1);
+	arenaOwners = malloc(mapCapacity * sizeof(int));
+	slotCapacity = 4 * USER_VAR_START;
+	nrSlots = USER_VAR_START;
+	variableOffsets = malloc(slotCapacity * sizeof(int));
+	variableNames = calloc(slotCapacity, sizeof(variableNames[0]));
+	freeSlots = malloc(slotCapacity * sizeof(int));
+	nrFreeSlots = 0;
+	tableCapacity = 4 * USER_VAR_START;
+	tableUsed = 0;
+	nameTable = malloc(tableCapacity * sizeof(int));
+	freeWords = 0;
+	compactCursor = ARENA_START;
+
+	if (variableMap == NULL || variableTypes == NULL || arenaOwners == NULL || variableOffsets == NULL
+		|| variableNames == NULL || freeSlots == NULL || nameTable == NULL) {
+		printf("  Out of memory\n");
+		exit(1);
+	}
+	for (int i = 0; i < mapCapacity; i++) arenaOwners[i] = -1;
+	for (int i = 0; i < tableCapacity; i++) nameTable[i] = EMPTY_ENTRY;
+	for (int i = 0; i < USER_VAR_START; i++) variableOffsets[i] = i;
+
+	strcpy(variableNames[ANS_ADDR], "ans");
+	variableTypes[ANS_ADDR] = TYPE_DOUBLE;
+	bindName(variableNames[ANS_ADDR], ANS_ADDR);
+}
+
+void loadVariables(int VAR_START_POSITION, int VAR_END_POSITION, char filename[64]) {
+	// Loads variables from file into memory
+	FILE* file = NULL;
+	file = fopen(filename, "r");
+	char textInput[LOAD_VAR_HOLDER_SIZE] = { '\0' };
+	char holder[LOAD_VAR_HOLDER_SIZE] = { '\0' };
+	bool lineError[LOAD_VAR_HOLDER_SIZE] = { false };
+	int j = 0; // iterator
+	int jHolder = 0;
+	bool noLoadFail = true;
+
+	if (file == NULL) {
+		printf("  Could not load %s\n", filename);
+	}
+	else {
+		// Iterates line by line. Starts at 1 because element 0 is "ans"
+		for (int i = VAR_START_POSITION; i <= VAR_END_POSITION && fgets(textInput, LOAD_VAR_HOLDER_SIZE, file); i++) {
+			if ((textInput[0] >= 'a' && textInput[0] <= 'z') || (textInput[0] >= 'A' && textInput[0] <= 'Z')) {
+
+				// Gets variable name
+				for (j = 0; j <= 20 && ((textInput[j] >= 'a' && textInput[j] <= 'z') || (textInput[j] >= 'A' && textInput[j] <= 'Z')
+					|| (textInput[j] >= '0' && textInput[j] <= '9') || textInput[j] == '_'); j++) {
+					variableNames[i][j] = textInput[j];
+				}
+
+				// Skips over space.  If character isn't a space, skip this line
+				if (textInput[j] != ' ' && textInput[j] != '\t') {
+					lineError[i] = true;
+					continue;
+				}
+				else j++;
+
+				// Gets variable values
+				for (; j < 118 && ((textInput[j] >= '0' && textInput[j] <= '9') || textInput[j] == '.' || textInput[j] == 'E'
+					|| textInput[j] == 'e' || textInput[j] == '-' || textInput[j] == '+'); j++) {
+					holder[jHolder] = textInput[j];
+					jHolder++;
+				}
+
+				// Puts variable values into memory
+				variableMap[i] = atof(holder);
+				variableTypes[i] = TYPE_DOUBLE;
+				bindName(variableNames[i], i);
+				// TODO:  Add support for different variable types
+
+				// Clears holder
+				while (jHolder > 0) {
+					holder[jHolder] = '\0';
+					jHolder--;
+				}
+				holder[jHolder] = '\0';
+			}
+			else if (textInput[0] == '\0') continue;
+			else lineError[i] = true;
+		}
+	}
+
+	for (int i = 0; i < LOAD_VAR_HOLDER_SIZE; i++) {
+		if (lineError[i]) {
+			printf("  Failed to parse line %d from file %s\n", i, filename);
+			noLoadFail = false;
+		}
+	}
+	if (!noLoadFail) printf("\n");
+
+	if (file != NULL) fclose(file);
+}
+
+// Saves variables to file
+void saveVariable(int VAR_START_POSITION, int VAR_END_POSITION, char filename[]) {
+	// Start and end positions will be different depending on whether constants or regular variables are being saved
+	// Positions should be chosen such that unnamed variables are not saved
+
+	FILE* file = NULL;
+	file = fopen(filename, "w");
+	bigInteger big;
+	char* digits = NULL;
+
+	if (file == NULL) {
+		printf("  Could not load %s\n", filename);
+	}
+	else {
+		// Only scalars can be written as text.  17 significant digits read back as the same double
+		for (int i = VAR_START_POSITION; i < VAR_END_POSITION && i < nrSlots; i++) {
+			if (variableNames[i][0] == '\0') continue;
+			if (variableTypes[variableOffsets[i]] == TYPE_INT_HEAD) {
+				initBig(&big);
+				digits = getBigInteger(i, &big) ? bigToString(&big) : NULL;
+				if (digits != NULL) fprintf(file, "%s %s\n", variableNames[i], digits);
+				free(digits);
+				freeBig(&big);
+			}
+			else if (getVariableType(i) == TYPE_INT) {
+				fprintf(file, "%s %lld\n", variableNames[i], getInteger(i));
+			}
+			else if (getVariableType(i) == TYPE_DOUBLE) {
+				fprintf(file, "%s %.17g\n", variableNames[i], getVariable(i));
+			}
+		}
+	}
+
+	if (file != NULL) fclose(file);
+}
+
+static uint64_t checksumWords(uint64_t sum, const void* data, long long int bytes) {
+	// Adds whole words to a checksum of the records of a session file
+	uint64_t word = 0;
+
+	for (long long int i = 0; i < bytes; i += 8) {
+		memcpy(&word, (const char*)data + i, 8);
+		sum = (sum ^ word) * 0x9E3779B97F4A7C15ULL;
+		sum ^= sum >> 29;
+	}
+	return sum;
+}
+
+static bool writeWords(FILE* file, const void* data, long long int bytes, uint64_t* sum, long long int* length) {
+	// Writes part of a record, padded with zeros to a whole word
+	char padding[8] = { 0 };
+	long long int whole = bytes & ~7LL;
+
+	if (fwrite(data, 1, whole, file) != (size_t)whole) return false;
+	*sum = checksumWords(*sum, data, whole);
+	*length += whole;
+	if (bytes == whole) return true;
+	memcpy(padding, (const char*)data + whole, bytes - whole);
+	*sum = checksumWords(*sum, padding, 8);
+	*length += 8;
+	return fwrite(padding, 1, 8, file) == 8;
+}
+
+// Saves "ans" and every user variable to a binary file, with values stored exactly.  The file is written under a
+// temporary name and then renamed, so that an existing session is only replaced by a complete one.  Arrays mapped from
+// files are saved as doubles.  Returns false, after printing why, if the file can't be written
+bool saveSession(const char fileName[]) {
+
+	char header[SESSION_HEADER_SIZE] = SESSION_MAGIC;
+	char* temporary = malloc(strlen(fileName) + 5);
+	FILE* file = NULL;
+	uint64_t sum = 0;
+	uint64_t word = 0;
+	long long int length = 0;
+	uint32_t nrRecords = 0;
+	uint32_t version = SESSION_VERSION;
+	double* values = NULL;
+	double* converted = NULL;
+	long count = 0;
+	long columns = 0;
+	int64_t shape[2];
+	bool ok = true;
+
+	if (temporary == NULL) return false;
+	sprintf(temporary, "%s.tmp", fileName);
+	file = fopen(temporary, "wb");
+	if (file == NULL) {
+		printf("  Could not write %s\n", fileName);
+		free(temporary);
+		return false;
+	}
+	ok = fwrite(header, 1, SESSION_HEADER_SIZE, file) == SESSION_HEADER_SIZE;
+
+	for (int slot = 0; slot < nrSlots && ok; slot = (slot == ANS_ADDR) ? USER_VAR_START : slot + 1) {
+		if (variableNames[slot][0] == '\0' || findVariableSlot(variableNames[slot]) != slot) continue;
+		if (variableTypes[variableOffsets[slot]] == TYPE_PRECISE_HEAD) {
+			word = RECORD_PRECISE;
+		}
+		else switch (getVariableType(slot)) {
+		case TYPE_DOUBLE:
+			word = RECORD_SCALAR;
+			break;
+		case TYPE_INT:
+			word = (variableTypes[variableOffsets[slot]] == TYPE_INT_HEAD) ? RECORD_BIG_INTEGER : RECORD_INTEGER;
+			break;
+		case TYPE_CPLX_RECT_ARR:
+			word = RECORD_COMPLEX_ARRAY;
+			break;
+		default:
+			word = RECORD_ARRAY;
+			break;
+		}
+		word |= (uint64_t)strlen(variableNames[slot]) << 8;
+		ok = writeWords(file, &word, 8, &sum, &length)
+			&& writeWords(file, variableNames[slot], (long long int)strlen(variableNames[slot]), &sum, &length);
+		nrRecords++;
+
+		if ((word & 0xFF) == RECORD_PRECISE) {
+			// The words after the head hold the exponent and the signed number of limbs as doubles
+			shape[0] = (int64_t)variableMap[variableOffsets[slot] + 1];
+			shape[1] = (int64_t)variableMap[variableOffsets[slot] + 2];
+			count = (long)variableMap[variableOffsets[slot]] - 2;
+			ok = ok && writeWords(file, shape, sizeof(shape), &sum, &length)
+				&& writeWords(file, &variableMap[variableOffsets[slot] + 3], count * 8LL, &sum, &length);
+			continue;
+		}
+		if ((word & 0xFF) == RECORD_BIG_INTEGER) {
+			// The word after the head holds the signed number of limbs as a double
+			shape[0] = (int64_t)variableMap[variableOffsets[slot] + 1];
+			count = (long)variableMap[variableOffsets[slot]] - 1;
+			ok = ok && writeWords(file, shape, 8, &sum, &length)
+				&& writeWords(file, &variableMap[variableOffsets[slot] + 2], count * 8LL, &sum, &length);
+			continue;
+		}
+		if (getVariableType(slot) == TYPE_DOUBLE || getVariableType(slot) == TYPE_INT) {
+			ok = ok && writeWords(file, &variableMap[variableOffsets[slot]], 8, &sum, &length);
+			continue;
+		}
+		values = getArray(slot, &count, &columns);
+		shape[0] = count;
+		shape[1] = columns;
+		ok = ok && writeWords(file, shape, sizeof(shape), &sum, &length);
+		if (getVariableType(slot) == TYPE_FLOAT_ARR) {
+			// Floats are written a block at a time as doubles
+			converted = malloc(BATCH_SIZE * 256 * sizeof(double));
+			ok = ok && converted != NULL;
+			for (long start = 0; start < count && ok; start += BATCH_SIZE * 256) {
+				long block = (count - start < BATCH_SIZE * 256) ? count - start : BATCH_SIZE * 256;
+				for (long i = 0; i < block; i++) converted[i] = ((const float*)values)[start + i];
+				ok = writeWords(file, converted, block * (long long int)sizeof(double), &sum, &length);
+			}
+			free(converted);
+		}
+		else {
+			count *= (getVariableType(slot) == TYPE_CPLX_RECT_ARR) ? 2 : 1;
+			ok = ok && writeWords(file, values, count * (long long int)sizeof(double), &sum, &length);
+		}
+	}
+
+	memcpy(&header[8], &version, 4);
+	memcpy(&header[12], &nrRecords, 4);
+	memcpy(&header[16], &length, 8);
+	memcpy(&header[24], &sum, 8);
+	ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(header, 1, SESSION_HEADER_SIZE, file) == SESSION_HEADER_SIZE;
+	ok = (fclose(file) == 0) && ok;
+	ok = ok && rename(temporary, fileName) == 0;
+	if (!ok) {
+		remove(temporary);
+		printf("  Could not write %s\n", fileName);
+	}
+	free(temporary);
+	return ok;
+}
+
+// Restores the variables of a file written by saveSession(), replacing variables of the same name.  The file is mapped
+// rather than read, and values are copied from it into the arena.  Nothing is changed unless the whole file is valid.
+// Returns false, after printing why, if it isn't
+bool loadSession(const char fileName[]) {
+
+	mappedArray file;
+	const char* data = NULL;
+	const char* record = NULL;
+	const char* end = NULL;
+	uint32_t version = 0;
+	uint32_t nrRecords = 0;
+	long long int length = 0;
+	uint64_t sum = 0;
+	uint64_t word = 0;
+	int64_t shape[2];
+	double value = 0.0;
+	long long int integer = 0;
+	char name[INPUT_HOLDER_SIZE];
+	long long int nameLength = 0;
+	long long int valueBytes = 0;
+	bigInteger big;
+	bigFloat precise;
+	int slot = 0;
+	bool scalar = false;
+	bool ok = true;
+
+	if (!mapFile(fileName, &file)) return false;
+	data = file.address;
+	if (file.size >= SESSION_HEADER_SIZE) {
+		memcpy(&version, &data[8], 4);
+		memcpy(&nrRecords, &data[12], 4);
+		memcpy(&length, &data[16], 8);
+		memcpy(&sum, &data[24], 8);
+	}
+	if (file.size < SESSION_HEADER_SIZE || memcmp(data, SESSION_MAGIC, 8) != 0 || version != SESSION_VERSION) {
+		printf("  %s is not a session file\n", fileName);
+		unmapArrayFile(&file);
+		return false;
+	}
+	if (length != file.size - SESSION_HEADER_SIZE || length % 8 != 0
+		|| checksumWords(0, &data[SESSION_HEADER_SIZE], length) != sum) {
+		printf("  %s is damaged\n", fileName);
+		unmapArrayFile(&file);
+		return false;
+	}
+
+	// Check every record before changing anything
+	end = data + file.size;
+	for (int pass = 0; pass < 2 && ok; pass++) {
+		record = &data[SESSION_HEADER_SIZE];
+		for (uint32_t i = 0; i < nrRecords && ok; i++) {
+			ok = end - record >= 8;
+			if (ok) memcpy(&word, record, 8);
+			nameLength = (long long int)(word >> 8);
+			scalar = (word & 0xFF) == RECORD_SCALAR || (word & 0xFF) == RECORD_INTEGER
+				|| (word & 0xFF) == RECORD_BIG_INTEGER;
+			ok = ok && nameLength > 0 && nameLength < INPUT_HOLDER_SIZE && (word & 0xFF) <= RECORD_PRECISE
+				&& end - record >= 8 + ((nameLength + 7) & ~7LL) + (scalar ? 8 : 16);
+			if (!ok) break;
+			memcpy(name, record + 8, nameLength);
+			name[nameLength] = '\0';
+			record += 8 + ((nameLength + 7) & ~7LL);
+
+			if ((word & 0xFF) == RECORD_PRECISE) {
+				memcpy(shape, record, sizeof(shape));
+				record += sizeof(shape);
+				ok = shape[0] > -(1LL << 50) && shape[0] < (1LL << 50) && shape[1] > -0x3FFFFFFF && shape[1] < 0x3FFFFFFF;
+				valueBytes = ok ? ((llabs(shape[1]) + 1) / 2) * 8 : 0;
+				ok = ok && end - record >= valueBytes;
+				if (ok && pass == 1) {
+					slot = findVariableSlot(name);
+					if (slot < 0) slot = addVariable(name);
+					initFloat(&precise);
+					precise.exponent = shape[0];
+					if (slot >= 0 && (slot == ANS_ADDR || slot >= USER_VAR_START)
+						&& !(setBigLimbs(&precise.mantissa, (const uint32_t*)record, (int)llabs(shape[1]), shape[1] < 0)
+							&& setBigFloat(slot, &precise))) {
+						printf("  Not enough memory for %s\n", name);
+					}
+					freeFloat(&precise);
+				}
+				record += valueBytes;
+				continue;
+			}
+			if ((word & 0xFF) == RECORD_BIG_INTEGER) {
+				memcpy(&integer, record, 8);
+				record += 8;
+				ok = integer != 0 && integer > -0x3FFFFFFF && integer < 0x3FFFFFFF;
+				valueBytes = ok ? ((llabs(integer) + 1) / 2) * 8 : 0;
+				ok = ok && end - record >= valueBytes;
+				if (ok && pass == 1) {
+					slot = findVariableSlot(name);
+					if (slot < 0) slot = addVariable(name);
+					initBig(&big);
+					if (slot >= 0 && (slot == ANS_ADDR || slot >= USER_VAR_START)
+						&& !(setBigLimbs(&big, (const uint32_t*)record, (int)llabs(integer), integer < 0)
+							&& setBigInteger(slot, &big))) {
+						printf("  Not enough memory for %s\n", name);
+					}
+					freeBig(&big);
+				}
+				record += valueBytes;
+				continue;
+			}
+			if (scalar) {
+				if (pass == 1) {
+					slot = findVariableSlot(name);
+					if (slot < 0) slot = addVariable(name);
+					if (slot >= 0 && (slot == ANS_ADDR || slot >= USER_VAR_START)) {
+						memcpy(&value, record, 8);
+						memcpy(&integer, record, 8);
+						if ((word & 0xFF) == RECORD_INTEGER) {
+							setInteger(slot, integer);
+						}
+						else {
+							setVariable(slot, value);
+						}
+					}
+				}
+				record += 8;
+				continue;
+			}
+			memcpy(shape, record, sizeof(shape));
+			record += sizeof(shape);
+			valueBytes = shape[0] * (long long int)sizeof(double) * (((word & 0xFF) == RECORD_COMPLEX_ARRAY) ? 2 : 1);
+			ok = shape[0] >= 1 && shape[0] < 0x3FFFFFFF && shape[1] >= 0 && (shape[1] == 0 || shape[0] % shape[1] == 0)
+				&& end - record >= valueBytes;
+			if (ok && pass == 1) {
+				slot = findVariableSlot(name);
+				if (slot < 0) slot = addVariable(name);
+				if (slot >= 0 && (slot == ANS_ADDR || slot >= USER_VAR_START)
+					&& !setArray(slot, (const double*)record, (long)shape[0], (long)shape[1],
+						((word & 0xFF) == RECORD_COMPLEX_ARRAY) ? TYPE_CPLX_RECT_ARR : TYPE_DOUBLE_ARR)) {
+					printf("  Not enough memory for %s\n", name);
+				}
+			}
+			record += valueBytes;
+		}
+		ok = ok && record == end;
+	}
+	if (!ok) printf("  %s is damaged\n", fileName);
+	unmapArrayFile(&file);
+	return ok;
+}
+
+// Allocates memory for variable, assigns variable
+// Returns the slot given to the new variable, a scalar of value 0, or -1 if there is no room left or the name is too long
+int addVariable(char name[]) {
+
+	int slot = 0;
+	int length = 0;
+	while (length < INPUT_HOLDER_SIZE && name[length] != '\0') length++;
+	if (length >= INPUT_HOLDER_SIZE || !growMap(1)) {
+		error = ERR_OVERFLOW;
+		return -1;
+	}
+	slot = newSlot();
+	if (slot < 0) {
+		error = ERR_OVERFLOW;
+		return -1;
+	}
+
+	memcpy(variableNames[slot], name, length);
+	variableNames[slot][length] = '\0';
+	variableOffsets[slot] = arenaLength;
+	variableTypes[arenaLength] = TYPE_DOUBLE;
+	variableMap[arenaLength] = 0.0;
+	arenaOwners[arenaLength] = slot;
+	arenaLength++;
+	bindName(variableNames[slot], slot);
+	return slot;
+}
+
+// Makes a name no longer refer to its variable, so that later statements can't find it.  The variable itself lives
+// until delVariable() is called on its slot, which a compiled "del" statement does when it runs
+void unbindVariable(char name[]) {
+
+	int index = findEntry(name);
+
+	if (nameTable[index] >= 0) {
+		nameTable[index] = DELETED_ENTRY;
+	}
+}
+
+// Memory for particular variable is freed.  The hole it leaves is closed later by compactVariables()
+void delVariable(int slot) {
+
+	int index = 0;
+
+	if (slot < USER_VAR_START || slot >= nrSlots || arenaOwners[variableOffsets[slot]] != slot) return;
+	index = findEntry(variableNames[slot]);
+	if (nameTable[index] == slot) {
+		nameTable[index] = DELETED_ENTRY;
+	}
+	releaseBlock(variableOffsets[slot]);
+
+	variableNames[slot][0] = '\0';
+	freeSlots[nrFreeSlots] = slot;
+	nrFreeSlots++;
+}
+
+// Closes holes in the arena by moving the values above them down, a bounded amount of work per call, so that it can be
+// called between statements without holding up evaluation.  Compiled code is unaffected, since it refers to slots
+void compactVariables() {
+
+	int budget = COMPACT_BUDGET;
+	int next = 0;
+	int slot = 0;
+	int length = 0;
+
+	while (freeWords > 0 && budget > 0 && compactCursor < arenaLength) {
+		if (variableTypes[compactCursor] != TYPE_FREE) {
+			compactCursor += blockLength(compactCursor);
+			budget--;
+			continue;
+		}
+
+		// Find the next value above the hole
+		for (next = compactCursor; next < arenaLength && variableTypes[next] == TYPE_FREE; next++) budget--;
+		if (next == arenaLength) {
+			freeWords -= arenaLength - compactCursor;
+			arenaLength = compactCursor;
+			break;
+		}
+
+		slot = arenaOwners[next];
+		length = blockLength(next);
+		memmove(&variableMap[compactCursor], &variableMap[next], length * sizeof(double));
+		memmove(&variableTypes[compactCursor], &variableTypes[next], length);
+		for (int i = compactCursor + length; i < next + length; i++) {
+			variableTypes[i] = TYPE_FREE;
+		}
+		arenaOwners[next] = -1;
+		arenaOwners[compactCursor] = slot;
+		variableOffsets[slot] = compactCursor;
+		compactCursor += length;
+		budget -= length;
+	}
+}
+
+// Finds the slot of a variable from its name, or returns -1 if no variable has that name
+int findVariableSlot(char input[]) {
+
+	int index = findEntry(input);
+
+	countLookup(LOOKUP_VARIABLE);
+	return (nameTable[index] >= 0) ? nameTable[index] : -1;
+}
+
+// Returns the value of a scalar variable, converting an integer or a number of any precision to a double
+double getVariable(int slot) {
+
+	int offset = variableOffsets[slot];
+	long long int integer = 0;
+	bigInteger big;
+	bigFloat precise;
+	double value = 0.0;
+
+	if (variableTypes[offset] == TYPE_INT_HEAD) {
+		initBig(&big);
+		if (getBigInteger(slot, &big)) value = bigToDouble(&big);
+		freeBig(&big);
+		return value;
+	}
+	if (variableTypes[offset] == TYPE_PRECISE_HEAD) {
+		initFloat(&precise);
+		if (getBigFloat(slot, &precise)) value = floatToDouble(&precise);
+		freeFloat(&precise);
+		return value;
+	}
+	if (variableTypes[offset] != TYPE_INT) return variableMap[offset];
+	memcpy(&integer, &variableMap[offset], sizeof(integer));
+	return (double)integer;
+}
+
+// Returns the value of a variable holding an integer
+long long int getInteger(int slot) {
+
+	long long int integer = 0;
+
+	memcpy(&integer, &variableMap[variableOffsets[slot]], sizeof(integer));
+	return integer;
+}
+
+static int scalarOffset(int slot) {
+	// Makes a variable hold a scalar, and returns the position of its word, or -1 if there is no room for it
+	int offset = variableOffsets[slot];
+
+	if (variableTypes[offset] != TYPE_DOUBLE && variableTypes[offset] != TYPE_INT) {
+		// The variable holds an array, which is replaced by a scalar.  Fixed slots go back to their own position
+		releaseBlock(offset);
+		if (slot < USER_VAR_START) {
+			offset = slot;
+		}
+		else {
+			if (!growMap(1)) {
+				error = ERR_OVERFLOW;
+				return -1;
+			}
+			offset = arenaLength;
+			arenaOwners[offset] = slot;
+			arenaLength++;
+		}
+		variableTypes[offset] = TYPE_DOUBLE;
+		variableOffsets[slot] = offset;
+	}
+	return offset;
+}
+
+void setVariable(int slot, double value) {
+
+	int offset = scalarOffset(slot);
+
+	if (offset < 0) return;
+	variableTypes[offset] = TYPE_DOUBLE;
+	variableMap[offset] = value;
+}
+
+// Stores an integer in a variable.  Its bits are kept in the word of the variable as they are
+void setInteger(int slot, long long int value) {
+
+	int offset = scalarOffset(slot);
+
+	if (offset < 0) return;
+	variableTypes[offset] = TYPE_INT;
+	memcpy(&variableMap[offset], &value, sizeof(value));
+}
+
+// Copies the value of a variable holding an integer of any size into value.  Returns false if it holds something else
+bool getBigInteger(int slot, bigInteger* value) {
+
+	int offset = variableOffsets[slot];
+	long long int integer = 0;
+	int length = 0;
+
+	if (variableTypes[offset] == TYPE_INT) {
+		memcpy(&integer, &variableMap[offset], sizeof(integer));
+		return setBig(value, integer);
+	}
+	if (variableTypes[offset] != TYPE_INT_HEAD) return false;
+	length = (int)variableMap[offset + 1];
+	return setBigLimbs(value, (const uint32_t*)&variableMap[offset + 2], abs(length), length < 0);
+}
+
+// Stores an integer of any size in a variable.  One that fits in 64 bits is stored as by setInteger().  A longer one
+// takes a block whose head is followed by its number of limbs, negative if it is, and then its limbs, two to a word.
+// Returns false if there is no room for it
+bool setBigInteger(int slot, const bigInteger* value) {
+
+	int offset = variableOffsets[slot];
+	long long int integer = 0;
+	int words = (value->length + 1) / 2;
+
+	if (bigToInteger(value, &integer)) {
+		setInteger(slot, integer);
+		return true;
+	}
+	if (variableTypes[offset] != TYPE_INT_HEAD || (int)variableMap[offset] != words + 1) {
+		if (!growMap(words + 2)) return false;
+		releaseBlock(offset);
+		offset = arenaLength;
+		variableMap[offset] = (double)(words + 1);
+		variableTypes[offset] = TYPE_INT_HEAD;
+		variableTypes[offset + 1] = TYPE_INT;
+		memset(&variableTypes[offset + 2], TYPE_INT_ARR, words);
+		arenaOwners[offset] = slot;
+		arenaLength += words + 2;
+		variableOffsets[slot] = offset;
+	}
+	variableMap[offset + 1] = value->negative ? -(double)value->length : (double)value->length;
+	variableMap[offset + 1 + words] = 0.0;
+	memcpy(&variableMap[offset + 2], value->limbs, value->length * sizeof(uint32_t));
+	return true;
+}
+
+// Copies the value of a variable holding a number of the precision set by "prec" into value.  Returns false if it holds
+// something else
+bool getBigFloat(int slot, bigFloat* value) {
+
+	int offset = variableOffsets[slot];
+	int length = 0;
+
+	if (variableTypes[offset] != TYPE_PRECISE_HEAD) return false;
+	length = (int)variableMap[offset + 2];
+	value->exponent = (long long int)variableMap[offset + 1];
+	value->undefined = false;
+	return setBigLimbs(&value->mantissa, (const uint32_t*)&variableMap[offset + 3], abs(length), length < 0);
+}
+
+// Stores a number of the precision set by "prec" in a variable.  It takes a block whose head is followed by its
+// exponent, its number of limbs, negative if it is, and then its limbs, two to a word.  Returns false if there is no
+// room for it
+bool setBigFloat(int slot, const bigFloat* value) {
+
+	int offset = variableOffsets[slot];
+	int words = (value->mantissa.length + 1) / 2;
+
+	if (variableTypes[offset] != TYPE_PRECISE_HEAD || (int)variableMap[offset] != words + 2) {
+		if (!growMap(words + 3)) return false;
+		releaseBlock(offset);
+		offset = arenaLength;
+		variableMap[offset] = (double)(words + 2);
+		variableTypes[offset] = TYPE_PRECISE_HEAD;
+		variableTypes[offset + 1] = TYPE_INT;
+		variableTypes[offset + 2] = TYPE_INT;
+		memset(&variableTypes[offset + 3], TYPE_PRECISE_ARR, words);
+		arenaOwners[offset] = slot;
+		arenaLength += words + 3;
+		variableOffsets[slot] = offset;
+	}
+	variableMap[offset + 1] = (double)value->exponent;
+	variableMap[offset + 2] = value->mantissa.negative ? -(double)value->mantissa.length : (double)value->mantissa.length;
+	if (words > 0) variableMap[offset + 2 + words] = 0.0;
+	memcpy(&variableMap[offset + 3], value->mantissa.limbs, value->mantissa.length * sizeof(uint32_t));
+	return true;
+}
+
+// Returns TYPE_DOUBLE_ARR or TYPE_CPLX_RECT_ARR for a variable holding an array of real or complex values,
+// TYPE_FLOAT_ARR for an array of floats mapped from a file, TYPE_INT for an integer of any size and TYPE_DOUBLE for
+// other scalars
+char getVariableType(int slot) {
+
+	switch (variableTypes[variableOffsets[slot]]) {
+	case TYPE_INT:
+	case TYPE_INT_HEAD:
+		return TYPE_INT;
+	case TYPE_DOUBLE_HEAD:
+		return TYPE_DOUBLE_ARR;
+	case TYPE_CPLX_RECT_HEAD:
+		return TYPE_CPLX_RECT_ARR;
+	case TYPE_FLOAT_HEAD:
+		return TYPE_FLOAT_ARR;
+	default:
+		return TYPE_DOUBLE;
+	}
+}
+
+// Returns the values of an array variable and sets its length and number of columns, or returns NULL if the variable is
+// not an array.  Complex values take two words each, the real part first
+double* getArray(int slot, long* length, long* columns) {
+
+	int offset = variableOffsets[slot];
+
+	if (variableTypes[offset] != TYPE_DOUBLE_HEAD && variableTypes[offset] != TYPE_CPLX_RECT_HEAD
+		&& variableTypes[offset] != TYPE_FLOAT_HEAD) {
+		return NULL;
+	}
+	*columns = (long)variableMap[offset + 1];
+	if (mappingOf(offset) >= 0) {
+		*length = mappings[mappingOf(offset)].file.length;
+		return (double*)mappings[mappingOf(offset)].file.values;
+	}
+	*length = ((long)variableMap[offset] - 1) / ((variableTypes[offset] == TYPE_CPLX_RECT_HEAD) ? 2 : 1);
+	return &variableMap[offset + 2];
+}
+
+static bool bindMapping(int slot, int mapping, long columns) {
+	// Makes a variable hold the array of a mapped file
+	int offset = 0;
+
+	if (!growMap(3)) return false;
+	mappings[mapping].users++;
+	releaseBlock(variableOffsets[slot]);
+
+	offset = arenaLength;
+	variableMap[offset] = 2.0;
+	variableTypes[offset] = (mappings[mapping].file.type == TYPE_FLOAT_ARR) ? TYPE_FLOAT_HEAD : TYPE_DOUBLE_HEAD;
+	variableMap[offset + 1] = (double)columns;
+	variableTypes[offset + 1] = TYPE_INT;
+	variableMap[offset + 2] = (double)mapping;
+	variableTypes[offset + 2] = TYPE_INT;
+	arenaOwners[offset] = slot;
+	arenaLength += 3;
+	variableOffsets[slot] = offset;
+	return true;
+}
+
+// Makes a variable hold the values of a file of doubles or floats, or of a .npy file, without reading them.  The file is
+// mapped, and its pages are read as the values on them are used.  Defines the variable if needed.  Returns false, after
+// printing why, if the file can't be used
+bool mapVariable(char name[], const char fileName[], bool single) {
+
+	int slot = findVariableSlot(name);
+	int mapping = 0;
+	fileMapping* newMappings = NULL;
+
+	if (slot < 0) slot = addVariable(name);
+	if (slot < USER_VAR_START) {
+		printf("  Can't store an array in %s\n", name);
+		return false;
+	}
+	for (mapping = 0; mapping < nrMappings && mappings[mapping].users > 0; mapping++);
+	if (mapping == nrMappings) {
+		newMappings = realloc(mappings, (nrMappings + 1) * sizeof(fileMapping));
+		if (newMappings == NULL) return false;
+		mappings = newMappings;
+		nrMappings++;
+	}
+	mappings[mapping].users = 0;
+	if (!mapArrayFile(fileName, single, &mappings[mapping].file)) return false;
+	if (!bindMapping(slot, mapping, mappings[mapping].file.columns)) {
+		unmapArrayFile(&mappings[mapping].file);
+		printf("  Not enough memory for %s\n", name);
+		return false;
+	}
+	return true;
+}
+
+// Stores an array in a variable, replacing its value.  type is TYPE_DOUBLE_ARR or TYPE_CPLX_RECT_ARR, and columns is
+// the row length of a matrix, or 0 for a plain array.  The values may be those of another variable.  The whole array of
+// a mapped file is shared rather than copied, and is the only way to store floats.  Returns false if there is no room
+bool setArray(int slot, const double values[], long length, long columns, char type) {
+
+	int offset = variableOffsets[slot];
+	long source = -1;  // Position of the values in variableMap, which may move when it grows
+	long words = (type == TYPE_CPLX_RECT_ARR) ? 2 * length : length;
+	char head = (type == TYPE_CPLX_RECT_ARR) ? TYPE_CPLX_RECT_HEAD : TYPE_DOUBLE_HEAD;
+
+	for (int i = 0; i < nrMappings; i++) {
+		if (mappings[i].users > 0 && mappings[i].file.values == (const void*)values && mappings[i].file.length == length) {
+			return bindMapping(slot, i, columns);
+		}
+	}
+	if (length < 1 || words >= 0x3FFFFFFF || type == TYPE_FLOAT_ARR) return false;
+	if (variableTypes[offset] == head && (long)variableMap[offset] == words + 1 && mappingOf(offset) < 0) {
+		// Same size, so the values are replaced where they are
+		variableMap[offset + 1] = (double)columns;
+		memmove(&variableMap[offset + 2], values, words * sizeof(double));
+		return true;
+	}
+
+	if (values >= variableMap && values < variableMap + mapCapacity) source = values - variableMap;
+	if (!growMap((int)words + 2)) return false;
+	if (source >= 0) values = &variableMap[source];
+	releaseBlock(offset);
+
+	// The head holds the number of words after it: the number of columns, then the values
+	offset = arenaLength;
+	variableMap[offset] = (double)(words + 1);
+	variableTypes[offset] = head;
+	variableMap[offset + 1] = (double)columns;
+	variableTypes[offset + 1] = TYPE_INT;
+	memmove(&variableMap[offset + 2], values, words * sizeof(double));
+	memset(&variableTypes[offset + 2], type, words);
+	arenaOwners[offset] = slot;
+	arenaLength += (int)words + 2;
+	variableOffsets[slot] = offset;
+	return true;
+}
+
+// Finds variable's value from its name, and returns it
+// TODO: Will need heavy modification when multiple data types will need to be supported
+double findVariable(char input[]) {
+
+	int slot = findVariableSlot(input);
+
+	if (slot >= 0) {
+		return getVariable(slot);
+	}
+	error = ERR_UNKNOWN_TOKEN;
+	for (int i = 0; i < INPUT_HOLDER_SIZE; i++) {
+		unrecognizedToken[i] = input[i];
+	}
+
+	return 0.0;
 }
\ No newline at end of file